@@ -1128,13 +1128,13 @@ void SherpaOnnxVoiceActivityDetectorClear(
 
 const SherpaOnnxSpeechSegment *SherpaOnnxVoiceActivityDetectorFront(
     const SherpaOnnxVoiceActivityDetector *p) {
-  const sherpa_onnx::SpeechSegment &segment = p->impl->Front();
+  sherpa_onnx::SpeechSegmentView segment = p->impl->FrontView();
 
   SherpaOnnxSpeechSegment *ans = new SherpaOnnxSpeechSegment;
   ans->start = segment.start;
-  ans->samples = new float[segment.samples.size()];
-  std::copy(segment.samples.begin(), segment.samples.end(), ans->samples);
-  ans->n = segment.samples.size();
+  ans->samples = new float[segment.samples.Size()];
+  segment.samples.CopyTo(ans->samples);
+  ans->n = segment.samples.Size();
 
   return ans;
 }
@@ -0,0 +1,136 @@
+// sherpa-onnx/csrc/batched-states-test.cc
+//
+// Copyright (c)  2025  Xiaomi Corporation
+
+#include "sherpa-onnx/csrc/batched-states.h"
+
+#include <array>
+#include <utility>
+#include <vector>
+
+#include "gtest/gtest.h"
+
+namespace sherpa_onnx {
+
+// Two states of a batch of 8 streams. The batch dim of the first one is
+// 1 and that of the second one is 0. Entries of stream i are i * 100 + j.
+static std::vector<Ort::Value> BuildStates() {
+  Ort::AllocatorWithDefaultOptions allocator;
+
+  std::array<int64_t, 3> a_shape{2, 8, 3};
+  std::array<int64_t, 2> b_shape{8, 2};
+
+  Ort::Value a = Ort::Value::CreateTensor<float>(allocator, a_shape.data(),
+                                                 a_shape.size());
+  Ort::Value b = Ort::Value::CreateTensor<int64_t>(allocator, b_shape.data(),
+                                                   b_shape.size());
+
+  float *pa = a.GetTensorMutableData<float>();
+  for (int32_t i = 0; i != 2; ++i) {
+    for (int32_t s = 0; s != 8; ++s) {
+      for (int32_t j = 0; j != 3; ++j) {
+        *pa++ = s * 100 + i * 3 + j;
+      }
+    }
+  }
+
+  int64_t *pb = b.GetTensorMutableData<int64_t>();
+  for (int32_t s = 0; s != 8; ++s) {
+    for (int32_t j = 0; j != 2; ++j) {
+      *pb++ = s * 100 + j;
+    }
+  }
+
+  std::vector<Ort::Value> ans;
+  ans.push_back(std::move(a));
+  ans.push_back(std::move(b));
+  return ans;
+}
+
+static void CheckRow(const BatchedStates &batched, int32_t row) {
+  int32_t index = 0;
+  auto states = batched.Get(row, &index);
+
+  const auto &a = (*states)[0];
+  const auto &b = (*states)[1];
+
+  int64_t num_rows = b.GetTensorTypeAndShapeInfo().GetShape()[0];
+  EXPECT_EQ(a.GetTensorTypeAndShapeInfo().GetShape()[1], num_rows);
+
+  const float *pa = a.GetTensorData<float>();
+  for (int32_t i = 0; i != 2; ++i) {
+    for (int32_t j = 0; j != 3; ++j) {
+      EXPECT_EQ(pa[(i * num_rows + index) * 3 + j], row * 100 + i * 3 + j);
+    }
+  }
+
+  const int64_t *pb = b.GetTensorData<int64_t>();
+  for (int32_t j = 0; j != 2; ++j) {
+    EXPECT_EQ(pb[index * 2 + j], row * 100 + j);
+  }
+}
+
+static int64_t NumRows(const BatchedStates &batched, int32_t row) {
+  int32_t index = 0;
+  auto states = batched.Get(row, &index);
+  return (*states)[1].GetTensorTypeAndShapeInfo().GetShape()[0];
+}
+
+TEST(BatchedStates, Get) {
+  BatchedStates batched(BuildStates(), {1, 0});
+  EXPECT_EQ(batched.BatchSize(), 8);
+
+  for (int32_t i = 0; i != 8; ++i) {
+    CheckRow(batched, i);
+  }
+}
+
+TEST(BatchedStates, Compact) {
+  BatchedStates batched(BuildStates(), {1, 0});
+
+  int32_t index = 0;
+  auto old_states = batched.Get(5, &index);
+
+  for (int32_t i : {0, 1, 2, 3, 4, 6}) {
+    batched.Release(i);
+  }
+
+  // 2 of the 8 rows are in use, so it is compacted
+  batched.MaybeCompact();
+  EXPECT_EQ(NumRows(batched, 5), 2);
+  CheckRow(batched, 5);
+  CheckRow(batched, 7);
+
+  // The states returned before compaction are still valid
+  EXPECT_EQ(old_states->at(1).GetTensorData<int64_t>()[5 * 2], 500);
+
+  batched.Release(7);
+  batched.MaybeCompact();
+  EXPECT_EQ(NumRows(batched, 5), 2);
+
+  // Releasing it again has no effect
+  batched.Release(7);
+  batched.MaybeCompact();
+  EXPECT_EQ(NumRows(batched, 5), 2);
+}
+
+TEST(BatchedStates, NoCompact) {
+  BatchedStates batched(BuildStates(), {1, 0});
+
+  for (int32_t i : {0, 1, 2, 3, 4}) {
+    batched.Release(i);
+  }
+
+  // 3 of the 8 rows are still in use
+  batched.MaybeCompact();
+  EXPECT_EQ(NumRows(batched, 5), 8);
+  CheckRow(batched, 6);
+
+  // All rows are released
+  for (int32_t i : {5, 6, 7}) {
+    batched.Release(i);
+  }
+  batched.MaybeCompact();
+}
+
+}  // namespace sherpa_onnx
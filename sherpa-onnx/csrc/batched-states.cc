@@ -0,0 +1,93 @@
+// sherpa-onnx/csrc/batched-states.cc
+//
+// Copyright (c)  2025  Xiaomi Corporation
+
+#include "sherpa-onnx/csrc/batched-states.h"
+
+#include <algorithm>
+#include <memory>
+#include <utility>
+#include <vector>
+
+#include "sherpa-onnx/csrc/gather.h"
+#include "sherpa-onnx/csrc/macros.h"
+
+namespace sherpa_onnx {
+
+BatchedStates::BatchedStates(std::vector<Ort::Value> states,
+                             std::vector<int32_t> dims)
+    : states_(std::make_shared<std::vector<Ort::Value>>(std::move(states))),
+      dims_(std::move(dims)) {
+  if (states_->size() != dims_.size() || dims_.empty()) {
+    SHERPA_ONNX_LOGE("Size mismatch or empty input. states: %d, dims: %d",
+                     static_cast<int32_t>(states_->size()),
+                     static_cast<int32_t>(dims_.size()));
+    SHERPA_ONNX_EXIT(-1);
+  }
+
+  batch_size_ = static_cast<int32_t>(
+      (*states_)[0].GetTensorTypeAndShapeInfo().GetShape()[dims_[0]]);
+  num_rows_ = batch_size_;
+  num_used_ = batch_size_;
+
+  index_.resize(batch_size_);
+  for (int32_t i = 0; i != batch_size_; ++i) {
+    index_[i] = i;
+  }
+}
+
+std::shared_ptr<std::vector<Ort::Value>> BatchedStates::Get(
+    int32_t row, int32_t *index) const {
+  std::lock_guard<std::mutex> lock(mutex_);
+  *index = index_[row];
+  return states_;
+}
+
+void BatchedStates::Release(int32_t row) {
+  std::lock_guard<std::mutex> lock(mutex_);
+  if (index_[row] != -1) {
+    index_[row] = -1;
+    --num_used_;
+  }
+}
+
+void BatchedStates::MaybeCompact() {
+  std::lock_guard<std::mutex> lock(mutex_);
+  if (num_used_ == 0 || num_used_ * 4 > num_rows_) {
+    return;
+  }
+
+  std::vector<int32_t> rows;
+  rows.reserve(num_used_);
+  for (auto &i : index_) {
+    if (i != -1) {
+      rows.push_back(i);
+      i = static_cast<int32_t>(rows.size()) - 1;
+    }
+  }
+
+  Ort::AllocatorWithDefaultOptions allocator;
+
+  int32_t num_states = static_cast<int32_t>(dims_.size());
+  auto states = std::make_shared<std::vector<Ort::Value>>();
+  states->reserve(num_states);
+
+  std::vector<const Ort::Value *> buf(num_used_);
+  for (int32_t k = 0; k != num_states; ++k) {
+    const Ort::Value *v = &(*states_)[k];
+    std::fill(buf.begin(), buf.end(), v);
+
+    if (v->GetTensorTypeAndShapeInfo().GetElementType() ==
+        ONNX_TENSOR_ELEMENT_DATA_TYPE_INT64) {
+      states->push_back(Gather<int64_t>(allocator, buf, rows, dims_[k]));
+    } else {
+      states->push_back(Gather(allocator, buf, rows, dims_[k]));
+    }
+  }
+
+  // Callers of Get() may still hold the old states
+  states_ = std::move(states);
+  num_rows_ = num_used_;
+}
+
+}  // namespace sherpa_onnx
@@ -0,0 +1,74 @@
+// sherpa-onnx/csrc/batched-states.h
+//
+// Copyright (c)  2025  Xiaomi Corporation
+#ifndef SHERPA_ONNX_CSRC_BATCHED_STATES_H_
+#define SHERPA_ONNX_CSRC_BATCHED_STATES_H_
+
+#include <memory>
+#include <mutex>  // NOLINT
+#include <vector>
+
+#include "onnxruntime_cxx_api.h"  // NOLINT
+
+namespace sherpa_onnx {
+
+/** Encoder states of a batch of streams as returned by a single call to
+ * the encoder. Each stream of the batch owns one row of it, given by its
+ * index in the batch.
+ *
+ * Once a stream no longer uses its row, it calls Release(). When at most
+ * a quarter of the rows are still in use, MaybeCompact() copies them into
+ * smaller tensors, so that a few idle streams do not keep the memory of
+ * the whole batch alive.
+ *
+ * All methods are thread-safe.
+ */
+class BatchedStates {
+ public:
+  /**
+   * @param states Encoder states of a batch.
+   * @param dims  dims[k] is the batch dim of states[k].
+   */
+  BatchedStates(std::vector<Ort::Value> states, std::vector<int32_t> dims);
+
+  // Number of rows, i.e., streams, of the batch when it was created
+  int32_t BatchSize() const { return batch_size_; }
+
+  /** Get the states containing the given row.
+   *
+   * @param row  The row of a stream. It must not have been released.
+   * @param index On return, it contains the index of the row along the
+   *              batch dim of the returned states.
+   * @return Return the states. They stay valid even if the batch is
+   *         compacted afterwards.
+   */
+  std::shared_ptr<std::vector<Ort::Value>> Get(int32_t row,
+                                               int32_t *index) const;
+
+  // Mark the given row as no longer in use.
+  void Release(int32_t row);
+
+  // Copy the rows in use into smaller tensors if at most a quarter of
+  // the current rows are in use.
+  void MaybeCompact();
+
+ private:
+  mutable std::mutex mutex_;
+  std::shared_ptr<std::vector<Ort::Value>> states_;
+  std::vector<int32_t> dims_;
+
+  // index_[row] is the index of the row in states_, or -1 if released
+  std::vector<int32_t> index_;
+
+  int32_t batch_size_ = 0;
+
+  // Number of rows in states_
+  int32_t num_rows_ = 0;
+
+  // Number of rows not released
+  int32_t num_used_ = 0;
+};
+
+}  // namespace sherpa_onnx
+
+#endif  // SHERPA_ONNX_CSRC_BATCHED_STATES_H_
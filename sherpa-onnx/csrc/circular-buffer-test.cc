@@ -147,4 +147,38 @@ TEST(CircularBuffer, PushAndPop) {
   EXPECT_EQ(c[1], 4000);
 }
 
+TEST(CircularBuffer, View) {
+  CircularBuffer buffer(5);
+
+  std::vector<float> a = {0, 1, 2, 3};
+  buffer.Push(a.data(), a.size());
+  buffer.Pop(3);
+
+  a = {4, 5, 6};
+  buffer.Push(a.data(), a.size());
+
+  // The elements [3, 7) wrap around
+  CircularBufferView view = buffer.View(3, 4);
+  EXPECT_EQ(view.Size(), 4);
+  EXPECT_EQ(view.n1, 2);
+  EXPECT_EQ(view.n2, 2);
+  EXPECT_EQ(view.p1[0], 3);
+  EXPECT_EQ(view.p1[1], 4);
+  EXPECT_EQ(view.p2[0], 5);
+  EXPECT_EQ(view.p2[1], 6);
+
+  std::vector<float> c(4);
+  EXPECT_TRUE(buffer.Get(3, 4, c.data()));
+  EXPECT_EQ(c, (std::vector<float>{3, 4, 5, 6}));
+  EXPECT_EQ(view.ToVector(), c);
+
+  view = buffer.View(3, 2);
+  EXPECT_EQ(view.n1, 2);
+  EXPECT_EQ(view.n2, 0);
+
+  // out of range
+  EXPECT_EQ(buffer.View(2, 1).Size(), 0);
+  EXPECT_FALSE(buffer.Get(3, 5, c.data()));
+}
+
 }  // namespace sherpa_onnx
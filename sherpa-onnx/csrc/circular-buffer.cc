@@ -5,11 +5,23 @@
 #include "sherpa-onnx/csrc/circular-buffer.h"
 
 #include <algorithm>
+#include <vector>
 
 #include "sherpa-onnx/csrc/macros.h"
 
 namespace sherpa_onnx {
 
+void CircularBufferView::CopyTo(float *out) const {
+  out = std::copy(p1, p1 + n1, out);
+  std::copy(p2, p2 + n2, out);
+}
+
+std::vector<float> CircularBufferView::ToVector() const {
+  std::vector<float> ans(Size());
+  CopyTo(ans.data());
+  return ans;
+}
+
 CircularBuffer::CircularBuffer(int32_t capacity) {
   if (capacity <= 0) {
     SHERPA_ONNX_LOGE("Please specify a positive capacity. Given: %d\n",
@@ -129,7 +141,8 @@ void CircularBuffer::Push(const float *p, int32_t n) {
   std::copy(p + part1_size, p + n, buffer_.begin());
 }
 
-std::vector<float> CircularBuffer::Get(int32_t start_index, int32_t n) const {
+CircularBufferView CircularBuffer::View(int32_t start_index,
+                                        int32_t n) const {
   if (start_index < head_ || start_index >= tail_) {
     SHERPA_ONNX_LOGE("Invalid start_index: %d. head_: %d, tail_: %d",
                      start_index, head_, tail_);
@@ -142,30 +155,46 @@ std::vector<float> CircularBuffer::Get(int32_t start_index, int32_t n) const {
     return {};
   }
 
-  int32_t capacity = static_cast<int32_t>(buffer_.size());
-
   if (start_index - head_ + n > size) {
     SHERPA_ONNX_LOGE("Invalid start_index: %d and n: %d. head_: %d, size: %d",
                      start_index, n, head_, size);
     return {};
   }
 
+  int32_t capacity = static_cast<int32_t>(buffer_.size());
   int32_t start = start_index % capacity;
 
-  if (start + n < capacity) {
-    return {buffer_.begin() + start, buffer_.begin() + start + n};
+  CircularBufferView ans;
+  ans.p1 = buffer_.data() + start;
+
+  if (start + n <= capacity) {
+    ans.n1 = n;
+    return ans;
   }
 
-  std::vector<float> ans(n);
+  ans.n1 = capacity - start;
+  ans.p2 = buffer_.data();
+  ans.n2 = n - ans.n1;
 
-  std::copy(buffer_.begin() + start, buffer_.end(), ans.begin());
+  return ans;
+}
 
-  int32_t part1_size = capacity - start;
-  int32_t part2_size = n - part1_size;
-  std::copy(buffer_.begin(), buffer_.begin() + part2_size,
-            ans.begin() + part1_size);
+bool CircularBuffer::Get(int32_t start_index, int32_t n, float *out) const {
+  if (n == 0) {
+    return true;
+  }
 
-  return ans;
+  CircularBufferView view = View(start_index, n);
+  if (view.Size() != n) {
+    return false;
+  }
+
+  view.CopyTo(out);
+  return true;
+}
+
+std::vector<float> CircularBuffer::Get(int32_t start_index, int32_t n) const {
+  return View(start_index, n).ToVector();
 }
 
 void CircularBuffer::Pop(int32_t n) {
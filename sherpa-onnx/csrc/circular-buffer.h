@@ -9,6 +9,27 @@
 
 namespace sherpa_onnx {
 
+// A read-only view of n consecutive elements of a CircularBuffer.
+//
+// Since the buffer wraps around, the elements are stored in at most two
+// contiguous parts: [p1, p1 + n1) followed by [p2, p2 + n2).
+//
+// A view is invalidated by Push(), Resize() and Reset() of the buffer.
+struct CircularBufferView {
+  const float *p1 = nullptr;
+  int32_t n1 = 0;
+
+  const float *p2 = nullptr;
+  int32_t n2 = 0;
+
+  int32_t Size() const { return n1 + n2; }
+
+  // Copy all elements to out, which must have room for Size() elements
+  void CopyTo(float *out) const;
+
+  std::vector<float> ToVector() const;
+};
+
 class CircularBuffer {
  public:
   // Capacity of this buffer. Should be large enough.
@@ -28,6 +49,16 @@ class CircularBuffer {
   // @return Return a vector of size n containing the requested elements
   std::vector<float> Get(int32_t start_index, int32_t n) const;
 
+  // Same as the above one, but it writes the result to out, which must
+  // have room for n elements, and does not allocate memory.
+  //
+  // @return Return false if the given range is invalid.
+  bool Get(int32_t start_index, int32_t n, float *out) const;
+
+  // Return a view of the elements [start_index, start_index + n) without
+  // copying them. An empty view is returned if the range is invalid.
+  CircularBufferView View(int32_t start_index, int32_t n) const;
+
   // Remove n elements from the buffer
   //
   // @param n Should be in the range [0, size_]
@@ -6,9 +6,14 @@
 
 #include <chrono>  // NOLINT
 #include <cmath>
+#include <cstddef>
+#include <cstdio>
+#include <fstream>
 #include <map>
+#include <memory>
 #include <random>
 #include <string>
+#include <utility>
 #include <vector>
 
 #include "gtest/gtest.h"
@@ -74,6 +79,178 @@ TEST(ContextGraph, TestCustomizeNonStrict) {
   TestHelper(queries, 5, false);
 }
 
+TEST(ContextGraph, SaveAndLoad) {
+  std::vector<std::string> contexts_str({"S", "HE", "SHE", "SHELL", "HIS"});
+  std::vector<std::vector<int32_t>> contexts;
+  for (const auto &s : contexts_str) {
+    contexts.emplace_back(s.begin(), s.end());
+  }
+  ContextGraph graph(contexts, 1, 0.5, {}, contexts_str);
+
+  std::string filename = "context-graph-test.bin";
+  ASSERT_TRUE(graph.Save(filename));
+  EXPECT_TRUE(ContextGraph::IsCompiledGraph(filename));
+
+  auto loaded = ContextGraph::Load(filename);
+  ASSERT_NE(loaded, nullptr);
+  EXPECT_EQ(loaded->NumNodes(), graph.NumNodes());
+
+  std::string query = "DHRHISHELLQ";
+  std::vector<std::string> matched_phrases;
+  auto state = graph.Root();
+  auto loaded_state = loaded->Root();
+  for (auto q : query) {
+    auto res = graph.ForwardOneStep(state, q);
+    auto loaded_res = loaded->ForwardOneStep(loaded_state, q);
+    EXPECT_EQ(std::get<0>(res), std::get<0>(loaded_res));
+
+    state = std::get<1>(res);
+    loaded_state = std::get<1>(loaded_res);
+    EXPECT_EQ(state->level, loaded_state->level);
+
+    auto matched = graph.IsMatched(state);
+    auto loaded_matched = loaded->IsMatched(loaded_state);
+    EXPECT_EQ(matched.first, loaded_matched.first);
+    if (matched.first) {
+      EXPECT_EQ(graph.Phrase(matched.second),
+                loaded->Phrase(loaded_matched.second));
+      matched_phrases.push_back(loaded->Phrase(loaded_matched.second));
+    }
+  }
+
+  std::vector<std::string> expected({"HIS", "SHE", "SHELL"});
+  EXPECT_EQ(matched_phrases, expected);
+
+  std::remove(filename.c_str());
+}
+
+// Overwrite the int32 at the given byte offset of a file
+static void PatchFile(const std::string &filename, int64_t offset,
+                      int32_t value) {
+  std::fstream f(filename, std::ios::in | std::ios::out | std::ios::binary);
+  f.seekp(offset);
+  f.write(reinterpret_cast<const char *>(&value), sizeof(value));
+}
+
+TEST(ContextGraph, LoadCorruptFile) {
+  std::vector<std::string> contexts_str({"S", "HE", "SHE", "SHELL", "HIS"});
+  std::vector<std::vector<int32_t>> contexts;
+  for (const auto &s : contexts_str) {
+    contexts.emplace_back(s.begin(), s.end());
+  }
+  ContextGraph graph(contexts, 1, 0.5, {}, contexts_str);
+
+  int32_t num_nodes = graph.NumNodes();
+  int32_t num_arcs = num_nodes - 1;
+
+  // Layout of the file: a 64-byte header, nodes, arc tokens, arc targets,
+  // the transition table of the root and phrases
+  int64_t header_size = 64;
+  auto node = [&](int32_t i, size_t field) -> int64_t {
+    return header_size + i * sizeof(ContextState) + field;
+  };
+  int64_t arc_targets = node(num_nodes, 0) + num_arcs * sizeof(int32_t);
+  int64_t root_next = arc_targets + num_arcs * sizeof(int32_t);
+
+  // Children of the root are sorted by token, so node 2 is "S"
+  std::vector<std::pair<int64_t, int32_t>> patches = {
+      {node(0, offsetof(ContextState, level)), 1},
+      {node(2, offsetof(ContextState, fail)), -1},
+      {node(2, offsetof(ContextState, fail)), num_nodes},
+      // A loop of fail links
+      {node(2, offsetof(ContextState, fail)), 2},
+      {node(2, offsetof(ContextState, output)), num_nodes},
+      {node(2, offsetof(ContextState, output)), 2},
+      {node(2, offsetof(ContextState, arc_begin)), -1},
+      {node(2, offsetof(ContextState, arc_end)), num_arcs + 1},
+      {node(2, offsetof(ContextState, phrase_begin)), -1},
+      {node(2, offsetof(ContextState, phrase_len)), 1000},
+      {node(2, offsetof(ContextState, level)), 5},
+      {arc_targets, 0},
+      {arc_targets, num_nodes},
+      {root_next + 'H' * sizeof(int32_t), num_nodes},
+      {root_next + 'H' * sizeof(int32_t), -2},
+  };
+
+  std::string filename = "context-graph-corrupt-test.bin";
+  for (const auto &p : patches) {
+    ASSERT_TRUE(graph.Save(filename));
+    ASSERT_NE(ContextGraph::Load(filename), nullptr);
+
+    PatchFile(filename, p.first, p.second);
+    EXPECT_EQ(ContextGraph::Load(filename), nullptr)
+        << p.first << " " << p.second;
+  }
+
+  std::remove(filename.c_str());
+}
+
+TEST(ContextGraph, Layered) {
+  std::vector<std::string> base_str({"S", "HE", "SHE", "SHELL"});
+  std::vector<std::string> overlay_str({"HIS", "SHE", "HERS"});
+  std::vector<std::string> all_str({"S", "HE", "SHE", "SHELL", "HIS", "HERS"});
+
+  auto to_ids = [](const std::vector<std::string> &v) {
+    std::vector<std::vector<int32_t>> ans;
+    for (const auto &s : v) {
+      ans.emplace_back(s.begin(), s.end());
+    }
+    return ans;
+  };
+
+  auto base = std::make_shared<ContextGraph>(
+      to_ids(base_str), 1, 0.5, std::vector<float>{}, base_str);
+  ContextGraph layered(base, to_ids(overlay_str), 1, 0.25, {}, overlay_str);
+  ContextGraph combined(to_ids(all_str), 1, 0.5, {}, all_str);
+
+  // With the same score for all tokens, it is equivalent to a single graph
+  // built from both lists after every step
+  for (bool strict_mode : {true, false}) {
+    for (std::string query : {"DHRHISHELLQ", "SHERSHE", "HEHISS", "SHE"}) {
+      auto layered_state = layered.Root();
+      auto combined_state = combined.Root();
+      for (auto q : query) {
+        auto res = layered.ForwardOneStep(layered_state, q, strict_mode);
+        auto expected = combined.ForwardOneStep(combined_state, q, strict_mode);
+        EXPECT_NEAR(std::get<0>(res), std::get<0>(expected), 1e-5) << query;
+
+        layered_state = std::get<1>(res);
+        combined_state = std::get<1>(expected);
+        EXPECT_EQ(layered_state->level, combined_state->level) << query;
+        EXPECT_NEAR(layered_state->node_score, combined_state->node_score,
+                    1e-5)
+            << query;
+
+        auto matched = layered.IsMatched(layered_state);
+        auto expected_matched = combined.IsMatched(combined_state);
+        ASSERT_EQ(matched.first, expected_matched.first) << query;
+        if (matched.first) {
+          EXPECT_EQ(layered.Phrase(matched.second),
+                    combined.Phrase(expected_matched.second))
+              << query;
+        }
+      }
+
+      EXPECT_NEAR(layered.Finalize(layered_state).first,
+                  combined.Finalize(combined_state).first, 1e-5)
+          << query;
+    }
+  }
+
+  // Thresholds of the overlay take effect for phrases in both graphs
+  std::string query = "SHE";
+  auto state = layered.Root();
+  for (auto q : query) {
+    state = std::get<1>(layered.ForwardOneStep(state, q));
+  }
+  auto matched = layered.IsMatched(state);
+  ASSERT_TRUE(matched.first);
+  EXPECT_EQ(layered.Phrase(matched.second), "SHE");
+  EXPECT_EQ(matched.second->ac_threshold, 0.25);
+
+  EXPECT_FALSE(layered.Save("context-graph-test.bin"));
+}
+
 TEST(ContextGraph, Benchmark) {
   std::random_device rd;
   std::mt19937 mt(rd());
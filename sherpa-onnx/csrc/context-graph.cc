@@ -6,18 +6,83 @@
 
 #include <algorithm>
 #include <cassert>
-#include <queue>
+#include <cstring>
+#include <fstream>
+#include <map>
 #include <string>
 #include <tuple>
+#include <unordered_map>
 #include <utility>
 
 #include "sherpa-onnx/csrc/macros.h"
 
 namespace sherpa_onnx {
+
+namespace {
+
+// A node of the trie used only while building the graph
+struct TrieNode {
+  ContextState state;
+  std::string phrase;
+  std::unordered_map<int32_t, int32_t> next;
+};
+
+// Header of the file written by ContextGraph::Save()
+struct ContextGraphHeader {
+  char magic[8];
+  int32_t state_size;
+  int32_t num_nodes;
+  int32_t num_arcs;
+  int32_t num_root_next;
+  int32_t num_phrase_bytes;
+  float context_score;
+  float ac_threshold;
+  int32_t reserved[7];
+};
+
+static_assert(sizeof(ContextGraphHeader) == 64, "");
+
+constexpr const char *kContextGraphMagic = "SOCTXG1";
+
+}  // namespace
+
+ContextGraph::ContextGraph() { Build({}, {}, {}, {}); }
+
+ContextGraph::ContextGraph(const std::vector<std::vector<int32_t>> &token_ids,
+                           float context_score, float ac_threshold,
+                           const std::vector<float> &scores /*= {}*/,
+                           const std::vector<std::string> &phrases /*= {}*/,
+                           const std::vector<float> &ac_thresholds /*= {}*/)
+    : context_score_(context_score), ac_threshold_(ac_threshold) {
+  Build(token_ids, scores, phrases, ac_thresholds);
+}
+
+ContextGraph::ContextGraph(ContextGraphPtr base,
+                           const std::vector<std::vector<int32_t>> &token_ids,
+                           float context_score, float ac_threshold,
+                           const std::vector<float> &scores /*= {}*/,
+                           const std::vector<std::string> &phrases /*= {}*/,
+                           const std::vector<float> &ac_thresholds /*= {}*/)
+    : context_score_(context_score),
+      ac_threshold_(ac_threshold),
+      base_(std::move(base)) {
+  if (base_ && base_->base_) {
+    SHERPA_ONNX_LOGE("The base of a layered context graph cannot be layered");
+    SHERPA_ONNX_EXIT(-1);
+  }
+
+  Build(token_ids, scores, phrases, ac_thresholds);
+
+  if (base_) {
+    std::lock_guard<std::mutex> lock(mutex_);
+    layered_root_ = &layered_states_[GetLayeredState(0, 0, {})].state;
+  }
+}
+
 void ContextGraph::Build(const std::vector<std::vector<int32_t>> &token_ids,
                          const std::vector<float> &scores,
                          const std::vector<std::string> &phrases,
-                         const std::vector<float> &ac_thresholds) const {
+                         const std::vector<float> &ac_thresholds) {
   if (!scores.empty()) {
     SHERPA_ONNX_CHECK_EQ(token_ids.size(), scores.size());
   }
@@ -27,78 +92,203 @@ void ContextGraph::Build(const std::vector<std::vector<int32_t>> &token_ids,
   if (!ac_thresholds.empty()) {
     SHERPA_ONNX_CHECK_EQ(token_ids.size(), ac_thresholds.size());
   }
+
+  std::vector<TrieNode> trie(1);  // trie[0] is the root
+
   for (int32_t i = 0; i < static_cast<int32_t>(token_ids.size()); ++i) {
-    auto node = root_.get();
+    int32_t node = 0;
     float score = scores.empty() ? 0.0f : scores[i];
     score = score == 0.0f ? context_score_ : score;
     float ac_threshold = ac_thresholds.empty() ? 0.0f : ac_thresholds[i];
     ac_threshold = ac_threshold == 0.0f ? ac_threshold_ : ac_threshold;
     std::string phrase = phrases.empty() ? std::string() : phrases[i];
 
-    for (int32_t j = 0; j < static_cast<int32_t>(token_ids[i].size()); ++j) {
+    int32_t num_tokens = static_cast<int32_t>(token_ids[i].size());
+    for (int32_t j = 0; j < num_tokens; ++j) {
       int32_t token = token_ids[i][j];
-      if (0 == node->next.count(token)) {
-        bool is_end = j == (static_cast<int32_t>(token_ids[i].size()) - 1);
-        node->next[token] = std::make_unique<ContextState>(
-            token, score, node->node_score + score,
-            is_end ? node->node_score + score : 0, j + 1,
-            is_end ? ac_threshold : 0.0f, is_end,
-            is_end ? phrase : std::string());
+      bool is_last = j == num_tokens - 1;
+      float parent_score = trie[node].state.node_score;
+
+      auto it = trie[node].next.find(token);
+      if (it == trie[node].next.end()) {
+        int32_t child = static_cast<int32_t>(trie.size());
+        trie[node].next[token] = child;
+
+        trie.emplace_back();
+        auto &s = trie.back().state;
+        s.token = token;
+        s.token_score = score;
+        s.node_score = parent_score + score;
+        s.output_score = is_last ? parent_score + score : 0;
+        s.level = j + 1;
+        s.ac_threshold = is_last ? ac_threshold : 0.0f;
+        s.is_end = is_last;
+        if (is_last) {
+          trie.back().phrase = phrase;
+        }
+
+        node = child;
       } else {
-        float token_score = std::max(score, node->next[token]->token_score);
-        node->next[token]->token_score = token_score;
-        float node_score = node->node_score + token_score;
-        node->next[token]->node_score = node_score;
-        bool is_end = (j == static_cast<int32_t>(token_ids[i].size()) - 1) ||
-                      node->next[token]->is_end;
-        node->next[token]->output_score = is_end ? node_score : 0.0f;
-        node->next[token]->is_end = is_end;
-        if (j == static_cast<int32_t>(token_ids[i].size()) - 1) {
-          node->next[token]->phrase = phrase;
-          node->next[token]->ac_threshold = ac_threshold;
+        node = it->second;
+        auto &s = trie[node].state;
+        s.token_score = std::max(score, s.token_score);
+        s.node_score = parent_score + s.token_score;
+        s.is_end = is_last || s.is_end;
+        s.output_score = s.is_end ? s.node_score : 0.0f;
+        if (is_last) {
+          trie[node].phrase = phrase;
+          s.ac_threshold = ac_threshold;
         }
       }
-      node = node->next[token].get();
     }
   }
+
+  // Renumber the nodes in breadth-first order and store the arcs of each
+  // node contiguously, sorted by token.
+  int32_t num_nodes = static_cast<int32_t>(trie.size());
+  std::vector<int32_t> order;  // order[new_index] = old_index
+  std::vector<int32_t> new_index(num_nodes);
+  order.reserve(num_nodes);
+  order.push_back(0);
+  new_index[0] = 0;
+
+  nodes_storage_.resize(num_nodes);
+  arc_tokens_storage_.clear();
+  arc_targets_storage_.clear();
+  arc_tokens_storage_.reserve(num_nodes - 1);
+  arc_targets_storage_.reserve(num_nodes - 1);
+  phrases_storage_.clear();
+
+  std::vector<std::pair<int32_t, int32_t>> arcs;
+  for (int32_t k = 0; k != num_nodes; ++k) {
+    const TrieNode &t = trie[order[k]];
+    ContextState &s = nodes_storage_[k];
+    s = t.state;
+
+    s.phrase_begin = static_cast<int32_t>(phrases_storage_.size());
+    s.phrase_len = static_cast<int32_t>(t.phrase.size());
+    phrases_storage_ += t.phrase;
+
+    arcs.assign(t.next.begin(), t.next.end());
+    std::sort(arcs.begin(), arcs.end());
+
+    s.arc_begin = static_cast<int32_t>(arc_tokens_storage_.size());
+    for (const auto &arc : arcs) {
+      new_index[arc.second] = static_cast<int32_t>(order.size());
+      order.push_back(arc.second);
+
+      arc_tokens_storage_.push_back(arc.first);
+      arc_targets_storage_.push_back(new_index[arc.second]);
+    }
+    s.arc_end = static_cast<int32_t>(arc_tokens_storage_.size());
+  }
+
+  // Dense transition table of the root
+  int32_t root_begin = nodes_storage_[0].arc_begin;
+  int32_t root_end = nodes_storage_[0].arc_end;
+  int32_t max_token = -1;
+  for (int32_t i = root_begin; i != root_end; ++i) {
+    max_token = std::max(max_token, arc_tokens_storage_[i]);
+  }
+
+  root_next_storage_.assign(max_token + 1, -1);
+  for (int32_t i = root_begin; i != root_end; ++i) {
+    if (arc_tokens_storage_[i] >= 0) {
+      root_next_storage_[arc_tokens_storage_[i]] = arc_targets_storage_[i];
+    }
+  }
+
+  SetPointers();
+
   FillFailOutput();
 }
 
+void ContextGraph::SetPointers() {
+  nodes_ = nodes_storage_.data();
+  arc_tokens_ = arc_tokens_storage_.data();
+  arc_targets_ = arc_targets_storage_.data();
+  root_next_ = root_next_storage_.data();
+  phrases_ = phrases_storage_.data();
+
+  num_nodes_ = static_cast<int32_t>(nodes_storage_.size());
+  num_arcs_ = static_cast<int32_t>(arc_tokens_storage_.size());
+  num_root_next_ = static_cast<int32_t>(root_next_storage_.size());
+  num_phrase_bytes_ = static_cast<int32_t>(phrases_storage_.size());
+}
+
 std::tuple<float, const ContextState *, const ContextState *>
 ContextGraph::ForwardOneStep(const ContextState *state, int32_t token,
                              bool strict_mode /*= true*/) const {
+  if (base_) {
+    return LayeredForwardOneStep(state, token, strict_mode);
+  }
+
+  return Step(state, token, strict_mode);
+}
+
+std::tuple<float, const ContextState *, const ContextState *>
+ContextGraph::LayeredForwardOneStep(const ContextState *state, int32_t token,
+                                    bool strict_mode) const {
+  std::lock_guard<std::mutex> lock(mutex_);
+  const LayeredState &cur = layered_states_[state->fail];
+
+  // Both automata always run in strict mode. A reset in non-strict mode
+  // resets both of them.
+  auto base_res =
+      base_->Step(base_->nodes_ + cur.base_node, token, true /*strict*/);
+  auto overlay_res = Step(nodes_ + cur.overlay_node, token, true /*strict*/);
+
+  std::vector<int32_t> tokens = cur.tokens;
+  tokens.push_back(token);
+
+  const LayeredState &next = layered_states_[GetLayeredState(
+      static_cast<int32_t>(std::get<1>(base_res) - base_->nodes_),
+      static_cast<int32_t>(std::get<1>(overlay_res) - nodes_), tokens)];
+
+  // It is the same as Step() for a single graph built from both lists
+  if (!strict_mode && next.state.output_score != 0) {
+    return std::make_tuple(next.matched_score - state->node_score,
+                           layered_root_, next.matched);
+  }
+
+  return std::make_tuple(
+      next.state.node_score - state->node_score + next.state.output_score,
+      &next.state, next.matched);
+}
+
+std::tuple<float, const ContextState *, const ContextState *>
+ContextGraph::Step(const ContextState *state, int32_t token,
+                   bool strict_mode) const {
   const ContextState *node = nullptr;
   float score = 0;
-  if (1 == state->next.count(token)) {
-    node = state->next.at(token).get();
+  int32_t next = Next(state, token);
+  if (next != -1) {
+    node = nodes_ + next;
     score = node->token_score;
   } else {
-    node = state->fail;
-    while (0 == node->next.count(token)) {
-      node = node->fail;
+    node = nodes_ + state->fail;
+    while ((next = Next(node, token)) == -1) {
+      node = nodes_ + node->fail;
       if (-1 == node->token) break;  // root
     }
-    if (1 == node->next.count(token)) {
-      node = node->next.at(token).get();
+    if (next == -1) {
+      next = Next(node, token);
+    }
+    if (next != -1) {
+      node = nodes_ + next;
     }
     score = node->node_score - state->node_score;
   }
 
-  if (!node) {
-    SHERPA_ONNX_LOGE("Some bad things happened.");
-    exit(-1);
-  }
-
   const ContextState *matched_node =
-      node->is_end ? node : (node->output != nullptr ? node->output : nullptr);
+      node->is_end ? node
+                   : (node->output != -1 ? nodes_ + node->output : nullptr);
 
   if (!strict_mode && node->output_score != 0) {
     SHERPA_ONNX_CHECK(nullptr != matched_node);
     float output_score =
-        node->is_end ? node->node_score
-                     : (node->output != nullptr ? node->output->node_score
-                                                : node->node_score);
-    return std::make_tuple(score + output_score - node->node_score, root_.get(),
+        matched_node ? matched_node->node_score : node->node_score;
+    return std::make_tuple(score + output_score - node->node_score, nodes_,
                            matched_node);
   }
   return std::make_tuple(score + node->output_score, node, matched_node);
@@ -107,61 +297,358 @@ ContextGraph::ForwardOneStep(const ContextState *state, int32_t token,
 std::pair<float, const ContextState *> ContextGraph::Finalize(
     const ContextState *state) const {
   float score = -state->node_score;
-  return std::make_pair(score, root_.get());
+  return std::make_pair(score, Root());
 }
 
 std::pair<bool, const ContextState *> ContextGraph::IsMatched(
     const ContextState *state) const {
-  bool status = false;
-  const ContextState *node = nullptr;
+  if (!base_) {
+    return IsMatchedImpl(state);
+  }
+
+  std::lock_guard<std::mutex> lock(mutex_);
+  const ContextState *matched = layered_states_[state->fail].matched;
+  return std::make_pair(matched != nullptr, matched);
+}
+
+std::pair<bool, const ContextState *> ContextGraph::IsMatchedImpl(
+    const ContextState *state) const {
   if (state->is_end) {
-    status = true;
-    node = state;
-  } else {
-    if (state->output != nullptr) {
-      status = true;
-      node = state->output;
+    return std::make_pair(true, state);
+  }
+
+  if (state->output != -1) {
+    return std::make_pair(true, nodes_ + state->output);
+  }
+
+  return std::make_pair(false, nullptr);
+}
+
+std::string ContextGraph::Phrase(const ContextState *state) const {
+  if (base_ && state >= base_->nodes_ &&
+      state < base_->nodes_ + base_->num_nodes_) {
+    return base_->Phrase(state);
+  }
+
+  return std::string(phrases_ + state->phrase_begin, state->phrase_len);
+}
+
+int32_t ContextGraph::GetLayeredState(
+    int32_t base_node, int32_t overlay_node,
+    const std::vector<int32_t> &tokens) const {
+  uint64_t key = (static_cast<uint64_t>(base_node) << 32) |
+                 static_cast<uint32_t>(overlay_node);
+
+  auto it = layered_index_.find(key);
+  if (it != layered_index_.end()) {
+    return it->second;
+  }
+
+  const ContextState *b = base_->nodes_ + base_node;
+  const ContextState *o = nodes_ + overlay_node;
+
+  // The longer of the two is the state of the single graph. If they have
+  // the same level, they have the same token string.
+  int32_t level = std::max(b->level, o->level);
+
+  LayeredState ls;
+  ls.base_node = base_node;
+  ls.overlay_node = overlay_node;
+  ls.tokens.assign(tokens.end() - level, tokens.end());
+
+  ContextState &s = ls.state;
+  s.token = level > 0 ? ls.tokens.back() : -1;
+  s.level = level;
+  s.node_score = LayeredScore(ls.tokens.data(), level);
+  s.fail = static_cast<int32_t>(layered_states_.size());
+  s.output = -1;
+
+  // Phrases that are suffixes of the token string, by their length. Those
+  // of the overlay override the ones of the base graph.
+  std::map<int32_t, const ContextState *> phrases;
+  auto collect = [&phrases](const ContextGraph &g, const ContextState *node) {
+    if (!node->is_end) {
+      node = node->output != -1 ? g.nodes_ + node->output : nullptr;
+    }
+
+    while (node) {
+      phrases[node->level] = node;
+      node = node->output != -1 ? g.nodes_ + node->output : nullptr;
     }
+  };
+  collect(*base_, b);
+  collect(*this, o);
+
+  for (const auto &p : phrases) {
+    float score = LayeredScore(ls.tokens.data() + level - p.first, p.first);
+    s.output_score += score;
+
+    // phrases is sorted by length, so the last one is the longest
+    ls.matched = p.second;
+    ls.matched_score = score;
   }
-  return std::make_pair(status, node);
+
+  if (ls.matched) {
+    s.is_end = ls.matched->level == level;
+    s.ac_threshold = ls.matched->ac_threshold;
+  }
+
+  int32_t index = s.fail;
+  layered_states_.push_back(std::move(ls));
+  layered_index_.emplace(key, index);
+
+  return index;
 }
 
-void ContextGraph::FillFailOutput() const {
-  std::queue<const ContextState *> node_queue;
-  for (auto &kv : root_->next) {
-    kv.second->fail = root_.get();
-    node_queue.push(kv.second.get());
+float ContextGraph::LayeredScore(const int32_t *tokens, int32_t n) const {
+  const ContextState *b = base_->nodes_;
+  const ContextState *o = nodes_;
+
+  float ans = 0;
+  for (int32_t i = 0; i != n; ++i) {
+    float score = 0;
+    if (b) {
+      int32_t next = base_->Next(b, tokens[i]);
+      b = next != -1 ? base_->nodes_ + next : nullptr;
+      score = b ? b->token_score : score;
+    }
+
+    if (o) {
+      int32_t next = Next(o, tokens[i]);
+      o = next != -1 ? nodes_ + next : nullptr;
+      score = o ? std::max(score, o->token_score) : score;
+    }
+
+    ans += score;
   }
-  while (!node_queue.empty()) {
-    auto current_node = node_queue.front();
-    node_queue.pop();
-    for (auto &kv : current_node->next) {
-      auto fail = current_node->fail;
-      if (1 == fail->next.count(kv.first)) {
-        fail = fail->next.at(kv.first).get();
-      } else {
-        fail = fail->fail;
-        while (0 == fail->next.count(kv.first)) {
-          fail = fail->fail;
-          if (-1 == fail->token) break;
+
+  return ans;
+}
+
+void ContextGraph::FillFailOutput() {
+  // Nodes are in breadth-first order, so the fail node of a node and
+  // everything it depends on are processed before the node itself.
+  for (int32_t k = 0; k != num_nodes_; ++k) {
+    const ContextState &current = nodes_storage_[k];
+    for (int32_t a = current.arc_begin; a != current.arc_end; ++a) {
+      int32_t token = arc_tokens_storage_[a];
+      ContextState &child = nodes_storage_[arc_targets_storage_[a]];
+
+      int32_t fail = 0;
+      if (k != 0) {
+        const ContextState *node = nodes_ + current.fail;
+        int32_t next = Next(node, token);
+        while (next == -1 && -1 != node->token) {
+          node = nodes_ + node->fail;
+          next = Next(node, token);
         }
-        if (1 == fail->next.count(kv.first))
-          fail = fail->next.at(kv.first).get();
+        fail = next != -1 ? next : static_cast<int32_t>(node - nodes_);
       }
-      kv.second->fail = fail;
+      child.fail = fail;
+
       // fill the output arc
-      auto output = fail;
-      while (!output->is_end) {
-        output = output->fail;
-        if (-1 == output->token) {
-          output = nullptr;
+      int32_t output = fail;
+      while (!nodes_[output].is_end) {
+        if (output == 0) {
+          output = -1;
           break;
         }
+        output = nodes_[output].fail;
       }
-      kv.second->output = output;
-      kv.second->output_score += output == nullptr ? 0 : output->output_score;
-      node_queue.push(kv.second.get());
+      child.output = output;
+      child.output_score += output == -1 ? 0 : nodes_[output].output_score;
     }
   }
 }
+
+bool ContextGraph::Save(const std::string &filename) const {
+  if (base_) {
+    SHERPA_ONNX_LOGE("A layered context graph cannot be saved");
+    return false;
+  }
+
+  std::ofstream os(filename, std::ios::binary);
+  if (!os) {
+    SHERPA_ONNX_LOGE("Failed to open '%s' for writing", filename.c_str());
+    return false;
+  }
+
+  ContextGraphHeader header{};
+  std::strncpy(header.magic, kContextGraphMagic, sizeof(header.magic));
+  header.state_size = sizeof(ContextState);
+  header.num_nodes = num_nodes_;
+  header.num_arcs = num_arcs_;
+  header.num_root_next = num_root_next_;
+  header.num_phrase_bytes = num_phrase_bytes_;
+  header.context_score = context_score_;
+  header.ac_threshold = ac_threshold_;
+
+  os.write(reinterpret_cast<const char *>(&header), sizeof(header));
+  os.write(reinterpret_cast<const char *>(nodes_),
+           sizeof(ContextState) * num_nodes_);
+  os.write(reinterpret_cast<const char *>(arc_tokens_),
+           sizeof(int32_t) * num_arcs_);
+  os.write(reinterpret_cast<const char *>(arc_targets_),
+           sizeof(int32_t) * num_arcs_);
+  os.write(reinterpret_cast<const char *>(root_next_),
+           sizeof(int32_t) * num_root_next_);
+  os.write(phrases_, num_phrase_bytes_);
+
+  if (!os) {
+    SHERPA_ONNX_LOGE("Failed to write '%s'", filename.c_str());
+    return false;
+  }
+
+  return true;
+}
+
+ContextGraphPtr ContextGraph::Load(const std::string &filename) {
+  FileBuffer buf = ReadFile(filename);
+  if (buf.size() < sizeof(ContextGraphHeader)) {
+    SHERPA_ONNX_LOGE("'%s' is not a context graph", filename.c_str());
+    return nullptr;
+  }
+
+  ContextGraphHeader header;
+  std::memcpy(&header, buf.data(), sizeof(header));
+
+  if (std::strncmp(header.magic, kContextGraphMagic, sizeof(header.magic)) !=
+      0) {
+    SHERPA_ONNX_LOGE("'%s' is not a context graph", filename.c_str());
+    return nullptr;
+  }
+
+  if (header.state_size != static_cast<int32_t>(sizeof(ContextState))) {
+    SHERPA_ONNX_LOGE(
+        "'%s' was saved by an incompatible version. State size: %d, "
+        "expected: %d",
+        filename.c_str(), header.state_size,
+        static_cast<int32_t>(sizeof(ContextState)));
+    return nullptr;
+  }
+
+  if (header.num_nodes < 1 || header.num_arcs != header.num_nodes - 1 ||
+      header.num_root_next < 0 || header.num_phrase_bytes < 0) {
+    SHERPA_ONNX_LOGE("Corrupted context graph '%s'", filename.c_str());
+    return nullptr;
+  }
+
+  size_t expected = sizeof(ContextGraphHeader) +
+                    sizeof(ContextState) * header.num_nodes +
+                    sizeof(int32_t) * header.num_arcs * 2 +
+                    sizeof(int32_t) * header.num_root_next +
+                    header.num_phrase_bytes;
+  if (buf.size() != expected) {
+    SHERPA_ONNX_LOGE("Corrupted context graph '%s'. Size: %d, expected: %d",
+                     filename.c_str(), static_cast<int32_t>(buf.size()),
+                     static_cast<int32_t>(expected));
+    return nullptr;
+  }
+
+  auto ans = std::make_shared<ContextGraph>();
+  ans->context_score_ = header.context_score;
+  ans->ac_threshold_ = header.ac_threshold;
+  ans->num_nodes_ = header.num_nodes;
+  ans->num_arcs_ = header.num_arcs;
+  ans->num_root_next_ = header.num_root_next;
+  ans->num_phrase_bytes_ = header.num_phrase_bytes;
+
+  ans->buffer_ = std::move(buf);
+  const char *p = ans->buffer_.data() + sizeof(ContextGraphHeader);
+
+  ans->nodes_ = reinterpret_cast<const ContextState *>(p);
+  p += sizeof(ContextState) * header.num_nodes;
+
+  ans->arc_tokens_ = reinterpret_cast<const int32_t *>(p);
+  p += sizeof(int32_t) * header.num_arcs;
+
+  ans->arc_targets_ = reinterpret_cast<const int32_t *>(p);
+  p += sizeof(int32_t) * header.num_arcs;
+
+  ans->root_next_ = reinterpret_cast<const int32_t *>(p);
+  p += sizeof(int32_t) * header.num_root_next;
+
+  ans->phrases_ = p;
+
+  // Not needed any longer
+  ans->nodes_storage_ = {};
+  ans->arc_tokens_storage_ = {};
+  ans->arc_targets_storage_ = {};
+  ans->root_next_storage_ = {};
+  ans->phrases_storage_ = {};
+
+  if (!ans->IsValid()) {
+    SHERPA_ONNX_LOGE("Corrupted context graph '%s'", filename.c_str());
+    return nullptr;
+  }
+
+  return ans;
+}
+
+bool ContextGraph::IsValid() const {
+  for (int32_t i = 0; i != num_arcs_; ++i) {
+    if (arc_targets_[i] <= 0 || arc_targets_[i] >= num_nodes_) {
+      return false;
+    }
+  }
+
+  for (int32_t i = 0; i != num_root_next_; ++i) {
+    if (root_next_[i] != -1 &&
+        (root_next_[i] <= 0 || root_next_[i] >= num_nodes_ ||
+         nodes_[root_next_[i]].level != 1)) {
+      return false;
+    }
+  }
+
+  const ContextState &root = nodes_[0];
+  if (root.token != -1 || root.level != 0 || root.fail != 0 ||
+      root.output != -1) {
+    return false;
+  }
+
+  for (int32_t i = 0; i != num_nodes_; ++i) {
+    const ContextState &s = nodes_[i];
+
+    // A fail or output link points to a node with a shorter token string,
+    // so following them always ends at the root
+    if (i != 0 && (s.fail < 0 || s.fail >= num_nodes_ ||
+                   nodes_[s.fail].level >= s.level)) {
+      return false;
+    }
+
+    if (s.output != -1 && (s.output < 0 || s.output >= num_nodes_ ||
+                           nodes_[s.output].level >= s.level)) {
+      return false;
+    }
+
+    if (s.arc_begin < 0 || s.arc_begin > s.arc_end || s.arc_end > num_arcs_) {
+      return false;
+    }
+
+    // The level of a node is the length of its token string
+    for (int32_t k = s.arc_begin; k != s.arc_end; ++k) {
+      if (nodes_[arc_targets_[k]].level != s.level + 1) {
+        return false;
+      }
+    }
+
+    if (s.phrase_begin < 0 || s.phrase_len < 0 ||
+        s.phrase_len > num_phrase_bytes_ - s.phrase_begin) {
+      return false;
+    }
+  }
+
+  return true;
+}
+
+bool ContextGraph::IsCompiledGraph(const std::string &filename) {
+  std::ifstream is(filename, std::ios::binary);
+  char magic[8] = {};
+  if (!is.read(magic, sizeof(magic))) {
+    return false;
+  }
+
+  return std::strncmp(magic, kContextGraphMagic, sizeof(magic)) == 0;
+}
+
 }  // namespace sherpa_onnx
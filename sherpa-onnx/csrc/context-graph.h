@@ -5,13 +5,18 @@
 #ifndef SHERPA_ONNX_CSRC_CONTEXT_GRAPH_H_
 #define SHERPA_ONNX_CSRC_CONTEXT_GRAPH_H_
 
+#include <algorithm>
+#include <cstdint>
+#include <deque>
 #include <memory>
+#include <mutex>  // NOLINT
 #include <string>
 #include <tuple>
 #include <unordered_map>
 #include <utility>
 #include <vector>
 
+#include "sherpa-onnx/csrc/file-utils.h"
 #include "sherpa-onnx/csrc/log.h"
 
 namespace sherpa_onnx {
@@ -19,52 +24,89 @@ namespace sherpa_onnx {
 class ContextGraph;
 using ContextGraphPtr = std::shared_ptr<ContextGraph>;
 
+// A node of ContextGraph.
+//
+// Nodes are stored in a contiguous array owned by the graph and refer to
+// each other by index, so the array can be saved to and mapped from a
+// file as it is. Use ContextGraph::Phrase() to get the phrase of a node.
+//
+// The states of a layered graph (see below) are created on the fly. For
+// them, fail holds the index of the state in the layered graph instead,
+// and output is always -1.
 struct ContextState {
-  int32_t token;
-  float token_score;
-  float node_score;
-  float output_score;
-  int32_t level;
-  float ac_threshold;
-  bool is_end;
-  std::string phrase;
-  std::unordered_map<int32_t, std::unique_ptr<ContextState>> next;
-  const ContextState *fail = nullptr;
-  const ContextState *output = nullptr;
-
-  ContextState() = default;
-  ContextState(int32_t token, float token_score, float node_score,
-               float output_score, int32_t level = 0, float ac_threshold = 0.0f,
-               bool is_end = false, const std::string &phrase = {})
-      : token(token),
-        token_score(token_score),
-        node_score(node_score),
-        output_score(output_score),
-        level(level),
-        ac_threshold(ac_threshold),
-        is_end(is_end),
-        phrase(phrase) {}
+  int32_t token = -1;
+  float token_score = 0;
+  float node_score = 0;
+  float output_score = 0;
+  int32_t level = 0;
+  float ac_threshold = 0;
+  int32_t is_end = 0;
+
+  // Index of the fail node
+  int32_t fail = 0;
+
+  // Index of the output node, or -1 if there is none
+  int32_t output = -1;
+
+  // Outgoing arcs are [arc_begin, arc_end) in the arc arrays of the graph.
+  // They are sorted by token.
+  int32_t arc_begin = 0;
+  int32_t arc_end = 0;
+
+  // The phrase is [phrase_begin, phrase_begin + phrase_len) in the
+  // phrase pool of the graph.
+  int32_t phrase_begin = 0;
+  int32_t phrase_len = 0;
 };
 
+/* An Aho-Corasick automaton for context biasing (hotwords) and
+ * keyword spotting.
+ *
+ * The graph is built once into flat arrays: nodes in breadth-first order,
+ * the outgoing arcs of each node sorted by token, and a dense transition
+ * table for the root. A step costs one table lookup at the root and a
+ * short binary search elsewhere. Fail and output links are computed at
+ * build time.
+ *
+ * A graph can be saved with Save() and loaded with Load(). Loading maps
+ * the file into memory, so it costs almost nothing even for very large
+ * hotword or keyword lists.
+ *
+ * A layered graph adds a small list of phrases, e.g., the hotwords of a
+ * single stream, on top of a shared base graph without copying it. The
+ * two automata run side by side; the longer of their two states is the
+ * state of a single graph built from both lists. Scores of this state are
+ * computed the first time it is reached, so every step gives the same
+ * score as with the single graph. A prefix in both lists gets the larger
+ * of its two token scores. For a phrase in both lists, the phrase and
+ * the ac_threshold of the overlay are used.
+ */
 class ContextGraph {
  public:
-  ContextGraph() = default;
+  ContextGraph();
   ContextGraph(const std::vector<std::vector<int32_t>> &token_ids,
                float context_score, float ac_threshold,
                const std::vector<float> &scores = {},
                const std::vector<std::string> &phrases = {},
-               const std::vector<float> &ac_thresholds = {})
-      : context_score_(context_score), ac_threshold_(ac_threshold) {
-    root_ = std::make_unique<ContextState>(-1, 0, 0, 0);
-    root_->fail = root_.get();
-    Build(token_ids, scores, phrases, ac_thresholds);
-  }
+               const std::vector<float> &ac_thresholds = {});
 
   ContextGraph(const std::vector<std::vector<int32_t>> &token_ids,
                float context_score, const std::vector<float> &scores = {})
       : ContextGraph(token_ids, context_score, 0.0f, scores,
                      std::vector<std::string>(), std::vector<float>()) {}
 
+  // Create a layered graph. Phrases of base and of token_ids are
+  // searched together. base must not be a layered graph itself.
+  ContextGraph(ContextGraphPtr base,
+               const std::vector<std::vector<int32_t>> &token_ids,
+               float context_score, float ac_threshold,
+               const std::vector<float> &scores = {},
+               const std::vector<std::string> &phrases = {},
+               const std::vector<float> &ac_thresholds = {});
+
+  ContextGraph(const ContextGraph &) = delete;
+  ContextGraph &operator=(const ContextGraph &) = delete;
+
   std::tuple<float, const ContextState *, const ContextState *> ForwardOneStep(
       const ContextState *state, int32_t token_id,
       bool strict_mode = true) const;
@@ -75,17 +117,125 @@ class ContextGraph {
   std::pair<float, const ContextState *> Finalize(
       const ContextState *state) const;
 
-  const ContextState *Root() const { return root_.get(); }
+  const ContextState *Root() const { return base_ ? layered_root_ : nodes_; }
+
+  // Return the phrase of a node returned by IsMatched() or ForwardOneStep().
+  // It is empty if no phrase is given for it.
+  std::string Phrase(const ContextState *state) const;
+
+  int32_t NumNodes() const { return num_nodes_; }
+
+  /** Save the graph to a binary file that can be loaded by Load().
+   *
+   * The file uses the native byte order. A layered graph cannot be saved.
+   *
+   * @return Return true on success.
+   */
+  bool Save(const std::string &filename) const;
+
+  /** Load a graph saved by Save().
+   *
+   * @return Return nullptr if the file cannot be read or if it is not
+   *         a valid graph.
+   */
+  static ContextGraphPtr Load(const std::string &filename);
+
+  // Return true if the file starts with the header written by Save()
+  static bool IsCompiledGraph(const std::string &filename);
 
  private:
-  float context_score_;
-  float ac_threshold_;
-  std::unique_ptr<ContextState> root_;
   void Build(const std::vector<std::vector<int32_t>> &token_ids,
              const std::vector<float> &scores,
              const std::vector<std::string> &phrases,
-             const std::vector<float> &ac_thresholds) const;
-  void FillFailOutput() const;
+             const std::vector<float> &ac_thresholds);
+
+  void FillFailOutput();
+
+  std::tuple<float, const ContextState *, const ContextState *> Step(
+      const ContextState *state, int32_t token_id, bool strict_mode) const;
+
+  std::pair<bool, const ContextState *> IsMatchedImpl(
+      const ContextState *state) const;
+
+  std::tuple<float, const ContextState *, const ContextState *>
+  LayeredForwardOneStep(const ContextState *state, int32_t token_id,
+                        bool strict_mode) const;
+
+  // Return the index into layered_states_ of the state for the given base
+  // node and overlay node. tokens ends with the token string of the state.
+  // The state is created on first use. The caller should hold mutex_.
+  int32_t GetLayeredState(int32_t base_node, int32_t overlay_node,
+                          const std::vector<int32_t> &tokens) const;
+
+  // Score of the given token string in a single graph built from the
+  // lists of base_ and of this graph
+  float LayeredScore(const int32_t *tokens, int32_t n) const;
+
+  // Set the pointers below to the owned arrays
+  void SetPointers();
+
+  // Return true if all indexes in the arrays are within range and if
+  // following fail and output links always reaches the root, so that a
+  // corrupted file cannot cause an out-of-bounds access or an endless loop.
+  bool IsValid() const;
+
+  // Return the index of the child of the given node with the given token,
+  // or -1 if there is none.
+  int32_t Next(const ContextState *state, int32_t token) const {
+    if (state == nodes_) {
+      return (token >= 0 && token < num_root_next_) ? root_next_[token] : -1;
+    }
+
+    const int32_t *begin = arc_tokens_ + state->arc_begin;
+    const int32_t *end = arc_tokens_ + state->arc_end;
+    const int32_t *it = std::lower_bound(begin, end, token);
+    return (it != end && *it == token) ? arc_targets_[it - arc_tokens_] : -1;
+  }
+
+ private:
+  float context_score_ = 0;
+  float ac_threshold_ = 0;
+
+  // They point either to the owned arrays below or to the content of
+  // buffer_ if the graph is loaded from a file.
+  const ContextState *nodes_ = nullptr;
+  const int32_t *arc_tokens_ = nullptr;
+  const int32_t *arc_targets_ = nullptr;
+  const int32_t *root_next_ = nullptr;
+  const char *phrases_ = nullptr;
+
+  int32_t num_nodes_ = 0;
+  int32_t num_arcs_ = 0;
+  int32_t num_root_next_ = 0;
+  int32_t num_phrase_bytes_ = 0;
+
+  std::vector<ContextState> nodes_storage_;
+  std::vector<int32_t> arc_tokens_storage_;
+  std::vector<int32_t> arc_targets_storage_;
+  std::vector<int32_t> root_next_storage_;
+  std::string phrases_storage_;
+
+  FileBuffer buffer_;
+
+  // Used only by a layered graph
+  struct LayeredState {
+    ContextState state;
+    int32_t base_node = 0;
+    int32_t overlay_node = 0;
+
+    // The longest phrase that is a suffix of tokens, or nullptr if there
+    // is none. It is a node of either base_ or this graph.
+    const ContextState *matched = nullptr;
+    float matched_score = 0;
+
+    std::vector<int32_t> tokens;
+  };
+
+  ContextGraphPtr base_;
+  const ContextState *layered_root_ = nullptr;
+  mutable std::deque<LayeredState> layered_states_;
+  mutable std::unordered_map<uint64_t, int32_t> layered_index_;
+  mutable std::mutex mutex_;
 };
 
 }  // namespace sherpa_onnx
@@ -15,7 +15,9 @@ std::string FastClusteringConfig::ToString() const {
 
   os << "FastClusteringConfig(";
   os << "num_clusters=" << num_clusters << ", ";
-  os << "threshold=" << threshold << ")";
+  os << "threshold=" << threshold << ", ";
+  os << "method=\"" << method << "\", ";
+  os << "block_size=" << block_size << ")";
 
   return os.str();
 }
@@ -31,6 +33,15 @@ void FastClusteringConfig::Register(ParseOptions *po) {
                "If num_clusters is not specified, then it specifies the "
                "distance threshold for clustering. smaller value -> more "
                "clusters. larger value -> fewer clusters");
+
+  po->Register("cluster-method", &method,
+               "Clustering method. Valid values: hclust, two-stage. "
+               "hclust needs O(n^2) memory for n inputs. Use two-stage if "
+               "you have many thousands of inputs.");
+
+  po->Register("cluster-block-size", &block_size,
+               "Used only when --cluster-method=two-stage. Number of inputs "
+               "that are clustered together in the first stage.");
 }
 
 bool FastClusteringConfig::Validate() const {
@@ -39,6 +50,20 @@ bool FastClusteringConfig::Validate() const {
     return false;
   }
 
+  if (method != "hclust" && method != "two-stage") {
+    SHERPA_ONNX_LOGE(
+        "Unsupported clustering method: '%s'. Valid values: hclust, "
+        "two-stage",
+        method.c_str());
+    return false;
+  }
+
+  if (method == "two-stage" && block_size < 2) {
+    SHERPA_ONNX_LOGE("block_size should be at least 2. Given: %d",
+                     block_size);
+    return false;
+  }
+
   return true;
 }
 
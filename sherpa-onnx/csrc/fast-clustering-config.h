@@ -24,10 +24,31 @@ struct FastClusteringConfig {
   // The larger, the fewer clusters it will generate.
   float threshold = 0.5;
 
+  // Supported values:
+  //
+  //  - hclust: Complete-linkage hierarchical clustering over all inputs.
+  //            It needs n*(n-1)/2 doubles for n inputs.
+  //
+  //  - two-stage: Inputs are split into blocks of block_size. Each block
+  //               is over-clustered with hclust and the centroids of the
+  //               resulting sub-clusters are then clustered with hclust.
+  //               Memory usage is O(n). Use it if you have many
+  //               thousands of inputs.
+  std::string method = "hclust";
+
+  // Used only when method is two-stage. Maximum number of inputs per block.
+  // It should be much larger than the number of clusters. hclust within a
+  // block needs block_size*(block_size-1)/2 doubles.
+  int32_t block_size = 1000;
+
   FastClusteringConfig() = default;
 
-  FastClusteringConfig(int32_t num_clusters, float threshold)
-      : num_clusters(num_clusters), threshold(threshold) {}
+  FastClusteringConfig(int32_t num_clusters, float threshold,
+                       const std::string &method, int32_t block_size)
+      : num_clusters(num_clusters),
+        threshold(threshold),
+        method(method),
+        block_size(block_size) {}
 
   std::string ToString() const;
 
@@ -4,6 +4,7 @@
 
 #include "sherpa-onnx/csrc/fast-clustering.h"
 
+#include <random>
 #include <vector>
 
 #include "gtest/gtest.h"
@@ -66,4 +67,52 @@ TEST(FastClustering, TestClusteringWithThreshold) {
   }
 }
 
+// Points around 3 orthogonal directions
+static std::vector<float> GenerateThreeClusters(int32_t n, int32_t dim,
+                                                std::vector<int32_t> *groups) {
+  std::mt19937 gen(20250);
+  std::normal_distribution<float> noise(0, 0.05);
+
+  std::vector<float> features(n * dim);
+  groups->resize(n);
+  for (int32_t i = 0; i != n; ++i) {
+    (*groups)[i] = i % 3;
+    for (int32_t d = 0; d != dim; ++d) {
+      features[i * dim + d] = (d == i % 3) + noise(gen);
+    }
+  }
+
+  return features;
+}
+
+static void ExpectSamePartition(const std::vector<int32_t> &a,
+                                const std::vector<int32_t> &b) {
+  ASSERT_EQ(a.size(), b.size());
+  for (int32_t i = 0; i != static_cast<int32_t>(a.size()); ++i) {
+    for (int32_t j = i + 1; j != static_cast<int32_t>(a.size()); ++j) {
+      EXPECT_EQ(a[i] == a[j], b[i] == b[j]) << i << ", " << j;
+    }
+  }
+}
+
+TEST(FastClustering, TestTwoStage) {
+  int32_t n = 500;
+  int32_t dim = 8;
+  std::vector<int32_t> groups;
+
+  for (int32_t num_clusters : {3, -1}) {
+    std::vector<float> features = GenerateThreeClusters(n, dim, &groups);
+
+    FastClusteringConfig config;
+    config.num_clusters = num_clusters;
+    config.threshold = 0.5;
+    config.method = "two-stage";
+    // It needs two levels of centroids
+    config.block_size = 32;
+
+    FastClustering clustering(config);
+    auto labels = clustering.Cluster(features.data(), n, dim);
+    ExpectSamePartition(labels, groups);
+  }
+}
 }  // namespace sherpa_onnx
@@ -4,6 +4,8 @@
 
 #include "sherpa-onnx/csrc/fast-clustering.h"
 
+#include <algorithm>
+#include <numeric>
 #include <vector>
 
 #include "Eigen/Dense"
@@ -11,6 +13,91 @@
 
 namespace sherpa_onnx {
 
+using RowMajorMatrix =
+    Eigen::Matrix<float, Eigen::Dynamic, Eigen::Dynamic, Eigen::RowMajor>;
+
+// Return the condensed cosine dissimilarity matrix of the rows of m, i.e.,
+// the upper triangular part without the diagonal in row major.
+// Each row of m is assumed to be L2-normalized.
+//
+// Similarities are computed a block of rows at a time with a matrix
+// multiplication, so the extra memory is block * num_rows floats.
+static std::vector<double> ComputeDistance(
+    const Eigen::Ref<const RowMajorMatrix> &m) {
+  int32_t num_rows = m.rows();
+  constexpr int32_t kBlock = 256;
+
+  std::vector<double> distance((static_cast<int64_t>(num_rows) *
+                                (num_rows - 1)) /
+                               2);
+
+  int64_t k = 0;
+  RowMajorMatrix similarity;
+  for (int32_t start = 0; start < num_rows; start += kBlock) {
+    int32_t n = std::min(kBlock, num_rows - start);
+
+    // similarity(i, j) is the cosine similarity between row start + i and
+    // row start + j
+    similarity.noalias() =
+        m.middleRows(start, n) * m.bottomRows(num_rows - start).transpose();
+
+    for (int32_t i = 0; i != n; ++i) {
+      const float *p = similarity.row(i).data();
+      for (int32_t j = i + 1; j < num_rows - start; ++j) {
+        double consine_dissimilarity = 1 - p[j];
+
+        if (consine_dissimilarity < 0) {
+          consine_dissimilarity = 0;
+        }
+
+        distance[k] = consine_dissimilarity;
+        ++k;
+      }
+    }
+  }
+
+  return distance;
+}
+
+// Complete-linkage clustering of the rows of m. If num_clusters is greater
+// than 0, the threshold is ignored.
+static std::vector<int32_t> Hclust(const Eigen::Ref<const RowMajorMatrix> &m,
+                                   int32_t num_clusters, float threshold) {
+  int32_t num_rows = m.rows();
+  if (num_rows <= 0) {
+    return {};
+  }
+
+  if (num_rows == 1) {
+    return {0};
+  }
+
+  std::vector<int32_t> labels(num_rows);
+  if (num_clusters >= num_rows) {
+    std::iota(labels.begin(), labels.end(), 0);
+    return labels;
+  }
+
+  std::vector<double> distance = ComputeDistance(m);
+
+  std::vector<int32_t> merge(2 * (num_rows - 1));
+  std::vector<double> height(num_rows - 1);
+
+  fastclustercpp::hclust_fast(num_rows, distance.data(),
+                              fastclustercpp::HCLUST_METHOD_COMPLETE,
+                              merge.data(), height.data());
+
+  if (num_clusters > 0) {
+    fastclustercpp::cutree_k(num_rows, merge.data(), num_clusters,
+                             labels.data());
+  } else {
+    fastclustercpp::cutree_cdist(num_rows, merge.data(), height.data(),
+                                 threshold, labels.data());
+  }
+
+  return labels;
+}
+
 class FastClustering::Impl {
  public:
   explicit Impl(const FastClusteringConfig &config) : config_(config) {}
@@ -25,43 +112,92 @@ class FastClustering::Impl {
       return {0};
     }
 
-    Eigen::Map<
-        Eigen::Matrix<float, Eigen::Dynamic, Eigen::Dynamic, Eigen::RowMajor>>
-        m(features, num_rows, num_cols);
+    Eigen::Map<RowMajorMatrix> m(features, num_rows, num_cols);
     m.rowwise().normalize();
 
-    std::vector<double> distance((num_rows * (num_rows - 1)) / 2);
+    if (config_.method == "two-stage") {
+      return ClusterTwoStage(m);
+    }
 
-    int32_t k = 0;
-    for (int32_t i = 0; i != num_rows; ++i) {
-      auto v = m.row(i);
-      for (int32_t j = i + 1; j != num_rows; ++j) {
-        double cosine_similarity = v.dot(m.row(j));
-        double consine_dissimilarity = 1 - cosine_similarity;
+    return Hclust(m, config_.num_clusters, config_.threshold);
+  }
 
-        if (consine_dissimilarity < 0) {
-          consine_dissimilarity = 0;
+ private:
+  // Split the rows into blocks of at most block_size rows and over-cluster
+  // each block with hclust. The normalized centroids of all sub-clusters
+  // are then clustered recursively until they fit into a single block.
+  // Memory usage is O(num_rows * num_cols + block_size^2).
+  std::vector<int32_t> ClusterTwoStage(
+      const Eigen::Ref<const RowMajorMatrix> &m) const {
+    int32_t num_rows = m.rows();
+    int32_t num_cols = m.cols();
+
+    if (num_rows <= config_.block_size) {
+      return Hclust(m, config_.num_clusters, config_.threshold);
+    }
+
+    // With num_clusters, each block is cut into this many times fewer
+    // sub-clusters than rows, but not fewer than num_clusters.
+    constexpr int32_t kReductionFactor = 8;
+
+    // Use blocks of equal size so that the last block is not tiny
+    int32_t num_blocks =
+        (num_rows + config_.block_size - 1) / config_.block_size;
+
+    // sub[i] is the sub-cluster of the i-th row
+    std::vector<int32_t> sub(num_rows);
+
+    // Row i is the sum of the rows in the i-th sub-cluster
+    std::vector<float> sums;
+
+    int32_t num_sub = 0;
+    for (int32_t b = 0; b != num_blocks; ++b) {
+      int32_t start = static_cast<int64_t>(b) * num_rows / num_blocks;
+      int32_t end = static_cast<int64_t>(b + 1) * num_rows / num_blocks;
+      int32_t n = end - start;
+      auto block = m.middleRows(start, n);
+
+      // Each block must shrink so that the recursion terminates
+      int32_t max_sub = std::max(1, n / 2);
+
+      std::vector<int32_t> labels;
+      if (config_.num_clusters > 0) {
+        int32_t k = std::max(config_.num_clusters, n / kReductionFactor);
+        labels = Hclust(block, std::min(k, max_sub), 0);
+      } else {
+        // Points within the threshold of each other stay together, as
+        // they would in hclust over all rows
+        labels = Hclust(block, -1, config_.threshold);
+        if (*std::max_element(labels.begin(), labels.end()) >= max_sub) {
+          labels = Hclust(block, max_sub, 0);
         }
+      }
 
-        distance[k] = consine_dissimilarity;
-        ++k;
+      int32_t count = *std::max_element(labels.begin(), labels.end()) + 1;
+      sums.resize(static_cast<int64_t>(num_sub + count) * num_cols, 0);
+
+      for (int32_t i = 0; i != n; ++i) {
+        sub[start + i] = num_sub + labels[i];
+
+        float *dst = sums.data() +
+                     static_cast<int64_t>(num_sub + labels[i]) * num_cols;
+        const float *src = block.row(i).data();
+        for (int32_t c = 0; c != num_cols; ++c) {
+          dst[c] += src[c];
+        }
       }
+
+      num_sub += count;
     }
 
-    std::vector<int32_t> merge(2 * (num_rows - 1));
-    std::vector<double> height(num_rows - 1);
+    Eigen::Map<RowMajorMatrix> centroids(sums.data(), num_sub, num_cols);
+    centroids.rowwise().normalize();
 
-    fastclustercpp::hclust_fast(num_rows, distance.data(),
-                                fastclustercpp::HCLUST_METHOD_COMPLETE,
-                                merge.data(), height.data());
+    std::vector<int32_t> sub_labels = ClusterTwoStage(centroids);
 
     std::vector<int32_t> labels(num_rows);
-    if (config_.num_clusters > 0) {
-      fastclustercpp::cutree_k(num_rows, merge.data(), config_.num_clusters,
-                               labels.data());
-    } else {
-      fastclustercpp::cutree_cdist(num_rows, merge.data(), height.data(),
-                                   config_.threshold, labels.data());
+    for (int32_t i = 0; i != num_rows; ++i) {
+      labels[i] = sub_labels[sub[i]];
     }
 
     return labels;
@@ -0,0 +1,79 @@
+// sherpa-onnx/csrc/feature-ring-test.cc
+//
+// Copyright (c)  2025  Xiaomi Corporation
+
+#include "sherpa-onnx/csrc/feature-ring.h"
+
+#include <thread>  // NOLINT
+#include <vector>
+
+#include "gtest/gtest.h"
+
+namespace sherpa_onnx {
+
+TEST(FeatureRing, PushGetPop) {
+  int32_t feature_dim = 3;
+  FeatureRing ring(feature_dim, 2);
+  EXPECT_EQ(ring.NumFrames(), 0);
+
+  for (int32_t i = 0; i != 7; ++i) {
+    std::vector<float> frame = {i * 1.0f, i * 10.0f, i * 100.0f};
+    ring.Push(frame.data());
+  }
+  EXPECT_EQ(ring.NumFrames(), 7);
+
+  // [1, 6) spans 3 blocks
+  std::vector<float> out(5 * feature_dim);
+  ring.Get(1, 5, out.data());
+  for (int32_t i = 0; i != 5; ++i) {
+    EXPECT_EQ(out[i * feature_dim], i + 1);
+    EXPECT_EQ(out[i * feature_dim + 2], (i + 1) * 100);
+  }
+
+  ring.Pop(5);
+  EXPECT_EQ(ring.Head(), 5);
+
+  ring.Get(5, 2, out.data());
+  EXPECT_EQ(out[0], 5);
+  EXPECT_EQ(out[feature_dim], 6);
+}
+
+TEST(FeatureRing, ProducerConsumer) {
+  int32_t feature_dim = 4;
+  int32_t num_frames = 10000;
+  int32_t chunk = 9;
+  int32_t shift = 5;
+
+  FeatureRing ring(feature_dim, 16);
+
+  std::thread producer([&]() {
+    std::vector<float> frame(feature_dim);
+    for (int32_t i = 0; i != num_frames; ++i) {
+      for (auto &f : frame) {
+        f = i;
+      }
+      ring.Push(frame.data());
+    }
+  });
+
+  std::vector<float> out(chunk * feature_dim);
+  int32_t start = 0;
+  while (start + chunk <= num_frames) {
+    if (ring.NumFrames() < start + chunk) {
+      std::this_thread::yield();
+      continue;
+    }
+
+    ring.Pop(start);
+    ring.Get(start, chunk, out.data());
+    for (int32_t i = 0; i != chunk; ++i) {
+      ASSERT_EQ(out[i * feature_dim], start + i);
+      ASSERT_EQ(out[i * feature_dim + feature_dim - 1], start + i);
+    }
+    start += shift;
+  }
+
+  producer.join();
+}
+
+}  // namespace sherpa_onnx
@@ -0,0 +1,116 @@
+// sherpa-onnx/csrc/feature-ring.cc
+//
+// Copyright (c)  2025  Xiaomi Corporation
+
+#include "sherpa-onnx/csrc/feature-ring.h"
+
+#include <algorithm>
+#include <vector>
+
+#include "sherpa-onnx/csrc/macros.h"
+
+namespace sherpa_onnx {
+
+struct FeatureRing::Block {
+  Block(int32_t start, int32_t size) : start(start), data(size) {}
+
+  // Index of the first frame in this block
+  int32_t start;
+  std::vector<float> data;
+
+  // Written by the producer, read by the consumer
+  std::atomic<Block *> next{nullptr};
+};
+
+FeatureRing::FeatureRing(int32_t feature_dim, int32_t frames_per_block)
+    : feature_dim_(feature_dim), frames_per_block_(frames_per_block) {
+  if (feature_dim_ <= 0 || frames_per_block_ <= 0) {
+    SHERPA_ONNX_LOGE("Invalid feature_dim: %d or frames_per_block: %d",
+                     feature_dim_, frames_per_block_);
+    SHERPA_ONNX_EXIT(-1);
+  }
+
+  head_ = new Block(0, feature_dim_ * frames_per_block_);
+  tail_ = head_;
+}
+
+FeatureRing::~FeatureRing() {
+  Block *p = head_;
+  while (p) {
+    Block *next = p->next.load(std::memory_order_relaxed);
+    delete p;
+    p = next;
+  }
+}
+
+void FeatureRing::Push(const float *frame) {
+  if (tail_size_ == frames_per_block_) {
+    auto block = new Block(tail_->start + frames_per_block_,
+                           feature_dim_ * frames_per_block_);
+    tail_->next.store(block, std::memory_order_release);
+    tail_ = block;
+    tail_size_ = 0;
+  }
+
+  std::copy(frame, frame + feature_dim_,
+            tail_->data.data() + tail_size_ * feature_dim_);
+  ++tail_size_;
+
+  // Publish the frame. It pairs with the acquire load in NumFrames().
+  num_frames_.fetch_add(1, std::memory_order_release);
+}
+
+const FeatureRing::Block *FeatureRing::FindBlock(int32_t frame_index) const {
+  const Block *p = head_;
+  while (frame_index >= p->start + frames_per_block_) {
+    p = p->next.load(std::memory_order_acquire);
+  }
+  return p;
+}
+
+void FeatureRing::Get(int32_t frame_index, int32_t n, float *out) const {
+  if (frame_index < head_index_ || frame_index + n > NumFrames()) {
+    SHERPA_ONNX_LOGE("Invalid range [%d, %d). Available range: [%d, %d)",
+                     frame_index, frame_index + n, head_index_, NumFrames());
+    SHERPA_ONNX_EXIT(-1);
+  }
+
+  const Block *p = FindBlock(frame_index);
+
+  while (n > 0) {
+    int32_t offset = frame_index - p->start;
+    int32_t k = std::min(n, frames_per_block_ - offset);
+
+    const float *src = p->data.data() + offset * feature_dim_;
+    out = std::copy(src, src + k * feature_dim_, out);
+
+    frame_index += k;
+    n -= k;
+
+    if (n > 0) {
+      p = p->next.load(std::memory_order_acquire);
+    }
+  }
+}
+
+void FeatureRing::Pop(int32_t frame_index) {
+  if (frame_index <= head_index_) {
+    return;
+  }
+
+  head_index_ = std::min(frame_index, NumFrames());
+
+  while (head_->start + frames_per_block_ <= head_index_) {
+    // We never free the block the producer is writing to, so the
+    // producer can always link a new block after it.
+    Block *next = head_->next.load(std::memory_order_acquire);
+    if (!next) {
+      break;
+    }
+
+    delete head_;
+    head_ = next;
+  }
+}
+
+}  // namespace sherpa_onnx
@@ -0,0 +1,83 @@
+// sherpa-onnx/csrc/feature-ring.h
+//
+// Copyright (c)  2025  Xiaomi Corporation
+#ifndef SHERPA_ONNX_CSRC_FEATURE_RING_H_
+#define SHERPA_ONNX_CSRC_FEATURE_RING_H_
+
+#include <atomic>
+#include <cstdint>
+
+namespace sherpa_onnx {
+
+// A single-producer/single-consumer queue of feature frames.
+//
+// Frames are stored in fixed-size blocks that form a linked list. The
+// producer appends frames at the tail and the consumer reads frames and
+// frees blocks at the head. Neither side takes a lock; the only shared
+// state is the number of frames pushed and the link between blocks.
+//
+// Frame indexes are linear, i.e., they start from 0 and never wrap around.
+//
+// Exactly one thread may call Push() at a time and exactly one thread may
+// call Get() and Pop() at a time. NumFrames() can be called from any thread.
+class FeatureRing {
+ public:
+  // @param feature_dim Number of floats per frame
+  // @param frames_per_block Number of frames in each block
+  explicit FeatureRing(int32_t feature_dim, int32_t frames_per_block = 128);
+  ~FeatureRing();
+
+  FeatureRing(const FeatureRing &) = delete;
+  FeatureRing &operator=(const FeatureRing &) = delete;
+
+  // Append a frame. It is called only by the producer.
+  //
+  // @param frame Pointer to an array of feature_dim floats
+  void Push(const float *frame);
+
+  // Total number of frames pushed so far.
+  int32_t NumFrames() const {
+    return num_frames_.load(std::memory_order_acquire);
+  }
+
+  // Copy n frames starting from frame_index to out. It is called only by
+  // the consumer.
+  //
+  // @param frame_index Should be in the range [Head(), NumFrames() - n]
+  // @param n Number of frames to copy
+  // @param out Pointer to an array of n * feature_dim floats
+  void Get(int32_t frame_index, int32_t n, float *out) const;
+
+  // Release frames with index less than frame_index. It is called only by
+  // the consumer. Frames are freed a block at a time.
+  void Pop(int32_t frame_index);
+
+  // Index of the first frame that is still available.
+  int32_t Head() const { return head_index_; }
+
+  int32_t FeatureDim() const { return feature_dim_; }
+
+ private:
+  struct Block;
+
+  // Return the block containing the given frame. Called by the consumer.
+  const Block *FindBlock(int32_t frame_index) const;
+
+ private:
+  int32_t feature_dim_;
+  int32_t frames_per_block_;
+
+  // Owned by the consumer
+  Block *head_ = nullptr;
+  int32_t head_index_ = 0;
+
+  // Owned by the producer
+  Block *tail_ = nullptr;
+  int32_t tail_size_ = 0;
+
+  std::atomic<int32_t> num_frames_{0};
+};
+
+}  // namespace sherpa_onnx
+
+#endif  // SHERPA_ONNX_CSRC_FEATURE_RING_H_
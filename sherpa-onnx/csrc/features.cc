@@ -5,12 +5,14 @@
 #include "sherpa-onnx/csrc/features.h"
 
 #include <algorithm>
+#include <atomic>
 #include <memory>
 #include <mutex>  // NOLINT
 #include <sstream>
 #include <vector>
 
 #include "kaldi-native-fbank/csrc/online-feature.h"
+#include "sherpa-onnx/csrc/feature-ring.h"
 #include "sherpa-onnx/csrc/macros.h"
 #include "sherpa-onnx/csrc/resample.h"
 
@@ -65,6 +67,8 @@ class FeatureExtractor::Impl {
     } else {
       InitFbank();
     }
+
+    ring_ = std::make_unique<FeatureRing>(FeatureDim());
   }
 
   void AcceptWaveform(int32_t sampling_rate, const float *waveform, int32_t n) {
@@ -79,6 +83,18 @@ class FeatureExtractor::Impl {
     }
   }
 
+  void AcceptWaveform(int32_t sampling_rate, const int16_t *waveform,
+                      int32_t n) {
+    float scale = config_.normalize_samples ? 1.0f / 32768 : 1.0f;
+
+    std::vector<float> buf(n);
+    for (int32_t i = 0; i != n; ++i) {
+      buf[i] = waveform[i] * scale;
+    }
+
+    AcceptWaveformImpl(sampling_rate, buf.data(), n);
+  }
+
   void AcceptWaveformImpl(int32_t sampling_rate, const float *waveform,
                           int32_t n) {
     std::lock_guard<std::mutex> lock(mutex_);
@@ -131,77 +147,47 @@ class FeatureExtractor::Impl {
     std::lock_guard<std::mutex> lock(mutex_);
     if (fbank_) {
       fbank_->InputFinished();
-      return;
     } else if (whisper_fbank_) {
       whisper_fbank_->InputFinished();
-      return;
     } else if (mfcc_) {
       mfcc_->InputFinished();
-      return;
+    } else {
+      SHERPA_ONNX_LOGE("unreachable code");
+      SHERPA_ONNX_EXIT(-1);
     }
 
-    SHERPA_ONNX_LOGE("unreachable code");
-    SHERPA_ONNX_EXIT(-1);
-  }
+    MoveReadyFrames();
 
-  int32_t NumFramesReady() const {
-    if (fbank_) {
-      return fbank_->NumFramesReady();
-    } else if (whisper_fbank_) {
-      return whisper_fbank_->NumFramesReady();
-    } else if (mfcc_) {
-      return mfcc_->NumFramesReady();
-    }
-    SHERPA_ONNX_LOGE("unreachable code");
-    SHERPA_ONNX_EXIT(-1);
-    return -1;
+    // Set it after the last frames are published; see IsLastFrame()
+    input_finished_.store(true, std::memory_order_release);
   }
 
-  bool IsLastFrame(int32_t frame) const {
-    std::lock_guard<std::mutex> lock(mutex_);
-    if (fbank_) {
-      return fbank_->IsLastFrame(frame);
-    } else if (whisper_fbank_) {
-      return whisper_fbank_->IsLastFrame(frame);
-    } else if (mfcc_) {
-      return mfcc_->IsLastFrame(frame);
-    }
+  // Frames are read from ring_, which is written only by the thread calling
+  // AcceptWaveform() and InputFinished(), so the methods below don't need
+  // to take mutex_.
+  int32_t NumFramesReady() const { return ring_->NumFrames(); }
 
-    SHERPA_ONNX_LOGE("unreachable code");
-    SHERPA_ONNX_EXIT(-1);
-    return false;
+  bool IsLastFrame(int32_t frame) const {
+    return input_finished_.load(std::memory_order_acquire) &&
+           frame == ring_->NumFrames() - 1;
   }
 
-  std::vector<float> GetFrames(int32_t frame_index, int32_t n) {
-    std::lock_guard<std::mutex> lock(mutex_);
+  void GetFrames(int32_t frame_index, int32_t n, float *out) const {
     if (frame_index + n > NumFramesReady()) {
       SHERPA_ONNX_LOGE("%d + %d > %d\n", frame_index, n, NumFramesReady());
       SHERPA_ONNX_EXIT(-1);
     }
 
-    int32_t discard_num = frame_index - last_frame_index_;
-    if (discard_num < 0) {
+    if (frame_index < ring_->Head()) {
       SHERPA_ONNX_LOGE("last_frame_index_: %d, frame_index_: %d",
-                       last_frame_index_, frame_index);
+                       ring_->Head(), frame_index);
       SHERPA_ONNX_EXIT(-1);
     }
 
-    PopWrapper(discard_num);
-
-    int32_t feature_dim = FeatureDim();
-    std::vector<float> features(feature_dim * n);
-
-    float *p = features.data();
-
-    for (int32_t i = 0; i != n; ++i) {
-      const float *f = GetFrameWrapper(i + frame_index);
-      std::copy(f, f + feature_dim, p);
-      p += feature_dim;
-    }
-
-    last_frame_index_ = frame_index;
+    // Frames before frame_index won't be accessed any longer
+    ring_->Pop(frame_index);
 
-    return features;
+    ring_->Get(frame_index, n, out);
   }
 
   int32_t FeatureDim() const {
@@ -221,17 +207,39 @@ class FeatureExtractor::Impl {
                              int32_t n) const {
     if (fbank_) {
       fbank_->AcceptWaveform(sampling_rate, waveform, n);
-      return;
     } else if (whisper_fbank_) {
       whisper_fbank_->AcceptWaveform(sampling_rate, waveform, n);
-      return;
     } else if (mfcc_) {
       mfcc_->AcceptWaveform(sampling_rate, waveform, n);
-      return;
+    } else {
+      SHERPA_ONNX_LOGE("unreachable code");
+      SHERPA_ONNX_EXIT(-1);
     }
 
-    SHERPA_ONNX_LOGE("unreachable code");
-    SHERPA_ONNX_EXIT(-1);
+    MoveReadyFrames();
+  }
+
+  // Move newly computed frames from the feature computer into ring_ so that
+  // the consumer never touches the feature computer. It is called with
+  // mutex_ held.
+  void MoveReadyFrames() const {
+    int32_t num_moved = ring_->NumFrames();
+    int32_t num_ready = 0;
+    if (fbank_) {
+      num_ready = fbank_->NumFramesReady();
+    } else if (whisper_fbank_) {
+      num_ready = whisper_fbank_->NumFramesReady();
+    } else if (mfcc_) {
+      num_ready = mfcc_->NumFramesReady();
+    }
+
+    for (int32_t i = num_moved; i < num_ready; ++i) {
+      ring_->Push(GetFrameWrapper(i));
+    }
+
+    if (num_ready > num_moved) {
+      PopWrapper(num_ready - num_moved);
+    }
   }
 
   const float *GetFrameWrapper(int32_t frame_index) const {
@@ -329,9 +337,11 @@ class FeatureExtractor::Impl {
   knf::FbankOptions opts_;
   knf::MfccOptions mfcc_opts_;
   FeatureExtractorConfig config_;
+  // Serializes AcceptWaveform() and InputFinished()
   mutable std::mutex mutex_;
   std::unique_ptr<LinearResample> resampler_;
-  int32_t last_frame_index_ = 0;
+  std::unique_ptr<FeatureRing> ring_;
+  mutable std::atomic<bool> input_finished_{false};
 };
 
 FeatureExtractor::FeatureExtractor(const FeatureExtractorConfig &config /*={}*/)
@@ -344,6 +354,12 @@ void FeatureExtractor::AcceptWaveform(int32_t sampling_rate,
   impl_->AcceptWaveform(sampling_rate, waveform, n);
 }
 
+void FeatureExtractor::AcceptWaveform(int32_t sampling_rate,
+                                      const int16_t *waveform,
+                                      int32_t n) const {
+  impl_->AcceptWaveform(sampling_rate, waveform, n);
+}
+
 void FeatureExtractor::InputFinished() const { impl_->InputFinished(); }
 
 int32_t FeatureExtractor::NumFramesReady() const {
@@ -354,9 +370,16 @@ bool FeatureExtractor::IsLastFrame(int32_t frame) const {
   return impl_->IsLastFrame(frame);
 }
 
+void FeatureExtractor::GetFrames(int32_t frame_index, int32_t n,
+                                 float *out) const {
+  impl_->GetFrames(frame_index, n, out);
+}
+
 std::vector<float> FeatureExtractor::GetFrames(int32_t frame_index,
                                                int32_t n) const {
-  return impl_->GetFrames(frame_index, n);
+  std::vector<float> features(n * FeatureDim());
+  impl_->GetFrames(frame_index, n, features.data());
+  return features;
 }
 
 int32_t FeatureExtractor::FeatureDim() const { return impl_->FeatureDim(); }
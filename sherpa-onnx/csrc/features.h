@@ -5,6 +5,7 @@
 #ifndef SHERPA_ONNX_CSRC_FEATURES_H_
 #define SHERPA_ONNX_CSRC_FEATURES_H_
 
+#include <cstdint>
 #include <memory>
 #include <string>
 #include <vector>
@@ -104,6 +105,13 @@ class FeatureExtractor {
   void AcceptWaveform(int32_t sampling_rate, const float *waveform,
                       int32_t n) const;
 
+  /** Same as above, but the input is 16-bit PCM, i.e., each sample is in
+   * the range [-32768, 32767]. The samples are converted and scaled in a
+   * single pass, so callers don't need to convert them to float first.
+   */
+  void AcceptWaveform(int32_t sampling_rate, const int16_t *waveform,
+                      int32_t n) const;
+
   /**
    * InputFinished() tells the class you won't be providing any
    * more waveform.  This will help flush out the last frame or two
@@ -128,6 +136,17 @@ class FeatureExtractor {
    */
   std::vector<float> GetFrames(int32_t frame_index, int32_t n) const;
 
+  /** Like GetFrames() above, but the frames are written to the given
+   * buffer, e.g., directly into a batched input tensor.
+   *
+   * It does not take any lock and can be called from a thread other than
+   * the one calling AcceptWaveform(). Frames before frame_index are
+   * released and cannot be accessed afterwards.
+   *
+   * @param out Pointer to an array of n * FeatureDim() floats
+   */
+  void GetFrames(int32_t frame_index, int32_t n, float *out) const;
+
   /// Return feature dim of this extractor
   int32_t FeatureDim() const;
 
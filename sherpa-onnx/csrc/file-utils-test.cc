@@ -0,0 +1,51 @@
+// sherpa-onnx/csrc/file-utils-test.cc
+//
+// Copyright (c)  2025  Xiaomi Corporation
+
+#include "sherpa-onnx/csrc/file-utils.h"
+
+#include <cstdio>
+#include <fstream>
+#include <string>
+#include <utility>
+
+#include "gtest/gtest.h"
+
+namespace sherpa_onnx {
+
+TEST(FileUtils, ReadFile) {
+  std::string filename = "sherpa-onnx-file-utils-test.bin";
+  std::string content = "hello sherpa-onnx";
+  content.push_back('\0');
+  content += "after zero";
+
+  {
+    std::ofstream os(filename, std::ios::binary);
+    os.write(content.data(), content.size());
+  }
+
+  auto buf = ReadFile(filename);
+  EXPECT_EQ(buf.size(), content.size());
+  EXPECT_EQ(std::string(buf.begin(), buf.end()), content);
+
+  FileBuffer moved = std::move(buf);
+  EXPECT_TRUE(buf.empty());
+  EXPECT_EQ(std::string(moved.begin(), moved.end()), content);
+
+  // the mapping is copy-on-write
+  moved.data()[0] = 'H';
+  EXPECT_EQ(moved[0], 'H');
+
+  auto buf2 = ReadFile(filename);
+  EXPECT_EQ(buf2[0], 'h');
+
+  std::remove(filename.c_str());
+}
+
+TEST(FileUtils, ReadNonExistingFile) {
+  auto buf = ReadFile("sherpa-onnx-file-utils-test-does-not-exist.bin");
+  EXPECT_TRUE(buf.empty());
+  EXPECT_EQ(buf.size(), 0);
+}
+
+}  // namespace sherpa_onnx
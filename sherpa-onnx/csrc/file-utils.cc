@@ -8,6 +8,17 @@
 #include <memory>
 #include <sstream>
 #include <string>
+#include <utility>
+#include <vector>
+
+#if defined(_WIN32)
+#include <windows.h>
+#else
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
 
 #include "sherpa-onnx/csrc/macros.h"
 
@@ -24,12 +35,156 @@ void AssertFileExists(const std::string &filename) {
   }
 }
 
-std::vector<char> ReadFile(const std::string &filename) {
-  std::ifstream input(filename, std::ios::binary);
-  std::vector<char> buffer(std::istreambuf_iterator<char>(input), {});
+static std::vector<char> ReadFileToVector(const std::string &filename) {
+  std::ifstream input(filename, std::ios::binary | std::ios::ate);
+  if (!input) {
+    return {};
+  }
+
+  std::streamsize n = input.tellg();
+  if (n <= 0) {
+    return {};
+  }
+
+  std::vector<char> buffer(n);
+
+  input.seekg(0, std::ios::beg);
+  if (!input.read(buffer.data(), n)) {
+    SHERPA_ONNX_LOGE("Failed to read '%s'", filename.c_str());
+    return {};
+  }
+
   return buffer;
 }
 
+#if defined(_WIN32)
+static char *MapFile(const std::string &filename, size_t *size) {
+  HANDLE file = CreateFileA(filename.c_str(), GENERIC_READ, FILE_SHARE_READ,
+                            nullptr, OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL,
+                            nullptr);
+  if (file == INVALID_HANDLE_VALUE) {
+    return nullptr;
+  }
+
+  LARGE_INTEGER file_size;
+  if (!GetFileSizeEx(file, &file_size) || file_size.QuadPart == 0) {
+    CloseHandle(file);
+    return nullptr;
+  }
+
+  HANDLE mapping =
+      CreateFileMappingA(file, nullptr, PAGE_WRITECOPY, 0, 0, nullptr);
+  CloseHandle(file);
+
+  if (!mapping) {
+    return nullptr;
+  }
+
+  void *p = MapViewOfFile(mapping, FILE_MAP_COPY, 0, 0, 0);
+
+  // The view keeps a reference to the mapping object
+  CloseHandle(mapping);
+
+  if (!p) {
+    return nullptr;
+  }
+
+  *size = static_cast<size_t>(file_size.QuadPart);
+
+  return static_cast<char *>(p);
+}
+
+static void UnmapFile(char *p, size_t /*size*/) { UnmapViewOfFile(p); }
+#else
+static char *MapFile(const std::string &filename, size_t *size) {
+  int fd = open(filename.c_str(), O_RDONLY);
+  if (fd == -1) {
+    return nullptr;
+  }
+
+  struct stat st;
+  if (fstat(fd, &st) == -1 || st.st_size == 0) {
+    close(fd);
+    return nullptr;
+  }
+
+  void *p = mmap(nullptr, st.st_size, PROT_READ | PROT_WRITE, MAP_PRIVATE, fd,
+                 0);
+
+  // The mapping stays valid after closing the file descriptor
+  close(fd);
+
+  if (p == MAP_FAILED) {
+    return nullptr;
+  }
+
+#if defined(MADV_WILLNEED)
+  // Models are read from start to end when creating a session.
+  // Start reading ahead now.
+  madvise(p, st.st_size, MADV_WILLNEED);
+#endif
+
+  *size = static_cast<size_t>(st.st_size);
+
+  return static_cast<char *>(p);
+}
+
+static void UnmapFile(char *p, size_t size) { munmap(p, size); }
+#endif
+
+FileBuffer::FileBuffer(const std::string &filename) {
+  data_ = MapFile(filename, &size_);
+  if (data_) {
+    mapped_ = true;
+    return;
+  }
+
+  size_ = 0;
+  buffer_ = ReadFileToVector(filename);
+  data_ = buffer_.data();
+  size_ = buffer_.size();
+}
+
+FileBuffer::~FileBuffer() { Release(); }
+
+FileBuffer::FileBuffer(FileBuffer &&other) noexcept {
+  *this = std::move(other);
+}
+
+FileBuffer &FileBuffer::operator=(FileBuffer &&other) noexcept {
+  if (this == &other) {
+    return *this;
+  }
+
+  Release();
+
+  mapped_ = other.mapped_;
+  size_ = other.size_;
+  buffer_ = std::move(other.buffer_);
+  data_ = mapped_ ? other.data_ : buffer_.data();
+
+  other.data_ = nullptr;
+  other.size_ = 0;
+  other.mapped_ = false;
+
+  return *this;
+}
+
+void FileBuffer::Release() {
+  if (mapped_) {
+    UnmapFile(data_, size_);
+  }
+
+  data_ = nullptr;
+  size_ = 0;
+  mapped_ = false;
+  buffer_.clear();
+}
+
+FileBuffer ReadFile(const std::string &filename) {
+  return FileBuffer(filename);
+}
+
 #if __ANDROID_API__ >= 9
 std::vector<char> ReadFile(AAssetManager *mgr, const std::string &filename) {
   AAsset *asset = AAssetManager_open(mgr, filename.c_str(), AASSET_MODE_BUFFER);
@@ -33,7 +33,59 @@ bool FileExists(const std::string &filename);
  */
 void AssertFileExists(const std::string &filename);
 
-std::vector<char> ReadFile(const std::string &filename);
+/** Read-only content of a file.
+ *
+ * The file is memory-mapped if the platform supports it, so that its pages
+ * are loaded on demand and shared with the page cache instead of being
+ * copied to the heap. Otherwise, the file is read into memory.
+ *
+ * The mapping is private (copy-on-write) so that it is safe to pass data()
+ * to APIs that accept a non-const pointer.
+ */
+class FileBuffer {
+ public:
+  FileBuffer() = default;
+  explicit FileBuffer(const std::string &filename);
+  ~FileBuffer();
+
+  FileBuffer(FileBuffer &&other) noexcept;
+  FileBuffer &operator=(FileBuffer &&other) noexcept;
+
+  FileBuffer(const FileBuffer &) = delete;
+  FileBuffer &operator=(const FileBuffer &) = delete;
+
+  char *data() { return data_; }
+  const char *data() const { return data_; }
+
+  size_t size() const { return size_; }
+  bool empty() const { return size_ == 0; }
+
+  char *begin() { return data_; }
+  char *end() { return data_ + size_; }
+  const char *begin() const { return data_; }
+  const char *end() const { return data_ + size_; }
+
+  char operator[](size_t i) const { return data_[i]; }
+
+  // true if the content is memory-mapped
+  bool IsMapped() const { return mapped_; }
+
+ private:
+  void Release();
+
+ private:
+  char *data_ = nullptr;
+  size_t size_ = 0;
+  bool mapped_ = false;
+
+  // Used only when the file cannot be memory-mapped
+  std::vector<char> buffer_;
+};
+
+/** Return the content of a file. An empty buffer is returned if the file
+ * cannot be opened.
+ */
+FileBuffer ReadFile(const std::string &filename);
 
 #if __ANDROID_API__ >= 9
 std::vector<char> ReadFile(AAssetManager *mgr, const std::string &filename);
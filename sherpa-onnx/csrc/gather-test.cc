@@ -0,0 +1,90 @@
+// sherpa-onnx/csrc/gather-test.cc
+//
+// Copyright (c)  2025  Xiaomi Corporation
+
+#include "sherpa-onnx/csrc/gather.h"
+
+#include "gtest/gtest.h"
+#include "sherpa-onnx/csrc/onnx-utils.h"
+
+namespace sherpa_onnx {
+
+TEST(Gather, Test2DTensorsDim0) {
+  Ort::AllocatorWithDefaultOptions allocator;
+
+  std::array<int64_t, 2> a_shape{2, 3};
+  std::array<int64_t, 2> b_shape{3, 3};
+
+  Ort::Value a = Ort::Value::CreateTensor<float>(allocator, a_shape.data(),
+                                                 a_shape.size());
+
+  Ort::Value b = Ort::Value::CreateTensor<float>(allocator, b_shape.data(),
+                                                 b_shape.size());
+
+  float *pa = a.GetTensorMutableData<float>();
+  float *pb = b.GetTensorMutableData<float>();
+  for (int32_t i = 0; i != static_cast<int32_t>(a_shape[0] * a_shape[1]);
+       ++i) {
+    pa[i] = i;
+  }
+  for (int32_t i = 0; i != static_cast<int32_t>(b_shape[0] * b_shape[1]);
+       ++i) {
+    pb[i] = i + 10;
+  }
+
+  // rows: b[2], a[0], b[0]
+  Ort::Value ans = Gather(allocator, {&b, &a, &b}, {2, 0, 0}, 0);
+
+  auto shape = ans.GetTensorTypeAndShapeInfo().GetShape();
+  EXPECT_EQ(shape[0], 3);
+  EXPECT_EQ(shape[1], 3);
+
+  const float *pans = ans.GetTensorData<float>();
+  for (int32_t i = 0; i != 3; ++i) {
+    EXPECT_EQ(pans[i], pb[6 + i]);
+    EXPECT_EQ(pans[3 + i], pa[i]);
+    EXPECT_EQ(pans[6 + i], pb[i]);
+  }
+
+  Print2D(&a);
+  Print2D(&b);
+  Print2D(&ans);
+}
+
+TEST(Gather, Test3DTensorsDim1) {
+  Ort::AllocatorWithDefaultOptions allocator;
+
+  std::array<int64_t, 3> a_shape{2, 3, 2};
+  std::array<int64_t, 3> b_shape{2, 1, 2};
+
+  Ort::Value a = Ort::Value::CreateTensor<int64_t>(allocator, a_shape.data(),
+                                                   a_shape.size());
+
+  Ort::Value b = Ort::Value::CreateTensor<int64_t>(allocator, b_shape.data(),
+                                                   b_shape.size());
+
+  int64_t *pa = a.GetTensorMutableData<int64_t>();
+  int64_t *pb = b.GetTensorMutableData<int64_t>();
+  for (int32_t i = 0; i != 12; ++i) {
+    pa[i] = i;
+  }
+  for (int32_t i = 0; i != 4; ++i) {
+    pb[i] = i + 100;
+  }
+
+  // rows: a[:, 1], b[:, 0]
+  Ort::Value ans = Gather<int64_t>(allocator, {&a, &b}, {1, 0}, 1);
+
+  auto shape = ans.GetTensorTypeAndShapeInfo().GetShape();
+  EXPECT_EQ(shape[0], 2);
+  EXPECT_EQ(shape[1], 2);
+  EXPECT_EQ(shape[2], 2);
+
+  const int64_t *pans = ans.GetTensorData<int64_t>();
+  std::array<int64_t, 8> expected{2, 3, 100, 101, 8, 9, 102, 103};
+  for (int32_t i = 0; i != 8; ++i) {
+    EXPECT_EQ(pans[i], expected[i]);
+  }
+}
+
+}  // namespace sherpa_onnx
@@ -0,0 +1,75 @@
+// sherpa-onnx/csrc/gather.cc
+//
+// Copyright (c)  2025  Xiaomi Corporation
+
+#include "sherpa-onnx/csrc/gather.h"
+
+#include <algorithm>
+#include <functional>
+#include <numeric>
+#include <utility>
+#include <vector>
+
+#include "sherpa-onnx/csrc/macros.h"
+
+namespace sherpa_onnx {
+
+template <typename T /*= float*/>
+Ort::Value Gather(OrtAllocator *allocator,
+                  const std::vector<const Ort::Value *> &values,
+                  const std::vector<int32_t> &rows, int32_t dim) {
+  if (values.size() != rows.size() || values.empty()) {
+    SHERPA_ONNX_LOGE("Size mismatch or empty input. values: %d, rows: %d",
+                     static_cast<int32_t>(values.size()),
+                     static_cast<int32_t>(rows.size()));
+    SHERPA_ONNX_EXIT(-1);
+  }
+
+  int32_t n = static_cast<int32_t>(rows.size());
+
+  std::vector<int64_t> shape =
+      values[0]->GetTensorTypeAndShapeInfo().GetShape();
+
+  auto leading_size = static_cast<int32_t>(std::accumulate(
+      shape.begin(), shape.begin() + dim, 1, std::multiplies<int64_t>()));
+
+  auto trailing_size = static_cast<int32_t>(std::accumulate(
+      shape.begin() + dim + 1, shape.end(), 1, std::multiplies<int64_t>()));
+
+  std::vector<int64_t> ans_shape = shape;
+  ans_shape[dim] = n;
+
+  Ort::Value ans = Ort::Value::CreateTensor<T>(allocator, ans_shape.data(),
+                                               ans_shape.size());
+  T *dst = ans.GetTensorMutableData<T>();
+
+  std::vector<const T *> src(n);
+  std::vector<int32_t> src_dim(n);
+  for (int32_t k = 0; k != n; ++k) {
+    src[k] = values[k]->template GetTensorData<T>();
+    src_dim[k] = static_cast<int32_t>(
+        values[k]->GetTensorTypeAndShapeInfo().GetShape()[dim]);
+  }
+
+  for (int32_t i = 0; i != leading_size; ++i) {
+    for (int32_t k = 0; k != n; ++k) {
+      const T *p =
+          src[k] + (static_cast<int64_t>(i) * src_dim[k] + rows[k]) *
+                       trailing_size;
+      std::copy(p, p + trailing_size, dst);
+      dst += trailing_size;
+    }
+  }
+
+  return ans;
+}
+
+template Ort::Value Gather<float>(
+    OrtAllocator *allocator, const std::vector<const Ort::Value *> &values,
+    const std::vector<int32_t> &rows, int32_t dim);
+
+template Ort::Value Gather<int64_t>(
+    OrtAllocator *allocator, const std::vector<const Ort::Value *> &values,
+    const std::vector<int32_t> &rows, int32_t dim);
+
+}  // namespace sherpa_onnx
@@ -0,0 +1,35 @@
+// sherpa-onnx/csrc/gather.h
+//
+// Copyright (c)  2025  Xiaomi Corporation
+#ifndef SHERPA_ONNX_CSRC_GATHER_H_
+#define SHERPA_ONNX_CSRC_GATHER_H_
+
+#include <vector>
+
+#include "onnxruntime_cxx_api.h"  // NOLINT
+
+namespace sherpa_onnx {
+
+/** Build a tensor from slices of other tensors.
+ *
+ * The i-th slice of the output along `dim` is the rows[i]-th slice of
+ * values[i] along `dim`. It is like Cat() of the selected slices, but
+ * without slicing them first.
+ *
+ * @param allocator Allocator to allocate space for the returned tensor
+ * @param values  Pointer to a list of tensors. They may repeat. Shape of
+ *                them must be equal except for the dimension to gather.
+ * @param rows  rows[i] is the index of the slice to take from values[i].
+ * @param dim  The dim along which to gather.
+ *
+ * @return Return a tensor of the same shape as values[0] except that
+ *         shape[dim] equals to rows.size().
+ */
+template <typename T = float>
+Ort::Value Gather(OrtAllocator *allocator,
+                  const std::vector<const Ort::Value *> &values,
+                  const std::vector<int32_t> &rows, int32_t dim);
+
+}  // namespace sherpa_onnx
+
+#endif  // SHERPA_ONNX_CSRC_GATHER_H_
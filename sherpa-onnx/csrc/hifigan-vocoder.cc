@@ -20,6 +20,7 @@
 #include "sherpa-onnx/csrc/file-utils.h"
 #include "sherpa-onnx/csrc/macros.h"
 #include "sherpa-onnx/csrc/onnx-utils.h"
+#include "sherpa-onnx/csrc/session-registry.h"
 #include "sherpa-onnx/csrc/session.h"
 
 namespace sherpa_onnx {
@@ -29,7 +30,7 @@ class HifiganVocoder::Impl {
   explicit Impl(int32_t num_threads, const std::string &provider,
                 const std::string &model)
       : env_(ORT_LOGGING_LEVEL_ERROR),
-        sess_opts_(GetSessionOptions(num_threads, provider)),
+        sess_opts_(GetSessionOptionsWithKey(num_threads, provider)),
         allocator_{} {
     auto buf = ReadFile(model);
     Init(buf.data(), buf.size());
@@ -39,7 +40,7 @@ class HifiganVocoder::Impl {
   explicit Impl(Manager *mgr, int32_t num_threads, const std::string &provider,
                 const std::string &model)
       : env_(ORT_LOGGING_LEVEL_ERROR),
-        sess_opts_(GetSessionOptions(num_threads, provider)),
+        sess_opts_(GetSessionOptionsWithKey(num_threads, provider)),
         allocator_{} {
     auto buf = ReadFile(mgr, model);
     Init(buf.data(), buf.size());
@@ -64,8 +65,7 @@ class HifiganVocoder::Impl {
 
  private:
   void Init(void *model_data, size_t model_data_length) {
-    sess_ = std::make_unique<Ort::Session>(env_, model_data, model_data_length,
-                                           sess_opts_);
+    sess_ = GetOrCreateSession(env_, model_data, model_data_length, sess_opts_);
 
     GetInputNames(sess_.get(), &input_names_, &input_names_ptr_);
 
@@ -74,10 +74,10 @@ class HifiganVocoder::Impl {
 
  private:
   Ort::Env env_;
-  Ort::SessionOptions sess_opts_;
+  SessionOptionsWithKey sess_opts_;
   Ort::AllocatorWithDefaultOptions allocator_;
 
-  std::unique_ptr<Ort::Session> sess_;
+  std::shared_ptr<Ort::Session> sess_;
 
   std::vector<std::string> input_names_;
   std::vector<const char *> input_names_ptr_;
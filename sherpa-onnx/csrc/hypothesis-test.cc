@@ -0,0 +1,138 @@
+// sherpa-onnx/csrc/hypothesis-test.cc
+//
+// Copyright (c)  2025  Xiaomi Corporation
+
+#include "sherpa-onnx/csrc/hypothesis.h"
+
+#include <vector>
+
+#include "gtest/gtest.h"
+
+namespace sherpa_onnx {
+
+TEST(Hypothesis, Append) {
+  Hypothesis h({-1, 0}, 0);
+  EXPECT_EQ(h.NumTokens(), 2);
+  EXPECT_TRUE(h.Timestamps().empty());
+
+  h.Append(5, 3);
+  h.SetLastYsProb(0.5);
+  h.Append(8, 7);
+  h.SetLastYsProb(0.25);
+
+  EXPECT_EQ(h.NumTokens(), 4);
+  EXPECT_EQ(h.LastToken(), 8);
+  EXPECT_EQ(h.Ys(), (std::vector<int64_t>{-1, 0, 5, 8}));
+  EXPECT_EQ(h.LastTokens(2), (std::vector<int64_t>{5, 8}));
+  EXPECT_EQ(h.Timestamps(), (std::vector<int32_t>{3, 7}));
+  EXPECT_EQ(h.YsProbs(), (std::vector<float>{0.5, 0.25}));
+  EXPECT_TRUE(h.LmProbs().empty());
+  EXPECT_TRUE(h.ContextScores().empty());
+}
+
+TEST(Hypothesis, SharedPrefix) {
+  Hypothesis a({-1, 0}, 0);
+  a.Append(5, 1);
+
+  Hypothesis b = a;
+  b.Append(6, 2);
+  b.SetLastContextScore(1.5);
+
+  // Setting a score on a shared tail must not affect the other copy
+  Hypothesis c = a;
+  c.SetLastYsProb(0.5);
+
+  EXPECT_EQ(a.Ys(), (std::vector<int64_t>{-1, 0, 5}));
+  EXPECT_EQ(b.Ys(), (std::vector<int64_t>{-1, 0, 5, 6}));
+  EXPECT_EQ(b.ContextScores(), (std::vector<float>{1.5}));
+  EXPECT_TRUE(a.YsProbs().empty());
+  EXPECT_EQ(c.YsProbs(), (std::vector<float>{0.5}));
+  EXPECT_EQ(a.Key(), c.Key());
+  EXPECT_NE(a.Key(), b.Key());
+}
+
+TEST(Hypothesis, Key) {
+  Hypothesis a({-1, 0}, 0);
+  a.Append(1, 0);
+  a.Append(2, 1);
+
+  Hypothesis b({-1, 0, 1, 2}, 0);
+  EXPECT_EQ(a.Key(), b.Key());
+
+  Hypothesis c({-1, 0, 2, 1}, 0);
+  EXPECT_NE(a.Key(), c.Key());
+
+  Hypothesis d({-1, 0, 1}, 0);
+  EXPECT_NE(a.Key(), d.Key());
+}
+
+TEST(Hypotheses, Add) {
+  Hypotheses hyps;
+
+  Hypothesis a({-1, 0}, -1);
+  a.Append(3, 0);
+  hyps.Add(a);
+
+  Hypothesis b({-1, 0, 3}, -2);
+  hyps.Add(b);
+
+  EXPECT_EQ(hyps.Size(), 1);
+  EXPECT_NEAR(hyps.begin()->second.log_prob,
+              LogAdd<double>()(-1.0, -2.0), 1e-6);
+
+  Hypothesis c({-1, 0, 4}, -3);
+  hyps.Add(c);
+  EXPECT_EQ(hyps.Size(), 2);
+  EXPECT_EQ(hyps.GetMostProbable(false).LastToken(), 3);
+}
+
+// Hyps with different tokens but the same key are kept apart
+TEST(Hypotheses, AddKeyCollision) {
+  Hypothesis a({-1, 0, 3}, -1);
+  Hypothesis b({-1, 0, 4}, -2);
+  Hypothesis c({-1, 0, 5}, -3);
+
+  // Pretend that b collides with a and that c uses the key b is moved to
+  b.tail->key = a.Key();
+  c.tail->key = a.Key() + 1;
+
+  Hypotheses hyps;
+  hyps.Add(a);
+  hyps.Add(b);
+  hyps.Add(c);
+  EXPECT_EQ(hyps.Size(), 3);
+
+  Hypothesis b2 = b;
+  b2.log_prob = -4;
+  hyps.Add(b2);
+  EXPECT_EQ(hyps.Size(), 3);
+
+  for (const auto &p : hyps) {
+    const auto &h = p.second;
+    if (h.LastToken() == 3) {
+      EXPECT_EQ(h.log_prob, -1);
+    } else if (h.LastToken() == 4) {
+      EXPECT_NEAR(h.log_prob, LogAdd<double>()(-2.0, -4.0), 1e-6);
+    } else {
+      EXPECT_EQ(h.LastToken(), 5);
+      EXPECT_EQ(h.log_prob, -3);
+    }
+  }
+
+  Hypotheses hyps2({a, b, c, b2});
+  EXPECT_EQ(hyps2.Size(), 3);
+}
+
+TEST(Hypothesis, LongHistory) {
+  // Releasing a long history must not overflow the stack
+  Hypothesis h({-1, 0}, 0);
+  for (int32_t i = 0; i != 1000000; ++i) {
+    h.Append(i % 500 + 1, i);
+  }
+  EXPECT_EQ(h.NumTokens(), 1000002);
+  Hypothesis copy = h;
+  h = Hypothesis();
+  EXPECT_EQ(copy.NumTokens(), 1000002);
+}
+
+}  // namespace sherpa_onnx
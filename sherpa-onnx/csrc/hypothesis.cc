@@ -6,20 +6,186 @@
 #include "sherpa-onnx/csrc/hypothesis.h"
 
 #include <algorithm>
+#include <memory>
+#include <string>
 #include <utility>
+#include <vector>
 
 namespace sherpa_onnx {
 
+namespace {
+
+// Hash of a token sequence, updated one token at a time.
+// The mixing steps are from splitmix64.
+uint64_t RollingHash(uint64_t h, int64_t token) {
+  uint64_t x = h * 0x100000001b3ULL + static_cast<uint64_t>(token) +
+               0x9e3779b97f4a7c15ULL;
+  x = (x ^ (x >> 30)) * 0xbf58476d1ce4e5b9ULL;
+  x = (x ^ (x >> 27)) * 0x94d049bb133111ebULL;
+  return x ^ (x >> 31);
+}
+
+std::shared_ptr<HypothesisToken> NewToken(
+    int64_t token, std::shared_ptr<HypothesisToken> prev) {
+  auto node = std::make_shared<HypothesisToken>();
+  node->token = token;
+  node->num_tokens = prev ? prev->num_tokens + 1 : 1;
+  node->key = RollingHash(prev ? prev->key : 0, token);
+  node->prev = std::move(prev);
+  return node;
+}
+
+// Collect the field of all nodes that have the given flag, oldest first.
+template <typename T, typename F>
+std::vector<T> Collect(const HypothesisToken *node, uint8_t flag, F get) {
+  std::vector<T> ans;
+  for (; node; node = node->prev.get()) {
+    if (node->flags & flag) {
+      ans.push_back(get(*node));
+    }
+  }
+  std::reverse(ans.begin(), ans.end());
+  return ans;
+}
+
+}  // namespace
+
+HypothesisToken::~HypothesisToken() {
+  std::shared_ptr<HypothesisToken> p = std::move(prev);
+  while (p && p.use_count() == 1) {
+    // p is the only owner, so detaching its predecessor is safe
+    p = std::move(p->prev);
+  }
+}
+
+bool SameTokens(const HypothesisToken *a, const HypothesisToken *b) {
+  while (a != b) {
+    if (a == nullptr || b == nullptr || a->token != b->token ||
+        a->num_tokens != b->num_tokens) {
+      return false;
+    }
+
+    a = a->prev.get();
+    b = b->prev.get();
+  }
+
+  return true;
+}
+
+void Hypothesis::ResetTokens(const std::vector<int64_t> &ys) {
+  tail = nullptr;
+  for (auto i : ys) {
+    tail = NewToken(i, std::move(tail));
+  }
+}
+
+void Hypothesis::Append(int64_t token, int32_t timestamp) {
+  tail = NewToken(token, std::move(tail));
+  tail->timestamp = timestamp;
+  tail->flags = HypothesisToken::kHasTimestamp;
+}
+
+HypothesisToken *Hypothesis::MutableTail() {
+  if (tail.use_count() > 1) {
+    tail = std::make_shared<HypothesisToken>(*tail);
+  }
+  return tail.get();
+}
+
+void Hypothesis::SetLastYsProb(float ys_prob) {
+  auto node = MutableTail();
+  node->ys_prob = ys_prob;
+  node->flags |= HypothesisToken::kHasYsProb;
+}
+
+void Hypothesis::SetLastLmProb(float lm_prob) {
+  auto node = MutableTail();
+  node->lm_prob = lm_prob;
+  node->flags |= HypothesisToken::kHasLmProb;
+}
+
+void Hypothesis::SetLastContextScore(float context_score) {
+  auto node = MutableTail();
+  node->context_score = context_score;
+  node->flags |= HypothesisToken::kHasContextScore;
+}
+
+void Hypothesis::CopyLastTokens(int32_t n, int64_t *dst) const {
+  const HypothesisToken *node = tail.get();
+  for (int32_t i = n - 1; i >= 0; --i) {
+    dst[i] = node->token;
+    node = node->prev.get();
+  }
+}
+
+std::vector<int64_t> Hypothesis::LastTokens(int32_t n) const {
+  std::vector<int64_t> ans(n);
+  CopyLastTokens(n, ans.data());
+  return ans;
+}
+
+std::vector<int64_t> Hypothesis::Ys() const {
+  std::vector<int64_t> ans(NumTokens());
+  CopyLastTokens(NumTokens(), ans.data());
+  return ans;
+}
+
+std::vector<int32_t> Hypothesis::Timestamps() const {
+  return Collect<int32_t>(tail.get(), HypothesisToken::kHasTimestamp,
+                          [](const auto &n) { return n.timestamp; });
+}
+
+std::vector<float> Hypothesis::YsProbs() const {
+  return Collect<float>(tail.get(), HypothesisToken::kHasYsProb,
+                        [](const auto &n) { return n.ys_prob; });
+}
+
+std::vector<float> Hypothesis::LmProbs() const {
+  return Collect<float>(tail.get(), HypothesisToken::kHasLmProb,
+                        [](const auto &n) { return n.lm_prob; });
+}
+
+std::vector<float> Hypothesis::ContextScores() const {
+  return Collect<float>(tail.get(), HypothesisToken::kHasContextScore,
+                        [](const auto &n) { return n.context_score; });
+}
+
+std::string Hypothesis::ToString() const {
+  std::ostringstream os;
+  std::string sep;
+  os << "(";
+  for (auto i : Ys()) {
+    os << sep << i;
+    sep = "-";
+  }
+  os << ", " << log_prob << ")";
+  return os.str();
+}
+
 void Hypotheses::Add(Hypothesis hyp) {
-  auto key = hyp.Key();
-  auto it = hyps_dict_.find(key);
+  uint64_t key = 0;
+  auto it = Find(hyp, &key);
   if (it == hyps_dict_.end()) {
-    hyps_dict_[key] = std::move(hyp);
+    hyps_dict_.emplace(key, std::move(hyp));
   } else {
     it->second.log_prob = LogAdd<double>()(it->second.log_prob, hyp.log_prob);
   }
 }
 
+Hypotheses::Map::iterator Hypotheses::Find(const Hypothesis &hyp,
+                                           uint64_t *key) {
+  *key = hyp.Key();
+  while (true) {
+    auto it = hyps_dict_.find(*key);
+    if (it == hyps_dict_.end() ||
+        SameTokens(it->second.tail.get(), hyp.tail.get())) {
+      return it;
+    }
+
+    ++*key;
+  }
+}
+
 Hypothesis Hypotheses::GetMostProbable(bool length_norm) const {
   if (length_norm == false) {
     return std::max_element(hyps_dict_.begin(), hyps_dict_.end(),
@@ -33,8 +199,10 @@ Hypothesis Hypotheses::GetMostProbable(bool length_norm) const {
     return std::max_element(
                hyps_dict_.begin(), hyps_dict_.end(),
                [](const auto &left, const auto &right) -> bool {
-                 return left.second.TotalLogProb() / left.second.ys.size() <
-                        right.second.TotalLogProb() / right.second.ys.size();
+                 return left.second.TotalLogProb() /
+                            left.second.NumTokens() <
+                        right.second.TotalLogProb() /
+                            right.second.NumTokens();
                })
         ->second;
   }
@@ -55,8 +223,8 @@ std::vector<Hypothesis> Hypotheses::GetTopK(int32_t k, bool length_norm) const {
     // for length_norm is true
     std::partial_sort(all_hyps.begin(), all_hyps.begin() + k, all_hyps.end(),
                       [](const auto &a, const auto &b) {
-                        return a.TotalLogProb() / a.ys.size() >
-                               b.TotalLogProb() / b.ys.size();
+                        return a.TotalLogProb() / a.NumTokens() >
+                               b.TotalLogProb() / b.NumTokens();
                       });
   }
 
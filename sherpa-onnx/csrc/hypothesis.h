@@ -7,12 +7,13 @@
 #ifndef SHERPA_ONNX_CSRC_HYPOTHESIS_H_
 #define SHERPA_ONNX_CSRC_HYPOTHESIS_H_
 
+#include <cstdint>
+#include <memory>
 #include <sstream>
 #include <string>
 #include <unordered_map>
 #include <utility>
 #include <vector>
-#include <memory>
 
 #include "onnxruntime_cxx_api.h"  // NOLINT
 #include "sherpa-onnx/csrc/context-graph.h"
@@ -22,29 +23,66 @@
 
 namespace sherpa_onnx {
 
-struct Hypothesis {
-  // The predicted tokens so far. Newly predicated tokens are appended.
-  std::vector<int64_t> ys;
-
-  // timestamps[i] contains the frame number after subsampling
-  // on which ys[i] is decoded.
-  std::vector<int32_t> timestamps;
-
-  // The acoustic probability for each token in ys.
-  // Used for keyword spotting task.
-  // For transducer mofified beam-search and greedy-search,
-  // this is filled with log_posterior scores.
-  std::vector<float> ys_probs;
+// A decoded token together with its per-token scores.
+//
+// The tokens of a hypothesis are kept in a persistent singly linked list
+// that goes from the most recent token back to the first one. Hypotheses
+// expanded from the same parent share the nodes of their common prefix, so
+// extending a hypothesis by one token costs O(1) no matter how long
+// the utterance is.
+struct HypothesisToken {
+  enum Flags : uint8_t {
+    kHasTimestamp = 1,
+    kHasYsProb = 2,
+    kHasLmProb = 4,
+    kHasContextScore = 8,
+  };
+
+  int64_t token = 0;
+
+  // The frame number after subsampling on which this token is decoded.
+  // Valid only if flags contains kHasTimestamp. The leading blanks
+  // used as decoder context have no timestamp.
+  int32_t timestamp = 0;
+
+  float ys_prob = 0;
+  float lm_prob = 0;
+  float context_score = 0;
+
+  uint8_t flags = 0;
+
+  // Number of tokens in the list ending at this node, this node included.
+  int32_t num_tokens = 0;
+
+  // Rolling hash of all tokens in the list ending at this node.
+  uint64_t key = 0;
+
+  std::shared_ptr<HypothesisToken> prev;
+
+  HypothesisToken() = default;
+  HypothesisToken(const HypothesisToken &) = default;
+  HypothesisToken &operator=(const HypothesisToken &) = delete;
+
+  // Nodes are released iteratively. Otherwise dropping the last reference
+  // to a long history would recurse once per token.
+  ~HypothesisToken();
+};
 
-  // lm_probs[i] contains the lm score for each token in ys.
-  // Used only in transducer mofified beam-search.
-  // Elements filled only if LM is used.
-  std::vector<float> lm_probs;
+// Return true if the token lists ending at a and b are the same. Lists of
+// hypotheses with a common history share nodes, so the comparison usually
+// stops after a few tokens.
+bool SameTokens(const HypothesisToken *a, const HypothesisToken *b);
 
-  // context_scores[i] contains the context-graph score for each token in ys.
-  // Used only in transducer mofified beam-search.
-  // Elements filled only if `ContextGraph` is used.
-  std::vector<float> context_scores;
+struct Hypothesis {
+  // The predicted tokens so far. It points to the most recent token.
+  // Newly predicated tokens are appended with Append().
+  //
+  // Use Ys(), Timestamps(), YsProbs(), LmProbs() and ContextScores()
+  // to get the per-token values as vectors.
+  //
+  // Nodes may be shared with other hypotheses; never modify them
+  // through this pointer.
+  std::shared_ptr<HypothesisToken> tail;
 
   // The total score of ys in log space.
   // It contains only acoustic scores
@@ -66,7 +104,7 @@ struct Hypothesis {
   // the LODR states
   std::shared_ptr<LodrStateCost> lodr_state;
 
-  const ContextState *context_state;
+  const ContextState *context_state = nullptr;
 
   // TODO(fangjun): Make it configurable
   // the minimum of tokens in a chunk for streaming RNN LM
@@ -77,29 +115,53 @@ struct Hypothesis {
   Hypothesis() = default;
   Hypothesis(const std::vector<int64_t> &ys, double log_prob,
              const ContextState *context_state = nullptr)
-      : ys(ys), log_prob(log_prob), context_state(context_state) {}
+      : log_prob(log_prob), context_state(context_state) {
+    ResetTokens(ys);
+  }
 
   double TotalLogProb() const { return log_prob + lm_log_prob; }
 
-  // If two Hypotheses have the same `Key`, then they contain
-  // the same token sequence.
-  std::string Key() const {
-    // TODO(fangjun): Use a hash function?
-    std::ostringstream os;
-    std::string sep;
-    for (auto i : ys) {
-      os << sep << i;
-      sep = "-";
-    }
-    return os.str();
-  }
+  // Hash of the token sequence. Hypotheses with the same tokens have
+  // the same key. Different token sequences have the same key only on
+  // a hash collision, so use SameTokens() to tell them apart.
+  uint64_t Key() const { return tail ? tail->key : 0; }
+
+  // Number of tokens, including the leading blanks used as decoder context.
+  int32_t NumTokens() const { return tail ? tail->num_tokens : 0; }
+
+  int64_t LastToken() const { return tail->token; }
+
+  // Replace all tokens with the given ones. They have no timestamps
+  // or scores, e.g., the leading blanks used as decoder context.
+  void ResetTokens(const std::vector<int64_t> &ys);
+
+  // Append a decoded token.
+  void Append(int64_t token, int32_t timestamp);
+
+  // Set scores of the most recently appended token.
+  void SetLastYsProb(float ys_prob);
+  void SetLastLmProb(float lm_prob);
+  void SetLastContextScore(float context_score);
+
+  // Copy the last n tokens to dst, oldest first.
+  // It requires n <= NumTokens().
+  void CopyLastTokens(int32_t n, int64_t *dst) const;
+
+  std::vector<int64_t> LastTokens(int32_t n) const;
+
+  std::vector<int64_t> Ys() const;
+  std::vector<int32_t> Timestamps() const;
+  std::vector<float> YsProbs() const;
+  std::vector<float> LmProbs() const;
+  std::vector<float> ContextScores() const;
 
   // For debugging
-  std::string ToString() const {
-    std::ostringstream os;
-    os << "(" << Key() << ", " << log_prob << ")";
-    return os.str();
-  }
+  std::string ToString() const;
+
+ private:
+  // Return the tail node for modification. It is copied first if
+  // it is shared with other hypotheses.
+  HypothesisToken *MutableTail();
 };
 
 class Hypotheses {
@@ -108,11 +170,17 @@ class Hypotheses {
 
   explicit Hypotheses(std::vector<Hypothesis> hyps) {
     for (auto &h : hyps) {
-      hyps_dict_[h.Key()] = std::move(h);
+      uint64_t key = 0;
+      auto it = Find(h, &key);
+      if (it != hyps_dict_.end()) {
+        it->second = std::move(h);
+      } else {
+        hyps_dict_.emplace(key, std::move(h));
+      }
     }
   }
 
-  explicit Hypotheses(std::unordered_map<std::string, Hypothesis> hyps_dict)
+  explicit Hypotheses(std::unordered_map<uint64_t, Hypothesis> hyps_dict)
       : hyps_dict_(std::move(hyps_dict)) {}
 
   // Add hyp to this object. If it already exists, its log_prob
@@ -158,7 +226,17 @@ class Hypotheses {
   }
 
  private:
-  using Map = std ::unordered_map<std::string, Hypothesis>;
+  using Map = std::unordered_map<uint64_t, Hypothesis>;
+
+  // Return the hyp that has the same tokens as the given one. If there is
+  // none, return end() and set key to an unused key for it.
+  //
+  // A hyp whose key is used by a hyp with different tokens is stored
+  // under the next unused key. Hyps are never removed one by one, so
+  // the search can stop at the first unused key.
+  Map::iterator Find(const Hypothesis &hyp, uint64_t *key);
+
+ private:
   Map hyps_dict_;
 };
 
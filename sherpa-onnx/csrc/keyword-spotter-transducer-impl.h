@@ -131,56 +131,12 @@ class KeywordSpotterTransducerImpl : public KeywordSpotterImpl {
       return nullptr;
     }
 
-    int32_t num_kws = current_ids.size();
-    int32_t num_default_kws = keywords_id_.size();
-
-    current_ids.insert(current_ids.end(), keywords_id_.begin(),
-                       keywords_id_.end());
-
-    if (!current_kws.empty() && !keywords_.empty()) {
-      current_kws.insert(current_kws.end(), keywords_.begin(), keywords_.end());
-    } else if (!current_kws.empty() && keywords_.empty()) {
-      current_kws.insert(current_kws.end(), num_default_kws, std::string());
-    } else if (current_kws.empty() && !keywords_.empty()) {
-      current_kws.insert(current_kws.end(), num_kws, std::string());
-      current_kws.insert(current_kws.end(), keywords_.begin(), keywords_.end());
-    } else {
-      // Do nothing.
-    }
-
-    if (!current_scores.empty() && !boost_scores_.empty()) {
-      current_scores.insert(current_scores.end(), boost_scores_.begin(),
-                            boost_scores_.end());
-    } else if (!current_scores.empty() && boost_scores_.empty()) {
-      current_scores.insert(current_scores.end(), num_default_kws,
-                            config_.keywords_score);
-    } else if (current_scores.empty() && !boost_scores_.empty()) {
-      current_scores.insert(current_scores.end(), num_kws,
-                            config_.keywords_score);
-      current_scores.insert(current_scores.end(), boost_scores_.begin(),
-                            boost_scores_.end());
-    } else {
-      // Do nothing.
-    }
-
-    if (!current_thresholds.empty() && !thresholds_.empty()) {
-      current_thresholds.insert(current_thresholds.end(), thresholds_.begin(),
-                                thresholds_.end());
-    } else if (!current_thresholds.empty() && thresholds_.empty()) {
-      current_thresholds.insert(current_thresholds.end(), num_default_kws,
-                                config_.keywords_threshold);
-    } else if (current_thresholds.empty() && !thresholds_.empty()) {
-      current_thresholds.insert(current_thresholds.end(), num_kws,
-                                config_.keywords_threshold);
-      current_thresholds.insert(current_thresholds.end(), thresholds_.begin(),
-                                thresholds_.end());
-    } else {
-      // Do nothing.
-    }
-
+    // The keywords of this stream are added on top of the shared graph of
+    // the default keywords, which is not copied.
     auto keywords_graph = std::make_shared<ContextGraph>(
-        current_ids, config_.keywords_score, config_.keywords_threshold,
-        current_scores, current_kws, current_thresholds);
+        keywords_graph_, current_ids, config_.keywords_score,
+        config_.keywords_threshold, current_scores, current_kws,
+        current_thresholds);
 
     auto stream =
         std::make_unique<OnlineStream>(config_.feat_config, keywords_graph);
@@ -217,24 +173,19 @@ class KeywordSpotterTransducerImpl : public KeywordSpotterImpl {
 
     std::vector<TransducerKeywordResult> results(n);
     std::vector<float> features_vec(n * chunk_size * feature_dim);
-    std::vector<std::vector<Ort::Value>> states_vec(n);
     std::vector<int64_t> all_processed_frames(n);
 
     for (int32_t i = 0; i != n; ++i) {
       SHERPA_ONNX_CHECK(ss[i]->GetContextGraph() != nullptr);
 
       const auto num_processed_frames = ss[i]->GetNumProcessedFrames();
-      std::vector<float> features =
-          ss[i]->GetFrames(num_processed_frames, chunk_size);
+      ss[i]->GetFrames(num_processed_frames, chunk_size,
+                       features_vec.data() + i * chunk_size * feature_dim);
 
       // Question: should num_processed_frames include chunk_shift?
       ss[i]->GetNumProcessedFrames() += chunk_shift;
 
-      std::copy(features.begin(), features.end(),
-                features_vec.data() + i * chunk_size * feature_dim);
-
       results[i] = std::move(ss[i]->GetKeywordResult());
-      states_vec[i] = std::move(ss[i]->GetStates());
       all_processed_frames[i] = num_processed_frames;
     }
 
@@ -254,19 +205,17 @@ class KeywordSpotterTransducerImpl : public KeywordSpotterImpl {
         memory_info, all_processed_frames.data(), all_processed_frames.size(),
         processed_frames_shape.data(), processed_frames_shape.size());
 
-    auto states = model_->StackStates(states_vec);
+    auto states = model_->StackStreamStates(ss, n);
 
     auto pair = model_->RunEncoder(std::move(x), std::move(states),
                                    std::move(processed_frames));
 
     decoder_->Decode(std::move(pair.first), ss, &results);
 
-    std::vector<std::vector<Ort::Value>> next_states =
-        model_->UnStackStates(pair.second);
+    model_->UnStackStreamStates(std::move(pair.second), ss, n);
 
     for (int32_t i = 0; i != n; ++i) {
       ss[i]->SetKeywordResult(results[i]);
-      ss[i]->SetStates(std::move(next_states[i]));
     }
   }
 
@@ -282,14 +231,18 @@ class KeywordSpotterTransducerImpl : public KeywordSpotterImpl {
 
  private:
   void InitKeywords(std::istream &is) {
-    if (!EncodeKeywords(is, sym_, &keywords_id_, &keywords_, &boost_scores_,
-                        &thresholds_)) {
+    std::vector<std::vector<int32_t>> keywords_id;
+    std::vector<std::string> keywords;
+    std::vector<float> boost_scores;
+    std::vector<float> thresholds;
+    if (!EncodeKeywords(is, sym_, &keywords_id, &keywords, &boost_scores,
+                        &thresholds)) {
       SHERPA_ONNX_LOGE("Encode keywords failed.");
       exit(-1);
     }
     keywords_graph_ = std::make_shared<ContextGraph>(
-        keywords_id_, config_.keywords_score, config_.keywords_threshold,
-        boost_scores_, keywords_, thresholds_);
+        keywords_id, config_.keywords_score, config_.keywords_threshold,
+        boost_scores, keywords, thresholds);
   }
 
   void InitKeywords() {
@@ -300,6 +253,22 @@ class KeywordSpotterTransducerImpl : public KeywordSpotterImpl {
     std::istringstream is(config_.keywords_file);
     InitKeywords(is);
 #else
+    if (ContextGraph::IsCompiledGraph(config_.keywords_file)) {
+      // It is saved by ContextGraph::Save()
+      keywords_graph_ = ContextGraph::Load(config_.keywords_file);
+      if (!keywords_graph_) {
+#if __OHOS__
+        SHERPA_ONNX_LOGE("Failed to load keywords graph: '%{public}s'",
+                         config_.keywords_file.c_str());
+#else
+        SHERPA_ONNX_LOGE("Failed to load keywords graph: '%s'",
+                         config_.keywords_file.c_str());
+#endif
+        exit(-1);
+      }
+      return;
+    }
+
     // each line in keywords_file contains space-separated words
     std::ifstream is(config_.keywords_file);
     if (!is) {
@@ -356,10 +325,6 @@ class KeywordSpotterTransducerImpl : public KeywordSpotterImpl {
 
  private:
   KeywordSpotterConfig config_;
-  std::vector<std::vector<int32_t>> keywords_id_;
-  std::vector<float> boost_scores_;
-  std::vector<float> thresholds_;
-  std::vector<std::string> keywords_;
   ContextGraphPtr keywords_graph_;
   std::unique_ptr<OnlineTransducerModel> model_;
   std::unique_ptr<TransducerKeywordDecoder> decoder_;
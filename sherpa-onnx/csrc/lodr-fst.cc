@@ -116,8 +116,9 @@ void LodrFst::ComputeScore(float scale, Hypothesis *hyp, int32_t offset) {
   hyp->lodr_state = std::make_unique<LodrStateCost>(this);
 
   // Walk through the FST with the input text from the hypothesis
-  for (size_t i = offset; i < hyp->ys.size(); ++i) {
-    *hyp->lodr_state = hyp->lodr_state->ForwardOneStep(hyp->ys[i]);
+  auto ys = hyp->Ys();
+  for (size_t i = offset; i < ys.size(); ++i) {
+    *hyp->lodr_state = hyp->lodr_state->ForwardOneStep(ys[i]);
   }
 
   float lodr_score = hyp->lodr_state->FinalScore();
@@ -0,0 +1,60 @@
+// sherpa-onnx/csrc/math-test.cc
+//
+// Copyright (c)  2025  Xiaomi Corporation
+
+#include "sherpa-onnx/csrc/math.h"
+
+#include <random>
+#include <vector>
+
+#include "gtest/gtest.h"
+
+namespace sherpa_onnx {
+
+TEST(LogSoftmaxTopk, CompareWithReference) {
+  std::mt19937 gen(20250101);
+  std::uniform_real_distribution<float> dist(-10, 10);
+
+  int32_t w = 500;
+  int32_t h = 4;
+  int32_t topk = 4;
+
+  std::vector<float> in(w * h);
+  for (auto &f : in) {
+    f = dist(gen);
+  }
+  std::vector<float> row_scores = {-1.5, -0.5, -3, -2};
+
+  std::vector<float> scores;
+  auto ans = LogSoftmaxTopk(in.data(), w, h, row_scores.data(), topk, &scores);
+
+  std::vector<float> expected_scores = in;
+  LogSoftmax(expected_scores.data(), w, h);
+  for (int32_t r = 0; r != h; ++r) {
+    for (int32_t i = 0; i != w; ++i) {
+      expected_scores[r * w + i] += row_scores[r];
+    }
+  }
+  auto expected = TopkIndex(expected_scores.data(), w * h, topk);
+
+  ASSERT_EQ(ans.size(), expected.size());
+  ASSERT_EQ(scores.size(), expected.size());
+  for (int32_t i = 0; i != topk; ++i) {
+    EXPECT_EQ(ans[i], expected[i]);
+    EXPECT_NEAR(scores[i], expected_scores[expected[i]], 1e-5);
+  }
+}
+
+TEST(LogSoftmaxTopk, TopkLargerThanInput) {
+  std::vector<float> in = {1, 3, 2};
+  auto ans = LogSoftmaxTopk<float>(in.data(), 3, 1, nullptr, 5);
+  EXPECT_EQ(ans, (std::vector<int32_t>{1, 2, 0}));
+}
+
+TEST(LogSumExp, Scale) {
+  std::vector<float> in = {1, 2, 3};
+  float expected = std::log(std::exp(0.5f) + std::exp(1.0f) + std::exp(1.5f));
+  EXPECT_NEAR(LogSumExp(in.data(), 3, 0.5f), expected, 1e-6);
+}
+
+}  // namespace sherpa_onnx
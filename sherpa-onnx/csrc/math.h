@@ -11,6 +11,7 @@
 #include <cassert>
 #include <cmath>
 #include <numeric>
+#include <utility>
 #include <vector>
 
 namespace sherpa_onnx {
@@ -119,6 +120,88 @@ std::vector<int32_t> TopkIndex(const T *vec, int32_t size, int32_t topk) {
   return {vec_index.begin(), vec_index.begin() + k_num};
 }
 
+// Return log(sum(exp(scale * in[i]))). scale must be positive.
+//
+// The loops are kept simple so that compilers can vectorize them.
+template <typename T>
+T LogSumExp(const T *in, int32_t n, T scale = 1) {
+  T m = *std::max_element(in, in + n) * scale;
+
+  T sum = 0;
+  for (int32_t i = 0; i < n; ++i) {
+    sum += std::exp(in[i] * scale - m);
+  }
+
+  return m + std::log(sum);
+}
+
+// It is equivalent to the following, but it neither modifies `in` nor
+// allocates a temporary array of size w * h:
+//
+//   LogSoftmax(in, w, h);
+//   for each row i: in[i][:] += row_scores[i];
+//   return TopkIndex(in, w * h, topk);
+//
+// Each row is visited twice: once to compute its log-normalizer and once
+// to update a min-heap of the best topk items.
+//
+// @param in  A 2-D array of shape (h, w)
+// @param row_scores  Pointer to an array of size h. If it is nullptr, 0 is
+//                    used for all rows.
+// @param topk_scores  If not nullptr, on return it contains the scores of the
+//                     returned indexes, i.e., log_softmax + row_score
+// @return Return indexes into `in` of the topk items, sorted by score in
+//         descending order.
+template <typename T>
+std::vector<int32_t> LogSoftmaxTopk(const T *in, int32_t w, int32_t h,
+                                    const T *row_scores, int32_t topk,
+                                    std::vector<T> *topk_scores = nullptr) {
+  topk = std::min<int32_t>(topk, w * h);
+
+  using Item = std::pair<T, int32_t>;
+  // Min-heap on score. For equal scores, the larger index is on top so that
+  // smaller indexes are preferred.
+  auto cmp = [](const Item &a, const Item &b) {
+    return a.first > b.first || (a.first == b.first && a.second < b.second);
+  };
+
+  std::vector<Item> heap;
+  heap.reserve(topk);
+
+  for (int32_t r = 0; r != h && topk > 0; ++r) {
+    const T *p = in + r * w;
+    T offset = (row_scores ? row_scores[r] : 0) - LogSumExp(p, w);
+
+    for (int32_t i = 0; i != w; ++i) {
+      T score = p[i] + offset;
+      if (static_cast<int32_t>(heap.size()) < topk) {
+        heap.emplace_back(score, r * w + i);
+        std::push_heap(heap.begin(), heap.end(), cmp);
+      } else if (score > heap.front().first) {
+        std::pop_heap(heap.begin(), heap.end(), cmp);
+        heap.back() = {score, r * w + i};
+        std::push_heap(heap.begin(), heap.end(), cmp);
+      }
+    }
+  }
+
+  std::sort_heap(heap.begin(), heap.end(), cmp);
+
+  std::vector<int32_t> ans(heap.size());
+  if (topk_scores) {
+    topk_scores->resize(heap.size());
+  }
+
+  for (int32_t i = 0; i != static_cast<int32_t>(heap.size()); ++i) {
+    ans[i] = heap[i].second;
+    if (topk_scores) {
+      (*topk_scores)[i] = heap[i].first;
+    }
+  }
+
+  return ans;
+}
+
 template <class T>
 std::vector<int32_t> TopkIndex(const std::vector<std::vector<T>> &vec,
                                int32_t topk) {
@@ -25,6 +25,7 @@
 #include "sherpa-onnx/csrc/file-utils.h"
 #include "sherpa-onnx/csrc/macros.h"
 #include "sherpa-onnx/csrc/onnx-utils.h"
+#include "sherpa-onnx/csrc/session-registry.h"
 #include "sherpa-onnx/csrc/session.h"
 #include "sherpa-onnx/csrc/text-utils.h"
 
@@ -35,7 +36,7 @@ class OfflineCanaryModel::Impl {
   explicit Impl(const OfflineModelConfig &config)
       : config_(config),
         env_(ORT_LOGGING_LEVEL_ERROR),
-        sess_opts_(GetSessionOptions(config)),
+        sess_opts_(GetSessionOptionsWithKey(config)),
         allocator_{} {
     {
       auto buf = ReadFile(config.canary.encoder);
@@ -52,7 +53,7 @@ class OfflineCanaryModel::Impl {
   Impl(Manager *mgr, const OfflineModelConfig &config)
       : config_(config),
         env_(ORT_LOGGING_LEVEL_ERROR),
-        sess_opts_(GetSessionOptions(config)),
+        sess_opts_(GetSessionOptionsWithKey(config)),
         allocator_{} {
     {
       auto buf = ReadFile(mgr, config.canary.encoder);
@@ -137,8 +138,8 @@ class OfflineCanaryModel::Impl {
 
  private:
   void InitEncoder(void *model_data, size_t model_data_length) {
-    encoder_sess_ = std::make_unique<Ort::Session>(
-        env_, model_data, model_data_length, sess_opts_);
+    encoder_sess_ = GetOrCreateSession(env_, model_data, model_data_length,
+                                       sess_opts_);
 
     GetInputNames(encoder_sess_.get(), &encoder_input_names_,
                   &encoder_input_names_ptr_);
@@ -179,8 +180,8 @@ class OfflineCanaryModel::Impl {
   }
 
   void InitDecoder(void *model_data, size_t model_data_length) {
-    decoder_sess_ = std::make_unique<Ort::Session>(
-        env_, model_data, model_data_length, sess_opts_);
+    decoder_sess_ = GetOrCreateSession(env_, model_data, model_data_length,
+                                       sess_opts_);
 
     GetInputNames(decoder_sess_.get(), &decoder_input_names_,
                   &decoder_input_names_ptr_);
@@ -193,11 +194,11 @@ class OfflineCanaryModel::Impl {
   OfflineCanaryModelMetaData meta_;
   OfflineModelConfig config_;
   Ort::Env env_;
-  Ort::SessionOptions sess_opts_;
+  SessionOptionsWithKey sess_opts_;
   Ort::AllocatorWithDefaultOptions allocator_;
 
-  std::unique_ptr<Ort::Session> encoder_sess_;
-  std::unique_ptr<Ort::Session> decoder_sess_;
+  std::shared_ptr<Ort::Session> encoder_sess_;
+  std::shared_ptr<Ort::Session> decoder_sess_;
 
   std::vector<std::string> encoder_input_names_;
   std::vector<const char *> encoder_input_names_ptr_;
@@ -9,6 +9,7 @@
 
 #include "sherpa-onnx/csrc/file-utils.h"
 #include "sherpa-onnx/csrc/onnx-utils.h"
+#include "sherpa-onnx/csrc/session-registry.h"
 #include "sherpa-onnx/csrc/session.h"
 #include "sherpa-onnx/csrc/text-utils.h"
 #include "sherpa-onnx/csrc/transpose.h"
@@ -20,7 +21,7 @@ class OfflineCEDModel::Impl {
   explicit Impl(const AudioTaggingModelConfig &config)
       : config_(config),
         env_(ORT_LOGGING_LEVEL_ERROR),
-        sess_opts_(GetSessionOptions(config)),
+        sess_opts_(GetSessionOptionsWithKey(config)),
         allocator_{} {
     auto buf = ReadFile(config_.ced);
     Init(buf.data(), buf.size());
@@ -30,7 +31,7 @@ class OfflineCEDModel::Impl {
   Impl(AAssetManager *mgr, const AudioTaggingModelConfig &config)
       : config_(config),
         env_(ORT_LOGGING_LEVEL_ERROR),
-        sess_opts_(GetSessionOptions(config)),
+        sess_opts_(GetSessionOptionsWithKey(config)),
         allocator_{} {
     auto buf = ReadFile(mgr, config_.ced);
     Init(buf.data(), buf.size());
@@ -51,8 +52,7 @@ class OfflineCEDModel::Impl {
 
  private:
   void Init(void *model_data, size_t model_data_length) {
-    sess_ = std::make_unique<Ort::Session>(env_, model_data, model_data_length,
-                                           sess_opts_);
+    sess_ = GetOrCreateSession(env_, model_data, model_data_length, sess_opts_);
 
     GetInputNames(sess_.get(), &input_names_, &input_names_ptr_);
 
@@ -75,10 +75,10 @@ class OfflineCEDModel::Impl {
  private:
   AudioTaggingModelConfig config_;
   Ort::Env env_;
-  Ort::SessionOptions sess_opts_;
+  SessionOptionsWithKey sess_opts_;
   Ort::AllocatorWithDefaultOptions allocator_;
 
-  std::unique_ptr<Ort::Session> sess_;
+  std::shared_ptr<Ort::Session> sess_;
 
   std::vector<std::string> input_names_;
   std::vector<const char *> input_names_ptr_;
@@ -9,6 +9,7 @@
 
 #include "sherpa-onnx/csrc/file-utils.h"
 #include "sherpa-onnx/csrc/onnx-utils.h"
+#include "sherpa-onnx/csrc/session-registry.h"
 #include "sherpa-onnx/csrc/session.h"
 #include "sherpa-onnx/csrc/text-utils.h"
 
@@ -19,7 +20,7 @@ class OfflineCtTransformerModel::Impl {
   explicit Impl(const OfflinePunctuationModelConfig &config)
       : config_(config),
         env_(ORT_LOGGING_LEVEL_ERROR),
-        sess_opts_(GetSessionOptions(config)),
+        sess_opts_(GetSessionOptionsWithKey(config)),
         allocator_{} {
     auto buf = ReadFile(config_.ct_transformer);
     Init(buf.data(), buf.size());
@@ -29,7 +30,7 @@ class OfflineCtTransformerModel::Impl {
   Impl(AAssetManager *mgr, const OfflinePunctuationModelConfig &config)
       : config_(config),
         env_(ORT_LOGGING_LEVEL_ERROR),
-        sess_opts_(GetSessionOptions(config)),
+        sess_opts_(GetSessionOptionsWithKey(config)),
         allocator_{} {
     auto buf = ReadFile(mgr, config_.ct_transformer);
     Init(buf.data(), buf.size());
@@ -53,8 +54,7 @@ class OfflineCtTransformerModel::Impl {
 
  private:
   void Init(void *model_data, size_t model_data_length) {
-    sess_ = std::make_unique<Ort::Session>(env_, model_data, model_data_length,
-                                           sess_opts_);
+    sess_ = GetOrCreateSession(env_, model_data, model_data_length, sess_opts_);
 
     GetInputNames(sess_.get(), &input_names_, &input_names_ptr_);
 
@@ -122,10 +122,10 @@ class OfflineCtTransformerModel::Impl {
  private:
   OfflinePunctuationModelConfig config_;
   Ort::Env env_;
-  Ort::SessionOptions sess_opts_;
+  SessionOptionsWithKey sess_opts_;
   Ort::AllocatorWithDefaultOptions allocator_;
 
-  std::unique_ptr<Ort::Session> sess_;
+  std::shared_ptr<Ort::Session> sess_;
 
   std::vector<std::string> input_names_;
   std::vector<const char *> input_names_ptr_;
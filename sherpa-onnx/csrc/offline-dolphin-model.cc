@@ -20,6 +20,7 @@
 #include "sherpa-onnx/csrc/file-utils.h"
 #include "sherpa-onnx/csrc/macros.h"
 #include "sherpa-onnx/csrc/onnx-utils.h"
+#include "sherpa-onnx/csrc/session-registry.h"
 #include "sherpa-onnx/csrc/session.h"
 #include "sherpa-onnx/csrc/text-utils.h"
 
@@ -30,7 +31,7 @@ class OfflineDolphinModel::Impl {
   explicit Impl(const OfflineModelConfig &config)
       : config_(config),
         env_(ORT_LOGGING_LEVEL_ERROR),
-        sess_opts_(GetSessionOptions(config)),
+        sess_opts_(GetSessionOptionsWithKey(config)),
         allocator_{} {
     auto buf = ReadFile(config_.dolphin.model);
     Init(buf.data(), buf.size());
@@ -40,7 +41,7 @@ class OfflineDolphinModel::Impl {
   Impl(Manager *mgr, const OfflineModelConfig &config)
       : config_(config),
         env_(ORT_LOGGING_LEVEL_ERROR),
-        sess_opts_(GetSessionOptions(config)),
+        sess_opts_(GetSessionOptionsWithKey(config)),
         allocator_{} {
     auto buf = ReadFile(mgr, config_.dolphin.model);
     Init(buf.data(), buf.size());
@@ -79,8 +80,7 @@ class OfflineDolphinModel::Impl {
 
  private:
   void Init(void *model_data, size_t model_data_length) {
-    sess_ = std::make_unique<Ort::Session>(env_, model_data, model_data_length,
-                                           sess_opts_);
+    sess_ = GetOrCreateSession(env_, model_data, model_data_length, sess_opts_);
 
     GetInputNames(sess_.get(), &input_names_, &input_names_ptr_);
 
@@ -108,10 +108,10 @@ class OfflineDolphinModel::Impl {
  private:
   OfflineModelConfig config_;
   Ort::Env env_;
-  Ort::SessionOptions sess_opts_;
+  SessionOptionsWithKey sess_opts_;
   Ort::AllocatorWithDefaultOptions allocator_;
 
-  std::unique_ptr<Ort::Session> sess_;
+  std::shared_ptr<Ort::Session> sess_;
 
   std::vector<std::string> input_names_;
   std::vector<const char *> input_names_ptr_;
@@ -5,45 +5,32 @@
 #include "sherpa-onnx/csrc/offline-fire-red-asr-greedy-search-decoder.h"
 
 #include <algorithm>
+#include <numeric>
 #include <tuple>
 #include <utility>
 
+#include "sherpa-onnx/csrc/gather.h"
 #include "sherpa-onnx/csrc/macros.h"
 #include "sherpa-onnx/csrc/onnx-utils.h"
 
 namespace sherpa_onnx {
 
-// Note: this functions works only for batch size == 1 at present
 std::vector<OfflineFireRedAsrDecoderResult>
-OfflineFireRedAsrGreedySearchDecoder::Decode(Ort::Value cross_k,
-                                             Ort::Value cross_v,
-                                             int32_t num_feature_frames) {
+OfflineFireRedAsrGreedySearchDecoder::Decode(
+    Ort::Value cross_k, Ort::Value cross_v,
+    const std::vector<int32_t> &num_feature_frames) {
   const auto &meta_data = model_->GetModelMetadata();
 
-  auto memory_info =
-      Ort::MemoryInfo::CreateCpu(OrtDeviceAllocator, OrtMemTypeDefault);
-
-  // For multilingual models, initial_tokens contains [sot, language, task]
-  //   - language is English by default
-  //   - task is transcribe by default
-  //
-  // For non-multilingual models, initial_tokens contains [sot]
-  std::array<int64_t, 2> token_shape = {1, 1};
-  int64_t token = meta_data.sos_id;
-
-  int32_t batch_size = 1;
-
-  Ort::Value tokens = Ort::Value::CreateTensor(
-      memory_info, &token, 1, token_shape.data(), token_shape.size());
+  int32_t batch_size = static_cast<int32_t>(num_feature_frames.size());
 
   std::array<int64_t, 1> offset_shape{1};
   Ort::Value offset = Ort::Value::CreateTensor<int64_t>(
       model_->Allocator(), offset_shape.data(), offset_shape.size());
   *(offset.GetTensorMutableData<int64_t>()) = 0;
 
-  std::vector<OfflineFireRedAsrDecoderResult> ans(1);
+  std::vector<OfflineFireRedAsrDecoderResult> ans(batch_size);
 
-  auto self_kv_cache = model_->GetInitialSelfKVCache();
+  auto self_kv_cache = model_->GetInitialSelfKVCache(batch_size);
 
   std::tuple<Ort::Value, Ort::Value, Ort::Value, Ort::Value, Ort::Value,
              Ort::Value>
@@ -54,13 +41,35 @@ OfflineFireRedAsrGreedySearchDecoder::Decode(Ort::Value cross_k,
                      std::move(cross_v),
                      std::move(offset)};
 
-  // assume at most 6 tokens per second
-  int32_t num_possible_tokens = num_feature_frames / 100.0 * 6;
-  num_possible_tokens =
-      std::min<int32_t>(num_possible_tokens, meta_data.max_len / 2);
+  // active[i] is the index into ans of the i-th row of the current batch.
+  // Utterances that have finished are removed from the batch.
+  std::vector<int32_t> active(batch_size);
+  std::iota(active.begin(), active.end(), 0);
+
+  std::vector<int32_t> num_possible_tokens(batch_size);
+  int32_t max_num_possible_tokens = 0;
+  for (int32_t i = 0; i != batch_size; ++i) {
+    // assume at most 6 tokens per second
+    num_possible_tokens[i] = std::min<int32_t>(
+        num_feature_frames[i] / 100.0 * 6, meta_data.max_len / 2);
+
+    max_num_possible_tokens =
+        std::max(max_num_possible_tokens, num_possible_tokens[i]);
+  }
+
+  std::vector<int64_t> tokens(batch_size, meta_data.sos_id);
+
+  for (int32_t step = 0; step < max_num_possible_tokens; ++step) {
+    int32_t num_active = static_cast<int32_t>(active.size());
+
+    std::array<int64_t, 2> token_shape = {num_active, 1};
+
+    Ort::Value tokens_tensor = Ort::Value::CreateTensor<int64_t>(
+        model_->Allocator(), token_shape.data(), token_shape.size());
+    std::copy(tokens.begin(), tokens.begin() + num_active,
+              tokens_tensor.GetTensorMutableData<int64_t>());
 
-  for (int32_t i = 0; i < num_possible_tokens; ++i) {
-    decoder_out = model_->ForwardDecoder(View(&tokens),
+    decoder_out = model_->ForwardDecoder(std::move(tokens_tensor),
                                          std::move(std::get<1>(decoder_out)),
                                          std::move(std::get<2>(decoder_out)),
                                          std::move(std::get<3>(decoder_out)),
@@ -73,15 +82,54 @@ OfflineFireRedAsrGreedySearchDecoder::Decode(Ort::Value cross_k,
     auto logits_shape = logits.GetTensorTypeAndShapeInfo().GetShape();
     int32_t vocab_size = logits_shape[2];
 
-    int32_t max_token_id = static_cast<int32_t>(std::distance(
-        p_logits, std::max_element(p_logits, p_logits + vocab_size)));
-    if (max_token_id == meta_data.eos_id) {
-      break;
+    // rows of the current batch that continue to the next step
+    std::vector<int32_t> keep;
+    keep.reserve(num_active);
+
+    for (int32_t i = 0; i != num_active; ++i, p_logits += vocab_size) {
+      int32_t b = active[i];
+      if (static_cast<int32_t>(ans[b].tokens.size()) >=
+          num_possible_tokens[b]) {
+        continue;
+      }
+
+      int32_t max_token_id = static_cast<int32_t>(std::distance(
+          p_logits, std::max_element(p_logits, p_logits + vocab_size)));
+      if (max_token_id == meta_data.eos_id) {
+        continue;
+      }
+
+      ans[b].tokens.push_back(max_token_id);
+
+      if (static_cast<int32_t>(ans[b].tokens.size()) >=
+          num_possible_tokens[b]) {
+        continue;
+      }
+
+      tokens[keep.size()] = max_token_id;
+      keep.push_back(i);
     }
 
-    ans[0].tokens.push_back(max_token_id);
+    if (keep.empty()) {
+      break;
+    }
 
-    token = max_token_id;
+    if (static_cast<int32_t>(keep.size()) != num_active) {
+      // Remove finished utterances from the batch. The self kv cache has
+      // shape (num_decoder_layers, N, max_len, num_head, head_dim) and
+      // cross_k/cross_v have shape (num_decoder_layers, N, T, d_model).
+      for (auto *v : {&std::get<1>(decoder_out), &std::get<2>(decoder_out),
+                      &std::get<3>(decoder_out), &std::get<4>(decoder_out)}) {
+        std::vector<const Ort::Value *> values(keep.size(), v);
+        *v = Gather(model_->Allocator(), values, keep, 1);
+      }
+
+      std::vector<int32_t> next_active(keep.size());
+      for (int32_t i = 0; i != static_cast<int32_t>(keep.size()); ++i) {
+        next_active[i] = active[keep[i]];
+      }
+      active = std::move(next_active);
+    }
 
     // increment offset
     *(std::get<5>(decoder_out).GetTensorMutableData<int64_t>()) += 1;
@@ -44,7 +44,7 @@ void OfflineLM::ComputeLMScore(float scale, int32_t context_size,
     num_hyps += h.Size();
     for (const auto &t : h) {
       max_token_seq =
-          std::max<int32_t>(max_token_seq, t.second.ys.size() - context_size);
+          std::max<int32_t>(max_token_seq, t.second.NumTokens() - context_size);
     }
   }
 
@@ -64,9 +64,8 @@ void OfflineLM::ComputeLMScore(float scale, int32_t context_size,
 
   for (const auto &h : *hyps) {
     for (const auto &t : h) {
-      const auto &ys = t.second.ys;
-      int32_t len = ys.size() - context_size;
-      std::copy(ys.begin() + context_size, ys.end(), p);
+      int32_t len = t.second.NumTokens() - context_size;
+      t.second.CopyLastTokens(len, p);
       *p_lens = len;
 
       p += max_token_seq;
@@ -23,10 +23,14 @@ class OfflineMoonshineDecoder {
   /** Run beam search given the output from the moonshine encoder model.
    *
    * @param encoder_out A 3-D tensor of shape (batch_size, T, dim)
+   * @param num_encoder_frames A vector of size `batch_size` containing
+   *                           the number of valid frames of each utterance
+   *                           in encoder_out.
    * @return Return a vector of size `N` containing the decoded results.
    */
   virtual std::vector<OfflineMoonshineDecoderResult> Decode(
-      Ort::Value encoder_out) = 0;
+      Ort::Value encoder_out,
+      const std::vector<int32_t> &num_encoder_frames) = 0;
 };
 
 }  // namespace sherpa_onnx
@@ -5,44 +5,60 @@
 #include "sherpa-onnx/csrc/offline-moonshine-greedy-search-decoder.h"
 
 #include <algorithm>
+#include <numeric>
 #include <utility>
 
+#include "sherpa-onnx/csrc/gather.h"
 #include "sherpa-onnx/csrc/macros.h"
 #include "sherpa-onnx/csrc/onnx-utils.h"
 
 namespace sherpa_onnx {
 
 std::vector<OfflineMoonshineDecoderResult>
-OfflineMoonshineGreedySearchDecoder::Decode(Ort::Value encoder_out) {
+OfflineMoonshineGreedySearchDecoder::Decode(
+    Ort::Value encoder_out, const std::vector<int32_t> &num_encoder_frames) {
+  int32_t batch_size = static_cast<int32_t>(num_encoder_frames.size());
+
   auto encoder_out_shape = encoder_out.GetTensorTypeAndShapeInfo().GetShape();
-  if (encoder_out_shape[0] != 1) {
-    SHERPA_ONNX_LOGE("Support only batch size == 1. Given: %d\n",
-                     static_cast<int32_t>(encoder_out_shape[0]));
+  if (encoder_out_shape[0] != batch_size) {
+    SHERPA_ONNX_LOGE("Batch size mismatch: %d vs %d\n",
+                     static_cast<int32_t>(encoder_out_shape[0]), batch_size);
     return {};
   }
 
   auto memory_info =
       Ort::MemoryInfo::CreateCpu(OrtDeviceAllocator, OrtMemTypeDefault);
 
-  // encoder_out_shape[1] * 384 is the number of audio samples
+  // num_encoder_frames[i] * 384 is the number of audio samples
   // 16000 is the sample rate
   //
   //
   // 384 is from the moonshine paper
-  int32_t max_len =
-      static_cast<int32_t>(encoder_out_shape[1] * 384 / 16000.0 * 6);
+  std::vector<int32_t> max_len(batch_size);
+  for (int32_t i = 0; i != batch_size; ++i) {
+    max_len[i] =
+        static_cast<int32_t>(num_encoder_frames[i] * 384 / 16000.0 * 6);
+  }
 
   int32_t sos = 1;
   int32_t eos = 2;
   int32_t seq_len = 1;
 
-  std::vector<int32_t> tokens;
+  std::vector<OfflineMoonshineDecoderResult> ans(batch_size);
+
+  // active[i] is the index into ans of the i-th row of the current batch.
+  // Utterances that have finished are removed from the batch.
+  std::vector<int32_t> active(batch_size);
+  std::iota(active.begin(), active.end(), 0);
+
+  std::vector<int32_t> tokens(batch_size, sos);
 
-  std::array<int64_t, 2> token_shape = {1, 1};
+  std::array<int64_t, 2> token_shape = {batch_size, 1};
   int64_t seq_len_shape = 1;
 
   Ort::Value token_tensor = Ort::Value::CreateTensor(
-      memory_info, &sos, 1, token_shape.data(), token_shape.size());
+      memory_info, tokens.data(), tokens.size(), token_shape.data(),
+      token_shape.size());
 
   Ort::Value seq_len_tensor =
       Ort::Value::CreateTensor(memory_info, &seq_len, 1, &seq_len_shape, 1);
@@ -55,20 +71,61 @@ OfflineMoonshineGreedySearchDecoder::Decode(Ort::Value encoder_out) {
 
   int32_t vocab_size = logits.GetTensorTypeAndShapeInfo().GetShape()[2];
 
-  for (int32_t i = 0; i != max_len; ++i) {
+  while (true) {
+    int32_t num_active = static_cast<int32_t>(active.size());
     const float *p = logits.GetTensorData<float>();
 
-    int32_t max_token_id = static_cast<int32_t>(
-        std::distance(p, std::max_element(p, p + vocab_size)));
-    if (max_token_id == eos) {
+    // rows of the current batch that continue to the next step
+    std::vector<int32_t> keep;
+    keep.reserve(num_active);
+
+    for (int32_t i = 0; i != num_active; ++i, p += vocab_size) {
+      int32_t b = active[i];
+      if (static_cast<int32_t>(ans[b].tokens.size()) >= max_len[b]) {
+        continue;
+      }
+
+      int32_t max_token_id = static_cast<int32_t>(
+          std::distance(p, std::max_element(p, p + vocab_size)));
+      if (max_token_id == eos) {
+        continue;
+      }
+
+      ans[b].tokens.push_back(max_token_id);
+
+      tokens[keep.size()] = max_token_id;
+      keep.push_back(i);
+    }
+
+    if (keep.empty()) {
       break;
     }
-    tokens.push_back(max_token_id);
+
+    if (static_cast<int32_t>(keep.size()) != num_active) {
+      // Remove finished utterances from the batch. encoder_out and all
+      // decoder states have the batch size as their first dimension.
+      std::vector<const Ort::Value *> values(keep.size(), &encoder_out);
+      encoder_out = Gather(model_->Allocator(), values, keep, 0);
+
+      for (auto &s : states) {
+        values.assign(keep.size(), &s);
+        s = Gather(model_->Allocator(), values, keep, 0);
+      }
+
+      std::vector<int32_t> next_active(keep.size());
+      for (int32_t i = 0; i != static_cast<int32_t>(keep.size()); ++i) {
+        next_active[i] = active[keep[i]];
+      }
+      active = std::move(next_active);
+    }
 
     seq_len += 1;
 
-    token_tensor = Ort::Value::CreateTensor(
-        memory_info, &tokens.back(), 1, token_shape.data(), token_shape.size());
+    token_shape[0] = static_cast<int64_t>(active.size());
+
+    token_tensor = Ort::Value::CreateTensor(memory_info, tokens.data(),
+                                            active.size(), token_shape.data(),
+                                            token_shape.size());
 
     seq_len_tensor =
         Ort::Value::CreateTensor(memory_info, &seq_len, 1, &seq_len_shape, 1);
@@ -84,10 +141,7 @@ OfflineMoonshineGreedySearchDecoder::Decode(Ort::Value encoder_out) {
         std::move(tmp_states));
   }
 
-  OfflineMoonshineDecoderResult ans;
-  ans.tokens = std::move(tokens);
-
-  return {ans};
+  return ans;
 }
 
 }  // namespace sherpa_onnx
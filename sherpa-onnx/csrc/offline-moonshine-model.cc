@@ -20,6 +20,7 @@
 #include "sherpa-onnx/csrc/file-utils.h"
 #include "sherpa-onnx/csrc/macros.h"
 #include "sherpa-onnx/csrc/onnx-utils.h"
+#include "sherpa-onnx/csrc/session-registry.h"
 #include "sherpa-onnx/csrc/session.h"
 #include "sherpa-onnx/csrc/text-utils.h"
 
@@ -30,7 +31,7 @@ class OfflineMoonshineModel::Impl {
   explicit Impl(const OfflineModelConfig &config)
       : config_(config),
         env_(ORT_LOGGING_LEVEL_ERROR),
-        sess_opts_(GetSessionOptions(config)),
+        sess_opts_(GetSessionOptionsWithKey(config)),
         allocator_{} {
     {
       auto buf = ReadFile(config.moonshine.preprocessor);
@@ -57,7 +58,7 @@ class OfflineMoonshineModel::Impl {
   Impl(Manager *mgr, const OfflineModelConfig &config)
       : config_(config),
         env_(ORT_LOGGING_LEVEL_ERROR),
-        sess_opts_(GetSessionOptions(config)),
+        sess_opts_(GetSessionOptionsWithKey(config)),
         allocator_{} {
     {
       auto buf = ReadFile(mgr, config.moonshine.preprocessor);
@@ -168,8 +169,8 @@ class OfflineMoonshineModel::Impl {
 
  private:
   void InitPreprocessor(void *model_data, size_t model_data_length) {
-    preprocessor_sess_ = std::make_unique<Ort::Session>(
-        env_, model_data, model_data_length, sess_opts_);
+    preprocessor_sess_ = GetOrCreateSession(env_, model_data, model_data_length,
+                                            sess_opts_);
 
     GetInputNames(preprocessor_sess_.get(), &preprocessor_input_names_,
                   &preprocessor_input_names_ptr_);
@@ -179,8 +180,8 @@ class OfflineMoonshineModel::Impl {
   }
 
   void InitEncoder(void *model_data, size_t model_data_length) {
-    encoder_sess_ = std::make_unique<Ort::Session>(
-        env_, model_data, model_data_length, sess_opts_);
+    encoder_sess_ = GetOrCreateSession(env_, model_data, model_data_length,
+                                       sess_opts_);
 
     GetInputNames(encoder_sess_.get(), &encoder_input_names_,
                   &encoder_input_names_ptr_);
@@ -190,8 +191,8 @@ class OfflineMoonshineModel::Impl {
   }
 
   void InitUnCachedDecoder(void *model_data, size_t model_data_length) {
-    uncached_decoder_sess_ = std::make_unique<Ort::Session>(
-        env_, model_data, model_data_length, sess_opts_);
+    uncached_decoder_sess_ = GetOrCreateSession(env_, model_data,
+                                                model_data_length, sess_opts_);
 
     GetInputNames(uncached_decoder_sess_.get(), &uncached_decoder_input_names_,
                   &uncached_decoder_input_names_ptr_);
@@ -202,8 +203,8 @@ class OfflineMoonshineModel::Impl {
   }
 
   void InitCachedDecoder(void *model_data, size_t model_data_length) {
-    cached_decoder_sess_ = std::make_unique<Ort::Session>(
-        env_, model_data, model_data_length, sess_opts_);
+    cached_decoder_sess_ = GetOrCreateSession(env_, model_data,
+                                              model_data_length, sess_opts_);
 
     GetInputNames(cached_decoder_sess_.get(), &cached_decoder_input_names_,
                   &cached_decoder_input_names_ptr_);
@@ -215,13 +216,13 @@ class OfflineMoonshineModel::Impl {
  private:
   OfflineModelConfig config_;
   Ort::Env env_;
-  Ort::SessionOptions sess_opts_;
+  SessionOptionsWithKey sess_opts_;
   Ort::AllocatorWithDefaultOptions allocator_;
 
-  std::unique_ptr<Ort::Session> preprocessor_sess_;
-  std::unique_ptr<Ort::Session> encoder_sess_;
-  std::unique_ptr<Ort::Session> uncached_decoder_sess_;
-  std::unique_ptr<Ort::Session> cached_decoder_sess_;
+  std::shared_ptr<Ort::Session> preprocessor_sess_;
+  std::shared_ptr<Ort::Session> encoder_sess_;
+  std::shared_ptr<Ort::Session> uncached_decoder_sess_;
+  std::shared_ptr<Ort::Session> cached_decoder_sess_;
 
   std::vector<std::string> preprocessor_input_names_;
   std::vector<const char *> preprocessor_input_names_ptr_;
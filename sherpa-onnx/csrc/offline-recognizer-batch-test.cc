@@ -0,0 +1,76 @@
+// sherpa-onnx/csrc/offline-recognizer-batch-test.cc
+//
+// Copyright (c)  2025  Xiaomi Corporation
+
+#include <memory>
+#include <string>
+#include <vector>
+
+#include "gtest/gtest.h"
+#include "sherpa-onnx/csrc/file-utils.h"
+#include "sherpa-onnx/csrc/macros.h"
+#include "sherpa-onnx/csrc/offline-recognizer.h"
+#include "sherpa-onnx/csrc/wave-reader.h"
+
+namespace sherpa_onnx {
+
+// Decode each wave, a copy of it and its first half, both one by one and
+// in a single batch, and check that the results are the same.
+static void TestBatchEqualsOneByOne(const OfflineRecognizerConfig &config,
+                                    const std::vector<std::string> &waves) {
+  OfflineRecognizer recognizer(config);
+
+  std::vector<std::vector<float>> samples;
+  int32_t sample_rate = 16000;
+  for (const auto &w : waves) {
+    bool is_ok = false;
+    auto s = ReadWave(w, &sample_rate, &is_ok);
+    ASSERT_TRUE(is_ok) << w;
+
+    samples.push_back(s);
+    samples.push_back(s);
+    samples.emplace_back(s.begin(), s.begin() + s.size() / 2);
+  }
+
+  int32_t n = static_cast<int32_t>(samples.size());
+
+  std::vector<std::unique_ptr<OfflineStream>> ss;
+  std::vector<OfflineStream *> p_ss;
+  std::vector<std::string> expected;
+  for (int32_t i = 0; i != n; ++i) {
+    auto one = recognizer.CreateStream();
+    one->AcceptWaveform(sample_rate, samples[i].data(), samples[i].size());
+    recognizer.DecodeStream(one.get());
+    expected.push_back(one->GetResult().text);
+
+    ss.push_back(recognizer.CreateStream());
+    ss.back()->AcceptWaveform(sample_rate, samples[i].data(),
+                              samples[i].size());
+    p_ss.push_back(ss.back().get());
+  }
+
+  recognizer.DecodeStreams(p_ss.data(), n);
+
+  for (int32_t i = 0; i != n; ++i) {
+    EXPECT_EQ(ss[i]->GetResult().text, expected[i]) << i;
+  }
+}
+
+// Please download the model from
+// https://github.com/k2-fsa/sherpa-onnx/releases/download/asr-models/sherpa-onnx-nemo-canary-180m-flash-en-es-de-fr-int8.tar.bz2
+TEST(OfflineRecognizerCanary, BatchEqualsOneByOne) {
+  std::string dir = "./sherpa-onnx-nemo-canary-180m-flash-en-es-de-fr-int8";
+  if (!FileExists(dir + "/tokens.txt")) {
+    SHERPA_ONNX_LOGE("%s does not exist. Skipping test", dir.c_str());
+    return;
+  }
+
+  OfflineRecognizerConfig config;
+  config.model_config.canary.encoder = dir + "/encoder.int8.onnx";
+  config.model_config.canary.decoder = dir + "/decoder.int8.onnx";
+  config.model_config.tokens = dir + "/tokens.txt";
+
+  TestBatchEqualsOneByOne(config, {dir + "/test_wavs/en.wav"});
+}
+
+}  // namespace sherpa_onnx
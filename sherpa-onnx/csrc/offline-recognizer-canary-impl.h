@@ -17,6 +17,7 @@
 #include "sherpa-onnx/csrc/offline-recognizer-impl.h"
 #include "sherpa-onnx/csrc/offline-recognizer.h"
 #include "sherpa-onnx/csrc/onnx-utils.h"
+#include "sherpa-onnx/csrc/slice.h"
 #include "sherpa-onnx/csrc/symbol-table.h"
 #include "sherpa-onnx/csrc/utils.h"
 
@@ -48,17 +49,53 @@ class OfflineRecognizerCanaryImpl : public OfflineRecognizerImpl {
   }
 
   void DecodeStreams(OfflineStream **ss, int32_t n) const override {
-    for (int32_t i = 0; i < n; ++i) {
-      DecodeStream(ss[i]);
+    if (n == 1) {
+      DecodeStream(ss[0]);
+      return;
+    }
+
+    // The encoder supports batches with padding. The exported decoder
+    // processes only one utterance at a time, so we run it on the valid
+    // frames of each utterance in the batch.
+    auto enc_out = RunEncoder(ss, n);
+    const Ort::Value &enc_states = enc_out[0];
+    const int64_t *enc_len = enc_out[1].GetTensorData<int64_t>();
+
+    for (int32_t i = 0; i != n; ++i) {
+      int32_t len = static_cast<int32_t>(enc_len[i]);
+
+      Ort::Value states =
+          Slice(model_->Allocator(), &enc_states, i, i + 1, 0, len);
+
+      std::array<int64_t, 2> mask_shape = {1, len};
+      Ort::Value mask = Ort::Value::CreateTensor<bool>(
+          model_->Allocator(), mask_shape.data(), mask_shape.size());
+      std::fill_n(mask.GetTensorMutableData<bool>(), len, true);
+
+      DecodeStream(ss[i], std::move(states), std::move(mask));
     }
   }
 
   void DecodeStream(OfflineStream *s) const {
-    auto meta = model_->GetModelMetadata();
-    auto enc_out = RunEncoder(s);
-    Ort::Value enc_states = std::move(enc_out[0]);
-    Ort::Value enc_mask = std::move(enc_out[2]);
+    auto enc_out = RunEncoder(&s, 1);
     // enc_out[1] is discarded
+    DecodeStream(s, std::move(enc_out[0]), std::move(enc_out[2]));
+  }
+
+  OfflineRecognizerConfig GetConfig() const override { return config_; }
+
+  void SetConfig(const OfflineRecognizerConfig &config) override {
+    config_.model_config.canary.src_lang = config.model_config.canary.src_lang;
+    config_.model_config.canary.tgt_lang = config.model_config.canary.tgt_lang;
+    config_.model_config.canary.use_pnc = config.model_config.canary.use_pnc;
+
+    // we don't change the config_ in the base class
+  }
+
+ private:
+  void DecodeStream(OfflineStream *s, Ort::Value enc_states,
+                    Ort::Value enc_mask) const {
+    auto meta = model_->GetModelMetadata();
     std::vector<int32_t> decoder_input = GetInitialDecoderInput();
     auto decoder_states = model_->GetInitialDecoderStates();
     Ort::Value logits{nullptr};
@@ -105,17 +142,6 @@ class OfflineRecognizerCanaryImpl : public OfflineRecognizerImpl {
     s->SetResult(r);
   }
 
-  OfflineRecognizerConfig GetConfig() const override { return config_; }
-
-  void SetConfig(const OfflineRecognizerConfig &config) override {
-    config_.model_config.canary.src_lang = config.model_config.canary.src_lang;
-    config_.model_config.canary.tgt_lang = config.model_config.canary.tgt_lang;
-    config_.model_config.canary.use_pnc = config.model_config.canary.use_pnc;
-
-    // we don't change the config_ in the base class
-  }
-
- private:
   OfflineRecognitionResult Convert(const std::vector<int32_t> &tokens) const {
     OfflineRecognitionResult r;
     r.tokens.reserve(tokens.size());
@@ -147,26 +173,41 @@ class OfflineRecognizerCanaryImpl : public OfflineRecognizerImpl {
     return max_token_id;
   }
 
-  std::vector<Ort::Value> RunEncoder(OfflineStream *s) const {
+  std::vector<Ort::Value> RunEncoder(OfflineStream **ss, int32_t n) const {
     auto memory_info =
         Ort::MemoryInfo::CreateCpu(OrtDeviceAllocator, OrtMemTypeDefault);
 
     int32_t feat_dim = config_.feat_config.feature_dim;
-    std::vector<float> f = s->GetFrames();
 
-    int32_t num_frames = f.size() / feat_dim;
+    std::vector<std::vector<float>> features(n);
+    std::vector<int64_t> x_length(n);
+    int64_t max_num_frames = 0;
+
+    for (int32_t i = 0; i != n; ++i) {
+      features[i] = ss[i]->GetFrames();
+      x_length[i] = features[i].size() / feat_dim;
+      max_num_frames = std::max(max_num_frames, x_length[i]);
+    }
 
-    std::array<int64_t, 3> shape = {1, num_frames, feat_dim};
+    std::array<int64_t, 3> shape = {n, max_num_frames, feat_dim};
 
-    Ort::Value x = Ort::Value::CreateTensor(memory_info, f.data(), f.size(),
-                                            shape.data(), shape.size());
+    Ort::Value x = Ort::Value::CreateTensor<float>(
+        model_->Allocator(), shape.data(), shape.size());
 
-    int64_t x_length_scalar = num_frames;
-    std::array<int64_t, 1> x_length_shape = {1};
-    Ort::Value x_length =
-        Ort::Value::CreateTensor(memory_info, &x_length_scalar, 1,
+    float *p = x.GetTensorMutableData<float>();
+    std::fill_n(p, n * max_num_frames * feat_dim, 0);
+
+    for (int32_t i = 0; i != n; ++i) {
+      std::copy(features[i].begin(), features[i].end(),
+                p + i * max_num_frames * feat_dim);
+    }
+
+    std::array<int64_t, 1> x_length_shape = {n};
+    Ort::Value x_length_tensor =
+        Ort::Value::CreateTensor(memory_info, x_length.data(), n,
                                  x_length_shape.data(), x_length_shape.size());
-    return model_->ForwardEncoder(std::move(x), std::move(x_length));
+
+    return model_->ForwardEncoder(std::move(x), std::move(x_length_tensor));
   }
 
   std::pair<Ort::Value, std::vector<Ort::Value>> RunDecoder(
@@ -89,7 +89,9 @@ class OfflineRecognizerFireRedAsrImpl : public OfflineRecognizerImpl {
   }
 
   void DecodeStreams(OfflineStream **ss, int32_t n) const override {
-    // batch decoding is not implemented yet
+    // The decoder has no mask for the cross attention, so padding a batch
+    // would change the results of the shorter utterances. Utterances are
+    // decoded one by one.
     for (int32_t i = 0; i != n; ++i) {
       DecodeStream(ss[i]);
     }
@@ -119,8 +121,9 @@ class OfflineRecognizerFireRedAsrImpl : public OfflineRecognizerImpl {
 
     auto cross_kv = model_->ForwardEncoder(std::move(x), std::move(x_len));
 
-    auto results = decoder_->Decode(std::move(cross_kv.first),
-                                    std::move(cross_kv.second), num_frames);
+    auto results =
+        decoder_->Decode(std::move(cross_kv.first), std::move(cross_kv.second),
+                         {static_cast<int32_t>(num_frames)});
 
     auto r = Convert(results[0], symbol_table_);
 
@@ -83,7 +83,9 @@ class OfflineRecognizerMoonshineImpl : public OfflineRecognizerImpl {
   }
 
   void DecodeStreams(OfflineStream **ss, int32_t n) const override {
-    // batch decoding is not implemented yet
+    // Neither the GroupNorm of the preprocessor nor the cross attention of
+    // the decoder has a mask, so padding a batch would change the results
+    // of the shorter utterances. Utterances are decoded one by one.
     for (int32_t i = 0; i != n; ++i) {
       DecodeStream(ss[i]);
     }
@@ -117,7 +119,7 @@ class OfflineRecognizerMoonshineImpl : public OfflineRecognizerImpl {
       Ort::Value encoder_out = model_->ForwardEncoder(
           std::move(features), std::move(features_len_tensor));
 
-      auto results = decoder_->Decode(std::move(encoder_out));
+      auto results = decoder_->Decode(std::move(encoder_out), {features_len});
 
       auto r = Convert(results[0], symbol_table_);
       r.text = ApplyInverseTextNormalization(std::move(r.text));
@@ -166,28 +166,19 @@ class OfflineRecognizerTransducerImpl : public OfflineRecognizerImpl {
                        hotwords.c_str());
     }
 
-    int32_t num_default_hws = hotwords_.size();
-    int32_t num_hws = current.size();
-
-    current.insert(current.end(), hotwords_.begin(), hotwords_.end());
-
-    if (!current_scores.empty() && !boost_scores_.empty()) {
-      current_scores.insert(current_scores.end(), boost_scores_.begin(),
-                            boost_scores_.end());
-    } else if (!current_scores.empty() && boost_scores_.empty()) {
-      current_scores.insert(current_scores.end(), num_default_hws,
-                            config_.hotwords_score);
-    } else if (current_scores.empty() && !boost_scores_.empty()) {
-      current_scores.insert(current_scores.end(), num_hws,
-                            config_.hotwords_score);
-      current_scores.insert(current_scores.end(), boost_scores_.begin(),
-                            boost_scores_.end());
+    // The hotwords of this stream are added on top of the shared graph of
+    // the default hotwords, which is not copied.
+    ContextGraphPtr context_graph;
+    if (current.empty()) {
+      context_graph = hotwords_graph_;
+    } else if (hotwords_graph_) {
+      context_graph = std::make_shared<ContextGraph>(
+          hotwords_graph_, current, config_.hotwords_score, 0.0f,
+          current_scores);
     } else {
-      // Do nothing.
+      context_graph = std::make_shared<ContextGraph>(
+          current, config_.hotwords_score, current_scores);
     }
-
-    auto context_graph = std::make_shared<ContextGraph>(
-        current, config_.hotwords_score, current_scores);
     return std::make_unique<OfflineStream>(config_.feat_config, context_graph);
   }
 
@@ -254,6 +245,17 @@ class OfflineRecognizerTransducerImpl : public OfflineRecognizerImpl {
   OfflineRecognizerConfig GetConfig() const override { return config_; }
 
   void InitHotwords() {
+    if (ContextGraph::IsCompiledGraph(config_.hotwords_file)) {
+      // It is saved by ContextGraph::Save()
+      hotwords_graph_ = ContextGraph::Load(config_.hotwords_file);
+      if (!hotwords_graph_) {
+        SHERPA_ONNX_LOGE("Failed to load hotwords graph: '%s'",
+                         config_.hotwords_file.c_str());
+        exit(-1);
+      }
+      return;
+    }
+
     // each line in hotwords_file contains space-separated words
 
     std::ifstream is(config_.hotwords_file);
@@ -263,14 +265,16 @@ class OfflineRecognizerTransducerImpl : public OfflineRecognizerImpl {
       exit(-1);
     }
 
+    std::vector<std::vector<int32_t>> hotwords;
+    std::vector<float> boost_scores;
     if (!EncodeHotwords(is, config_.model_config.modeling_unit, symbol_table_,
-                        bpe_encoder_.get(), &hotwords_, &boost_scores_)) {
+                        bpe_encoder_.get(), &hotwords, &boost_scores)) {
       SHERPA_ONNX_LOGE(
           "Failed to encode some hotwords, skip them already, see logs above "
           "for details.");
     }
     hotwords_graph_ = std::make_shared<ContextGraph>(
-        hotwords_, config_.hotwords_score, boost_scores_);
+        hotwords, config_.hotwords_score, boost_scores);
   }
 
   template <typename Manager>
@@ -287,21 +291,21 @@ class OfflineRecognizerTransducerImpl : public OfflineRecognizerImpl {
       exit(-1);
     }
 
+    std::vector<std::vector<int32_t>> hotwords;
+    std::vector<float> boost_scores;
     if (!EncodeHotwords(is, config_.model_config.modeling_unit, symbol_table_,
-                        bpe_encoder_.get(), &hotwords_, &boost_scores_)) {
+                        bpe_encoder_.get(), &hotwords, &boost_scores)) {
       SHERPA_ONNX_LOGE(
           "Failed to encode some hotwords, skip them already, see logs above "
           "for details.");
     }
     hotwords_graph_ = std::make_shared<ContextGraph>(
-        hotwords_, config_.hotwords_score, boost_scores_);
+        hotwords, config_.hotwords_score, boost_scores);
   }
 
  private:
   OfflineRecognizerConfig config_;
   SymbolTable symbol_table_;
-  std::vector<std::vector<int32_t>> hotwords_;
-  std::vector<float> boost_scores_;
   ContextGraphPtr hotwords_graph_;
   std::unique_ptr<ssentencepiece::Ssentencepiece> bpe_encoder_;
   std::unique_ptr<OfflineTransducerModel> model_;
@@ -66,9 +66,65 @@ class OfflineRecognizerWhisperImpl : public OfflineRecognizerImpl {
   }
 
   void DecodeStreams(OfflineStream **ss, int32_t n) const override {
-    // batch decoding is not implemented yet
+    if (n == 1) {
+      DecodeStream(ss[0]);
+      return;
+    }
+
+    decoder_->SetConfig(config_.model_config.whisper);
+
+    int32_t feat_dim = model_->FeatureDim();
+
+    std::vector<std::vector<float>> features(n);
+    std::vector<int32_t> num_frames(n);
+    int32_t max_actual_frames = 0;
+
+    for (int32_t i = 0; i != n; ++i) {
+      features[i] = ss[i]->GetFrames();
+      num_frames[i] = PrepareFeatures(&features[i], feat_dim);
+
+      max_actual_frames =
+          std::max(max_actual_frames, NumPaddedFrames(num_frames[i]));
+    }
+
+    // Pad all utterances to the same length. Since each utterance is
+    // already followed by zero tail paddings, the extra paddings for the
+    // shorter utterances are also zeros.
+    std::array<int64_t, 3> shape{n, max_actual_frames, feat_dim};
+
+    Ort::Value mel = Ort::Value::CreateTensor<float>(
+        model_->Allocator(), shape.data(), shape.size());
+
+    float *p_mel = mel.GetTensorMutableData<float>();
+    std::fill_n(p_mel, n * max_actual_frames * feat_dim, 0);
+
     for (int32_t i = 0; i != n; ++i) {
-      DecodeStream(ss[i]);
+      std::copy(features[i].data(),
+                features[i].data() + num_frames[i] * feat_dim,
+                p_mel + i * max_actual_frames * feat_dim);
+    }
+
+    mel = Transpose12(model_->Allocator(), &mel);
+
+    try {
+      auto cross_kv = model_->ForwardEncoder(std::move(mel));
+
+      auto results = decoder_->Decode(std::move(cross_kv.first),
+                                      std::move(cross_kv.second), num_frames);
+
+      for (int32_t i = 0; i != n; ++i) {
+        auto r = Convert(results[i], symbol_table_);
+        ss[i]->SetResult(r);
+      }
+    } catch (const Ort::Exception &ex) {
+      SHERPA_ONNX_LOGE(
+          "\n\nCaught exception:\n\n%s\n\nwhen decoding a batch of %d "
+          "utterances. Decode them one by one",
+          ex.what(), n);
+
+      for (int32_t i = 0; i != n; ++i) {
+        DecodeStream(ss[i]);
+      }
     }
   }
 
@@ -82,37 +138,10 @@ class OfflineRecognizerWhisperImpl : public OfflineRecognizerImpl {
   void DecodeStream(OfflineStream *s) const {
     decoder_->SetConfig(config_.model_config.whisper);
 
-    int32_t max_num_frames = 3000;
-    auto memory_info =
-        Ort::MemoryInfo::CreateCpu(OrtDeviceAllocator, OrtMemTypeDefault);
-
     int32_t feat_dim = s->FeatureDim();
     std::vector<float> f = s->GetFrames();
-    int32_t num_frames = f.size() / feat_dim;
-
-    // we use 50 here so that there will be some zero tail paddings
-    if (num_frames >= max_num_frames - 50) {
-      SHERPA_ONNX_LOGE(
-          "Only waves less than 30 seconds are supported. We process only the "
-          "first 30 seconds and discard the remaining data");
-      num_frames = max_num_frames - 50;
-    }
-
-    model_->NormalizeFeatures(f.data(), num_frames, feat_dim);
-
-    // note that 1000 is an experience-value.
-    // You can replace 1000 by other values, say, 100.
-    //
-    // Since we have removed the 30 seconds constraint, we need
-    // tail_padding_frames so that whisper is able to detect the eot token.
-    int32_t tail_padding_frames = 1000;
-
-    if (config_.model_config.whisper.tail_paddings > 0) {
-      tail_padding_frames = config_.model_config.whisper.tail_paddings;
-    }
-
-    int32_t actual_frames =
-        std::min(num_frames + tail_padding_frames, max_num_frames);
+    int32_t num_frames = PrepareFeatures(&f, feat_dim);
+    int32_t actual_frames = NumPaddedFrames(num_frames);
 
     std::array<int64_t, 3> shape{1, actual_frames, feat_dim};
 
@@ -131,7 +160,7 @@ class OfflineRecognizerWhisperImpl : public OfflineRecognizerImpl {
       auto cross_kv = model_->ForwardEncoder(std::move(mel));
 
       auto results = decoder_->Decode(std::move(cross_kv.first),
-                                      std::move(cross_kv.second), num_frames);
+                                      std::move(cross_kv.second), {num_frames});
 
       auto r = Convert(results[0], symbol_table_);
       s->SetResult(r);
@@ -141,12 +170,52 @@ class OfflineRecognizerWhisperImpl : public OfflineRecognizerImpl {
           "input frames: %d, Current tail "
           "paddings: %d. If you see a lot of such exceptions, please consider "
           "using a larger --whisper-tail-paddings",
-          ex.what(), num_frames, tail_padding_frames);
+          ex.what(), num_frames, TailPaddingFrames());
       return;
     }
   }
 
  private:
+  // Normalize the features in-place and return the number of frames
+  // to use. Frames beyond 30 seconds are discarded.
+  int32_t PrepareFeatures(std::vector<float> *f, int32_t feat_dim) const {
+    int32_t max_num_frames = 3000;
+    int32_t num_frames = f->size() / feat_dim;
+
+    // we use 50 here so that there will be some zero tail paddings
+    if (num_frames >= max_num_frames - 50) {
+      SHERPA_ONNX_LOGE(
+          "Only waves less than 30 seconds are supported. We process only the "
+          "first 30 seconds and discard the remaining data");
+      num_frames = max_num_frames - 50;
+    }
+
+    model_->NormalizeFeatures(f->data(), num_frames, feat_dim);
+
+    return num_frames;
+  }
+
+  int32_t TailPaddingFrames() const {
+    // note that 1000 is an experience-value.
+    // You can replace 1000 by other values, say, 100.
+    //
+    // Since we have removed the 30 seconds constraint, we need
+    // tail_padding_frames so that whisper is able to detect the eot token.
+    int32_t tail_padding_frames = 1000;
+
+    if (config_.model_config.whisper.tail_paddings > 0) {
+      tail_padding_frames = config_.model_config.whisper.tail_paddings;
+    }
+
+    return tail_padding_frames;
+  }
+
+  // Number of frames including tail paddings fed to the encoder
+  int32_t NumPaddedFrames(int32_t num_frames) const {
+    int32_t max_num_frames = 3000;
+    return std::min(num_frames + TailPaddingFrames(), max_num_frames);
+  }
+
   OfflineRecognitionResult Convert(const OfflineWhisperDecoderResult &src,
                                    const SymbolTable &sym_table) const {
     OfflineRecognitionResult r;
@@ -20,6 +20,7 @@
 
 #include "sherpa-onnx/csrc/file-utils.h"
 #include "sherpa-onnx/csrc/onnx-utils.h"
+#include "sherpa-onnx/csrc/session-registry.h"
 #include "sherpa-onnx/csrc/session.h"
 #include "sherpa-onnx/csrc/text-utils.h"
 
@@ -30,7 +31,7 @@ class OfflineSourceSeparationSpleeterModel::Impl {
   explicit Impl(const OfflineSourceSeparationModelConfig &config)
       : config_(config),
         env_(ORT_LOGGING_LEVEL_ERROR),
-        sess_opts_(GetSessionOptions(config)),
+        sess_opts_(GetSessionOptionsWithKey(config)),
         allocator_{} {
     {
       auto buf = ReadFile(config.spleeter.vocals);
@@ -47,7 +48,7 @@ class OfflineSourceSeparationSpleeterModel::Impl {
   Impl(Manager *mgr, const OfflineSourceSeparationModelConfig &config)
       : config_(config),
         env_(ORT_LOGGING_LEVEL_ERROR),
-        sess_opts_(GetSessionOptions(config)),
+        sess_opts_(GetSessionOptionsWithKey(config)),
         allocator_{} {
     {
       auto buf = ReadFile(mgr, config.spleeter.vocals);
@@ -81,8 +82,8 @@ class OfflineSourceSeparationSpleeterModel::Impl {
 
  private:
   void InitVocals(void *model_data, size_t model_data_length) {
-    vocals_sess_ = std::make_unique<Ort::Session>(
-        env_, model_data, model_data_length, sess_opts_);
+    vocals_sess_ = GetOrCreateSession(env_, model_data, model_data_length,
+                                      sess_opts_);
 
     GetInputNames(vocals_sess_.get(), &vocals_input_names_,
                   &vocals_input_names_ptr_);
@@ -135,8 +136,8 @@ class OfflineSourceSeparationSpleeterModel::Impl {
   }
 
   void InitAccompaniment(void *model_data, size_t model_data_length) {
-    accompaniment_sess_ = std::make_unique<Ort::Session>(
-        env_, model_data, model_data_length, sess_opts_);
+    accompaniment_sess_ = GetOrCreateSession(env_, model_data,
+                                             model_data_length, sess_opts_);
 
     GetInputNames(accompaniment_sess_.get(), &accompaniment_input_names_,
                   &accompaniment_input_names_ptr_);
@@ -150,10 +151,10 @@ class OfflineSourceSeparationSpleeterModel::Impl {
   OfflineSourceSeparationSpleeterModelMetaData meta_;
 
   Ort::Env env_;
-  Ort::SessionOptions sess_opts_;
+  SessionOptionsWithKey sess_opts_;
   Ort::AllocatorWithDefaultOptions allocator_;
 
-  std::unique_ptr<Ort::Session> vocals_sess_;
+  std::shared_ptr<Ort::Session> vocals_sess_;
 
   std::vector<std::string> vocals_input_names_;
   std::vector<const char *> vocals_input_names_ptr_;
@@ -161,7 +162,7 @@ class OfflineSourceSeparationSpleeterModel::Impl {
   std::vector<std::string> vocals_output_names_;
   std::vector<const char *> vocals_output_names_ptr_;
 
-  std::unique_ptr<Ort::Session> accompaniment_sess_;
+  std::shared_ptr<Ort::Session> accompaniment_sess_;
 
   std::vector<std::string> accompaniment_input_names_;
   std::vector<const char *> accompaniment_input_names_ptr_;
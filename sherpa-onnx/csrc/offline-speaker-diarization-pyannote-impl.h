@@ -5,8 +5,12 @@
 #define SHERPA_ONNX_CSRC_OFFLINE_SPEAKER_DIARIZATION_PYANNOTE_IMPL_H_
 
 #include <algorithm>
+#include <atomic>
 #include <cmath>
+#include <exception>
 #include <memory>
+#include <mutex>  // NOLINT
+#include <thread>  // NOLINT
 #include <unordered_map>
 #include <utility>
 #include <vector>
@@ -263,47 +267,124 @@ class OfflineSpeakerDiarizationPyannoteImpl
     int32_t num_chunks = (n - window_size) / window_shift + 1;
     bool has_last_chunk = ((n - window_size) % window_shift) > 0;
 
-    ans.reserve(num_chunks + has_last_chunk);
+    // chunks[i] points to the start of the i-th chunk
+    std::vector<const float *> chunks;
+    chunks.reserve(num_chunks + has_last_chunk);
 
     const float *p = audio;
-
     for (int32_t i = 0; i != num_chunks; ++i, p += window_shift) {
-      Matrix2D m = ProcessChunk(p);
-
-      ans.push_back(std::move(m));
+      chunks.push_back(p);
     }
 
+    std::vector<float> last_chunk;
     if (has_last_chunk) {
-      std::vector<float> buf(window_size);
-      std::copy(p, audio + n, buf.data());
+      last_chunk.resize(window_size);
+      std::copy(p, audio + n, last_chunk.data());
+      chunks.push_back(last_chunk.data());
+    }
 
-      Matrix2D m = ProcessChunk(buf.data());
+    ans.resize(chunks.size());
+
+    int32_t total = static_cast<int32_t>(chunks.size());
+    int32_t batch_size = config_.segmentation.batch_size;
+    int32_t num_batches = (total + batch_size - 1) / batch_size;
+    int32_t num_workers = std::min(config_.segmentation.num_workers,
+                                   num_batches);
+
+    // Each batch writes to its own entries in ans, so the result does not
+    // depend on the order in which batches are processed.
+    std::atomic<int32_t> next_batch{0};
+
+    // The first exception thrown by a worker, e.g., Ort::Exception. It is
+    // rethrown after all threads are joined.
+    std::mutex error_mutex;
+    std::exception_ptr error;
+
+    auto worker = [&]() {
+      int32_t b;
+      while ((b = next_batch.fetch_add(1)) < num_batches) {
+        int32_t start = b * batch_size;
+        int32_t this_batch_size = std::min(batch_size, total - start);
+        try {
+          ProcessChunks(chunks.data() + start, this_batch_size,
+                        ans.data() + start);
+        } catch (...) {
+          std::lock_guard<std::mutex> lock(error_mutex);
+          if (!error) {
+            error = std::current_exception();
+          }
 
-      ans.push_back(std::move(m));
+          // So that other workers stop, too
+          next_batch = num_batches;
+          return;
+        }
+      }
+    };
+
+    std::vector<std::thread> threads;
+    threads.reserve(num_workers - 1);
+    for (int32_t i = 1; i < num_workers; ++i) {
+      threads.emplace_back(worker);
+    }
+
+    worker();
+
+    for (auto &t : threads) {
+      t.join();
+    }
+
+    if (error) {
+      std::rethrow_exception(error);
     }
 
     return ans;
   }
 
   Matrix2D ProcessChunk(const float *p) const {
+    Matrix2D ans;
+    ProcessChunks(&p, 1, &ans);
+    return ans;
+  }
+
+  // Run the segmentation model on n chunks in a batch
+  //
+  // @param chunks chunks[i] points to an array of window_size samples
+  // @param n Number of chunks
+  // @param out On return, out[i] contains the output for chunks[i]
+  void ProcessChunks(const float *const *chunks, int32_t n,
+                     Matrix2D *out) const {
     const auto &meta_data = segmentation_model_.GetModelMetaData();
     int32_t window_size = meta_data.window_size;
 
     auto memory_info =
         Ort::MemoryInfo::CreateCpu(OrtDeviceAllocator, OrtMemTypeDefault);
 
-    std::array<int64_t, 3> shape = {1, 1, window_size};
+    std::array<int64_t, 3> shape = {n, 1, window_size};
+
+    std::vector<float> buf;
+    float *x_data = const_cast<float *>(chunks[0]);
+    if (n > 1) {
+      // Chunks overlap in the input audio, so we have to copy them
+      buf.resize(n * window_size);
+      for (int32_t i = 0; i != n; ++i) {
+        std::copy(chunks[i], chunks[i] + window_size,
+                  buf.data() + i * window_size);
+      }
+      x_data = buf.data();
+    }
+
+    Ort::Value x = Ort::Value::CreateTensor(
+        memory_info, x_data, n * window_size, shape.data(), shape.size());
 
-    Ort::Value x =
-        Ort::Value::CreateTensor(memory_info, const_cast<float *>(p),
-                                 window_size, shape.data(), shape.size());
+    Ort::Value y = segmentation_model_.Forward(std::move(x));
+    std::vector<int64_t> y_shape = y.GetTensorTypeAndShapeInfo().GetShape();
 
-    Ort::Value out = segmentation_model_.Forward(std::move(x));
-    std::vector<int64_t> out_shape = out.GetTensorTypeAndShapeInfo().GetShape();
-    Matrix2D m(out_shape[1], out_shape[2]);
-    std::copy(out.GetTensorData<float>(), out.GetTensorData<float>() + m.size(),
-              &m(0, 0));
-    return m;
+    const float *p = y.GetTensorData<float>();
+    for (int32_t i = 0; i != n; ++i) {
+      out[i] = Matrix2D(y_shape[1], y_shape[2]);
+      std::copy(p, p + out[i].size(), &out[i](0, 0));
+      p += out[i].size();
+    }
   }
 
   Matrix2DInt32 ToMultiLabel(const Matrix2D &m) const {
@@ -477,38 +558,64 @@ class OfflineSpeakerDiarizationPyannoteImpl
 
     int32_t k = 0;
     int32_t cur_row_index = 0;
-    for (const auto &v : sample_indexes) {
-      auto stream = embedding_extractor_.CreateStream();
-      for (const auto &p : v) {
-        int32_t end = (p.second <= n) ? p.second : n;
-        int32_t num_samples = end - p.first;
-
-        if (num_samples > 0) {
-          stream->AcceptWaveform(sample_rate, audio + p.first, num_samples);
+    int32_t num_segments = static_cast<int32_t>(sample_indexes.size());
+
+    // Streams are processed in groups so that the features of only a
+    // limited number of streams are kept in memory. Each group is passed
+    // to ComputeBatch(), which runs the model on batches of streams.
+    constexpr int32_t kGroupSize = 128;
+
+    std::vector<std::unique_ptr<OnlineStream>> streams;
+    std::vector<OnlineStream *> ss;
+
+    for (int32_t start = 0; start < num_segments; start += kGroupSize) {
+      int32_t group_end = std::min(start + kGroupSize, num_segments);
+
+      streams.clear();
+      ss.clear();
+
+      for (int32_t i = start; i != group_end; ++i) {
+        auto stream = embedding_extractor_.CreateStream();
+        for (const auto &p : sample_indexes[i]) {
+          int32_t end = (p.second <= n) ? p.second : n;
+          int32_t num_samples = end - p.first;
+
+          if (num_samples > 0) {
+            stream->AcceptWaveform(sample_rate, audio + p.first, num_samples);
+          }
         }
-      }
 
-      stream->InputFinished();
-      if (!embedding_extractor_.IsReady(stream.get())) {
-        SHERPA_ONNX_LOGE(
-            "This segment is too short, which should not happen since we have "
-            "already filtered short segments");
-        SHERPA_ONNX_EXIT(-1);
+        stream->InputFinished();
+        if (!embedding_extractor_.IsReady(stream.get())) {
+          SHERPA_ONNX_LOGE(
+              "This segment is too short, which should not happen since we "
+              "have already filtered short segments");
+          SHERPA_ONNX_EXIT(-1);
+        }
+
+        ss.push_back(stream.get());
+        streams.push_back(std::move(stream));
       }
 
-      std::vector<float> embedding = embedding_extractor_.Compute(stream.get());
+      std::vector<std::vector<float>> embeddings =
+          embedding_extractor_.ComputeBatch(ss.data(), ss.size());
 
-      if (std::none_of(embedding.begin(), embedding.end(), IsNaNWrapper)) {
-        // a valid embedding
-        std::copy(embedding.begin(), embedding.end(), &ans(cur_row_index, 0));
-        cur_row_index += 1;
-        valid_indexes->push_back(k);
-      }
+      for (const auto &embedding : embeddings) {
+        if (std::none_of(embedding.begin(), embedding.end(), IsNaNWrapper)) {
+          // a valid embedding
+          std::copy(embedding.begin(), embedding.end(),
+                    &ans(cur_row_index, 0));
+          cur_row_index += 1;
+          valid_indexes->push_back(k);
+        }
 
-      k += 1;
+        k += 1;
 
-      if (callback) {
-        callback(k, ans.rows(), callback_arg);
+        // Called once per embedding as before batching, though the calls
+        // of a group come together after the group is computed
+        if (callback) {
+          callback(k, ans.rows(), callback_arg);
+        }
       }
     }
 
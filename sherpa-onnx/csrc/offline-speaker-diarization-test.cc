@@ -0,0 +1,78 @@
+// sherpa-onnx/csrc/offline-speaker-diarization-test.cc
+//
+// Copyright (c)  2025  Xiaomi Corporation
+
+#include "sherpa-onnx/csrc/offline-speaker-diarization.h"
+
+#include <string>
+#include <utility>
+#include <vector>
+
+#include "gtest/gtest.h"
+#include "sherpa-onnx/csrc/file-utils.h"
+#include "sherpa-onnx/csrc/macros.h"
+#include "sherpa-onnx/csrc/wave-reader.h"
+
+namespace sherpa_onnx {
+
+static std::vector<OfflineSpeakerDiarizationSegment> Process(
+    OfflineSpeakerDiarizationConfig config, int32_t batch_size,
+    int32_t num_workers, const std::vector<float> &samples) {
+  config.segmentation.batch_size = batch_size;
+  config.segmentation.num_workers = num_workers;
+
+  OfflineSpeakerDiarization sd(config);
+  return sd.Process(samples.data(), samples.size()).SortByStartTime();
+}
+
+// Please download the models and the test wave from
+// https://github.com/k2-fsa/sherpa-onnx/releases/tag/speaker-segmentation-models
+// https://github.com/k2-fsa/sherpa-onnx/releases/tag/speaker-recongition-models
+//
+// Running the segmentation model in batches and on several threads gives
+// the same result as running it on one chunk at a time.
+TEST(OfflineSpeakerDiarization, BatchedSameAsUnbatched) {
+  std::string segmentation =
+      "./sherpa-onnx-pyannote-segmentation-3-0/model.onnx";
+  std::string embedding =
+      "./3dspeaker_speech_eres2net_base_sv_zh-cn_3dspeaker_16k.onnx";
+  std::string wave = "./0-four-speakers-zh.wav";
+
+  for (const auto &f : {segmentation, embedding, wave}) {
+    if (!FileExists(f)) {
+      SHERPA_ONNX_LOGE("%s does not exist. Skipping test", f.c_str());
+      return;
+    }
+  }
+
+  OfflineSpeakerDiarizationConfig config;
+  config.segmentation.pyannote.model = segmentation;
+  config.embedding.model = embedding;
+  config.clustering.num_clusters = 4;
+
+  int32_t sample_rate = 0;
+  bool is_ok = false;
+  std::vector<float> samples = ReadWave(wave, &sample_rate, &is_ok);
+  ASSERT_TRUE(is_ok);
+
+  auto expected = Process(config, 1, 1, samples);
+  ASSERT_FALSE(expected.empty());
+
+  // (batch_size, num_workers)
+  std::vector<std::pair<int32_t, int32_t>> settings = {
+      {4, 1}, {1, 3}, {3, 2}, {100, 2}};
+
+  for (const auto &[batch_size, num_workers] : settings) {
+    auto segments = Process(config, batch_size, num_workers, samples);
+    ASSERT_EQ(segments.size(), expected.size())
+        << batch_size << " " << num_workers;
+
+    for (int32_t i = 0; i != static_cast<int32_t>(segments.size()); ++i) {
+      EXPECT_NEAR(segments[i].Start(), expected[i].Start(), 1e-3) << i;
+      EXPECT_NEAR(segments[i].End(), expected[i].End(), 1e-3) << i;
+      EXPECT_EQ(segments[i].Speaker(), expected[i].Speaker()) << i;
+    }
+  }
+}
+
+}  // namespace sherpa_onnx
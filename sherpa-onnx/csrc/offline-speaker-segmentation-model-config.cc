@@ -21,6 +21,13 @@ void OfflineSpeakerSegmentationModelConfig::Register(ParseOptions *po) {
 
   po->Register("provider", &provider,
                "Specify a provider to use: cpu, cuda, coreml");
+
+  po->Register("batch-size", &batch_size,
+               "Number of chunks to process in a single run of the model");
+
+  po->Register("num-workers", &num_workers,
+               "Number of threads that run the model on different batches "
+               "of chunks in parallel");
 }
 
 bool OfflineSpeakerSegmentationModelConfig::Validate() const {
@@ -29,6 +36,16 @@ bool OfflineSpeakerSegmentationModelConfig::Validate() const {
     return false;
   }
 
+  if (batch_size < 1) {
+    SHERPA_ONNX_LOGE("batch_size should be > 0. Given %d", batch_size);
+    return false;
+  }
+
+  if (num_workers < 1) {
+    SHERPA_ONNX_LOGE("num_workers should be > 0. Given %d", num_workers);
+    return false;
+  }
+
   if (!pyannote.model.empty()) {
     return pyannote.Validate();
   }
@@ -49,7 +66,9 @@ std::string OfflineSpeakerSegmentationModelConfig::ToString() const {
   os << "pyannote=" << pyannote.ToString() << ", ";
   os << "num_threads=" << num_threads << ", ";
   os << "debug=" << (debug ? "True" : "False") << ", ";
-  os << "provider=\"" << provider << "\")";
+  os << "provider=\"" << provider << "\", ";
+  os << "batch_size=" << batch_size << ", ";
+  os << "num_workers=" << num_workers << ")";
 
   return os.str();
 }
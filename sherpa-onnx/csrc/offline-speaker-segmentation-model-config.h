@@ -18,6 +18,13 @@ struct OfflineSpeakerSegmentationModelConfig {
   bool debug = false;
   std::string provider = "cpu";
 
+  // Number of chunks to process in a single run of the model
+  int32_t batch_size = 1;
+
+  // Number of threads that run the model on different batches in parallel.
+  // Each of them uses num_threads threads inside onnxruntime.
+  int32_t num_workers = 1;
+
   OfflineSpeakerSegmentationModelConfig() = default;
 
   explicit OfflineSpeakerSegmentationModelConfig(
@@ -21,6 +21,24 @@
 
 namespace sherpa_onnx {
 
+inline knf::StftConfig GetGtcrnStftConfig(
+    const OfflineSpeechDenoiserGtcrnModelMetaData &meta) {
+  knf::StftConfig stft_config;
+  stft_config.n_fft = meta.n_fft;
+  stft_config.hop_length = meta.hop_length;
+  stft_config.win_length = meta.window_length;
+  stft_config.window_type = meta.window_type;
+  if (stft_config.window_type == "hann_sqrt") {
+    auto window = knf::GetWindow("hann", stft_config.win_length);
+    for (auto &w : window) {
+      w = std::sqrt(w);
+    }
+    stft_config.window = std::move(window);
+  }
+
+  return stft_config;
+}
+
 class OfflineSpeechDenoiserGtcrnImpl : public OfflineSpeechDenoiserImpl {
  public:
   explicit OfflineSpeechDenoiserGtcrnImpl(
@@ -57,18 +75,7 @@ class OfflineSpeechDenoiserGtcrnImpl : public OfflineSpeechDenoiserImpl {
       n = tmp.size();
     }
 
-    knf::StftConfig stft_config;
-    stft_config.n_fft = meta.n_fft;
-    stft_config.hop_length = meta.hop_length;
-    stft_config.win_length = meta.window_length;
-    stft_config.window_type = meta.window_type;
-    if (stft_config.window_type == "hann_sqrt") {
-      auto window = knf::GetWindow("hann", stft_config.win_length);
-      for (auto &w : window) {
-        w = std::sqrt(w);
-      }
-      stft_config.window = std::move(window);
-    }
+    knf::StftConfig stft_config = GetGtcrnStftConfig(meta);
 
     knf::Stft stft(stft_config);
     knf::StftResult stft_result = stft.Compute(p, n);
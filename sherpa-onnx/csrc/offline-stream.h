@@ -80,6 +80,13 @@ class OfflineStream {
   void AcceptWaveform(int32_t sampling_rate, const float *waveform,
                       int32_t n) const;
 
+  /** Same as above, but the input is 16-bit PCM, i.e., each sample is in
+   * the range [-32768, 32767]. The samples are converted and scaled in a
+   * single pass, so callers don't need to convert them to float first.
+   */
+  void AcceptWaveform(int32_t sampling_rate, const int16_t *waveform,
+                      int32_t n) const;
+
   /// Return feature dim of this extractor.
   ///
   /// Note: if it is Moonshine, then it returns the number of audio samples
@@ -101,30 +101,26 @@ OfflineTransducerModifiedBeamSearchDecoder::Decode(
       // assuming blank id is 0
       SubtractBlank(p_logit, vocab_size, num_hyps, 0, blank_penalty_);
     }
-    LogSoftmax(p_logit, vocab_size, num_hyps);
 
-    // now p_logit contains log_softmax output, we rename it to p_logprob
-    // to match what it actually contains
-    float *p_logprob = p_logit;
-
-    // add log_prob of each hypothesis to p_logprob before taking top_k
+    // log_prob of each hypothesis, added to the log_softmax output of the
+    // joiner before taking top_k
+    std::vector<float> hyp_log_probs(num_hyps);
     for (int32_t i = 0; i != num_hyps; ++i) {
-      float log_prob = prev[i].log_prob;
-      for (int32_t k = 0; k != vocab_size; ++k, ++p_logprob) {
-        *p_logprob += log_prob;
-      }
+      hyp_log_probs[i] = prev[i].log_prob;
     }
-    p_logprob = p_logit;  // we changed p_logprob in the above for loop
 
     // Now compute top_k for each utterance
+    std::vector<float> topk_log_probs;
     for (int32_t i = 0; i != n; ++i) {
       int32_t start = hyps_row_splits[i];
       int32_t end = hyps_row_splits[i + 1];
-      auto topk =
-          TopkIndex(p_logprob, vocab_size * (end - start), max_active_paths_);
+      auto topk = LogSoftmaxTopk(
+          p_logit + start * vocab_size, vocab_size, end - start,
+          hyp_log_probs.data() + start, max_active_paths_, &topk_log_probs);
 
       Hypotheses hyps;
-      for (auto k : topk) {
+      for (int32_t j = 0; j != static_cast<int32_t>(topk.size()); ++j) {
+        int32_t k = topk[j];
         int32_t hyp_index = k / vocab_size + start;
         int32_t new_token = k % vocab_size;
         Hypothesis new_hyp = prev[hyp_index];
@@ -134,8 +130,7 @@ OfflineTransducerModifiedBeamSearchDecoder::Decode(
         // blank is hardcoded to 0
         // also, it treats unk as blank
         if (new_token != 0 && new_token != unk_id_) {
-          new_hyp.ys.push_back(new_token);
-          new_hyp.timestamps.push_back(t);
+          new_hyp.Append(new_token, t);
           if (context_graphs[i] != nullptr) {
             auto context_res =
                 context_graphs[i]->ForwardOneStep(context_state,
@@ -146,10 +141,9 @@ OfflineTransducerModifiedBeamSearchDecoder::Decode(
           }
         }
 
-        new_hyp.log_prob = p_logprob[k] + context_score;
+        new_hyp.log_prob = topk_log_probs[j] + context_score;
         hyps.Add(std::move(new_hyp));
-      }  // for (auto k : topk)
-      p_logprob += (end - start) * vocab_size;
+      }  // for (int32_t j = 0; j != topk.size(); ++j)
       cur.push_back(std::move(hyps));
     }  // for (int32_t i = 0; i != n; ++i)
 
@@ -184,8 +178,9 @@ OfflineTransducerModifiedBeamSearchDecoder::Decode(
     auto &r = unsorted_ans[packed_encoder_out.sorted_indexes[i]];
 
     // strip leading blanks
-    r.tokens = {hyp.ys.begin() + context_size, hyp.ys.end()};
-    r.timestamps = std::move(hyp.timestamps);
+    r.tokens = hyp.Ys();
+    r.tokens.erase(r.tokens.begin(), r.tokens.begin() + context_size);
+    r.timestamps = hyp.Timestamps();
   }
 
   return unsorted_ans;
@@ -4,7 +4,13 @@
 
 #include "sherpa-onnx/csrc/offline-tts-impl.h"
 
+#include <algorithm>
+#include <condition_variable>  // NOLINT
+#include <exception>
 #include <memory>
+#include <mutex>  // NOLINT
+#include <thread>  // NOLINT
+#include <utility>
 #include <vector>
 
 #if __ANDROID_API__ >= 9
@@ -35,6 +41,159 @@ std::vector<int64_t> OfflineTtsImpl::AddBlank(const std::vector<int64_t> &x,
   return buffer;
 }
 
+GeneratedAudio OfflineTtsImpl::ProcessBatches(
+    int32_t num_sentences, int32_t batch_size, int32_t num_workers,
+    const std::function<GeneratedAudio(int32_t)> &process,
+    GeneratedAudioCallback callback) const {
+  GeneratedAudio ans;
+  ans.sample_rate = SampleRate();
+
+  if (num_sentences <= 0) {
+    return ans;
+  }
+
+  if (batch_size <= 0 || batch_size > num_sentences) {
+    batch_size = num_sentences;
+  }
+
+  int32_t num_batches = (num_sentences + batch_size - 1) / batch_size;
+
+  // If the last batch is not full, the progress is 1 after the last full
+  // batch and stays 1 for the last batch.
+  int32_t num_full_batches = num_sentences / batch_size;
+
+  // Called on the current thread for each batch in order.
+  // Return false to stop.
+  auto on_audio = [&](int32_t b, const GeneratedAudio &audio) -> bool {
+    ans.samples.insert(ans.samples.end(), audio.samples.begin(),
+                       audio.samples.end());
+
+    if (!callback) {
+      return true;
+    }
+
+    // Caution(fangjun): audio is freed when the callback returns, so users
+    // should copy the data if they want to access the data after
+    // the callback returns to avoid segmentation fault.
+    float progress =
+        b < num_full_batches ? (b + 1) * 1.0 / num_full_batches : 1.0;
+    return callback(audio.samples.data(), audio.samples.size(), progress) !=
+           0;
+  };
+
+  num_workers = std::min(num_workers, num_batches);
+
+  if (num_workers <= 1) {
+    for (int32_t b = 0; b != num_batches; ++b) {
+      if (!on_audio(b, process(b))) {
+        break;
+      }
+    }
+
+    return ans;
+  }
+
+  std::mutex mutex;
+  std::condition_variable cond;
+
+  // The following variables are protected by mutex
+  std::vector<GeneratedAudio> results(num_batches);
+  std::vector<bool> done(num_batches, false);
+  int32_t next_batch = 0;
+  int32_t num_consumed = 0;
+  bool stop = false;
+
+  // The first exception thrown by process(). It is rethrown on this thread
+  // after the workers are joined.
+  std::exception_ptr error;
+
+  // Workers do not run ahead of the callback by more than this number of
+  // batches, so memory usage does not grow with the length of the text.
+  int32_t max_ahead = 2 * num_workers;
+
+  auto worker = [&]() {
+    while (true) {
+      int32_t b = 0;
+      {
+        std::unique_lock<std::mutex> lock(mutex);
+        cond.wait(lock, [&]() {
+          return stop || next_batch == num_batches ||
+                 next_batch < num_consumed + max_ahead;
+        });
+
+        if (stop || next_batch == num_batches) {
+          return;
+        }
+
+        b = next_batch++;
+      }
+
+      GeneratedAudio audio;
+      try {
+        audio = process(b);
+      } catch (...) {
+        {
+          std::lock_guard<std::mutex> lock(mutex);
+          if (!error) {
+            error = std::current_exception();
+          }
+          stop = true;
+        }
+        cond.notify_all();
+        return;
+      }
+
+      {
+        std::lock_guard<std::mutex> lock(mutex);
+        results[b] = std::move(audio);
+        done[b] = true;
+      }
+      cond.notify_all();
+    }
+  };
+
+  std::vector<std::thread> threads;
+  threads.reserve(num_workers);
+  for (int32_t i = 0; i != num_workers; ++i) {
+    threads.emplace_back(worker);
+  }
+
+  for (int32_t b = 0; b != num_batches; ++b) {
+    GeneratedAudio audio;
+    {
+      std::unique_lock<std::mutex> lock(mutex);
+      cond.wait(lock, [&]() { return done[b] || error; });
+      if (error) {
+        break;
+      }
+      audio = std::move(results[b]);
+    }
+
+    bool should_continue = on_audio(b, audio);
+
+    {
+      std::lock_guard<std::mutex> lock(mutex);
+      num_consumed = b + 1;
+      stop = !should_continue;
+    }
+    cond.notify_all();
+
+    if (!should_continue) {
+      break;
+    }
+  }
+
+  for (auto &t : threads) {
+    t.join();
+  }
+
+  if (error) {
+    std::rethrow_exception(error);
+  }
+
+  return ans;
+}
+
 std::unique_ptr<OfflineTtsImpl> OfflineTtsImpl::Create(
     const OfflineTtsConfig &config) {
   if (!config.model.vits.model.empty()) {
@@ -5,8 +5,12 @@
 #ifndef SHERPA_ONNX_CSRC_OFFLINE_TTS_IMPL_H_
 #define SHERPA_ONNX_CSRC_OFFLINE_TTS_IMPL_H_
 
+#include <algorithm>
+#include <functional>
+#include <iterator>
 #include <memory>
 #include <string>
+#include <utility>
 #include <vector>
 
 #include "sherpa-onnx/csrc/offline-tts.h"
@@ -36,6 +40,54 @@ class OfflineTtsImpl {
 
   std::vector<int64_t> AddBlank(const std::vector<int64_t> &x,
                                 int32_t blank_id = 0) const;
+
+ protected:
+  // Split v into batches of batch_size items. The last batch may contain
+  // fewer items. If batch_size is not positive, there is a single batch.
+  template <typename T>
+  static std::vector<std::vector<T>> SplitIntoBatches(std::vector<T> v,
+                                                      int32_t batch_size) {
+    int32_t n = static_cast<int32_t>(v.size());
+    if (batch_size <= 0 || batch_size > n) {
+      batch_size = n;
+    }
+
+    std::vector<std::vector<T>> ans;
+    for (int32_t i = 0; i < n; i += batch_size) {
+      int32_t end = std::min(n, i + batch_size);
+      ans.emplace_back(std::make_move_iterator(v.begin() + i),
+                       std::make_move_iterator(v.begin() + end));
+    }
+
+    return ans;
+  }
+
+  /* Generate audio for the batches of SplitIntoBatches(sentences,
+   * batch_size) and concatenate them.
+   *
+   * @param num_sentences Number of sentences.
+   * @param batch_size Number of sentences in a batch. The last batch may
+   *                   contain fewer sentences. If it is not positive,
+   *                   there is a single batch.
+   * @param num_workers If greater than 1, batches are processed on this
+   *                    many threads. While the callback is handling one
+   *                    batch, later batches are being processed, so the
+   *                    frontend output of later sentences goes through the
+   *                    models while earlier audio is consumed.
+   * @param process process(b) returns the audio for the b-th batch. It must
+   *                be safe to call it from several threads at the same time.
+   *                If it throws, the exception is rethrown on the calling
+   *                thread after all threads are joined.
+   * @param callback If not empty, it is called on the calling thread for
+   *                 each batch in order. If it returns 0, no more batches
+   *                 are processed. The progress after the b-th full batch
+   *                 is (b + 1) / num_full_batches. It is 1 after the last
+   *                 batch.
+   */
+  GeneratedAudio ProcessBatches(
+      int32_t num_sentences, int32_t batch_size, int32_t num_workers,
+      const std::function<GeneratedAudio(int32_t)> &process,
+      GeneratedAudioCallback callback) const;
 };
 
 }  // namespace sherpa_onnx
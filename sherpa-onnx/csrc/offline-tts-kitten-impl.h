@@ -256,13 +256,11 @@ class OfflineTtsKittenImpl : public OfflineTtsImpl {
 #endif
     }
 
-    // the input text is too long, we process sentences within it in batches
-    // to avoid OOM. Batch size is config_.max_num_sentences
-    std::vector<std::vector<int64_t>> batch_x;
-
+    // We process one sentence at a time. Sentences can be processed in
+    // parallel if config_.num_workers > 1
     int32_t batch_size = 1;
-    batch_x.reserve(batch_size);
-    int32_t num_batches = x_size / batch_size;
+    auto batch_x = SplitIntoBatches(std::move(x), batch_size);
+    int32_t num_batches = static_cast<int32_t>(batch_x.size());
 
     if (config_.model.debug) {
 #if __OHOS__
@@ -278,52 +276,9 @@ class OfflineTtsKittenImpl : public OfflineTtsImpl {
 #endif
     }
 
-    GeneratedAudio ans;
-
-    int32_t should_continue = 1;
-
-    int32_t k = 0;
-
-    for (int32_t b = 0; b != num_batches && should_continue; ++b) {
-      batch_x.clear();
-      for (int32_t i = 0; i != batch_size; ++i, ++k) {
-        batch_x.push_back(std::move(x[k]));
-      }
-
-      auto audio = Process(batch_x, sid, speed);
-      ans.sample_rate = audio.sample_rate;
-      ans.samples.insert(ans.samples.end(), audio.samples.begin(),
-                         audio.samples.end());
-      if (callback) {
-        should_continue = callback(audio.samples.data(), audio.samples.size(),
-                                   (b + 1) * 1.0 / num_batches);
-        // Caution(fangjun): audio is freed when the callback returns, so users
-        // should copy the data if they want to access the data after
-        // the callback returns to avoid segmentation fault.
-      }
-    }
-
-    batch_x.clear();
-    while (k < static_cast<int32_t>(x.size()) && should_continue) {
-      batch_x.push_back(std::move(x[k]));
-
-      ++k;
-    }
-
-    if (!batch_x.empty()) {
-      auto audio = Process(batch_x, sid, speed);
-      ans.sample_rate = audio.sample_rate;
-      ans.samples.insert(ans.samples.end(), audio.samples.begin(),
-                         audio.samples.end());
-      if (callback) {
-        callback(audio.samples.data(), audio.samples.size(), 1.0);
-        // Caution(fangjun): audio is freed when the callback returns, so users
-        // should copy the data if they want to access the data after
-        // the callback returns to avoid segmentation fault.
-      }
-    }
-
-    return ans;
+    return ProcessBatches(
+        x_size, batch_size, config_.num_workers,
+        [&](int32_t b) { return Process(batch_x[b], sid, speed); }, callback);
   }
 
  private:
@@ -23,6 +23,7 @@
 #include "sherpa-onnx/csrc/offline-tts-matcha-model.h"
 #include "sherpa-onnx/csrc/onnx-utils.h"
 #include "sherpa-onnx/csrc/piper-phonemize-lexicon.h"
+#include "sherpa-onnx/csrc/silence-scaler.h"
 #include "sherpa-onnx/csrc/text-utils.h"
 #include "sherpa-onnx/csrc/vocoder.h"
 
@@ -237,23 +238,14 @@ class OfflineTtsMatchaImpl : public OfflineTtsImpl {
 
     int32_t x_size = static_cast<int32_t>(x.size());
 
-    if (config_.max_num_sentences <= 0 || x_size <= config_.max_num_sentences) {
-      auto ans = Process(x, sid, speed);
-      if (callback) {
-        callback(ans.samples.data(), ans.samples.size(), 1.0);
-      }
-      return ans;
-    }
-
-    // the input text is too long, we process sentences within it in batches
-    // to avoid OOM. Batch size is config_.max_num_sentences
-    std::vector<std::vector<int64_t>> batch_x;
-
+    // If the input text is too long, we process sentences within it in
+    // batches to avoid OOM. Batch size is config_.max_num_sentences.
+    // Batches can be processed in parallel if config_.num_workers > 1
     int32_t batch_size = config_.max_num_sentences;
-    batch_x.reserve(config_.max_num_sentences);
-    int32_t num_batches = x_size / batch_size;
+    auto batch_x = SplitIntoBatches(std::move(x), batch_size);
+    int32_t num_batches = static_cast<int32_t>(batch_x.size());
 
-    if (config_.model.debug) {
+    if (config_.model.debug && num_batches > 1) {
 #if __OHOS__
       SHERPA_ONNX_LOGE(
           "Text is too long. Split it into %{public}d batches. batch size: "
@@ -267,52 +259,13 @@ class OfflineTtsMatchaImpl : public OfflineTtsImpl {
 #endif
     }
 
-    GeneratedAudio ans;
-
-    int32_t should_continue = 1;
-
-    int32_t k = 0;
-
-    for (int32_t b = 0; b != num_batches && should_continue; ++b) {
-      batch_x.clear();
-      for (int32_t i = 0; i != batch_size; ++i, ++k) {
-        batch_x.push_back(std::move(x[k]));
-      }
-
-      auto audio = Process(batch_x, sid, speed);
-      ans.sample_rate = audio.sample_rate;
-      ans.samples.insert(ans.samples.end(), audio.samples.begin(),
-                         audio.samples.end());
-      if (callback) {
-        should_continue = callback(audio.samples.data(), audio.samples.size(),
-                                   (b + 1) * 1.0 / num_batches);
-        // Caution(fangjun): audio is freed when the callback returns, so users
-        // should copy the data if they want to access the data after
-        // the callback returns to avoid segmentation fault.
-      }
-    }
-
-    batch_x.clear();
-    while (k < static_cast<int32_t>(x.size()) && should_continue) {
-      batch_x.push_back(std::move(x[k]));
-
-      ++k;
-    }
-
-    if (!batch_x.empty()) {
-      auto audio = Process(batch_x, sid, speed);
-      ans.sample_rate = audio.sample_rate;
-      ans.samples.insert(ans.samples.end(), audio.samples.begin(),
-                         audio.samples.end());
-      if (callback) {
-        callback(audio.samples.data(), audio.samples.size(), 1.0);
-        // Caution(fangjun): audio is freed when the callback returns, so users
-        // should copy the data if they want to access the data after
-        // the callback returns to avoid segmentation fault.
-      }
+    if (callback && config_.model.matcha.vocoder_chunk_size > 0) {
+      return GenerateStreaming(batch_x, sid, speed, callback);
     }
 
-    return ans;
+    return ProcessBatches(
+        x_size, batch_size, config_.num_workers,
+        [&](int32_t b) { return Process(batch_x[b], sid, speed); }, callback);
   }
 
  private:
@@ -357,8 +310,75 @@ class OfflineTtsMatchaImpl : public OfflineTtsImpl {
     }
   }
 
+  // Batches are processed one by one. The vocoder output of each batch is
+  // passed to the callback chunk by chunk, so the first audio is available
+  // before the whole batch is vocoded. Pauses are scaled per batch, as in
+  // Process(), so the output is the same as that of the non-streaming mode.
+  GeneratedAudio GenerateStreaming(
+      const std::vector<std::vector<std::vector<int64_t>>> &batch_x,
+      int64_t sid, float speed, GeneratedAudioCallback callback) const {
+    GeneratedAudio ans;
+    ans.sample_rate = model_->GetMetaData().sample_rate;
+
+    int32_t num_batches = static_cast<int32_t>(batch_x.size());
+    float silence_scale = config_.silence_scale;
+
+    int32_t should_continue = 1;
+
+    auto emit = [&](std::vector<float> samples, float progress) {
+      if (samples.empty()) {
+        return;
+      }
+
+      ans.samples.insert(ans.samples.end(), samples.begin(), samples.end());
+      should_continue = callback(samples.data(), samples.size(), progress);
+    };
+
+    for (int32_t b = 0; b != num_batches && should_continue; ++b) {
+      Ort::Value mel = RunAcousticModel(batch_x[b], sid, speed);
+
+      SilenceScaler scaler(ans.sample_rate, silence_scale);
+
+      vocoder_->RunChunked(
+          std::move(mel), config_.model.matcha.vocoder_chunk_size,
+          [&](const float *samples, int32_t n, float progress) -> int32_t {
+            float p = (b + progress) / num_batches;
+            if (silence_scale != 1) {
+              emit(scaler.Process(samples, n), p);
+            } else {
+              emit(std::vector<float>(samples, samples + n), p);
+            }
+            return should_continue;
+          });
+
+      if (should_continue && silence_scale != 1) {
+        emit(scaler.Finish(), static_cast<float>(b + 1) / num_batches);
+      }
+    }
+
+    return ans;
+  }
+
   GeneratedAudio Process(const std::vector<std::vector<int64_t>> &tokens,
                          int32_t sid, float speed) const {
+    Ort::Value mel = RunAcousticModel(tokens, sid, speed);
+
+    GeneratedAudio ans;
+
+    ans.samples = vocoder_->Run(std::move(mel));
+    ans.sample_rate = model_->GetMetaData().sample_rate;
+
+    float silence_scale = config_.silence_scale;
+    if (silence_scale != 1) {
+      ans = ans.ScaleSilence(silence_scale);
+    }
+
+    return ans;
+  }
+
+  // Return the mel spectrogram of shape (1, feat_dim, num_frames)
+  Ort::Value RunAcousticModel(const std::vector<std::vector<int64_t>> &tokens,
+                              int32_t sid, float speed) const {
     int32_t num_tokens = 0;
     for (const auto &k : tokens) {
       num_tokens += k.size();
@@ -377,19 +397,7 @@ class OfflineTtsMatchaImpl : public OfflineTtsImpl {
     Ort::Value x_tensor = Ort::Value::CreateTensor(
         memory_info, x.data(), x.size(), x_shape.data(), x_shape.size());
 
-    Ort::Value mel = model_->Run(std::move(x_tensor), sid, speed);
-
-    GeneratedAudio ans;
-
-    ans.samples = vocoder_->Run(std::move(mel));
-    ans.sample_rate = model_->GetMetaData().sample_rate;
-
-    float silence_scale = config_.silence_scale;
-    if (silence_scale != 1) {
-      ans = ans.ScaleSilence(silence_scale);
-    }
-
-    return ans;
+    return model_->Run(std::move(x_tensor), sid, speed);
   }
 
  private:
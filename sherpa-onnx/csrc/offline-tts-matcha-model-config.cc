@@ -29,6 +29,11 @@ void OfflineTtsMatchaModelConfig::Register(ParseOptions *po) {
                "noise_scale for Matcha models");
   po->Register("matcha-length-scale", &length_scale,
                "Speech speed. Larger->Slower; Smaller->faster.");
+  po->Register("matcha-vocoder-chunk-size", &vocoder_chunk_size,
+               "If positive, run the vocoder on chunks of this many mel "
+               "frames so that the first audio is returned before the whole "
+               "sentence is vocoded. Used only when a callback is given. "
+               "0 to disable.");
 }
 
 bool OfflineTtsMatchaModelConfig::Validate() const {
@@ -121,6 +126,12 @@ bool OfflineTtsMatchaModelConfig::Validate() const {
     }
   }
 
+  if (vocoder_chunk_size < 0) {
+    SHERPA_ONNX_LOGE("--matcha-vocoder-chunk-size should be >= 0. Given: %d",
+                     vocoder_chunk_size);
+    return false;
+  }
+
   return true;
 }
 
@@ -135,7 +146,8 @@ std::string OfflineTtsMatchaModelConfig::ToString() const {
   os << "data_dir=\"" << data_dir << "\", ";
   os << "dict_dir=\"" << dict_dir << "\", ";
   os << "noise_scale=" << noise_scale << ", ";
-  os << "length_scale=" << length_scale << ")";
+  os << "length_scale=" << length_scale << ", ";
+  os << "vocoder_chunk_size=" << vocoder_chunk_size << ")";
 
   return os.str();
 }
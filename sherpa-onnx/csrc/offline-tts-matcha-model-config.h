@@ -27,6 +27,12 @@ struct OfflineTtsMatchaModelConfig {
   float noise_scale = 1;
   float length_scale = 1;
 
+  // If positive and a callback is given, the vocoder is run on chunks of
+  // this many mel frames and the audio of each chunk is passed to the
+  // callback as soon as it is ready. If 0, the mel spectrogram of each
+  // batch of sentences is vocoded at once.
+  int32_t vocoder_chunk_size = 0;
+
   OfflineTtsMatchaModelConfig() = default;
 
   OfflineTtsMatchaModelConfig(const std::string &acoustic_model,
@@ -35,7 +41,8 @@ struct OfflineTtsMatchaModelConfig {
                               const std::string &tokens,
                               const std::string &data_dir,
                               const std::string &dict_dir,
-                              float noise_scale = 1.0, float length_scale = 1)
+                              float noise_scale = 1.0, float length_scale = 1,
+                              int32_t vocoder_chunk_size = 0)
       : acoustic_model(acoustic_model),
         vocoder(vocoder),
         lexicon(lexicon),
@@ -43,7 +50,8 @@ struct OfflineTtsMatchaModelConfig {
         data_dir(data_dir),
         dict_dir(dict_dir),
         noise_scale(noise_scale),
-        length_scale(length_scale) {}
+        length_scale(length_scale),
+        vocoder_chunk_size(vocoder_chunk_size) {}
 
   void Register(ParseOptions *po);
   bool Validate() const;
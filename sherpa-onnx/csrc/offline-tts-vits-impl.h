@@ -245,25 +245,15 @@ class OfflineTtsVitsImpl : public OfflineTtsImpl {
 
     int32_t x_size = static_cast<int32_t>(x.size());
 
-    if (config_.max_num_sentences <= 0 || x_size <= config_.max_num_sentences) {
-      auto ans = Process(x, tones, sid, speed);
-      if (callback) {
-        callback(ans.samples.data(), ans.samples.size(), 1.0);
-      }
-      return ans;
-    }
-
-    // the input text is too long, we process sentences within it in batches
-    // to avoid OOM. Batch size is config_.max_num_sentences
-    std::vector<std::vector<int64_t>> batch_x;
-    std::vector<std::vector<int64_t>> batch_tones;
-
+    // If the input text is too long, we process sentences within it in
+    // batches to avoid OOM. Batch size is config_.max_num_sentences.
+    // Batches can be processed in parallel if config_.num_workers > 1
     int32_t batch_size = config_.max_num_sentences;
-    batch_x.reserve(config_.max_num_sentences);
-    batch_tones.reserve(config_.max_num_sentences);
-    int32_t num_batches = x_size / batch_size;
+    auto batch_x = SplitIntoBatches(std::move(x), batch_size);
+    auto batch_tones = SplitIntoBatches(std::move(tones), batch_size);
+    int32_t num_batches = static_cast<int32_t>(batch_x.size());
 
-    if (config_.model.debug) {
+    if (config_.model.debug && num_batches > 1) {
 #if __OHOS__
       SHERPA_ONNX_LOGE(
           "Text is too long. Split it into %{public}d batches. batch size: "
@@ -277,61 +267,16 @@ class OfflineTtsVitsImpl : public OfflineTtsImpl {
 #endif
     }
 
-    GeneratedAudio ans;
-
-    int32_t should_continue = 1;
-
-    int32_t k = 0;
-
-    for (int32_t b = 0; b != num_batches && should_continue; ++b) {
-      batch_x.clear();
-      batch_tones.clear();
-      for (int32_t i = 0; i != batch_size; ++i, ++k) {
-        batch_x.push_back(std::move(x[k]));
-
-        if (!tones.empty()) {
-          batch_tones.push_back(std::move(tones[k]));
-        }
-      }
+    const std::vector<std::vector<int64_t>> no_tones;
 
-      auto audio = Process(batch_x, batch_tones, sid, speed);
-      ans.sample_rate = audio.sample_rate;
-      ans.samples.insert(ans.samples.end(), audio.samples.begin(),
-                         audio.samples.end());
-      if (callback) {
-        should_continue = callback(audio.samples.data(), audio.samples.size(),
-                                   (b + 1) * 1.0 / num_batches);
-        // Caution(fangjun): audio is freed when the callback returns, so users
-        // should copy the data if they want to access the data after
-        // the callback returns to avoid segmentation fault.
-      }
-    }
-
-    batch_x.clear();
-    batch_tones.clear();
-    while (k < static_cast<int32_t>(x.size()) && should_continue) {
-      batch_x.push_back(std::move(x[k]));
-      if (!tones.empty()) {
-        batch_tones.push_back(std::move(tones[k]));
-      }
-
-      ++k;
-    }
-
-    if (!batch_x.empty()) {
-      auto audio = Process(batch_x, batch_tones, sid, speed);
-      ans.sample_rate = audio.sample_rate;
-      ans.samples.insert(ans.samples.end(), audio.samples.begin(),
-                         audio.samples.end());
-      if (callback) {
-        callback(audio.samples.data(), audio.samples.size(), 1.0);
-        // Caution(fangjun): audio is freed when the callback returns, so users
-        // should copy the data if they want to access the data after
-        // the callback returns to avoid segmentation fault.
-      }
-    }
-
-    return ans;
+    return ProcessBatches(
+        x_size, batch_size, config_.num_workers,
+        [&](int32_t b) {
+          return Process(batch_x[b],
+                         batch_tones.empty() ? no_tones : batch_tones[b], sid,
+                         speed);
+        },
+        callback);
   }
 
  private:
@@ -4,9 +4,9 @@
 
 #include "sherpa-onnx/csrc/offline-tts.h"
 
-#include <cmath>
 #include <string>
 #include <utility>
+#include <vector>
 
 #if __ANDROID_API__ >= 9
 #include "android/asset_manager.h"
@@ -20,72 +20,24 @@
 #include "sherpa-onnx/csrc/file-utils.h"
 #include "sherpa-onnx/csrc/macros.h"
 #include "sherpa-onnx/csrc/offline-tts-impl.h"
+#include "sherpa-onnx/csrc/silence-scaler.h"
 #include "sherpa-onnx/csrc/text-utils.h"
 
 namespace sherpa_onnx {
 
-struct SilenceInterval {
-  int32_t start;
-  int32_t end;
-};
-
 GeneratedAudio GeneratedAudio::ScaleSilence(float scale) const {
   if (scale == 1) {
     return *this;
   }
-  // if the interval is larger than 0.2 second, then we assume it is a pause
-  int32_t threshold = static_cast<int32_t>(sample_rate * 0.2);
-
-  std::vector<SilenceInterval> intervals;
-  int32_t num_samples = static_cast<int32_t>(samples.size());
-
-  int32_t last = -1;
-  int32_t i;
-  for (i = 0; i != num_samples; ++i) {
-    if (fabs(samples[i]) <= 0.01) {
-      if (last == -1) {
-        last = i;
-      }
-      continue;
-    }
-
-    if (last != -1 && i - last < threshold) {
-      last = -1;
-      continue;
-    }
-
-    if (last != -1) {
-      intervals.push_back({last, i});
-      last = -1;
-    }
-  }
-
-  if (last != -1 && num_samples - last > threshold) {
-    intervals.push_back({last, num_samples});
-  }
 
-  if (intervals.empty()) {
-    return *this;
-  }
+  SilenceScaler scaler(sample_rate, scale);
 
   GeneratedAudio ans;
   ans.sample_rate = sample_rate;
-  ans.samples.reserve(samples.size());
-
-  i = 0;
-  for (const auto &interval : intervals) {
-    ans.samples.insert(ans.samples.end(), samples.begin() + i,
-                       samples.begin() + interval.start);
-    i = interval.end;
-    int32_t n = static_cast<int32_t>((interval.end - interval.start) * scale);
-
-    ans.samples.insert(ans.samples.end(), samples.begin() + interval.start,
-                       samples.begin() + interval.start + n);
-  }
+  ans.samples = scaler.Process(samples.data(), samples.size());
 
-  if (i < num_samples) {
-    ans.samples.insert(ans.samples.end(), samples.begin() + i, samples.end());
-  }
+  std::vector<float> tail = scaler.Finish();
+  ans.samples.insert(ans.samples.end(), tail.begin(), tail.end());
 
   return ans;
 }
@@ -115,6 +67,11 @@ void OfflineTtsConfig::Register(ParseOptions *po) {
   po->Register("tts-silence-scale", &silence_scale,
                "Duration of the pause is scaled by this number. So a smaller "
                "value leads to a shorter pause.");
+
+  po->Register("tts-num-workers", &num_workers,
+               "Number of threads for generating audio of different batches "
+               "of sentences in parallel. Each of them uses --num-threads "
+               "threads for the models.");
 }
 
 bool OfflineTtsConfig::Validate() const {
@@ -145,6 +102,12 @@ bool OfflineTtsConfig::Validate() const {
     return false;
   }
 
+  if (num_workers < 1) {
+    SHERPA_ONNX_LOGE("--tts-num-workers should be at least 1. Given: %d",
+                     num_workers);
+    return false;
+  }
+
   return model.Validate();
 }
 
@@ -156,7 +119,8 @@ std::string OfflineTtsConfig::ToString() const {
   os << "rule_fsts=\"" << rule_fsts << "\", ";
   os << "rule_fars=\"" << rule_fars << "\", ";
   os << "max_num_sentences=" << max_num_sentences << ", ";
-  os << "silence_scale=" << silence_scale << ")";
+  os << "silence_scale=" << silence_scale << ", ";
+  os << "num_workers=" << num_workers << ")";
 
   return os.str();
 }
@@ -37,15 +37,25 @@ struct OfflineTtsConfig {
   // the duration of the new interval is old_duration * silence_scale.
   float silence_scale = 0.2;
 
+  // Number of threads for generating audio of different batches of
+  // sentences. If it is greater than 1, later sentences are generated
+  // while the callback is handling the audio of earlier sentences.
+  // The callback is still invoked in order on the calling thread.
+  //
+  // Note that each worker runs the models with model.num_threads threads.
+  int32_t num_workers = 1;
+
   OfflineTtsConfig() = default;
   OfflineTtsConfig(const OfflineTtsModelConfig &model,
                    const std::string &rule_fsts, const std::string &rule_fars,
-                   int32_t max_num_sentences, float silence_scale)
+                   int32_t max_num_sentences, float silence_scale,
+                   int32_t num_workers)
       : model(model),
         rule_fsts(rule_fsts),
         rule_fars(rule_fars),
         max_num_sentences(max_num_sentences),
-        silence_scale(silence_scale) {}
+        silence_scale(silence_scale),
+        num_workers(num_workers) {}
 
   void Register(ParseOptions *po);
   bool Validate() const;
@@ -5,8 +5,12 @@
 #include "sherpa-onnx/csrc/offline-websocket-server-impl.h"
 
 #include <algorithm>
+#include <string>
+#include <utility>
+#include <vector>
 
 #include "sherpa-onnx/csrc/macros.h"
+#include "sherpa-onnx/csrc/text-utils.h"
 
 namespace sherpa_onnx {
 
@@ -21,6 +25,17 @@ void OfflineWebsocketDecoderConfig::Register(ParseOptions *po) {
       "Max utterance length in seconds. If we receive an utterance "
       "longer than this value, we will reject the connection. "
       "If you have enough memory, you can select a large value for it.");
+
+  po->Register("bucket-boundaries", &bucket_boundaries,
+               "Comma-separated durations in seconds, e.g., 5,10,20. "
+               "Requests are grouped by duration using these boundaries "
+               "and each batch contains requests from a single group, "
+               "which reduces padding. Leave it empty to use one group.");
+
+  po->Register("max-batch-wait-ms", &max_batch_wait_ms,
+               "If there are fewer than --max-batch-size requests in a "
+               "group, wait at most this number of milliseconds for more "
+               "requests before decoding the group.");
 }
 
 void OfflineWebsocketDecoderConfig::Validate() const {
@@ -39,77 +54,217 @@ void OfflineWebsocketDecoderConfig::Validate() const {
                      max_utterance_length);
     exit(-1);
   }
+
+  std::vector<float> boundaries;
+  if (!SplitStringToFloats(bucket_boundaries, ",", true, &boundaries)) {
+    SHERPA_ONNX_LOGE("Invalid --bucket-boundaries: '%s'",
+                     bucket_boundaries.c_str());
+    exit(-1);
+  }
+
+  for (int32_t i = 0; i != static_cast<int32_t>(boundaries.size()); ++i) {
+    if (boundaries[i] <= 0 || (i > 0 && boundaries[i] <= boundaries[i - 1])) {
+      SHERPA_ONNX_LOGE(
+          "Expect positive and increasing --bucket-boundaries. Given: '%s'",
+          bucket_boundaries.c_str());
+      exit(-1);
+    }
+  }
+
+  if (max_batch_wait_ms < 0) {
+    SHERPA_ONNX_LOGE("Expect --max-batch-wait-ms >= 0. Given: %d",
+                     max_batch_wait_ms);
+    exit(-1);
+  }
 }
 
 OfflineWebsocketDecoder::OfflineWebsocketDecoder(OfflineWebsocketServer *server)
     : config_(server->GetConfig().decoder_config),
       server_(server),
-      recognizer_(config_.recognizer_config) {}
+      recognizer_(config_.recognizer_config) {
+  SplitStringToFloats(config_.bucket_boundaries, ",", true,
+                      &bucket_boundaries_);
+  buckets_.resize(bucket_boundaries_.size() + 1);
+}
 
 void OfflineWebsocketDecoder::Push(connection_hdl hdl, ConnectionDataPtr d) {
-  std::lock_guard<std::mutex> lock(mutex_);
-  streams_.push_back({hdl, d});
+  // Push() is called in the order the requests of a connection are
+  // received, so the index gives the order to send their results back.
+  int64_t index;
+  {
+    std::lock_guard<std::mutex> lock(results_mutex_);
+    index = results_[hdl].num_requests++;
+  }
+
+  // Feature extraction runs in the work threads without holding mutex_,
+  // so that requests are processed in parallel.
+  asio::post(server_->GetWorkContext(), [this, hdl, index, d]() {
+    auto sample_rate = d->sample_rate;
+    auto samples = reinterpret_cast<const float *>(&d->data[0]);
+    int32_t num_samples = d->expected_byte_size / sizeof(float);
+
+    auto s = recognizer_.CreateStream();
+    s->AcceptWaveform(sample_rate, samples, num_samples);
+
+    float duration = static_cast<float>(num_samples) / sample_rate;
+    int32_t b = static_cast<int32_t>(
+        std::upper_bound(bucket_boundaries_.begin(), bucket_boundaries_.end(),
+                         duration) -
+        bucket_boundaries_.begin());
+
+    {
+      std::lock_guard<std::mutex> lock(mutex_);
+      buckets_[b].push_back({hdl, index, std::move(s), Clock::now()});
+    }
+
+    Decode();
+  });
+}
+
+int32_t OfflineWebsocketDecoder::SelectBucket(
+    Clock::time_point now, std::chrono::milliseconds *wait) const {
+  // Among the full buckets, or among all buckets if none is full, select
+  // the one with the oldest request.
+  int32_t oldest = -1;
+  int32_t oldest_full = -1;
+  for (int32_t i = 0; i != static_cast<int32_t>(buckets_.size()); ++i) {
+    const auto &q = buckets_[i];
+    if (q.empty()) {
+      continue;
+    }
+
+    if (oldest == -1 ||
+        q.front().arrival_time < buckets_[oldest].front().arrival_time) {
+      oldest = i;
+    }
+
+    if (static_cast<int32_t>(q.size()) >= config_.max_batch_size &&
+        (oldest_full == -1 || q.front().arrival_time <
+                                  buckets_[oldest_full].front().arrival_time)) {
+      oldest_full = i;
+    }
+  }
+
+  if (oldest_full != -1) {
+    return oldest_full;
+  }
+
+  if (oldest == -1) {
+    *wait = std::chrono::milliseconds(0);
+    return -1;
+  }
+
+  auto waited = std::chrono::duration_cast<std::chrono::milliseconds>(
+      now - buckets_[oldest].front().arrival_time);
+  auto max_wait = std::chrono::milliseconds(config_.max_batch_wait_ms);
+  if (waited >= max_wait) {
+    return oldest;
+  }
+
+  *wait = max_wait - waited;
+  return -1;
+}
+
+void OfflineWebsocketDecoder::DecodeAfter(std::chrono::milliseconds wait) {
+  auto timer =
+      std::make_shared<asio::steady_timer>(server_->GetWorkContext(), wait);
+  timer->async_wait([this, timer](const asio::error_code & /*ec*/) {
+    {
+      std::lock_guard<std::mutex> lock(mutex_);
+      timer_pending_ = false;
+    }
+    Decode();
+  });
 }
 
 void OfflineWebsocketDecoder::Decode() {
   std::unique_lock<std::mutex> lock(mutex_);
-  if (streams_.empty()) {
+
+  std::chrono::milliseconds wait(0);
+  int32_t b = SelectBucket(Clock::now(), &wait);
+  if (b == -1) {
+    if (wait.count() > 0 && !timer_pending_) {
+      timer_pending_ = true;
+      lock.unlock();
+      DecodeAfter(wait);
+    }
     return;
   }
 
+  auto &q = buckets_[b];
   int32_t size =
-      std::min(static_cast<int32_t>(streams_.size()), config_.max_batch_size);
-  SHERPA_ONNX_LOGE("size: %d", size);
+      std::min(static_cast<int32_t>(q.size()), config_.max_batch_size);
+  SHERPA_ONNX_LOGE("size: %d, bucket: %d", size, b);
 
-  // We first lock the mutex for streams_, take items from it, and then
+  // We first lock the mutex for buckets_, take items from it, and then
   // unlock the mutex; in doing so we don't need to lock the mutex to
-  // access hdl and connection_data later.
-  std::vector<connection_hdl> handles(size);
-
-  // Store connection_data here to prevent the data from being freed
-  // while we are still using it.
-  std::vector<ConnectionDataPtr> connection_data(size);
+  // access hdl and the streams later.
+  std::vector<Request> requests;
+  requests.reserve(size);
+  for (int32_t i = 0; i != size; ++i) {
+    requests.push_back(std::move(q.front()));
+    q.pop_front();
+  }
 
-  std::vector<const float *> samples(size);
-  std::vector<int32_t> samples_length(size);
-  std::vector<std::unique_ptr<OfflineStream>> ss(size);
-  std::vector<OfflineStream *> p_ss(size);
+  bool has_more =
+      std::any_of(buckets_.begin(), buckets_.end(),
+                  [](const auto &bucket) { return !bucket.empty(); });
 
-  for (int32_t i = 0; i != size; ++i) {
-    auto &p = streams_.front();
-    handles[i] = p.first;
-    connection_data[i] = p.second;
-    streams_.pop_front();
-
-    auto sample_rate = connection_data[i]->sample_rate;
-    auto samples =
-        reinterpret_cast<const float *>(&connection_data[i]->data[0]);
-    auto num_samples = connection_data[i]->expected_byte_size / sizeof(float);
-    auto s = recognizer_.CreateStream();
-    s->AcceptWaveform(sample_rate, samples, num_samples);
+  lock.unlock();
 
-    ss[i] = std::move(s);
-    p_ss[i] = ss[i].get();
+  if (has_more) {
+    // Other buckets may be ready, too. If not, the next call schedules a
+    // timer for them.
+    asio::post(server_->GetWorkContext(), [this]() { Decode(); });
   }
 
-  lock.unlock();
+  std::vector<OfflineStream *> p_ss(size);
+  for (int32_t i = 0; i != size; ++i) {
+    p_ss[i] = requests[i].stream.get();
+  }
 
   // Note: DecodeStreams is thread-safe
   recognizer_.DecodeStreams(p_ss.data(), size);
 
   for (int32_t i = 0; i != size; ++i) {
-    connection_hdl hdl = handles[i];
+    connection_hdl hdl = requests[i].hdl;
+    std::string text = requests[i].stream->GetResult().AsJsonString();
+    {
+      std::lock_guard<std::mutex> lock(results_mutex_);
+      results_[hdl].pending.emplace(requests[i].index, std::move(text));
+    }
+
     asio::post(server_->GetConnectionContext(),
-               [this, hdl, result = ss[i]->GetResult()]() {
-                 websocketpp::lib::error_code ec;
-                 server_->GetServer().send(hdl, result.AsJsonString(),
-                                           websocketpp::frame::opcode::text,
-                                           ec);
-                 if (ec) {
-                   server_->GetServer().get_alog().write(
-                       websocketpp::log::alevel::app, ec.message());
-                 }
-               });
+               [this, hdl]() { SendResults(hdl); });
+  }
+}
+
+void OfflineWebsocketDecoder::SendResults(connection_hdl hdl) {
+  // Results are sent while holding the mutex so that they are sent in
+  // order even if several connection threads run this function.
+  std::lock_guard<std::mutex> lock(results_mutex_);
+  auto it = results_.find(hdl);
+  if (it == results_.end()) {
+    // They have been sent by a previous call
+    return;
+  }
+
+  auto &r = it->second;
+  while (!r.pending.empty() && r.pending.begin()->first == r.num_sent) {
+    websocketpp::lib::error_code ec;
+    server_->GetServer().send(hdl, r.pending.begin()->second,
+                              websocketpp::frame::opcode::text, ec);
+    if (ec) {
+      server_->GetServer().get_alog().write(websocketpp::log::alevel::app,
+                                            ec.message());
+    }
+
+    r.pending.erase(r.pending.begin());
+    ++r.num_sent;
+  }
+
+  if (r.num_sent == r.num_requests) {
+    results_.erase(it);
   }
 }
 
@@ -247,8 +402,6 @@ void OfflineWebsocketServer::OnMessage(connection_hdl hdl,
         decoder_.Push(hdl, d);
 
         connection_data->Clear();
-
-        asio::post(io_work_, [this]() { decoder_.Decode(); });
       }
       break;
     }
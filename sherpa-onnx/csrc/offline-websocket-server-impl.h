@@ -5,10 +5,12 @@
 #ifndef SHERPA_ONNX_CSRC_OFFLINE_WEBSOCKET_SERVER_IMPL_H_
 #define SHERPA_ONNX_CSRC_OFFLINE_WEBSOCKET_SERVER_IMPL_H_
 
+#include <chrono>  // NOLINT
 #include <deque>
 #include <fstream>
 #include <map>
 #include <memory>
+#include <mutex>  // NOLINT
 #include <string>
 #include <utility>
 #include <vector>
@@ -69,6 +71,16 @@ struct OfflineWebsocketDecoderConfig {
 
   float max_utterance_length = 300;  // seconds
 
+  // Comma-separated durations in seconds. Requests are put into buckets
+  // by duration using these boundaries, and a batch contains requests
+  // from a single bucket only, so that short utterances are not padded
+  // to the length of long ones.
+  std::string bucket_boundaries = "5,10,20,40,80";
+
+  // If a bucket is not full, its oldest request waits at most this long
+  // for more requests before the bucket is decoded.
+  int32_t max_batch_wait_ms = 10;
+
   void Register(ParseOptions *po);
   void Validate() const;
 };
@@ -83,7 +95,8 @@ class OfflineWebsocketDecoder {
    */
   explicit OfflineWebsocketDecoder(OfflineWebsocketServer *server);
 
-  /** Insert received data to the queue for decoding.
+  /** Compute features of the received data in one of the work threads
+   * and insert it to the queue for decoding.
    *
    * @param hdl A handle to the connection. We can use it to send the result
    *            back to the client once it finishes decoding.
@@ -97,19 +110,71 @@ class OfflineWebsocketDecoder {
 
   const OfflineWebsocketDecoderConfig &GetConfig() const { return config_; }
 
+ private:
+  using Clock = std::chrono::steady_clock;
+
+  struct Request {
+    connection_hdl hdl;
+
+    // Index of this request among the requests of the connection
+    int64_t index;
+
+    std::unique_ptr<OfflineStream> stream;
+    Clock::time_point arrival_time;
+  };
+
+  // Requests are decoded out of order since they are put into buckets by
+  // duration and their features are computed in parallel. Results of a
+  // connection wait here until the results of all earlier requests of the
+  // connection have been sent.
+  struct ConnectionResults {
+    // Number of requests pushed so far
+    int64_t num_requests = 0;
+
+    // Number of results sent so far
+    int64_t num_sent = 0;
+
+    // Results not sent yet, keyed by Request::index
+    std::map<int64_t, std::string> pending;
+  };
+
+  // Return the bucket to decode, or -1 if no bucket is ready yet. In the
+  // latter case, wait is set to how long to wait for the oldest request.
+  // The caller should hold mutex_.
+  int32_t SelectBucket(Clock::time_point now,
+                       std::chrono::milliseconds *wait) const;
+
+  // Call Decode() after the given time
+  void DecodeAfter(std::chrono::milliseconds wait);
+
+  // Send pending results of the given connection that are next in order.
+  // It is called in the connection threads.
+  void SendResults(connection_hdl hdl);
+
  private:
   OfflineWebsocketDecoderConfig config_;
 
-  /** When we have received all the data from the client, we put it into
-   * this queue; the worker threads will get items from this queue for
-   * decoding.
+  // Parsed from config_.bucket_boundaries
+  std::vector<float> bucket_boundaries_;
+
+  /** When we have received all the data from the client and computed its
+   * features, we put it into one of these queues by its duration; the
+   * worker threads will get items from these queues for decoding.
    *
-   * Number of items to take from this queue is determined by
-   * `--max-batch-size`. If there are not enough items in the queue, we won't
-   * wait and take whatever we have for decoding.
+   * Number of items to take from a queue is determined by
+   * `--max-batch-size`. If there are not enough items in the queue, we
+   * wait at most `--max-batch-wait-ms` for more requests.
    */
   std::mutex mutex_;
-  std::deque<std::pair<connection_hdl, ConnectionDataPtr>> streams_;
+  std::vector<std::deque<Request>> buckets_;
+
+  // True if a timer for Decode() is pending
+  bool timer_pending_ = false;
+
+  // Connections with requests whose results have not been sent yet
+  std::mutex results_mutex_;
+  std::map<connection_hdl, ConnectionResults, std::owner_less<connection_hdl>>
+      results_;
 
   OfflineWebsocketServer *server_;  // Not owned
   OfflineRecognizer recognizer_;
@@ -130,6 +195,7 @@ class OfflineWebsocketServer {
                          const OfflineWebsocketServerConfig &config);
 
   asio::io_context &GetConnectionContext() { return io_conn_; }
+  asio::io_context &GetWorkContext() { return io_work_; }
   server &GetServer() { return server_; }
 
   void Run(uint16_t port);
@@ -36,6 +36,11 @@ Usage:
   --log-file=./log.txt \
   --max-batch-size=5
 
+A client can send several audio files over one connection. They may be
+decoded in a different order, e.g., a short file after a long one may be
+decoded first, but results are always sent back in the order the files
+are received.
+
 Please refer to
 https://k2-fsa.github.io/sherpa/onnx/pretrained_models/index.html
 for a list of pre-trained models to download.
@@ -18,12 +18,14 @@ void OfflineWhisperGreedySearchDecoder::SetConfig(
 }
 
 std::vector<OfflineWhisperDecoderResult>
-OfflineWhisperGreedySearchDecoder::Decode(Ort::Value cross_k,
-                                          Ort::Value cross_v,
-                                          int32_t num_feature_frames) {
+OfflineWhisperGreedySearchDecoder::Decode(
+    Ort::Value cross_k, Ort::Value cross_v,
+    const std::vector<int32_t> &num_feature_frames) {
   auto memory_info =
       Ort::MemoryInfo::CreateCpu(OrtDeviceAllocator, OrtMemTypeDefault);
 
+  int32_t batch_size = num_feature_frames.size();
+
   // For multilingual models, initial_tokens contains [sot, language, task]
   //   - language is English by default
   //   - task is transcribe by default
@@ -31,6 +33,9 @@ OfflineWhisperGreedySearchDecoder::Decode(Ort::Value cross_k,
   // For non-multilingual models, initial_tokens contains [sot]
   std::vector<int64_t> initial_tokens = model_->GetInitialTokens();
 
+  // language ID of each utterance. Used only for multilingual models
+  std::vector<int32_t> lang_ids;
+
   if (model_->IsMultiLingual()) {
     if (!config_.language.empty()) {
       const auto &lang2id = model_->GetLang2ID();
@@ -40,15 +45,9 @@ OfflineWhisperGreedySearchDecoder::Decode(Ort::Value cross_k,
         exit(-1);
       }
 
-      int32_t lang_id = lang2id.at(config_.language);
-
-      // 0: sot, 1: lang_id, 2: task, 3: no_timestamps
-      initial_tokens[1] = lang_id;
+      lang_ids.assign(batch_size, lang2id.at(config_.language));
     } else {
-      int32_t lang_id = model_->DetectLanguage(cross_k, cross_v);
-
-      // 0: sot, 1: lang_id, 2: task, 3: no_timestamps
-      initial_tokens[1] = lang_id;
+      lang_ids = model_->DetectLanguages(cross_k, cross_v);
     }
 
     if (config_.task == "translate") {
@@ -63,12 +62,26 @@ OfflineWhisperGreedySearchDecoder::Decode(Ort::Value cross_k,
 
   initial_tokens.push_back(model_->NoTimeStampsToken());
 
-  int32_t batch_size = 1;
-  std::array<int64_t, 2> token_shape{
-      batch_size, static_cast<int64_t>(initial_tokens.size())};
+  int32_t num_initial_tokens = initial_tokens.size();
+
+  // All utterances share the same number of initial tokens, so a single
+  // offset into the self kv cache is valid for every row of the batch.
+  std::vector<int64_t> batch_initial_tokens;
+  batch_initial_tokens.reserve(batch_size * num_initial_tokens);
+  for (int32_t b = 0; b != batch_size; ++b) {
+    batch_initial_tokens.insert(batch_initial_tokens.end(),
+                                initial_tokens.begin(), initial_tokens.end());
+
+    if (!lang_ids.empty()) {
+      // 0: sot, 1: lang_id, 2: task, 3: no_timestamps
+      batch_initial_tokens[b * num_initial_tokens + 1] = lang_ids[b];
+    }
+  }
+
+  std::array<int64_t, 2> token_shape{batch_size, num_initial_tokens};
 
   Ort::Value tokens = Ort::Value::CreateTensor(
-      memory_info, initial_tokens.data(), initial_tokens.size(),
+      memory_info, batch_initial_tokens.data(), batch_initial_tokens.size(),
       token_shape.data(), token_shape.size());
 
   std::array<int64_t, 1> offset_shape{1};
@@ -76,7 +89,7 @@ OfflineWhisperGreedySearchDecoder::Decode(Ort::Value cross_k,
       model_->Allocator(), offset_shape.data(), offset_shape.size());
   *(offset.GetTensorMutableData<int64_t>()) = 0;
 
-  auto self_kv_cache = model_->GetInitialSelfKVCache();
+  auto self_kv_cache = model_->GetInitialSelfKVCache(batch_size);
 
   auto decoder_out = model_->ForwardDecoder(
       std::move(tokens), std::move(self_kv_cache.first),
@@ -84,7 +97,7 @@ OfflineWhisperGreedySearchDecoder::Decode(Ort::Value cross_k,
       std::move(offset));
 
   *(std::get<5>(decoder_out).GetTensorMutableData<int64_t>()) =
-      initial_tokens.size();
+      num_initial_tokens;
 
   const auto &logits = std::get<0>(decoder_out);
   const float *p_logits = logits.GetTensorData<float>();
@@ -92,32 +105,64 @@ OfflineWhisperGreedySearchDecoder::Decode(Ort::Value cross_k,
   auto logits_shape = logits.GetTensorTypeAndShapeInfo().GetShape();
   int32_t vocab_size = logits_shape[2];
 
-  const float *p_start = p_logits + (logits_shape[1] - 1) * vocab_size;
+  std::vector<int64_t> max_token_ids(batch_size);
+  for (int32_t b = 0; b != batch_size; ++b) {
+    const float *p_start =
+        p_logits + (b * logits_shape[1] + logits_shape[1] - 1) * vocab_size;
 
-  int32_t max_token_id = static_cast<int32_t>(
-      std::distance(p_start, std::max_element(p_start, p_start + vocab_size)));
+    max_token_ids[b] = std::distance(
+        p_start, std::max_element(p_start, p_start + vocab_size));
+  }
 
   int32_t n_text_ctx = model_->TextCtx();
+  int32_t eot = model_->EOT();
+
+  std::vector<OfflineWhisperDecoderResult> ans(batch_size);
 
-  std::vector<int32_t> predicted_tokens;
+  // num_possible_tokens[b] is the maximum number of tokens for utterance b
+  std::vector<int32_t> num_possible_tokens(batch_size);
+  for (int32_t b = 0; b != batch_size; ++b) {
+    // assume at most 6 tokens per second
+    num_possible_tokens[b] = std::min<int32_t>(
+        num_feature_frames[b] / 100.0 * 6, n_text_ctx / 2);
+  }
 
-  // assume at most 6 tokens per second
-  int32_t num_possible_tokens = num_feature_frames / 100.0 * 6;
-  num_possible_tokens = std::min<int32_t>(num_possible_tokens, n_text_ctx / 2);
+  // Rows that have finished decoding keep feeding eot to the decoder so
+  // that the remaining rows can continue in lockstep. Their outputs are
+  // ignored.
+  std::vector<bool> done(batch_size, false);
+  int32_t num_done = 0;
 
-  for (int32_t i = 0; i < num_possible_tokens; ++i) {
-    if (max_token_id == model_->EOT()) {
-      break;
+  std::array<int64_t, 2> step_token_shape{batch_size, 1};
+
+  while (true) {
+    for (int32_t b = 0; b != batch_size; ++b) {
+      if (done[b]) {
+        continue;
+      }
+
+      if (max_token_ids[b] == eot ||
+          static_cast<int32_t>(ans[b].tokens.size()) >=
+              num_possible_tokens[b]) {
+        done[b] = true;
+        ++num_done;
+        continue;
+      }
+
+      ans[b].tokens.push_back(max_token_ids[b]);
     }
 
-    predicted_tokens.push_back(max_token_id);
+    if (num_done == batch_size) {
+      break;
+    }
 
-    std::array<int64_t, 2> token_shape{1, 1};
     Ort::Value tokens = Ort::Value::CreateTensor<int64_t>(
-        model_->Allocator(), token_shape.data(), token_shape.size());
+        model_->Allocator(), step_token_shape.data(), step_token_shape.size());
 
     int64_t *p_tokens = tokens.GetTensorMutableData<int64_t>();
-    p_tokens[0] = max_token_id;
+    for (int32_t b = 0; b != batch_size; ++b) {
+      p_tokens[b] = done[b] ? eot : max_token_ids[b];
+    }
 
     decoder_out = model_->ForwardDecoder(std::move(tokens),
                                          std::move(std::get<1>(decoder_out)),
@@ -137,21 +182,26 @@ OfflineWhisperGreedySearchDecoder::Decode(Ort::Value cross_k,
     const auto &logits = std::get<0>(decoder_out);
     const float *p_logits = logits.GetTensorData<float>();
 
-    max_token_id = static_cast<int64_t>(std::distance(
-        p_logits, std::max_element(p_logits, p_logits + vocab_size)));
-  }
+    for (int32_t b = 0; b != batch_size; ++b, p_logits += vocab_size) {
+      if (done[b]) {
+        continue;
+      }
 
-  std::vector<OfflineWhisperDecoderResult> ans(1);
+      max_token_ids[b] = std::distance(
+          p_logits, std::max_element(p_logits, p_logits + vocab_size));
+    }
+  }
 
   const auto &id2lang = model_->GetID2Lang();
-  if (id2lang.count(initial_tokens[1])) {
-    ans[0].lang = id2lang.at(initial_tokens[1]);
-  } else {
-    ans[0].lang = "";
+  for (int32_t b = 0; b != batch_size; ++b) {
+    int32_t lang_id = batch_initial_tokens[b * num_initial_tokens + 1];
+    if (id2lang.count(lang_id)) {
+      ans[b].lang = id2lang.at(lang_id);
+    } else {
+      ans[b].lang = "";
+    }
   }
 
-  ans[0].tokens = std::move(predicted_tokens);
-
   return ans;
 }
 
@@ -30,6 +30,7 @@
 #include "sherpa-onnx/csrc/macros.h"
 #include "sherpa-onnx/csrc/online-transducer-decoder.h"
 #include "sherpa-onnx/csrc/onnx-utils.h"
+#include "sherpa-onnx/csrc/session-registry.h"
 #include "sherpa-onnx/csrc/session.h"
 #include "sherpa-onnx/csrc/text-utils.h"
 #include "sherpa-onnx/csrc/unbind.h"
@@ -39,9 +40,9 @@ namespace sherpa_onnx {
 OnlineEbranchformerTransducerModel::OnlineEbranchformerTransducerModel(
     const OnlineModelConfig &config)
     : env_(ORT_LOGGING_LEVEL_ERROR),
-      encoder_sess_opts_(GetSessionOptions(config)),
-      decoder_sess_opts_(GetSessionOptions(config, "decoder")),
-      joiner_sess_opts_(GetSessionOptions(config, "joiner")),
+      encoder_sess_opts_(GetSessionOptionsWithKey(config)),
+      decoder_sess_opts_(GetSessionOptionsWithKey(config, "decoder")),
+      joiner_sess_opts_(GetSessionOptionsWithKey(config, "joiner")),
       config_(config),
       allocator_{} {
   {
@@ -65,9 +66,9 @@ OnlineEbranchformerTransducerModel::OnlineEbranchformerTransducerModel(
     Manager *mgr, const OnlineModelConfig &config)
     : env_(ORT_LOGGING_LEVEL_ERROR),
       config_(config),
-      encoder_sess_opts_(GetSessionOptions(config)),
-      decoder_sess_opts_(GetSessionOptions(config)),
-      joiner_sess_opts_(GetSessionOptions(config)),
+      encoder_sess_opts_(GetSessionOptionsWithKey(config)),
+      decoder_sess_opts_(GetSessionOptionsWithKey(config)),
+      joiner_sess_opts_(GetSessionOptionsWithKey(config)),
       allocator_{} {
   {
     auto buf = ReadFile(mgr, config.transducer.encoder);
@@ -87,8 +88,8 @@ OnlineEbranchformerTransducerModel::OnlineEbranchformerTransducerModel(
 
 void OnlineEbranchformerTransducerModel::InitEncoder(void *model_data,
                                                      size_t model_data_length) {
-  encoder_sess_ = std::make_unique<Ort::Session>(
-      env_, model_data, model_data_length, encoder_sess_opts_);
+  encoder_sess_ = GetOrCreateSession(env_, model_data, model_data_length,
+                                     encoder_sess_opts_);
 
   GetInputNames(encoder_sess_.get(), &encoder_input_names_,
                 &encoder_input_names_ptr_);
@@ -154,8 +155,8 @@ void OnlineEbranchformerTransducerModel::InitEncoder(void *model_data,
 
 void OnlineEbranchformerTransducerModel::InitDecoder(void *model_data,
                                                      size_t model_data_length) {
-  decoder_sess_ = std::make_unique<Ort::Session>(
-      env_, model_data, model_data_length, decoder_sess_opts_);
+  decoder_sess_ = GetOrCreateSession(env_, model_data, model_data_length,
+                                     decoder_sess_opts_);
 
   GetInputNames(decoder_sess_.get(), &decoder_input_names_,
                 &decoder_input_names_ptr_);
@@ -179,8 +180,8 @@ void OnlineEbranchformerTransducerModel::InitDecoder(void *model_data,
 
 void OnlineEbranchformerTransducerModel::InitJoiner(void *model_data,
                                                     size_t model_data_length) {
-  joiner_sess_ = std::make_unique<Ort::Session>(
-      env_, model_data, model_data_length, joiner_sess_opts_);
+  joiner_sess_ = GetOrCreateSession(env_, model_data, model_data_length,
+                                    joiner_sess_opts_);
 
   GetInputNames(joiner_sess_.get(), &joiner_input_names_,
                 &joiner_input_names_ptr_);
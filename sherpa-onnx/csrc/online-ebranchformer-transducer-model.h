@@ -13,6 +13,7 @@
 #include "onnxruntime_cxx_api.h"  // NOLINT
 #include "sherpa-onnx/csrc/online-model-config.h"
 #include "sherpa-onnx/csrc/online-transducer-model.h"
+#include "sherpa-onnx/csrc/session.h"
 
 namespace sherpa_onnx {
 
@@ -60,15 +61,15 @@ class OnlineEbranchformerTransducerModel : public OnlineTransducerModel {
 
  private:
   Ort::Env env_;
-  Ort::SessionOptions encoder_sess_opts_;
-  Ort::SessionOptions decoder_sess_opts_;
-  Ort::SessionOptions joiner_sess_opts_;
+  SessionOptionsWithKey encoder_sess_opts_;
+  SessionOptionsWithKey decoder_sess_opts_;
+  SessionOptionsWithKey joiner_sess_opts_;
 
   Ort::AllocatorWithDefaultOptions allocator_;
 
-  std::unique_ptr<Ort::Session> encoder_sess_;
-  std::unique_ptr<Ort::Session> decoder_sess_;
-  std::unique_ptr<Ort::Session> joiner_sess_;
+  std::shared_ptr<Ort::Session> encoder_sess_;
+  std::shared_ptr<Ort::Session> decoder_sess_;
+  std::shared_ptr<Ort::Session> joiner_sess_;
 
   std::vector<std::string> encoder_input_names_;
   std::vector<const char *> encoder_input_names_ptr_;
@@ -24,6 +24,9 @@ void OnlineLMConfig::Register(ParseOptions *po) {
   po->Register("lodr-scale", &lodr_scale, "LODR scale.");
   po->Register("lodr-backoff-id", &lodr_backoff_id,
                "ID of the backoff in the LODR FST. -1 means autodetect");
+  po->Register("lm-cache-size", &lm_cache_size,
+               "Number of LM states to cache for shallow fusion. Hypotheses "
+               "with the same tokens share a cached state. 0 to disable it");
 }
 
 bool OnlineLMConfig::Validate() const {
@@ -37,6 +40,12 @@ bool OnlineLMConfig::Validate() const {
     return false;
   }
 
+  if (lm_cache_size < 0) {
+    SHERPA_ONNX_LOGE("lm_cache_size should be >= 0. Given: %d",
+                     lm_cache_size);
+    return false;
+  }
+
   return true;
 }
 
@@ -49,6 +58,7 @@ std::string OnlineLMConfig::ToString() const {
   os << "lodr_scale=" << lodr_scale << ", ";
   os << "lodr_fst=\"" << lodr_fst << "\", ";
   os << "lodr_backoff_id=" << lodr_backoff_id << ", ";
+  os << "lm_cache_size=" << lm_cache_size << ", ";
   os << "shallow_fusion=" << (shallow_fusion ? "True" : "False") << ")";
 
   return os.str();
@@ -24,12 +24,17 @@ struct OnlineLMConfig {
   // enable shallow fusion
   bool shallow_fusion = true;
 
+  // Number of LM states cached for shallow fusion. Hypotheses with the
+  // same token sequence reuse a cached state instead of running the LM.
+  // 0 disables the cache.
+  int32_t lm_cache_size = 1024;
+
   OnlineLMConfig() = default;
 
   OnlineLMConfig(const std::string &model, float scale, int32_t lm_num_threads,
                  const std::string &lm_provider, bool shallow_fusion,
                  const std::string &lodr_fst, float lodr_scale,
-                 int32_t lodr_backoff_id)
+                 int32_t lodr_backoff_id, int32_t lm_cache_size = 1024)
       : model(model),
         scale(scale),
         lm_num_threads(lm_num_threads),
@@ -37,7 +42,8 @@ struct OnlineLMConfig {
         shallow_fusion(shallow_fusion),
         lodr_fst(lodr_fst),
         lodr_scale(lodr_scale),
-        lodr_backoff_id(lodr_backoff_id) {}
+        lodr_backoff_id(lodr_backoff_id),
+        lm_cache_size(lm_cache_size) {}
 
   void Register(ParseOptions *po);
   bool Validate() const;
@@ -56,6 +56,20 @@ class OnlineLM {
    *
    */
   virtual void ComputeLMScoreSF(float scale, Hypothesis *hyp) = 0;
+
+  /** Same as ComputeLMScoreSF() above, but for all hypotheses that are
+   * extended by a token in the current frame. Implementations may score
+   * them with a single batched run of the LM.
+   *
+   * @param scale LM score
+   * @param hyps They are changed in-place.
+   */
+  virtual void ComputeLMScoreSF(float scale,
+                                const std::vector<Hypothesis *> &hyps) {
+    for (auto hyp : hyps) {
+      ComputeLMScoreSF(scale, hyp);
+    }
+  }
 };
 
 }  // namespace sherpa_onnx
@@ -26,6 +26,7 @@
 #include "sherpa-onnx/csrc/macros.h"
 #include "sherpa-onnx/csrc/online-transducer-decoder.h"
 #include "sherpa-onnx/csrc/onnx-utils.h"
+#include "sherpa-onnx/csrc/session-registry.h"
 #include "sherpa-onnx/csrc/session.h"
 #include "sherpa-onnx/csrc/unbind.h"
 
@@ -35,7 +36,7 @@ OnlineLstmTransducerModel::OnlineLstmTransducerModel(
     const OnlineModelConfig &config)
     : env_(ORT_LOGGING_LEVEL_ERROR),
       config_(config),
-      sess_opts_(GetSessionOptions(config)),
+      sess_opts_(GetSessionOptionsWithKey(config)),
       allocator_{} {
   {
     auto buf = ReadFile(config.transducer.encoder);
@@ -58,7 +59,7 @@ OnlineLstmTransducerModel::OnlineLstmTransducerModel(
     Manager *mgr, const OnlineModelConfig &config)
     : env_(ORT_LOGGING_LEVEL_ERROR),
       config_(config),
-      sess_opts_(GetSessionOptions(config)),
+      sess_opts_(GetSessionOptionsWithKey(config)),
       allocator_{} {
   {
     auto buf = ReadFile(mgr, config.transducer.encoder);
@@ -78,8 +79,8 @@ OnlineLstmTransducerModel::OnlineLstmTransducerModel(
 
 void OnlineLstmTransducerModel::InitEncoder(void *model_data,
                                             size_t model_data_length) {
-  encoder_sess_ = std::make_unique<Ort::Session>(env_, model_data,
-                                                 model_data_length, sess_opts_);
+  encoder_sess_ = GetOrCreateSession(env_, model_data, model_data_length,
+                                     sess_opts_);
 
   GetInputNames(encoder_sess_.get(), &encoder_input_names_,
                 &encoder_input_names_ptr_);
@@ -110,8 +111,8 @@ void OnlineLstmTransducerModel::InitEncoder(void *model_data,
 
 void OnlineLstmTransducerModel::InitDecoder(void *model_data,
                                             size_t model_data_length) {
-  decoder_sess_ = std::make_unique<Ort::Session>(env_, model_data,
-                                                 model_data_length, sess_opts_);
+  decoder_sess_ = GetOrCreateSession(env_, model_data, model_data_length,
+                                     sess_opts_);
 
   GetInputNames(decoder_sess_.get(), &decoder_input_names_,
                 &decoder_input_names_ptr_);
@@ -135,8 +136,8 @@ void OnlineLstmTransducerModel::InitDecoder(void *model_data,
 
 void OnlineLstmTransducerModel::InitJoiner(void *model_data,
                                            size_t model_data_length) {
-  joiner_sess_ = std::make_unique<Ort::Session>(env_, model_data,
-                                                model_data_length, sess_opts_);
+  joiner_sess_ = GetOrCreateSession(env_, model_data, model_data_length,
+                                    sess_opts_);
 
   GetInputNames(joiner_sess_.get(), &joiner_input_names_,
                 &joiner_input_names_ptr_);
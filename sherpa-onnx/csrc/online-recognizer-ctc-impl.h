@@ -154,19 +154,16 @@ class OnlineRecognizerCtcImpl : public OnlineRecognizerImpl {
 
     for (int32_t i = 0; i != n; ++i) {
       const auto num_processed_frames = ss[i]->GetNumProcessedFrames();
-      std::vector<float> features =
-          ss[i]->GetFrames(num_processed_frames, chunk_length);
+      float *features = features_vec.data() + i * chunk_length * feat_dim;
+      ss[i]->GetFrames(num_processed_frames, chunk_length, features);
       if (config_.feat_config.is_whisper) {
-        OfflineWhisperModel::NormalizeFeatures(features.data(), chunk_length,
+        OfflineWhisperModel::NormalizeFeatures(features, chunk_length,
                                                feat_dim);
       }
 
       // Question: should num_processed_frames include chunk_shift?
       ss[i]->GetNumProcessedFrames() += chunk_shift;
 
-      std::copy(features.begin(), features.end(),
-                features_vec.data() + i * chunk_length * feat_dim);
-
       results[i] = std::move(ss[i]->GetCtcResult());
       states_vec[i] = std::move(ss[i]->GetStates());
       all_processed_frames[i] = num_processed_frames;
@@ -212,28 +212,19 @@ class OnlineRecognizerTransducerImpl : public OnlineRecognizerImpl {
                        hotwords.c_str());
     }
 
-    int32_t num_default_hws = hotwords_.size();
-    int32_t num_hws = current.size();
-
-    current.insert(current.end(), hotwords_.begin(), hotwords_.end());
-
-    if (!current_scores.empty() && !boost_scores_.empty()) {
-      current_scores.insert(current_scores.end(), boost_scores_.begin(),
-                            boost_scores_.end());
-    } else if (!current_scores.empty() && boost_scores_.empty()) {
-      current_scores.insert(current_scores.end(), num_default_hws,
-                            config_.hotwords_score);
-    } else if (current_scores.empty() && !boost_scores_.empty()) {
-      current_scores.insert(current_scores.end(), num_hws,
-                            config_.hotwords_score);
-      current_scores.insert(current_scores.end(), boost_scores_.begin(),
-                            boost_scores_.end());
+    // The hotwords of this stream are added on top of the shared graph of
+    // the default hotwords, which is not copied.
+    ContextGraphPtr context_graph;
+    if (current.empty()) {
+      context_graph = hotwords_graph_;
+    } else if (hotwords_graph_) {
+      context_graph = std::make_shared<ContextGraph>(
+          hotwords_graph_, current, config_.hotwords_score, 0.0f,
+          current_scores);
     } else {
-      // Do nothing.
+      context_graph = std::make_shared<ContextGraph>(
+          current, config_.hotwords_score, current_scores);
     }
-
-    auto context_graph = std::make_shared<ContextGraph>(
-        current, config_.hotwords_score, current_scores);
     auto stream =
         std::make_unique<OnlineStream>(config_.feat_config, context_graph);
     InitOnlineStream(stream.get());
@@ -288,7 +279,6 @@ class OnlineRecognizerTransducerImpl : public OnlineRecognizerImpl {
 
     std::vector<OnlineTransducerDecoderResult> results(n);
     std::vector<float> features_vec(n * chunk_size * feature_dim);
-    std::vector<std::vector<Ort::Value>> states_vec(n);
     std::vector<int64_t> all_processed_frames(n);
     bool has_context_graph = false;
 
@@ -298,22 +288,18 @@ class OnlineRecognizerTransducerImpl : public OnlineRecognizerImpl {
       }
 
       const auto num_processed_frames = ss[i]->GetNumProcessedFrames();
-      std::vector<float> features =
-          ss[i]->GetFrames(num_processed_frames, chunk_size);
+      float *features = features_vec.data() + i * chunk_size * feature_dim;
+      ss[i]->GetFrames(num_processed_frames, chunk_size, features);
 
       if (config_.feat_config.is_whisper) {
-        OfflineWhisperModel::NormalizeFeatures(features.data(), chunk_size,
+        OfflineWhisperModel::NormalizeFeatures(features, chunk_size,
                                                feature_dim);
       }
 
       // Question: should num_processed_frames include chunk_shift?
       ss[i]->GetNumProcessedFrames() += chunk_shift;
 
-      std::copy(features.begin(), features.end(),
-                features_vec.data() + i * chunk_size * feature_dim);
-
       results[i] = std::move(ss[i]->GetResult());
-      states_vec[i] = std::move(ss[i]->GetStates());
       all_processed_frames[i] = num_processed_frames;
     }
 
@@ -333,7 +319,7 @@ class OnlineRecognizerTransducerImpl : public OnlineRecognizerImpl {
         memory_info, all_processed_frames.data(), all_processed_frames.size(),
         processed_frames_shape.data(), processed_frames_shape.size());
 
-    auto states = model_->StackStates(states_vec);
+    auto states = model_->StackStreamStates(ss, n);
 
     auto pair = model_->RunEncoder(std::move(x), std::move(states),
                                    std::move(processed_frames));
@@ -344,12 +330,10 @@ class OnlineRecognizerTransducerImpl : public OnlineRecognizerImpl {
       decoder_->Decode(std::move(pair.first), &results);
     }
 
-    std::vector<std::vector<Ort::Value>> next_states =
-        model_->UnStackStates(pair.second);
+    model_->UnStackStreamStates(std::move(pair.second), ss, n);
 
     for (int32_t i = 0; i != n; ++i) {
       ss[i]->SetResult(results[i]);
-      ss[i]->SetStates(std::move(next_states[i]));
     }
   }
 
@@ -405,9 +389,8 @@ class OnlineRecognizerTransducerImpl : public OnlineRecognizerImpl {
       // truncate all last hyps and save as the 'ys' context for next result
       // (the encoder state buffers are kept)
       for (const auto &it : last_result.hyps) {
-        auto h = it.second;
-        r.hyps.Add({std::vector<int64_t>(h.ys.end() - context_size, h.ys.end()),
-                    h.log_prob});
+        const auto &h = it.second;
+        r.hyps.Add({h.LastTokens(context_size), h.log_prob});
       }
 
       r.tokens = std::vector<int64_t>(last_result.tokens.end() - context_size,
@@ -436,6 +419,17 @@ class OnlineRecognizerTransducerImpl : public OnlineRecognizerImpl {
 
  private:
   void InitHotwords() {
+    if (ContextGraph::IsCompiledGraph(config_.hotwords_file)) {
+      // It is saved by ContextGraph::Save()
+      hotwords_graph_ = ContextGraph::Load(config_.hotwords_file);
+      if (!hotwords_graph_) {
+        SHERPA_ONNX_LOGE("Failed to load hotwords graph: %s",
+                         config_.hotwords_file.c_str());
+        exit(-1);
+      }
+      return;
+    }
+
     // each line in hotwords_file contains space-separated words
 
     std::ifstream is(config_.hotwords_file);
@@ -445,14 +439,16 @@ class OnlineRecognizerTransducerImpl : public OnlineRecognizerImpl {
       exit(-1);
     }
 
+    std::vector<std::vector<int32_t>> hotwords;
+    std::vector<float> boost_scores;
     if (!EncodeHotwords(is, config_.model_config.modeling_unit, sym_,
-                        bpe_encoder_.get(), &hotwords_, &boost_scores_)) {
+                        bpe_encoder_.get(), &hotwords, &boost_scores)) {
       SHERPA_ONNX_LOGE(
           "Failed to encode some hotwords, skip them already, see logs above "
           "for details.");
     }
     hotwords_graph_ = std::make_shared<ContextGraph>(
-        hotwords_, config_.hotwords_score, boost_scores_);
+        hotwords, config_.hotwords_score, boost_scores);
   }
 
   template <typename Manager>
@@ -469,28 +465,32 @@ class OnlineRecognizerTransducerImpl : public OnlineRecognizerImpl {
       exit(-1);
     }
 
+    std::vector<std::vector<int32_t>> hotwords;
+    std::vector<float> boost_scores;
     if (!EncodeHotwords(is, config_.model_config.modeling_unit, sym_,
-                        bpe_encoder_.get(), &hotwords_, &boost_scores_)) {
+                        bpe_encoder_.get(), &hotwords, &boost_scores)) {
       SHERPA_ONNX_LOGE(
           "Failed to encode some hotwords, skip them already, see logs above "
           "for details.");
     }
     hotwords_graph_ = std::make_shared<ContextGraph>(
-        hotwords_, config_.hotwords_score, boost_scores_);
+        hotwords, config_.hotwords_score, boost_scores);
   }
 
   void InitHotwordsFromBufStr() {
     // each line in hotwords_file contains space-separated words
 
     std::istringstream iss(config_.hotwords_buf);
+    std::vector<std::vector<int32_t>> hotwords;
+    std::vector<float> boost_scores;
     if (!EncodeHotwords(iss, config_.model_config.modeling_unit, sym_,
-                        bpe_encoder_.get(), &hotwords_, &boost_scores_)) {
+                        bpe_encoder_.get(), &hotwords, &boost_scores)) {
       SHERPA_ONNX_LOGE(
           "Failed to encode some hotwords, skip them already, see logs above "
           "for details.");
     }
     hotwords_graph_ = std::make_shared<ContextGraph>(
-        hotwords_, config_.hotwords_score, boost_scores_);
+        hotwords, config_.hotwords_score, boost_scores);
   }
 
   void InitOnlineStream(OnlineStream *stream) const {
@@ -510,8 +510,6 @@ class OnlineRecognizerTransducerImpl : public OnlineRecognizerImpl {
 
  private:
   OnlineRecognizerConfig config_;
-  std::vector<std::vector<int32_t>> hotwords_;
-  std::vector<float> boost_scores_;
   ContextGraphPtr hotwords_graph_;
   std::unique_ptr<ssentencepiece::Ssentencepiece> bpe_encoder_;
   std::unique_ptr<OnlineTransducerModel> model_;
@@ -0,0 +1,83 @@
+// sherpa-onnx/csrc/online-rnn-lm-test.cc
+//
+// Copyright (c)  2025  Xiaomi Corporation
+
+#include "sherpa-onnx/csrc/online-rnn-lm.h"
+
+#include <random>
+#include <string>
+#include <vector>
+
+#include "gtest/gtest.h"
+#include "sherpa-onnx/csrc/file-utils.h"
+#include "sherpa-onnx/csrc/hypothesis.h"
+#include "sherpa-onnx/csrc/macros.h"
+
+namespace sherpa_onnx {
+
+static void ExpectSameScores(const Hypothesis &a, const Hypothesis &b) {
+  EXPECT_NEAR(a.lm_log_prob, b.lm_log_prob, 1e-4);
+
+  const Ort::Value &sa = a.nn_lm_scores.value;
+  const Ort::Value &sb = b.nn_lm_scores.value;
+  int64_t n = sa.GetTensorTypeAndShapeInfo().GetElementCount();
+  ASSERT_EQ(n, sb.GetTensorTypeAndShapeInfo().GetElementCount());
+
+  const float *pa = sa.GetTensorData<float>();
+  const float *pb = sb.GetTensorData<float>();
+  for (int64_t i = 0; i != n; ++i) {
+    EXPECT_NEAR(pa[i], pb[i], 1e-4) << i;
+  }
+}
+
+// Please download the model from
+// https://huggingface.co/vsd-vector/icefall-librispeech-rnn-lm/blob/main/with-state-epoch-99-avg-1.onnx
+TEST(OnlineRnnLM, BatchedSameAsUnbatched) {
+  std::string filename = "./with-state-epoch-99-avg-1.onnx";
+  if (!FileExists(filename)) {
+    SHERPA_ONNX_LOGE("%s does not exist. Skipping test", filename.c_str());
+    return;
+  }
+
+  OnlineLMConfig config;
+  config.model = filename;
+  config.lm_cache_size = 0;
+  OnlineRnnLM unbatched_lm(config);
+
+  config.lm_cache_size = 16;
+  OnlineRnnLM batched_lm(config);
+
+  float scale = 0.5;
+  int32_t num_hyps = 8;
+  int32_t num_steps = 10;
+
+  // A small vocabulary, so some hypotheses have the same tokens and some
+  // token sequences are found in the cache
+  std::mt19937 gen(20250106);
+  std::uniform_int_distribution<int32_t> dist(1, 3);
+
+  std::vector<Hypothesis> unbatched(num_hyps, Hypothesis({0, 0}, 0));
+  std::vector<Hypothesis> batched(num_hyps, Hypothesis({0, 0}, 0));
+
+  for (int32_t t = 0; t != num_steps; ++t) {
+    std::vector<Hypothesis *> hyps;
+    for (int32_t i = 0; i != num_hyps; ++i) {
+      // Hypotheses 0 and 1 always have the same tokens
+      int32_t token = i == 1 ? batched[0].LastToken() : dist(gen);
+
+      unbatched[i].Append(token, t);
+      batched[i].Append(token, t);
+
+      unbatched_lm.ComputeLMScoreSF(scale, &unbatched[i]);
+      hyps.push_back(&batched[i]);
+    }
+
+    batched_lm.ComputeLMScoreSF(scale, hyps);
+
+    for (int32_t i = 0; i != num_hyps; ++i) {
+      ExpectSameScores(unbatched[i], batched[i]);
+    }
+  }
+}
+
+}  // namespace sherpa_onnx
@@ -6,7 +6,12 @@
 #include "sherpa-onnx/csrc/online-rnn-lm.h"
 
 #include <algorithm>
+#include <array>
+#include <list>
+#include <memory>
+#include <mutex>  // NOLINT
 #include <string>
+#include <unordered_map>
 #include <utility>
 #include <vector>
 
@@ -32,40 +37,55 @@ class OnlineRnnLM::Impl {
 
   // shallow fusion scoring function
   void ComputeLMScoreSF(float scale, Hypothesis *hyp) {
-    if (hyp->nn_lm_states.empty()) {
-      auto init_states = GetInitStatesSF();
-      hyp->nn_lm_scores.value = std::move(init_states.first);
-      hyp->nn_lm_states = Convert(std::move(init_states.second));
-      // if LODR enabled, we need to initialize the LODR state
-      if (lodr_fst_ != nullptr) {
-        hyp->lodr_state = std::make_unique<LodrStateCost>(lodr_fst_.get());
+    ComputeLMScoreSF(scale, std::vector<Hypothesis *>{hyp});
+  }
+
+  // batched shallow fusion scoring function
+  void ComputeLMScoreSF(float scale, const std::vector<Hypothesis *> &hyps) {
+    // Hypotheses to run through the LM. A hypothesis with the same tokens
+    // as an earlier one in to_run is not run, but listed in copies.
+    // Hypothesis::Key() is only a hash, so the tokens are compared too.
+    std::vector<Hypothesis *> to_run;
+    std::vector<std::vector<Hypothesis *>> copies;
+    std::unordered_map<uint64_t, int32_t> key2index;
+
+    for (auto hyp : hyps) {
+      AddLastTokenScore(scale, hyp);
+
+      if (LookupCache(hyp)) {
+        continue;
       }
-    }
 
-    // get lm score for cur token given the hyp->ys[:-1] and save to lm_log_prob
-    const float *nn_lm_scores = hyp->nn_lm_scores.value.GetTensorData<float>();
-    hyp->lm_log_prob += nn_lm_scores[hyp->ys.back()] * scale;
+      auto it = key2index.find(hyp->Key());
+      if (it != key2index.end() &&
+          SameTokens(to_run[it->second]->tail.get(), hyp->tail.get())) {
+        copies[it->second].push_back(hyp);
+        continue;
+      }
 
-    // if LODR enabled, we need to update the LODR state
-    if (lodr_fst_ != nullptr) {
-      auto next_lodr_state = std::make_unique<LodrStateCost>(
-                            hyp->lodr_state->ForwardOneStep(hyp->ys.back()));
-      // calculate the score of the latest token
-      auto score = next_lodr_state->Score() - hyp->lodr_state->Score();
-      hyp->lodr_state = std::move(next_lodr_state);
-      // apply LODR to hyp score
-      hyp->lm_log_prob += score * config_.lodr_scale;
+      if (it == key2index.end()) {
+        key2index[hyp->Key()] = static_cast<int32_t>(to_run.size());
+      }
+      to_run.push_back(hyp);
+      copies.emplace_back();
+    }
+
+    if (to_run.empty()) {
+      return;
     }
 
     // get lm scores for next tokens given the hyp->ys[:] and save to
     // nn_lm_scores
-    std::array<int64_t, 2> x_shape{1, 1};
-    Ort::Value x = Ort::Value::CreateTensor<int64_t>(allocator_, x_shape.data(),
-                                                     x_shape.size());
-    *x.GetTensorMutableData<int64_t>() = hyp->ys.back();
-    auto lm_out = ScoreToken(std::move(x), Convert(hyp->nn_lm_states));
-    hyp->nn_lm_scores.value = std::move(lm_out.first);
-    hyp->nn_lm_states = Convert(std::move(lm_out.second));
+    RunBatch(to_run);
+
+    for (int32_t i = 0; i != static_cast<int32_t>(to_run.size()); ++i) {
+      for (auto hyp : copies[i]) {
+        hyp->nn_lm_scores = to_run[i]->nn_lm_scores;
+        hyp->nn_lm_states = to_run[i]->nn_lm_states;
+      }
+
+      InsertCache(*to_run[i]);
+    }
   }
 
   // classic rescore function
@@ -76,9 +96,9 @@ class OnlineRnnLM::Impl {
     for (auto &hyp : *hyps) {
       for (auto &h_m : hyp) {
         auto &h = h_m.second;
-        auto &ys = h.ys;
+        const int32_t num_tokens = h.NumTokens();
         const int32_t token_num_in_chunk =
-            ys.size() - context_size - h.cur_scored_pos - 1;
+            num_tokens - context_size - h.cur_scored_pos - 1;
 
         if (token_num_in_chunk < 1) {
           continue;
@@ -94,8 +114,8 @@ class OnlineRnnLM::Impl {
           Ort::Value x = Ort::Value::CreateTensor<int64_t>(
               allocator, x_shape.data(), x_shape.size());
           int64_t *p_x = x.GetTensorMutableData<int64_t>();
-          std::copy(ys.begin() + context_size + h.cur_scored_pos, ys.end() - 1,
-                    p_x);
+          auto ys = h.LastTokens(token_num_in_chunk + 1);
+          std::copy(ys.begin(), ys.end() - 1, p_x);
 
           // streaming forward by NN LM
           auto out =
@@ -160,6 +180,187 @@ class OnlineRnnLM::Impl {
   }
 
  private:
+  // Add the score of the last token of hyp to hyp->lm_log_prob. The
+  // score was computed when hyp was extended by the previous token.
+  void AddLastTokenScore(float scale, Hypothesis *hyp) {
+    if (hyp->nn_lm_states.empty()) {
+      auto init_states = GetInitStatesSF();
+      hyp->nn_lm_scores.value = std::move(init_states.first);
+      hyp->nn_lm_states = Convert(std::move(init_states.second));
+      // if LODR enabled, we need to initialize the LODR state
+      if (lodr_fst_ != nullptr) {
+        hyp->lodr_state = std::make_unique<LodrStateCost>(lodr_fst_.get());
+      }
+    }
+
+    // get lm score for cur token given the hyp->ys[:-1] and save to lm_log_prob
+    const float *nn_lm_scores = hyp->nn_lm_scores.value.GetTensorData<float>();
+    hyp->lm_log_prob += nn_lm_scores[hyp->LastToken()] * scale;
+
+    // if LODR enabled, we need to update the LODR state
+    if (lodr_fst_ != nullptr) {
+      auto next_lodr_state = std::make_unique<LodrStateCost>(
+                            hyp->lodr_state->ForwardOneStep(hyp->LastToken()));
+      // calculate the score of the latest token
+      auto score = next_lodr_state->Score() - hyp->lodr_state->Score();
+      hyp->lodr_state = std::move(next_lodr_state);
+      // apply LODR to hyp score
+      hyp->lm_log_prob += score * config_.lodr_scale;
+    }
+  }
+
+  // Feed the last token of each hypothesis to the LM with a single run
+  // and update nn_lm_scores and nn_lm_states of each hypothesis.
+  void RunBatch(const std::vector<Hypothesis *> &hyps) {
+    int32_t n = static_cast<int32_t>(hyps.size());
+
+    std::array<int64_t, 2> x_shape{n, 1};
+    Ort::Value x = Ort::Value::CreateTensor<int64_t>(allocator_, x_shape.data(),
+                                                     x_shape.size());
+    int64_t *p_x = x.GetTensorMutableData<int64_t>();
+    for (int32_t i = 0; i != n; ++i) {
+      p_x[i] = hyps[i]->LastToken();
+    }
+
+    if (n == 1) {
+      auto lm_out = ScoreToken(std::move(x), Convert(hyps[0]->nn_lm_states));
+      hyps[0]->nn_lm_scores.value = std::move(lm_out.first);
+      hyps[0]->nn_lm_states = Convert(std::move(lm_out.second));
+      return;
+    }
+
+    int32_t num_states = static_cast<int32_t>(hyps[0]->nn_lm_states.size());
+    std::vector<Ort::Value> states;
+    states.reserve(num_states);
+    for (int32_t k = 0; k != num_states; ++k) {
+      states.push_back(StackStates(hyps, k));
+    }
+
+    auto lm_out = ScoreToken(std::move(x), std::move(states));
+
+    // lm_out.first has shape (n, ...). Each hypothesis gets a tensor of
+    // shape (1, ...)
+    std::vector<int64_t> shape =
+        lm_out.first.GetTensorTypeAndShapeInfo().GetShape();
+    int64_t size = lm_out.first.GetTensorTypeAndShapeInfo().GetElementCount();
+    int64_t stride = size / n;
+    shape[0] = 1;
+
+    const float *p = lm_out.first.GetTensorData<float>();
+    for (int32_t i = 0; i != n; ++i) {
+      Ort::Value scores = Ort::Value::CreateTensor<float>(
+          allocator_, shape.data(), shape.size());
+      std::copy(p + i * stride, p + (i + 1) * stride,
+                scores.GetTensorMutableData<float>());
+      hyps[i]->nn_lm_scores.value = std::move(scores);
+    }
+
+    for (int32_t k = 0; k != num_states; ++k) {
+      UnstackStates(&lm_out.second[k], hyps, k);
+    }
+  }
+
+  // Stack the k-th state of each hypothesis, of shape
+  // (num_layers, 1, hidden_size), into a tensor of shape
+  // (num_layers, n, hidden_size).
+  Ort::Value StackStates(const std::vector<Hypothesis *> &hyps, int32_t k) {
+    int32_t n = static_cast<int32_t>(hyps.size());
+    std::vector<int64_t> shape =
+        hyps[0]->nn_lm_states[k].value.GetTensorTypeAndShapeInfo().GetShape();
+    int64_t num_layers = shape[0];
+    int64_t dim = shape[2];
+    shape[1] = n;
+
+    Ort::Value ans = Ort::Value::CreateTensor<float>(allocator_, shape.data(),
+                                                     shape.size());
+    float *dst = ans.GetTensorMutableData<float>();
+    for (int32_t i = 0; i != n; ++i) {
+      const float *src = hyps[i]->nn_lm_states[k].value.GetTensorData<float>();
+      for (int64_t l = 0; l != num_layers; ++l) {
+        std::copy(src + l * dim, src + (l + 1) * dim,
+                  dst + (l * n + i) * dim);
+      }
+    }
+
+    return ans;
+  }
+
+  // The inverse of StackStates()
+  void UnstackStates(Ort::Value *states, const std::vector<Hypothesis *> &hyps,
+                     int32_t k) {
+    int32_t n = static_cast<int32_t>(hyps.size());
+    std::vector<int64_t> shape = states->GetTensorTypeAndShapeInfo().GetShape();
+    int64_t num_layers = shape[0];
+    int64_t dim = shape[2];
+    shape[1] = 1;
+
+    const float *src = states->GetTensorData<float>();
+    for (int32_t i = 0; i != n; ++i) {
+      Ort::Value s = Ort::Value::CreateTensor<float>(allocator_, shape.data(),
+                                                     shape.size());
+      float *dst = s.GetTensorMutableData<float>();
+      for (int64_t l = 0; l != num_layers; ++l) {
+        std::copy(src + (l * n + i) * dim, src + (l * n + i + 1) * dim,
+                  dst + l * dim);
+      }
+
+      if (hyps[i]->nn_lm_states.size() <= static_cast<size_t>(k)) {
+        hyps[i]->nn_lm_states.resize(k + 1);
+      }
+      hyps[i]->nn_lm_states[k].value = std::move(s);
+    }
+  }
+
+  // If the LM state of the tokens of hyp is cached, copy it to hyp and
+  // return true.
+  bool LookupCache(Hypothesis *hyp) {
+    if (config_.lm_cache_size == 0) {
+      return false;
+    }
+
+    std::lock_guard<std::mutex> lock(cache_mutex_);
+    auto it = cache_index_.find(hyp->Key());
+    if (it == cache_index_.end() ||
+        !SameTokens(it->second->tokens.get(), hyp->tail.get())) {
+      return false;
+    }
+
+    // move it to the front, i.e., mark it as the most recently used
+    cache_.splice(cache_.begin(), cache_, it->second);
+
+    hyp->nn_lm_scores = it->second->scores;
+    hyp->nn_lm_states = it->second->states;
+
+    return true;
+  }
+
+  void InsertCache(const Hypothesis &hyp) {
+    if (config_.lm_cache_size == 0) {
+      return;
+    }
+
+    std::lock_guard<std::mutex> lock(cache_mutex_);
+    auto it = cache_index_.find(hyp.Key());
+    if (it != cache_index_.end()) {
+      cache_.splice(cache_.begin(), cache_, it->second);
+    } else {
+      cache_.emplace_front();
+      cache_index_[hyp.Key()] = cache_.begin();
+
+      if (static_cast<int32_t>(cache_.size()) > config_.lm_cache_size) {
+        cache_index_.erase(cache_.back().key);
+        cache_.pop_back();
+      }
+    }
+
+    // If another token sequence with the same key is cached, it is replaced
+    auto &entry = cache_.front();
+    entry.key = hyp.Key();
+    entry.tokens = hyp.tail;
+    entry.scores = hyp.nn_lm_scores;
+    entry.states = hyp.nn_lm_states;
+  }
+
   void Init(const OnlineLMConfig &config) {
     auto buf = ReadFile(config_.model);
 
@@ -232,6 +433,27 @@ class OnlineRnnLM::Impl {
   int32_t sos_id_ = 1;
 
   std::unique_ptr<LodrFst> lodr_fst_;
+
+  // LM outputs after consuming a token sequence. Used only in shallow
+  // fusion.
+  struct CacheEntry {
+    // Hypothesis::Key() of the token sequence
+    uint64_t key = 0;
+
+    // The token sequence. Keys may collide, so it is compared on lookup.
+    // The nodes are shared with the hypotheses.
+    std::shared_ptr<const HypothesisToken> tokens;
+
+    CopyableOrtValue scores;
+    std::vector<CopyableOrtValue> states;
+  };
+
+  // The most recently used entry is at the front
+  std::list<CacheEntry> cache_;
+  std::unordered_map<uint64_t, std::list<CacheEntry>::iterator> cache_index_;
+
+  // Streams may be decoded in parallel by several threads
+  std::mutex cache_mutex_;
 };
 
 OnlineRnnLM::OnlineRnnLM(const OnlineLMConfig &config)
@@ -265,4 +487,9 @@ void OnlineRnnLM::ComputeLMScoreSF(float scale, Hypothesis *hyp) {
   return impl_->ComputeLMScoreSF(scale, hyp);
 }
 
+void OnlineRnnLM::ComputeLMScoreSF(float scale,
+                                   const std::vector<Hypothesis *> &hyps) {
+  return impl_->ComputeLMScoreSF(scale, hyps);
+}
+
 }  // namespace sherpa_onnx
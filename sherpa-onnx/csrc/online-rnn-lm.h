@@ -58,6 +58,16 @@ class OnlineRnnLM : public OnlineLM {
    */
   void ComputeLMScoreSF(float scale, Hypothesis *hyp) override;
 
+  /** Batched shallow fusion. Hypotheses whose token sequence is found in
+   * the LM state cache are not run through the LM. The others are run
+   * in a single batch, with duplicated token sequences run only once.
+   *
+   * @param scale LM score
+   * @param hyps They are changed in-place.
+   */
+  void ComputeLMScoreSF(float scale,
+                        const std::vector<Hypothesis *> &hyps) override;
+
  private:
   class Impl;
   std::unique_ptr<Impl> impl_;
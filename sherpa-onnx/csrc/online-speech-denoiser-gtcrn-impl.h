@@ -0,0 +1,84 @@
+// sherpa-onnx/csrc/online-speech-denoiser-gtcrn-impl.h
+//
+// Copyright (c)  2025  Xiaomi Corporation
+
+#ifndef SHERPA_ONNX_CSRC_ONLINE_SPEECH_DENOISER_GTCRN_IMPL_H_
+#define SHERPA_ONNX_CSRC_ONLINE_SPEECH_DENOISER_GTCRN_IMPL_H_
+
+#include <array>
+#include <memory>
+#include <utility>
+#include <vector>
+
+#include "sherpa-onnx/csrc/offline-speech-denoiser-gtcrn-impl.h"
+#include "sherpa-onnx/csrc/offline-speech-denoiser-gtcrn-model.h"
+#include "sherpa-onnx/csrc/online-speech-denoiser-impl.h"
+
+namespace sherpa_onnx {
+
+class OnlineSpeechDenoiserGtcrnImpl : public OnlineSpeechDenoiserImpl {
+ public:
+  explicit OnlineSpeechDenoiserGtcrnImpl(
+      const OnlineSpeechDenoiserConfig &config)
+      : model_(config.model) {}
+
+  template <typename Manager>
+  OnlineSpeechDenoiserGtcrnImpl(Manager *mgr,
+                                const OnlineSpeechDenoiserConfig &config)
+      : model_(mgr, config.model) {}
+
+  std::unique_ptr<OnlineSpeechDenoiserStream> CreateStream() const override {
+    const auto &meta = model_.GetMetaData();
+
+    auto s = std::make_unique<OnlineSpeechDenoiserStream>(
+        GetGtcrnStftConfig(meta), meta.sample_rate);
+    s->SetStates(model_.GetInitStates());
+
+    return s;
+  }
+
+  void Run(OnlineSpeechDenoiserStream *s) const override {
+    int32_t num_frames = s->NumFramesReady();
+    if (num_frames == 0) {
+      return;
+    }
+
+    int32_t num_bins = s->NumBins();
+
+    auto memory_info =
+        Ort::MemoryInfo::CreateCpu(OrtDeviceAllocator, OrtMemTypeDefault);
+
+    std::vector<float> x(num_bins * 2);
+    std::array<int64_t, 4> x_shape{1, num_bins, 1, 2};
+
+    auto states = std::move(s->GetStates());
+
+    // The model is causal, so frames are processed as soon as they are
+    // available, with the states carried over between calls.
+    for (int32_t i = 0; i != num_frames; ++i) {
+      s->GetFrame(x.data());
+
+      Ort::Value x_tensor = Ort::Value::CreateTensor(
+          memory_info, x.data(), x.size(), x_shape.data(), x_shape.size());
+
+      Ort::Value output{nullptr};
+      std::tie(output, states) =
+          model_.Run(std::move(x_tensor), std::move(states));
+
+      s->AcceptFrame(output.GetTensorData<float>());
+    }
+
+    s->SetStates(std::move(states));
+  }
+
+  int32_t GetSampleRate() const override {
+    return model_.GetMetaData().sample_rate;
+  }
+
+ private:
+  OfflineSpeechDenoiserGtcrnModel model_;
+};
+
+}  // namespace sherpa_onnx
+
+#endif  // SHERPA_ONNX_CSRC_ONLINE_SPEECH_DENOISER_GTCRN_IMPL_H_
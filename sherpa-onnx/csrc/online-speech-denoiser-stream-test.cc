@@ -0,0 +1,96 @@
+// sherpa-onnx/csrc/online-speech-denoiser-stream-test.cc
+//
+// Copyright (c)  2025  Xiaomi Corporation
+
+#include "sherpa-onnx/csrc/online-speech-denoiser-stream.h"
+
+#include <algorithm>
+#include <cmath>
+#include <vector>
+
+#include "gtest/gtest.h"
+#include "kaldi-native-fbank/csrc/feature-window.h"
+#include "kaldi-native-fbank/csrc/istft.h"
+#include "kaldi-native-fbank/csrc/stft.h"
+
+namespace sherpa_onnx {
+
+// A frame-dependent gain, standing in for the model
+static float Gain(int32_t frame, int32_t bin) {
+  return 0.5f + 0.4f * std::sin(frame + bin);
+}
+
+static void TestMatchOffline(int32_t hop_length, int32_t num_samples) {
+  knf::StftConfig config;
+  config.n_fft = 512;
+  config.hop_length = hop_length;
+  config.win_length = 512;
+  config.window_type = "hann";
+  config.window = knf::GetWindow("hann", config.win_length);
+  for (auto &w : config.window) {
+    w = std::sqrt(w);
+  }
+
+  std::vector<float> samples(num_samples);
+  for (int32_t i = 0; i != num_samples; ++i) {
+    samples[i] = std::sin(0.01f * i) + 0.1f * std::cos(0.37f * i);
+  }
+
+  int32_t num_bins = config.n_fft / 2 + 1;
+
+  knf::Stft stft(config);
+  knf::StftResult r = stft.Compute(samples.data(), num_samples);
+  for (int32_t f = 0; f != r.num_frames; ++f) {
+    for (int32_t k = 0; k != num_bins; ++k) {
+      r.real[f * num_bins + k] *= Gain(f, k);
+      r.imag[f * num_bins + k] *= Gain(f, k);
+    }
+  }
+
+  knf::IStft istft(config);
+  std::vector<float> expected = istft.Compute(r);
+
+  OnlineSpeechDenoiserStream s(config, 16000);
+  std::vector<float> frame(2 * num_bins);
+  std::vector<float> actual;
+  int32_t f = 0;
+
+  auto process = [&]() {
+    while (s.NumFramesReady() > 0) {
+      s.GetFrame(frame.data());
+      for (int32_t k = 0; k != num_bins; ++k) {
+        frame[2 * k] *= Gain(f, k);
+        frame[2 * k + 1] *= Gain(f, k);
+      }
+      ++f;
+      s.AcceptFrame(frame.data());
+    }
+
+    auto audio = s.GetDenoisedSamples();
+    actual.insert(actual.end(), audio.samples.begin(), audio.samples.end());
+  };
+
+  int32_t chunk = 333;
+  for (int32_t i = 0; i < num_samples; i += chunk) {
+    s.AcceptWaveform(16000, samples.data() + i,
+                     std::min(chunk, num_samples - i));
+    process();
+  }
+
+  s.InputFinished();
+  process();
+
+  EXPECT_EQ(f, r.num_frames);
+  ASSERT_EQ(actual.size(), expected.size());
+  for (int32_t i = 0; i != static_cast<int32_t>(actual.size()); ++i) {
+    EXPECT_NEAR(actual[i], expected[i], 1e-4) << i;
+  }
+}
+
+TEST(OnlineSpeechDenoiserStream, MatchOffline) {
+  TestMatchOffline(256, 16000);
+  TestMatchOffline(256, 1000);
+  TestMatchOffline(128, 5000);
+}
+
+}  // namespace sherpa_onnx
@@ -0,0 +1,356 @@
+// sherpa-onnx/csrc/online-speech-denoiser-stream.cc
+//
+// Copyright (c)  2025  Xiaomi Corporation
+
+#include "sherpa-onnx/csrc/online-speech-denoiser-stream.h"
+
+#include <algorithm>
+#include <memory>
+#include <utility>
+#include <vector>
+
+#include "kaldi-native-fbank/csrc/feature-window.h"
+#include "kaldi-native-fbank/csrc/istft.h"
+#include "sherpa-onnx/csrc/macros.h"
+#include "sherpa-onnx/csrc/resample.h"
+
+namespace sherpa_onnx {
+
+static knf::StftConfig GetFrameStftConfig(knf::StftConfig config) {
+  // We pad the input ourselves, so each call to knf::Stft sees exactly
+  // one frame.
+  config.center = false;
+  return config;
+}
+
+static knf::StftConfig GetFrameIStftConfig(const knf::StftConfig &config) {
+  // With a rectangular window, knf::IStft of a single frame is just the
+  // inverse FFT of that frame. Windowing and overlap-add are done by us.
+  knf::StftConfig ans = config;
+  ans.center = false;
+  ans.win_length = config.n_fft;
+  ans.window = std::vector<float>(config.n_fft, 1);
+  return ans;
+}
+
+// Return the window of size n_fft used by knf::Stft
+static std::vector<float> GetPaddedWindow(const knf::StftConfig &config) {
+  std::vector<float> window = config.window;
+  if (window.empty()) {
+    window = knf::GetWindow(config.window_type, config.win_length);
+  }
+
+  std::vector<float> ans(config.n_fft);
+  int32_t offset = (config.n_fft - static_cast<int32_t>(window.size())) / 2;
+  std::copy(window.begin(), window.end(), ans.begin() + offset);
+
+  return ans;
+}
+
+class OnlineSpeechDenoiserStream::Impl {
+ public:
+  Impl(const knf::StftConfig &config, int32_t sample_rate)
+      : n_fft_(config.n_fft),
+        hop_length_(config.hop_length),
+        pad_(config.n_fft / 2),
+        sample_rate_(sample_rate),
+        stft_(GetFrameStftConfig(config)),
+        istft_(GetFrameIStftConfig(config)),
+        window_(GetPaddedWindow(config)),
+        ola_(n_fft_),
+        den_(n_fft_),
+        num_to_drop_(pad_) {
+    if (hop_length_ <= 0 || hop_length_ > n_fft_) {
+      SHERPA_ONNX_LOGE("Invalid hop_length: %d. n_fft: %d", hop_length_,
+                       n_fft_);
+      SHERPA_ONNX_EXIT(-1);
+    }
+  }
+
+  void AcceptWaveform(int32_t sample_rate, const float *samples, int32_t n) {
+    if (finished_) {
+      SHERPA_ONNX_LOGE("Don't call AcceptWaveform() after InputFinished()");
+      return;
+    }
+
+    if (resampler_) {
+      if (sample_rate != resampler_->GetInputSamplingRate()) {
+        SHERPA_ONNX_LOGE(
+            "You changed the input sampling rate!! Expected: %d, given: "
+            "%d",
+            resampler_->GetInputSamplingRate(), sample_rate);
+        exit(-1);
+      }
+
+      std::vector<float> tmp;
+      resampler_->Resample(samples, n, false, &tmp);
+      AppendSamples(tmp.data(), tmp.size());
+      return;
+    }
+
+    if (sample_rate != sample_rate_) {
+      SHERPA_ONNX_LOGE(
+          "Creating a resampler:\n"
+          "   in_sample_rate: %d\n"
+          "   output_sample_rate: %d\n",
+          sample_rate, sample_rate_);
+
+      float min_freq = std::min<int32_t>(sample_rate, sample_rate_);
+      float lowpass_cutoff = 0.99 * 0.5 * min_freq;
+
+      int32_t lowpass_filter_width = 6;
+      resampler_ = std::make_unique<LinearResample>(
+          sample_rate, sample_rate_, lowpass_cutoff, lowpass_filter_width);
+
+      std::vector<float> tmp;
+      resampler_->Resample(samples, n, false, &tmp);
+      AppendSamples(tmp.data(), tmp.size());
+      return;
+    }
+
+    AppendSamples(samples, n);
+  }
+
+  void InputFinished() {
+    if (finished_) {
+      return;
+    }
+
+    if (resampler_) {
+      std::vector<float> tmp;
+      resampler_->Resample(nullptr, 0, true, &tmp);
+      AppendSamples(tmp.data(), tmp.size());
+    }
+
+    finished_ = true;
+
+    if (!started_) {
+      // The input is too short for reflection padding
+      input_.insert(input_.begin(), pad_, 0);
+      input_.insert(input_.end(), pad_, 0);
+      started_ = true;
+    } else {
+      // Same as reflection padding. The last pad_ + 1 input samples are
+      // always kept in input_. See AcceptFrame().
+      int32_t last = static_cast<int32_t>(input_.size()) - 1;
+      for (int32_t i = 1; i <= pad_; ++i) {
+        input_.push_back(input_[last - i]);
+      }
+    }
+
+    MaybeFlushTail();
+  }
+
+  bool IsInputFinished() const { return finished_; }
+
+  DenoisedAudio GetDenoisedSamples() {
+    DenoisedAudio ans;
+    ans.sample_rate = sample_rate_;
+    ans.samples.swap(output_);
+    return ans;
+  }
+
+  int32_t NumFramesReady() const {
+    if (!started_) {
+      return 0;
+    }
+
+    int32_t n = static_cast<int32_t>(input_.size()) - pos_;
+    if (n < n_fft_) {
+      return 0;
+    }
+
+    return (n - n_fft_) / hop_length_ + 1;
+  }
+
+  int32_t NumBins() const { return n_fft_ / 2 + 1; }
+
+  void GetFrame(float *out) {
+    if (NumFramesReady() == 0) {
+      SHERPA_ONNX_LOGE("No frames are ready");
+      SHERPA_ONNX_EXIT(-1);
+    }
+
+    knf::StftResult r = stft_.Compute(input_.data() + pos_, n_fft_);
+
+    int32_t num_bins = NumBins();
+    for (int32_t i = 0; i != num_bins; ++i) {
+      out[2 * i] = r.real[i];
+      out[2 * i + 1] = r.imag[i];
+    }
+  }
+
+  void AcceptFrame(const float *frame) {
+    int32_t num_bins = NumBins();
+
+    knf::StftResult r;
+    r.num_frames = 1;
+    r.real.resize(num_bins);
+    r.imag.resize(num_bins);
+    for (int32_t i = 0; i != num_bins; ++i) {
+      r.real[i] = frame[2 * i];
+      r.imag[i] = frame[2 * i + 1];
+    }
+
+    std::vector<float> y = istft_.Compute(r);
+
+    for (int32_t i = 0; i != n_fft_; ++i) {
+      ola_[i] += y[i] * window_[i];
+      den_[i] += window_[i] * window_[i];
+    }
+
+    // No later frame overlaps with the first hop_length_ samples
+    Emit(hop_length_);
+
+    std::copy(ola_.begin() + hop_length_, ola_.end(), ola_.begin());
+    std::fill(ola_.end() - hop_length_, ola_.end(), 0);
+
+    std::copy(den_.begin() + hop_length_, den_.end(), den_.begin());
+    std::fill(den_.end() - hop_length_, den_.end(), 0);
+
+    pos_ += hop_length_;
+
+    // Keep the last pad_ + 1 samples for reflection padding
+    int32_t n =
+        std::min(pos_, static_cast<int32_t>(input_.size()) - (pad_ + 1));
+    if (n > 0) {
+      input_.erase(input_.begin(), input_.begin() + n);
+      pos_ -= n;
+    }
+
+    MaybeFlushTail();
+  }
+
+  void SetStates(std::vector<Ort::Value> states) {
+    states_ = std::move(states);
+  }
+
+  std::vector<Ort::Value> &GetStates() { return states_; }
+
+ private:
+  void AppendSamples(const float *samples, int32_t n) {
+    input_.insert(input_.end(), samples, samples + n);
+
+    if (!started_ && static_cast<int32_t>(input_.size()) > pad_) {
+      // Same as reflection padding, i.e., x[pad_], ..., x[1]
+      std::vector<float> left(pad_);
+      for (int32_t i = 0; i != pad_; ++i) {
+        left[i] = input_[pad_ - i];
+      }
+      input_.insert(input_.begin(), left.begin(), left.end());
+      started_ = true;
+    }
+  }
+
+  // Output the first n samples in ola_. The first pad_ samples of the
+  // whole output are discarded, just as knf::IStft does for center=true.
+  void Emit(int32_t n) {
+    for (int32_t i = 0; i != n; ++i) {
+      float v = den_[i] > 1e-8f ? ola_[i] / den_[i] : ola_[i];
+
+      if (num_to_drop_ > 0) {
+        --num_to_drop_;
+        continue;
+      }
+
+      output_.push_back(v);
+    }
+  }
+
+  // After the last frame, knf::IStft also outputs pad_ - hop_length_
+  // samples that are not covered by Emit() in AcceptFrame().
+  void MaybeFlushTail() {
+    if (!finished_ || tail_flushed_ || NumFramesReady() > 0) {
+      return;
+    }
+
+    if (pad_ > hop_length_) {
+      Emit(pad_ - hop_length_);
+    }
+
+    tail_flushed_ = true;
+  }
+
+ private:
+  int32_t n_fft_;
+  int32_t hop_length_;
+  int32_t pad_;
+  int32_t sample_rate_;
+
+  knf::Stft stft_;
+  knf::IStft istft_;
+
+  // synthesis window of size n_fft_
+  std::vector<float> window_;
+
+  std::unique_ptr<LinearResample> resampler_;
+
+  // Input samples, including the left padding
+  std::vector<float> input_;
+
+  // Index into input_ of the start of the next frame
+  int32_t pos_ = 0;
+
+  bool started_ = false;
+  bool finished_ = false;
+  bool tail_flushed_ = false;
+
+  // Overlap-add buffer and the sum of squared windows. Index 0
+  // corresponds to the start of the next frame.
+  std::vector<float> ola_;
+  std::vector<float> den_;
+
+  int32_t num_to_drop_;
+
+  std::vector<float> output_;
+
+  std::vector<Ort::Value> states_;
+};
+
+OnlineSpeechDenoiserStream::OnlineSpeechDenoiserStream(
+    const knf::StftConfig &config, int32_t sample_rate)
+    : impl_(std::make_unique<Impl>(config, sample_rate)) {}
+
+OnlineSpeechDenoiserStream::~OnlineSpeechDenoiserStream() = default;
+
+void OnlineSpeechDenoiserStream::AcceptWaveform(int32_t sample_rate,
+                                                const float *samples,
+                                                int32_t n) {
+  impl_->AcceptWaveform(sample_rate, samples, n);
+}
+
+void OnlineSpeechDenoiserStream::InputFinished() { impl_->InputFinished(); }
+
+bool OnlineSpeechDenoiserStream::IsInputFinished() const {
+  return impl_->IsInputFinished();
+}
+
+DenoisedAudio OnlineSpeechDenoiserStream::GetDenoisedSamples() {
+  return impl_->GetDenoisedSamples();
+}
+
+int32_t OnlineSpeechDenoiserStream::NumFramesReady() const {
+  return impl_->NumFramesReady();
+}
+
+int32_t OnlineSpeechDenoiserStream::NumBins() const {
+  return impl_->NumBins();
+}
+
+void OnlineSpeechDenoiserStream::GetFrame(float *out) {
+  impl_->GetFrame(out);
+}
+
+void OnlineSpeechDenoiserStream::AcceptFrame(const float *frame) {
+  impl_->AcceptFrame(frame);
+}
+
+void OnlineSpeechDenoiserStream::SetStates(std::vector<Ort::Value> states) {
+  impl_->SetStates(std::move(states));
+}
+
+std::vector<Ort::Value> &OnlineSpeechDenoiserStream::GetStates() {
+  return impl_->GetStates();
+}
+
+}  // namespace sherpa_onnx
@@ -0,0 +1,92 @@
+// sherpa-onnx/csrc/online-speech-denoiser-stream.h
+//
+// Copyright (c)  2025  Xiaomi Corporation
+#ifndef SHERPA_ONNX_CSRC_ONLINE_SPEECH_DENOISER_STREAM_H_
+#define SHERPA_ONNX_CSRC_ONLINE_SPEECH_DENOISER_STREAM_H_
+
+#include <memory>
+#include <vector>
+
+#include "kaldi-native-fbank/csrc/stft.h"
+#include "onnxruntime_cxx_api.h"  // NOLINT
+#include "sherpa-onnx/csrc/offline-speech-denoiser.h"
+
+namespace sherpa_onnx {
+
+// Per-stream state of OnlineSpeechDenoiser.
+//
+// It computes the STFT of the input incrementally and reconstructs the
+// output by overlap-add, one frame at a time. The result is the same as
+// computing knf::Stft with center=true on the whole input, processing
+// each frame, and then computing knf::IStft.
+//
+// The latency is n_fft samples and the memory usage does not depend on
+// the length of the input.
+class OnlineSpeechDenoiserStream {
+ public:
+  // @param config STFT config of the model. config.center is ignored and
+  //               the input is always padded as if center is true.
+  // @param sample_rate Sample rate expected by the model
+  OnlineSpeechDenoiserStream(const knf::StftConfig &config,
+                             int32_t sample_rate);
+
+  ~OnlineSpeechDenoiserStream();
+
+  /**
+   * @param sample_rate Sample rate of the input samples. If it is different
+   *                    from the one expected by the model, the input is
+   *                    resampled.
+   * @param samples 1-D array of audio samples. Each sample is in the
+   *                range [-1, 1].
+   * @param n Number of samples
+   */
+  void AcceptWaveform(int32_t sample_rate, const float *samples, int32_t n);
+
+  // Call it to signal that no more samples will be given. Remaining
+  // samples are padded so that they can be processed.
+  void InputFinished();
+
+  bool IsInputFinished() const;
+
+  // Return denoised samples that are available so far and remove them
+  // from the stream. Concatenating all returned samples gives the
+  // denoised audio of the whole input.
+  DenoisedAudio GetDenoisedSamples();
+
+  // Number of frames that can be processed now
+  int32_t NumFramesReady() const;
+
+  // Number of frequency bins per frame, i.e., n_fft / 2 + 1
+  int32_t NumBins() const;
+
+  /**
+   * Compute the STFT of the next frame.
+   *
+   * @param out Pointer to an array of shape (NumBins(), 2) containing
+   *            the real and imaginary parts of each bin.
+   *
+   * It is an error to call it if NumFramesReady() is 0.
+   */
+  void GetFrame(float *out);
+
+  /**
+   * Set the processed STFT of the frame returned by GetFrame() and move
+   * to the next frame.
+   *
+   * @param frame Pointer to an array of shape (NumBins(), 2), in the same
+   *              layout as GetFrame().
+   */
+  void AcceptFrame(const float *frame);
+
+  // Recurrent states of the model for this stream
+  void SetStates(std::vector<Ort::Value> states);
+  std::vector<Ort::Value> &GetStates();
+
+ private:
+  class Impl;
+  std::unique_ptr<Impl> impl_;
+};
+
+}  // namespace sherpa_onnx
+
+#endif  // SHERPA_ONNX_CSRC_ONLINE_SPEECH_DENOISER_STREAM_H_
@@ -0,0 +1,60 @@
+// sherpa-onnx/csrc/online-speech-denoiser.cc
+//
+// Copyright (c)  2025  Xiaomi Corporation
+
+#include "sherpa-onnx/csrc/online-speech-denoiser.h"
+
+#include <memory>
+
+#include "sherpa-onnx/csrc/online-speech-denoiser-impl.h"
+
+#if __ANDROID_API__ >= 9
+#include "android/asset_manager.h"
+#include "android/asset_manager_jni.h"
+#endif
+
+#if __OHOS__
+#include "rawfile/raw_file_manager.h"
+#endif
+
+namespace sherpa_onnx {
+
+template <typename Manager>
+OnlineSpeechDenoiser::OnlineSpeechDenoiser(
+    Manager *mgr, const OnlineSpeechDenoiserConfig &config)
+    : impl_(OnlineSpeechDenoiserImpl::Create(mgr, config)) {}
+
+OnlineSpeechDenoiser::OnlineSpeechDenoiser(
+    const OnlineSpeechDenoiserConfig &config)
+    : impl_(OnlineSpeechDenoiserImpl::Create(config)) {}
+
+OnlineSpeechDenoiser::~OnlineSpeechDenoiser() = default;
+
+std::unique_ptr<OnlineSpeechDenoiserStream> OnlineSpeechDenoiser::CreateStream()
+    const {
+  return impl_->CreateStream();
+}
+
+bool OnlineSpeechDenoiser::IsReady(const OnlineSpeechDenoiserStream *s) const {
+  return s->NumFramesReady() > 0;
+}
+
+void OnlineSpeechDenoiser::Run(OnlineSpeechDenoiserStream *s) const {
+  impl_->Run(s);
+}
+
+int32_t OnlineSpeechDenoiser::GetSampleRate() const {
+  return impl_->GetSampleRate();
+}
+
+#if __ANDROID_API__ >= 9
+template OnlineSpeechDenoiser::OnlineSpeechDenoiser(
+    AAssetManager *mgr, const OnlineSpeechDenoiserConfig &config);
+#endif
+
+#if __OHOS__
+template OnlineSpeechDenoiser::OnlineSpeechDenoiser(
+    NativeResourceManager *mgr, const OnlineSpeechDenoiserConfig &config);
+#endif
+
+}  // namespace sherpa_onnx
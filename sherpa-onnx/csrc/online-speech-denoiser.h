@@ -0,0 +1,64 @@
+// sherpa-onnx/csrc/online-speech-denoiser.h
+//
+// Copyright (c)  2025  Xiaomi Corporation
+#ifndef SHERPA_ONNX_CSRC_ONLINE_SPEECH_DENOISER_H_
+#define SHERPA_ONNX_CSRC_ONLINE_SPEECH_DENOISER_H_
+
+#include <memory>
+
+#include "sherpa-onnx/csrc/offline-speech-denoiser.h"
+#include "sherpa-onnx/csrc/online-speech-denoiser-stream.h"
+
+namespace sherpa_onnx {
+
+// The streaming denoiser uses the same models as OfflineSpeechDenoiser.
+using OnlineSpeechDenoiserConfig = OfflineSpeechDenoiserConfig;
+
+class OnlineSpeechDenoiserImpl;
+
+// Frame-synchronous speech denoising.
+//
+// Usage:
+//
+//   auto s = denoiser.CreateStream();
+//   while (has more audio) {
+//     s->AcceptWaveform(sample_rate, samples, n);
+//     denoiser.Run(s.get());
+//     auto audio = s->GetDenoisedSamples();
+//     // use audio.samples
+//   }
+//   s->InputFinished();
+//   denoiser.Run(s.get());
+//   auto audio = s->GetDenoisedSamples();
+//
+// The output is the same as that of OfflineSpeechDenoiser for the whole
+// input. A single OnlineSpeechDenoiser can be shared by many streams.
+class OnlineSpeechDenoiser {
+ public:
+  explicit OnlineSpeechDenoiser(const OnlineSpeechDenoiserConfig &config);
+  ~OnlineSpeechDenoiser();
+
+  template <typename Manager>
+  OnlineSpeechDenoiser(Manager *mgr, const OnlineSpeechDenoiserConfig &config);
+
+  std::unique_ptr<OnlineSpeechDenoiserStream> CreateStream() const;
+
+  // Return true if s has frames to be processed
+  bool IsReady(const OnlineSpeechDenoiserStream *s) const;
+
+  // Process all frames of s that are ready. Denoised samples can be
+  // retrieved with s->GetDenoisedSamples() afterwards.
+  void Run(OnlineSpeechDenoiserStream *s) const;
+
+  /*
+   * Return the sample rate of the denoised audio
+   */
+  int32_t GetSampleRate() const;
+
+ private:
+  std::unique_ptr<OnlineSpeechDenoiserImpl> impl_;
+};
+
+}  // namespace sherpa_onnx
+
+#endif  // SHERPA_ONNX_CSRC_ONLINE_SPEECH_DENOISER_H_
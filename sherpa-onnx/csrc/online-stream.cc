@@ -3,6 +3,7 @@
 // Copyright (c)  2023  Xiaomi Corporation
 #include "sherpa-onnx/csrc/online-stream.h"
 
+#include <atomic>
 #include <memory>
 #include <utility>
 #include <vector>
@@ -18,31 +19,36 @@ class OnlineStream::Impl {
                 ContextGraphPtr context_graph)
       : feat_extractor_(config), context_graph_(std::move(context_graph)) {}
 
+  // The feature extractor is a single-producer/single-consumer queue,
+  // so the feature related methods below don't take mutex_. This avoids
+  // contention between the thread feeding audio and the decoding thread.
   void AcceptWaveform(int32_t sampling_rate, const float *waveform, int32_t n) {
-    std::lock_guard<std::mutex> lock(mutex_);
     feat_extractor_.AcceptWaveform(sampling_rate, waveform, n);
   }
 
-  void InputFinished() const {
-    std::lock_guard<std::mutex> lock(mutex_);
-    feat_extractor_.InputFinished();
+  void AcceptWaveform(int32_t sampling_rate, const int16_t *waveform,
+                      int32_t n) {
+    feat_extractor_.AcceptWaveform(sampling_rate, waveform, n);
   }
 
+  void InputFinished() const { feat_extractor_.InputFinished(); }
+
   int32_t NumFramesReady() const {
-    std::lock_guard<std::mutex> lock(mutex_);
     return feat_extractor_.NumFramesReady() - start_frame_index_;
   }
 
   bool IsLastFrame(int32_t frame) const {
-    std::lock_guard<std::mutex> lock(mutex_);
     return feat_extractor_.IsLastFrame(frame);
   }
 
   std::vector<float> GetFrames(int32_t frame_index, int32_t n) const {
-    std::lock_guard<std::mutex> lock(mutex_);
     return feat_extractor_.GetFrames(frame_index + start_frame_index_, n);
   }
 
+  void GetFrames(int32_t frame_index, int32_t n, float *out) const {
+    feat_extractor_.GetFrames(frame_index + start_frame_index_, n, out);
+  }
+
   void Reset() {
     std::lock_guard<std::mutex> lock(mutex_);
     // we don't reset the feature extractor
@@ -102,12 +108,28 @@ class OnlineStream::Impl {
 
   int32_t FeatureDim() const { return feat_extractor_.FeatureDim(); }
 
+  ~Impl() { ReleaseBatchedStates(true); }
+
   void SetStates(std::vector<Ort::Value> states) {
     states_ = std::move(states);
+    ReleaseBatchedStates(true);
   }
 
   std::vector<Ort::Value> &GetStates() { return states_; }
 
+  void SetBatchedStates(std::shared_ptr<BatchedStates> states, int32_t row) {
+    states_.clear();
+    ReleaseBatchedStates(false);
+    batched_states_ = std::move(states);
+    batched_states_row_ = row;
+  }
+
+  const std::shared_ptr<BatchedStates> &GetBatchedStates() const {
+    return batched_states_;
+  }
+
+  int32_t GetBatchedStatesRow() const { return batched_states_row_; }
+
   void SetNeMoDecoderStates(std::vector<Ort::Value> decoder_states) {
     decoder_states_ = std::move(decoder_states);
   }
@@ -141,12 +163,25 @@ class OnlineStream::Impl {
   }
 
  private:
+  void ReleaseBatchedStates(bool compact) {
+    if (!batched_states_) {
+      return;
+    }
+
+    batched_states_->Release(batched_states_row_);
+    if (compact) {
+      batched_states_->MaybeCompact();
+    }
+    batched_states_ = nullptr;
+    batched_states_row_ = 0;
+  }
+
   FeatureExtractor feat_extractor_;
   mutable std::mutex mutex_;
   /// For contextual-biasing
   ContextGraphPtr context_graph_;
   int32_t num_processed_frames_ = 0;  // before subsampling
-  int32_t start_frame_index_ = 0;     // never reset
+  std::atomic<int32_t> start_frame_index_{0};  // never reset
   int32_t segment_ = 0;
   OnlineTransducerDecoderResult result_;
   TransducerKeywordResult prev_keyword_result_;
@@ -154,6 +189,8 @@ class OnlineStream::Impl {
   TransducerKeywordResult empty_keyword_result_;
   OnlineCtcDecoderResult ctc_result_;
   std::vector<Ort::Value> states_;  // states for transducer or ctc models
+  std::shared_ptr<BatchedStates> batched_states_;
+  int32_t batched_states_row_ = 0;
   std::vector<Ort::Value> decoder_states_;  // states for nemo transducer models
   std::vector<float> paraformer_feat_cache_;
   std::vector<float> paraformer_encoder_out_cache_;
@@ -174,6 +211,11 @@ void OnlineStream::AcceptWaveform(int32_t sampling_rate, const float *waveform,
   impl_->AcceptWaveform(sampling_rate, waveform, n);
 }
 
+void OnlineStream::AcceptWaveform(int32_t sampling_rate,
+                                  const int16_t *waveform, int32_t n) const {
+  impl_->AcceptWaveform(sampling_rate, waveform, n);
+}
+
 void OnlineStream::InputFinished() const { impl_->InputFinished(); }
 
 int32_t OnlineStream::NumFramesReady() const { return impl_->NumFramesReady(); }
@@ -182,6 +224,11 @@ bool OnlineStream::IsLastFrame(int32_t frame) const {
   return impl_->IsLastFrame(frame);
 }
 
+void OnlineStream::GetFrames(int32_t frame_index, int32_t n,
+                             float *out) const {
+  impl_->GetFrames(frame_index, n, out);
+}
+
 std::vector<float> OnlineStream::GetFrames(int32_t frame_index,
                                            int32_t n) const {
   return impl_->GetFrames(frame_index, n);
@@ -244,6 +291,19 @@ std::vector<Ort::Value> &OnlineStream::GetStates() {
   return impl_->GetStates();
 }
 
+void OnlineStream::SetBatchedStates(std::shared_ptr<BatchedStates> states,
+                                    int32_t row) {
+  impl_->SetBatchedStates(std::move(states), row);
+}
+
+const std::shared_ptr<BatchedStates> &OnlineStream::GetBatchedStates() const {
+  return impl_->GetBatchedStates();
+}
+
+int32_t OnlineStream::GetBatchedStatesRow() const {
+  return impl_->GetBatchedStatesRow();
+}
+
 void OnlineStream::SetNeMoDecoderStates(
     std::vector<Ort::Value> decoder_states) {
   return impl_->SetNeMoDecoderStates(std::move(decoder_states));
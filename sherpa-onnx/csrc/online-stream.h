@@ -10,6 +10,7 @@
 
 #include "kaldi-decoder/csrc/faster-decoder.h"
 #include "onnxruntime_cxx_api.h"  // NOLINT
+#include "sherpa-onnx/csrc/batched-states.h"
 #include "sherpa-onnx/csrc/context-graph.h"
 #include "sherpa-onnx/csrc/features.h"
 #include "sherpa-onnx/csrc/online-ctc-decoder.h"
@@ -37,6 +38,13 @@ class OnlineStream {
   void AcceptWaveform(int32_t sampling_rate, const float *waveform,
                       int32_t n) const;
 
+  /** Same as above, but the input is 16-bit PCM, i.e., each sample is in
+   * the range [-32768, 32767]. The samples are converted and scaled in a
+   * single pass, so callers don't need to convert them to float first.
+   */
+  void AcceptWaveform(int32_t sampling_rate, const int16_t *waveform,
+                      int32_t n) const;
+
   /**
    * InputFinished() tells the class you won't be providing any
    * more waveform.  This will help flush out the last frame or two
@@ -61,6 +69,11 @@ class OnlineStream {
    */
   std::vector<float> GetFrames(int32_t frame_index, int32_t n) const;
 
+  /** Like GetFrames() above, but the frames are written to out, which
+   * should have room for n * FeatureDim() floats.
+   */
+  void GetFrames(int32_t frame_index, int32_t n, float *out) const;
+
   void Reset();
 
   int32_t FeatureDim() const;
@@ -88,9 +101,18 @@ class OnlineStream {
   void SetParaformerResult(const OnlineParaformerDecoderResult &r);
   OnlineParaformerDecoderResult &GetParaformerResult();
 
+  // It also clears the batched states set by SetBatchedStates().
   void SetStates(std::vector<Ort::Value> states);
   std::vector<Ort::Value> &GetStates();
 
+  // Let the states of this stream be the given row of a batch. They
+  // are used instead of GetStates() until SetStates() is called. The row
+  // of the previous batch, if any, is released but the previous batch is
+  // not compacted. See BatchedStates::MaybeCompact().
+  void SetBatchedStates(std::shared_ptr<BatchedStates> states, int32_t row);
+  const std::shared_ptr<BatchedStates> &GetBatchedStates() const;
+  int32_t GetBatchedStatesRow() const;
+
   void SetNeMoDecoderStates(std::vector<Ort::Value> decoder_states);
   std::vector<Ort::Value> &GetNeMoDecoderStates();
 
@@ -0,0 +1,221 @@
+// sherpa-onnx/csrc/online-transducer-decoder-out-cache-test.cc
+//
+// Copyright (c)  2025  Xiaomi Corporation
+
+#include "sherpa-onnx/csrc/online-transducer-decoder-out-cache.h"
+
+#include <array>
+#include <random>
+#include <utility>
+#include <vector>
+
+#include "gtest/gtest.h"
+
+namespace sherpa_onnx {
+
+// A stateless decoder whose output depends only on the context. It counts
+// the number of calls to RunDecoder() and the number of rows decoded.
+class FakeTransducerModel : public OnlineTransducerModel {
+ public:
+  std::vector<Ort::Value> StackStates(
+      const std::vector<std::vector<Ort::Value>> & /*states*/) const override {
+    return {};
+  }
+
+  std::vector<std::vector<Ort::Value>> UnStackStates(
+      const std::vector<Ort::Value> & /*states*/) const override {
+    return {};
+  }
+
+  std::vector<Ort::Value> GetEncoderInitStates() override { return {}; }
+
+  std::pair<Ort::Value, std::vector<Ort::Value>> RunEncoder(
+      Ort::Value /*features*/, std::vector<Ort::Value> /*states*/,
+      Ort::Value /*processed_frames*/) override {
+    return {Ort::Value{nullptr}, std::vector<Ort::Value>{}};
+  }
+
+  Ort::Value RunDecoder(Ort::Value decoder_input) override {
+    std::vector<int64_t> shape =
+        decoder_input.GetTensorTypeAndShapeInfo().GetShape();
+    int32_t n = shape[0];
+    const int64_t *p = decoder_input.GetTensorData<int64_t>();
+
+    std::array<int64_t, 2> out_shape{n, kDecoderDim};
+    Ort::Value out = Ort::Value::CreateTensor<float>(
+        allocator_, out_shape.data(), out_shape.size());
+    float *q = out.GetTensorMutableData<float>();
+
+    for (int32_t i = 0; i != n; ++i) {
+      float sum = 0;
+      for (int32_t j = 0; j != kContextSize; ++j) {
+        sum = sum * 10 + p[i * kContextSize + j];
+      }
+
+      for (int32_t d = 0; d != kDecoderDim; ++d) {
+        q[i * kDecoderDim + d] = sum + d * 0.5f;
+      }
+    }
+
+    ++num_calls;
+    num_rows += n;
+    last_output = q;
+
+    return out;
+  }
+
+  Ort::Value RunJoiner(Ort::Value /*encoder_out*/,
+                       Ort::Value /*decoder_out*/) override {
+    return Ort::Value{nullptr};
+  }
+
+  int32_t ContextSize() const override { return kContextSize; }
+
+  int32_t ChunkSize() const override { return 0; }
+
+  int32_t ChunkShift() const override { return 0; }
+
+  int32_t VocabSize() const override { return 10; }
+
+  OrtAllocator *Allocator() override { return allocator_; }
+
+  static constexpr int32_t kContextSize = 2;
+  static constexpr int32_t kDecoderDim = 3;
+
+  int32_t num_calls = 0;
+  int32_t num_rows = 0;
+
+  // Data of the tensor returned by the last call to RunDecoder()
+  const float *last_output = nullptr;
+
+ private:
+  Ort::AllocatorWithDefaultOptions allocator_;
+};
+
+static Hypothesis MakeHyp(const std::vector<int64_t> &tokens) {
+  Hypothesis hyp({0, 0}, 0);
+  for (int64_t t : tokens) {
+    hyp.Append(t, 0);
+  }
+  return hyp;
+}
+
+// Run the decoder without the cache and compare the output
+static void ExpectSameAsUncached(const Ort::Value &ans,
+                                 const std::vector<Hypothesis> &hyps) {
+  FakeTransducerModel model;
+  Ort::Value expected = model.RunDecoder(model.BuildDecoderInput(hyps));
+
+  std::vector<int64_t> shape = ans.GetTensorTypeAndShapeInfo().GetShape();
+  ASSERT_EQ(shape, expected.GetTensorTypeAndShapeInfo().GetShape());
+
+  const float *p = ans.GetTensorData<float>();
+  const float *q = expected.GetTensorData<float>();
+  int32_t n = hyps.size() * FakeTransducerModel::kDecoderDim;
+  for (int32_t i = 0; i != n; ++i) {
+    EXPECT_EQ(p[i], q[i]) << i;
+  }
+}
+
+TEST(OnlineTransducerDecoderOutCache, SameAsUncached) {
+  FakeTransducerModel model;
+  OnlineTransducerDecoderOutCache cache(16);
+
+  // A small vocabulary, so contexts are found in the table, and a small
+  // table, so it is cleared several times
+  std::mt19937 gen(20250108);
+  std::uniform_int_distribution<int32_t> dist(0, 4);
+
+  std::vector<Hypothesis> hyps(6, MakeHyp({}));
+  for (int32_t t = 0; t != 50; ++t) {
+    for (auto &h : hyps) {
+      int32_t token = dist(gen);
+      if (token != 0) {
+        h.Append(token, t);
+      }
+    }
+
+    ExpectSameAsUncached(cache.Run(&model, hyps), hyps);
+  }
+
+  EXPECT_LT(model.num_rows, 50 * static_cast<int32_t>(hyps.size()));
+}
+
+TEST(OnlineTransducerDecoderOutCache, DedupMisses) {
+  FakeTransducerModel model;
+  OnlineTransducerDecoderOutCache cache;
+
+  // 3 distinct contexts
+  std::vector<Hypothesis> hyps = {MakeHyp({1, 2}), MakeHyp({3}),
+                                  MakeHyp({5, 1, 2}), MakeHyp({3}),
+                                  MakeHyp({2, 1})};
+
+  ExpectSameAsUncached(cache.Run(&model, hyps), hyps);
+  EXPECT_EQ(model.num_calls, 1);
+  EXPECT_EQ(model.num_rows, 3);
+
+  // All of them are found in the table
+  ExpectSameAsUncached(cache.Run(&model, hyps), hyps);
+  EXPECT_EQ(model.num_calls, 1);
+
+  // Only the new context is decoded
+  hyps.push_back(MakeHyp({4}));
+  ExpectSameAsUncached(cache.Run(&model, hyps), hyps);
+  EXPECT_EQ(model.num_calls, 2);
+  EXPECT_EQ(model.num_rows, 4);
+}
+
+TEST(OnlineTransducerDecoderOutCache, ReuseOutputIfAllMiss) {
+  FakeTransducerModel model;
+  OnlineTransducerDecoderOutCache cache;
+
+  std::vector<Hypothesis> hyps = {MakeHyp({1}), MakeHyp({2}), MakeHyp({3})};
+  Ort::Value ans = cache.Run(&model, hyps);
+  ExpectSameAsUncached(ans, hyps);
+  EXPECT_EQ(ans.GetTensorData<float>(), model.last_output);
+
+  // With duplicates, the output is copied
+  hyps = {MakeHyp({4}), MakeHyp({5}), MakeHyp({4})};
+  ans = cache.Run(&model, hyps);
+  ExpectSameAsUncached(ans, hyps);
+  EXPECT_NE(ans.GetTensorData<float>(), model.last_output);
+  EXPECT_EQ(model.num_rows, 5);
+
+  // With some of them found in the table, the output is copied
+  hyps = {MakeHyp({6}), MakeHyp({1})};
+  ans = cache.Run(&model, hyps);
+  ExpectSameAsUncached(ans, hyps);
+  EXPECT_NE(ans.GetTensorData<float>(), model.last_output);
+  EXPECT_EQ(model.num_rows, 6);
+}
+
+TEST(OnlineTransducerDecoderOutCache, ClearWhenThreeQuartersFull) {
+  FakeTransducerModel model;
+
+  // It holds up to 12 contexts
+  OnlineTransducerDecoderOutCache cache(16);
+
+  std::vector<Hypothesis> hyps;
+  for (int32_t i = 1; i <= 12; ++i) {
+    hyps.push_back(MakeHyp({i}));
+  }
+
+  ExpectSameAsUncached(cache.Run(&model, hyps), hyps);
+  EXPECT_EQ(model.num_rows, 12);
+
+  ExpectSameAsUncached(cache.Run(&model, hyps), hyps);
+  EXPECT_EQ(model.num_rows, 12);
+
+  // The 13th context clears the table
+  std::vector<Hypothesis> other = {MakeHyp({13})};
+  ExpectSameAsUncached(cache.Run(&model, other), other);
+  EXPECT_EQ(model.num_rows, 13);
+
+  ExpectSameAsUncached(cache.Run(&model, other), other);
+  EXPECT_EQ(model.num_rows, 13);
+
+  ExpectSameAsUncached(cache.Run(&model, hyps), hyps);
+  EXPECT_EQ(model.num_rows, 25);
+}
+
+}  // namespace sherpa_onnx
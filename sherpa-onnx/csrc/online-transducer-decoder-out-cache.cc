@@ -0,0 +1,203 @@
+// sherpa-onnx/csrc/online-transducer-decoder-out-cache.cc
+//
+// Copyright (c)  2025  Xiaomi Corporation
+
+#include "sherpa-onnx/csrc/online-transducer-decoder-out-cache.h"
+
+#include <algorithm>
+#include <array>
+#include <utility>
+#include <vector>
+
+namespace sherpa_onnx {
+
+static uint64_t HashContext(const int64_t *context, int32_t context_size) {
+  uint64_t h = 14695981039346656037ULL;
+  for (int32_t i = 0; i != context_size; ++i) {
+    h = (h ^ static_cast<uint64_t>(context[i])) * 1099511628211ULL;
+  }
+  return h ^ (h >> 29);
+}
+
+OnlineTransducerDecoderOutCache::OnlineTransducerDecoderOutCache(
+    int32_t capacity) {
+  capacity_ = 16;
+  while (capacity_ < capacity) {
+    capacity_ *= 2;
+  }
+  mask_ = capacity_ - 1;
+  used_.resize(capacity_, 0);
+}
+
+Ort::Value OnlineTransducerDecoderOutCache::Run(
+    OnlineTransducerModel *model, const std::vector<Hypothesis> &hyps) {
+  int32_t n = static_cast<int32_t>(hyps.size());
+  int32_t context_size = model->ContextSize();
+
+  std::vector<int64_t> contexts(n * context_size);
+  for (int32_t i = 0; i != n; ++i) {
+    hyps[i].CopyLastTokens(context_size, contexts.data() + i * context_size);
+  }
+
+  Ort::Value ans{nullptr};
+
+  // Index into hyps of each distinct context that is not in the table
+  std::vector<int32_t> misses;
+
+  // For each hypothesis, index into misses, or -1 if it is found
+  std::vector<int32_t> miss_index(n, -1);
+
+  auto add_miss = [&](int32_t i) {
+    const int64_t *c = contexts.data() + i * context_size;
+    for (int32_t k = 0; k != static_cast<int32_t>(misses.size()); ++k) {
+      const int64_t *m = contexts.data() + misses[k] * context_size;
+      if (std::equal(c, c + context_size, m)) {
+        miss_index[i] = k;
+        return;
+      }
+    }
+    miss_index[i] = static_cast<int32_t>(misses.size());
+    misses.push_back(i);
+  };
+
+  {
+    std::lock_guard<std::mutex> lock(mutex_);
+    if (context_size_ == 0) {
+      context_size_ = context_size;
+      keys_.resize(static_cast<size_t>(capacity_) * context_size_);
+    }
+
+    if (decoder_dim_ > 0) {
+      std::vector<int64_t> shape = shape_;
+      shape[0] = n;
+      ans = Ort::Value::CreateTensor<float>(model->Allocator(), shape.data(),
+                                            shape.size());
+      float *p = ans.GetTensorMutableData<float>();
+
+      for (int32_t i = 0; i != n; ++i) {
+        int32_t slot = Find(contexts.data() + i * context_size);
+        if (slot == -1) {
+          add_miss(i);
+          continue;
+        }
+
+        const float *src = values_.data() + slot * decoder_dim_;
+        std::copy(src, src + decoder_dim_, p + i * decoder_dim_);
+      }
+    } else {
+      for (int32_t i = 0; i != n; ++i) {
+        add_miss(i);
+      }
+    }
+  }
+
+  if (misses.empty()) {
+    return ans;
+  }
+
+  int32_t num_misses = static_cast<int32_t>(misses.size());
+  std::array<int64_t, 2> input_shape{num_misses, context_size};
+  Ort::Value decoder_input = Ort::Value::CreateTensor<int64_t>(
+      model->Allocator(), input_shape.data(), input_shape.size());
+  int64_t *p_input = decoder_input.GetTensorMutableData<int64_t>();
+  for (int32_t k = 0; k != num_misses; ++k) {
+    const int64_t *c = contexts.data() + misses[k] * context_size;
+    std::copy(c, c + context_size, p_input + k * context_size);
+  }
+
+  Ort::Value decoder_out = model->RunDecoder(std::move(decoder_input));
+
+  std::vector<int64_t> shape =
+      decoder_out.GetTensorTypeAndShapeInfo().GetShape();
+  int32_t dim = static_cast<int32_t>(
+      decoder_out.GetTensorTypeAndShapeInfo().GetElementCount() / num_misses);
+
+  // If nothing is found in the table and all contexts are distinct, the
+  // decoder output can be returned as it is.
+  bool reuse_output = num_misses == n;
+  for (int32_t i = 0; i != n && reuse_output; ++i) {
+    reuse_output = miss_index[i] == i;
+  }
+
+  if (reuse_output) {
+    ans = std::move(decoder_out);
+  } else {
+    if (!ans) {
+      std::vector<int64_t> ans_shape = shape;
+      ans_shape[0] = n;
+      ans = Ort::Value::CreateTensor<float>(
+          model->Allocator(), ans_shape.data(), ans_shape.size());
+    }
+
+    float *dst = ans.GetTensorMutableData<float>();
+    const float *src = decoder_out.GetTensorData<float>();
+    for (int32_t i = 0; i != n; ++i) {
+      if (miss_index[i] != -1) {
+        std::copy(src + miss_index[i] * dim, src + (miss_index[i] + 1) * dim,
+                  dst + i * dim);
+      }
+    }
+  }
+
+  const float *p = ans.GetTensorData<float>();
+
+  std::lock_guard<std::mutex> lock(mutex_);
+
+  if (decoder_dim_ == 0) {
+    decoder_dim_ = dim;
+    shape_ = shape;
+    shape_[0] = 1;
+    values_.resize(static_cast<size_t>(capacity_) * decoder_dim_);
+  }
+
+  for (int32_t k = 0; k != num_misses; ++k) {
+    const int64_t *c = contexts.data() + misses[k] * context_size;
+    if (Find(c) == -1) {
+      Insert(c, p + misses[k] * dim);
+    }
+  }
+
+  return ans;
+}
+
+int32_t OnlineTransducerDecoderOutCache::Find(const int64_t *context) const {
+  int32_t slot =
+      static_cast<int32_t>(HashContext(context, context_size_) & mask_);
+
+  while (used_[slot]) {
+    const int64_t *key = keys_.data() + slot * context_size_;
+    if (std::equal(context, context + context_size_, key)) {
+      return slot;
+    }
+    slot = (slot + 1) & mask_;
+  }
+
+  return -1;
+}
+
+void OnlineTransducerDecoderOutCache::Insert(const int64_t *context,
+                                             const float *decoder_out) {
+  if ((size_ + 1) * 4 > capacity_ * 3) {
+    Clear();
+  }
+
+  int32_t slot =
+      static_cast<int32_t>(HashContext(context, context_size_) & mask_);
+  while (used_[slot]) {
+    slot = (slot + 1) & mask_;
+  }
+
+  used_[slot] = 1;
+  std::copy(context, context + context_size_,
+            keys_.begin() + slot * context_size_);
+  std::copy(decoder_out, decoder_out + decoder_dim_,
+            values_.begin() + slot * decoder_dim_);
+  ++size_;
+}
+
+void OnlineTransducerDecoderOutCache::Clear() {
+  std::fill(used_.begin(), used_.end(), 0);
+  size_ = 0;
+}
+
+}  // namespace sherpa_onnx
@@ -0,0 +1,81 @@
+// sherpa-onnx/csrc/online-transducer-decoder-out-cache.h
+//
+// Copyright (c)  2025  Xiaomi Corporation
+#ifndef SHERPA_ONNX_CSRC_ONLINE_TRANSDUCER_DECODER_OUT_CACHE_H_
+#define SHERPA_ONNX_CSRC_ONLINE_TRANSDUCER_DECODER_OUT_CACHE_H_
+
+#include <cstdint>
+#include <mutex>  // NOLINT
+#include <vector>
+
+#include "onnxruntime_cxx_api.h"  // NOLINT
+#include "sherpa-onnx/csrc/hypothesis.h"
+#include "sherpa-onnx/csrc/online-transducer-model.h"
+
+namespace sherpa_onnx {
+
+// Cache of the output of a stateless transducer decoder.
+//
+// The decoder output depends only on the last ContextSize() tokens of a
+// hypothesis, so it is stored in an open-addressing hash table keyed by
+// these tokens. Only hypotheses whose context is not in the table are
+// run through the decoder, in a single batch. Most frames emit blanks,
+// so most lookups hit.
+//
+// When the table is 3/4 full, it is cleared. It is safe to use it from
+// several threads at the same time.
+class OnlineTransducerDecoderOutCache {
+ public:
+  // @param capacity Maximum number of contexts in the table. It is
+  //                 rounded up to a power of 2.
+  explicit OnlineTransducerDecoderOutCache(int32_t capacity = 4096);
+
+  /** Return the decoder output for the given hypotheses.
+   *
+   * It is equivalent to
+   *
+   *   model->RunDecoder(model->BuildDecoderInput(hyps))
+   *
+   * @return Return a tensor of shape (hyps.size(), decoder_dim).
+   */
+  Ort::Value Run(OnlineTransducerModel *model,
+                 const std::vector<Hypothesis> &hyps);
+
+ private:
+  // Return the slot of the given context, or -1 if it is not in the table
+  int32_t Find(const int64_t *context) const;
+
+  // Insert a context that is not in the table
+  void Insert(const int64_t *context, const float *decoder_out);
+
+  void Clear();
+
+ private:
+  int32_t capacity_;
+  int32_t mask_;
+
+  int32_t context_size_ = 0;
+
+  // It is set when the table is used for the first time
+  int32_t decoder_dim_ = 0;
+
+  // Shape of the decoder output with batch size 1
+  std::vector<int64_t> shape_;
+
+  // keys_[i * context_size_ : (i + 1) * context_size_] is the context of
+  // slot i
+  std::vector<int64_t> keys_;
+
+  // values_[i * decoder_dim_ : (i + 1) * decoder_dim_] is the decoder
+  // output of slot i
+  std::vector<float> values_;
+
+  std::vector<uint8_t> used_;
+  int32_t size_ = 0;
+
+  mutable std::mutex mutex_;
+};
+
+}  // namespace sherpa_onnx
+
+#endif  // SHERPA_ONNX_CSRC_ONLINE_TRANSDUCER_DECODER_OUT_CACHE_H_
@@ -5,6 +5,7 @@
 #include "sherpa-onnx/csrc/online-transducer-greedy-search-decoder.h"
 
 #include <algorithm>
+#include <array>
 #include <utility>
 #include <vector>
 
@@ -112,11 +113,20 @@ void OnlineTransducerGreedySearchDecoder::Decode(
     decoder_out = model_->RunDecoder(std::move(decoder_input));
   }
 
+  // Scratch buffers reused across frames and calls. They are thread_local
+  // since streams may be decoded concurrently from several threads.
+  static thread_local std::vector<float> encoder_out_buffer;
+  static thread_local std::vector<float> logit_buffer;
+
+  std::array<int64_t, 2> logit_shape{batch_size, vocab_size};
+
   for (int32_t t = 0; t != num_frames; ++t) {
     Ort::Value cur_encoder_out =
-        GetEncoderOutFrame(model_->Allocator(), &encoder_out, t);
-    Ort::Value logit =
-        model_->RunJoiner(std::move(cur_encoder_out), View(&decoder_out));
+        GetEncoderOutFrame(&encoder_out, t, &encoder_out_buffer);
+    Ort::Value logit = CreateTensorFromBuffer(&logit_buffer, logit_shape.data(),
+                                              logit_shape.size());
+    model_->RunJoinerInto(std::move(cur_encoder_out), View(&decoder_out),
+                          &logit);
 
     float *p_logit = logit.GetTensorMutableData<float>();
 
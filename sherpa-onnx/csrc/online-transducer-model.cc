@@ -17,12 +17,16 @@
 #include <memory>
 #include <sstream>
 #include <string>
+#include <utility>
+#include <vector>
 
 #include "sherpa-onnx/csrc/file-utils.h"
+#include "sherpa-onnx/csrc/gather.h"
 #include "sherpa-onnx/csrc/macros.h"
 #include "sherpa-onnx/csrc/online-conformer-transducer-model.h"
 #include "sherpa-onnx/csrc/online-ebranchformer-transducer-model.h"
 #include "sherpa-onnx/csrc/online-lstm-transducer-model.h"
+#include "sherpa-onnx/csrc/online-stream.h"
 #include "sherpa-onnx/csrc/online-zipformer-transducer-model.h"
 #include "sherpa-onnx/csrc/online-zipformer2-transducer-model.h"
 #include "sherpa-onnx/csrc/onnx-utils.h"
@@ -156,6 +160,115 @@ Ort::Value OnlineTransducerModel::BuildDecoderInput(
   return decoder_input;
 }
 
+void OnlineTransducerModel::RunJoinerInto(Ort::Value encoder_out,
+                                          Ort::Value decoder_out,
+                                          Ort::Value *logit) {
+  *logit = RunJoiner(std::move(encoder_out), std::move(decoder_out));
+}
+
+std::vector<Ort::Value> OnlineTransducerModel::StackStreamStates(
+    OnlineStream **ss, int32_t n) {
+  std::vector<int32_t> dims = StatesBatchDims();
+  if (dims.empty()) {
+    std::vector<std::vector<Ort::Value>> states_vec(n);
+    for (int32_t i = 0; i != n; ++i) {
+      states_vec[i] = std::move(ss[i]->GetStates());
+    }
+    return StackStates(states_vec);
+  }
+
+  const auto &batched = ss[0]->GetBatchedStates();
+  bool reuse = batched && batched->BatchSize() == n;
+  for (int32_t i = 0; reuse && i != n; ++i) {
+    reuse = ss[i]->GetBatchedStates() == batched &&
+            ss[i]->GetBatchedStatesRow() == i;
+  }
+
+  if (reuse) {
+    // The given streams own all rows of it, so none of them is released
+    // and it is not compacted. We return views of it so that it is left
+    // intact if the encoder throws. It is kept alive by the streams until
+    // UnStackStreamStates() gives them new states.
+    int32_t index = 0;
+    auto states = batched->Get(0, &index);
+
+    std::vector<Ort::Value> ans;
+    ans.reserve(states->size());
+    for (auto &v : *states) {
+      ans.push_back(View(&v));
+    }
+    return ans;
+  }
+
+  // Hold the states of each batch, since it may be compacted while we
+  // are reading it
+  std::vector<std::shared_ptr<std::vector<Ort::Value>>> src(n);
+  std::vector<int32_t> rows(n);
+  for (int32_t i = 0; i != n; ++i) {
+    if (ss[i]->GetBatchedStates()) {
+      src[i] = ss[i]->GetBatchedStates()->Get(ss[i]->GetBatchedStatesRow(),
+                                              &rows[i]);
+    } else {
+      // states of a new or reset stream have batch size 1
+      rows[i] = 0;
+    }
+  }
+
+  int32_t num_states = static_cast<int32_t>(dims.size());
+
+  std::vector<Ort::Value> ans;
+  ans.reserve(num_states);
+
+  std::vector<const Ort::Value *> buf(n);
+  for (int32_t k = 0; k != num_states; ++k) {
+    for (int32_t i = 0; i != n; ++i) {
+      buf[i] = src[i] ? &(*src[i])[k] : &ss[i]->GetStates()[k];
+    }
+
+    if (buf[0]->GetTensorTypeAndShapeInfo().GetElementType() ==
+        ONNX_TENSOR_ELEMENT_DATA_TYPE_INT64) {
+      ans.push_back(Gather<int64_t>(Allocator(), buf, rows, dims[k]));
+    } else {
+      ans.push_back(Gather(Allocator(), buf, rows, dims[k]));
+    }
+  }
+
+  return ans;
+}
+
+void OnlineTransducerModel::UnStackStreamStates(std::vector<Ort::Value> states,
+                                                OnlineStream **ss, int32_t n) {
+  std::vector<int32_t> dims = StatesBatchDims();
+  if (dims.empty()) {
+    std::vector<std::vector<Ort::Value>> next_states = UnStackStates(states);
+    for (int32_t i = 0; i != n; ++i) {
+      ss[i]->SetStates(std::move(next_states[i]));
+    }
+    return;
+  }
+
+  // Release the rows of all streams in their previous batches before
+  // compacting any of them, so that we don't copy rows that are about to
+  // be released
+  std::vector<std::shared_ptr<BatchedStates>> prev;
+  prev.reserve(n);
+
+  auto batched =
+      std::make_shared<BatchedStates>(std::move(states), std::move(dims));
+
+  for (int32_t i = 0; i != n; ++i) {
+    const auto &p = ss[i]->GetBatchedStates();
+    if (p && std::find(prev.begin(), prev.end(), p) == prev.end()) {
+      prev.push_back(p);
+    }
+    ss[i]->SetBatchedStates(batched, i);
+  }
+
+  for (auto &p : prev) {
+    p->MaybeCompact();
+  }
+}
+
 Ort::Value OnlineTransducerModel::BuildDecoderInput(
     const std::vector<Hypothesis> &hyps) {
   int32_t batch_size = static_cast<int32_t>(hyps.size());
@@ -166,7 +279,7 @@ Ort::Value OnlineTransducerModel::BuildDecoderInput(
   int64_t *p = decoder_input.GetTensorMutableData<int64_t>();
 
   for (const auto &h : hyps) {
-    std::copy(h.ys.end() - context_size, h.ys.end(), p);
+    h.CopyLastTokens(context_size, p);
     p += context_size;
   }
   return decoder_input;
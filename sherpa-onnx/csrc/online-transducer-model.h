@@ -17,6 +17,7 @@
 namespace sherpa_onnx {
 
 struct OnlineTransducerDecoderResult;
+class OnlineStream;
 
 class OnlineTransducerModel {
  public:
@@ -49,6 +50,43 @@ class OnlineTransducerModel {
   virtual std::vector<std::vector<Ort::Value>> UnStackStates(
       const std::vector<Ort::Value> &states) const = 0;
 
+  /** Return the batch dim of each encoder state tensor.
+   *
+   * If it is not empty, states returned by RunEncoder() are not split into
+   * per-stream states. See StackStreamStates() and UnStackStreamStates().
+   */
+  virtual std::vector<int32_t> StatesBatchDims() const { return {}; }
+
+  /** Get the batched encoder states of a list of streams.
+   *
+   * If StatesBatchDims() is empty, it calls StackStates() with the states
+   * of each stream.
+   *
+   * Otherwise, if the streams are exactly the batch saved by the last
+   * call to UnStackStreamStates(), in the same order, views of the
+   * batched states are returned without any copy. The streams keep
+   * their states until UnStackStreamStates() is called, so they are
+   * still valid if the encoder throws. If not, the rows of each stream
+   * are gathered from the batches they live in.
+   *
+   * @param ss Pointer to a list of streams.
+   * @param n  Number of streams in ss.
+   * @return Return the batched states of the n streams.
+   */
+  std::vector<Ort::Value> StackStreamStates(OnlineStream **ss, int32_t n);
+
+  /** Save the batched states returned by RunEncoder() to the streams.
+   *
+   * It is the inverse operation of `StackStreamStates`. If
+   * StatesBatchDims() is not empty, the batch is shared by the streams
+   * and the i-th stream owns its i-th row. The rows of the streams in
+   * their previous batches are released, and the previous batches that
+   * are now mostly unused are compacted. See BatchedStates. Otherwise,
+   * it is split with UnStackStates().
+   */
+  void UnStackStreamStates(std::vector<Ort::Value> states, OnlineStream **ss,
+                           int32_t n);
+
   /** Get the initial encoder states.
    *
    * @return Return the initial encoder state.
@@ -105,6 +143,17 @@ class OnlineTransducerModel {
   virtual Ort::Value RunJoiner(Ort::Value encoder_out,
                                Ort::Value decoder_out) = 0;
 
+  /** Like RunJoiner() but the output is written to a preallocated tensor
+   * so that no memory is allocated for it in the decoding loop.
+   *
+   * @param logit A tensor of shape (N, vocab_size). Its content is
+   *              overwritten with the output of the joint network.
+   *              Models that don't support preallocated outputs replace
+   *              it with a newly allocated tensor.
+   */
+  virtual void RunJoinerInto(Ort::Value encoder_out, Ort::Value decoder_out,
+                             Ort::Value *logit);
+
   /** If we are using a stateless decoder and if it contains a
    *  Conv1D, this function returns the kernel size of the convolution layer.
    */
@@ -6,6 +6,7 @@
 #include "sherpa-onnx/csrc/online-transducer-modified-beam-search-decoder.h"
 
 #include <algorithm>
+#include <array>
 #include <utility>
 #include <vector>
 
@@ -56,14 +57,15 @@ void OnlineTransducerModifiedBeamSearchDecoder::StripLeadingBlanks(
   int32_t context_size = model_->ContextSize();
   auto hyp = r->hyps.GetMostProbable(true);
 
-  std::vector<int64_t> tokens(hyp.ys.begin() + context_size, hyp.ys.end());
+  std::vector<int64_t> tokens = hyp.Ys();
+  tokens.erase(tokens.begin(), tokens.begin() + context_size);
   r->tokens = std::move(tokens);
-  r->timestamps = std::move(hyp.timestamps);
+  r->timestamps = hyp.Timestamps();
 
   // export per-token scores
-  r->ys_probs = std::move(hyp.ys_probs);
-  r->lm_probs = std::move(hyp.lm_probs);
-  r->context_scores = std::move(hyp.context_scores);
+  r->ys_probs = hyp.YsProbs();
+  r->lm_probs = hyp.LmProbs();
+  r->context_scores = hyp.ContextScores();
 
   r->num_trailing_blanks = hyp.num_trailing_blanks;
 }
@@ -100,6 +102,12 @@ void OnlineTransducerModifiedBeamSearchDecoder::Decode(
   }
   std::vector<Hypothesis> prev;
 
+  // Scratch buffers reused across frames and calls. They are thread_local
+  // since streams may be decoded concurrently from several threads.
+  static thread_local std::vector<float> encoder_out_buffer;
+  static thread_local std::vector<float> repeat_buffer;
+  static thread_local std::vector<float> logit_buffer;
+
   for (int32_t t = 0; t != num_frames; ++t) {
     // Due to merging paths with identical token sequences,
     // not all utterances have "num_active_paths" paths.
@@ -115,67 +123,66 @@ void OnlineTransducerModifiedBeamSearchDecoder::Decode(
     cur.clear();
     cur.reserve(batch_size);
 
-    Ort::Value decoder_input = model_->BuildDecoderInput(prev);
-    Ort::Value decoder_out = model_->RunDecoder(std::move(decoder_input));
+    Ort::Value decoder_out = decoder_out_cache_.Run(model_, prev);
     if (t == 0) {
       UseCachedDecoderOut(hyps_row_splits, *result, &decoder_out);
     }
 
     Ort::Value cur_encoder_out =
-        GetEncoderOutFrame(model_->Allocator(), &encoder_out, t);
+        GetEncoderOutFrame(&encoder_out, t, &encoder_out_buffer);
     cur_encoder_out =
-        Repeat(model_->Allocator(), &cur_encoder_out, hyps_row_splits);
-    Ort::Value logit =
-        model_->RunJoiner(std::move(cur_encoder_out), View(&decoder_out));
+        Repeat(&cur_encoder_out, hyps_row_splits, &repeat_buffer);
+    std::array<int64_t, 2> logit_shape{num_hyps, vocab_size};
+    Ort::Value logit = CreateTensorFromBuffer(&logit_buffer, logit_shape.data(),
+                                              logit_shape.size());
+    model_->RunJoinerInto(std::move(cur_encoder_out), View(&decoder_out),
+                          &logit);
 
     float *p_logit = logit.GetTensorMutableData<float>();
 
-    // copy raw logits, apply temperature-scaling  (for confidences)
+    // Log-normalizer of the temperature-scaled logits (for confidences).
     // Note: temperature scaling is used only for the confidences,
     //       the decoding algorithm uses the original logits
-    int32_t p_logit_items = vocab_size * num_hyps;
-    std::vector<float> logit_with_temperature(p_logit_items);
-    {
-      std::copy(p_logit, p_logit + p_logit_items,
-                logit_with_temperature.begin());
-      for (float &elem : logit_with_temperature) {
-        elem /= temperature_scale_;
-      }
-      LogSoftmax(logit_with_temperature.data(), vocab_size, num_hyps);
-    }
+    //
+    // It is computed only for hypotheses that emit a non-blank token,
+    // since in most frames only blanks are selected.
+    std::vector<float> log_norm_with_temperature(num_hyps);
+    std::vector<bool> has_log_norm_with_temperature(num_hyps, false);
 
     if (blank_penalty_ > 0.0) {
       // assuming blank id is 0
       SubtractBlank(p_logit, vocab_size, num_hyps, 0, blank_penalty_);
     }
-    LogSoftmax(p_logit, vocab_size, num_hyps);
-
-    // now p_logit contains log_softmax output, we rename it to p_logprob
-    // to match what it actually contains
-    float *p_logprob = p_logit;
 
-    // add log_prob of each hypothesis to p_logprob before taking top_k
+    // log_prob of each hypothesis, added to the log_softmax output of the
+    // joiner before taking top_k
+    std::vector<float> hyp_log_probs(num_hyps);
     for (int32_t i = 0; i != num_hyps; ++i) {
-      float log_prob = prev[i].log_prob;
+      hyp_log_probs[i] = prev[i].log_prob;
       if (lm_ && shallow_fusion_) {
-         log_prob += prev[i].lm_log_prob;
-      }
-
-      for (int32_t k = 0; k != vocab_size; ++k, ++p_logprob) {
-        *p_logprob += log_prob;
+        hyp_log_probs[i] += prev[i].lm_log_prob;
       }
     }
-    p_logprob = p_logit;  // we changed p_logprob in the above for loop
 
+    // New hypotheses of all streams. They are added to cur only after the
+    // LM has scored those ending with a new token, so that it can score
+    // all of them with a single batched run.
+    std::vector<Hypothesis> new_hyps;
+    std::vector<int32_t> new_hyps_row_splits(batch_size + 1);
+    std::vector<float> prev_lm_log_probs;
+    std::vector<int32_t> lm_hyp_indexes;
+
+    std::vector<float> topk_log_probs;
     for (int32_t b = 0; b != batch_size; ++b) {
       int32_t frame_offset = (*result)[b].frame_offset;
       int32_t start = hyps_row_splits[b];
       int32_t end = hyps_row_splits[b + 1];
-      auto topk =
-          TopkIndex(p_logprob, vocab_size * (end - start), max_active_paths_);
+      auto topk = LogSoftmaxTopk(
+          p_logit + start * vocab_size, vocab_size, end - start,
+          hyp_log_probs.data() + start, max_active_paths_, &topk_log_probs);
 
-      Hypotheses hyps;
-      for (auto k : topk) {
+      for (int32_t j = 0; j != static_cast<int32_t>(topk.size()); ++j) {
+        int32_t k = topk[j];
         int32_t hyp_index = k / vocab_size + start;
         int32_t new_token = k % vocab_size;
 
@@ -187,8 +194,7 @@ void OnlineTransducerModifiedBeamSearchDecoder::Decode(
         // blank is hardcoded to 0
         // also, it treats unk as blank
         if (new_token != 0 && new_token != unk_id_) {
-          new_hyp.ys.push_back(new_token);
-          new_hyp.timestamps.push_back(t + frame_offset);
+          new_hyp.Append(new_token, t + frame_offset);
           new_hyp.num_trailing_blanks = 0;
           if (ss != nullptr && ss[b]->GetContextGraph() != nullptr) {
             auto context_res = ss[b]->GetContextGraph()->ForwardOneStep(
@@ -197,47 +203,80 @@ void OnlineTransducerModifiedBeamSearchDecoder::Decode(
             new_hyp.context_state = std::get<1>(context_res);
           }
           if (lm_ && shallow_fusion_) {
-            lm_->ComputeLMScoreSF(lm_scale_, &new_hyp);
+            lm_hyp_indexes.push_back(static_cast<int32_t>(new_hyps.size()));
           }
         } else {
           ++new_hyp.num_trailing_blanks;
         }
         if (lm_ && shallow_fusion_) {
-           new_hyp.log_prob = p_logprob[k] + context_score -
+           new_hyp.log_prob = topk_log_probs[j] + context_score -
                            prev_lm_log_prob;  // log_prob only includes the
                                               // score of the transducer
         } else {
-           new_hyp.log_prob = p_logprob[k] + context_score;  // rescore or no LM
-                                                             // previous token
-                                                             // score is ignored
+          // rescore or no LM, previous token score is ignored
+          new_hyp.log_prob = topk_log_probs[j] + context_score;
         }
 
         // export the per-token log scores
         if (new_token != 0 && new_token != unk_id_) {
-          float y_prob = logit_with_temperature[start * vocab_size + k];
-          new_hyp.ys_probs.push_back(y_prob);
-
-          if (lm_ && shallow_fusion_) {  // export only if
-                                         // LM shallow fusion is used
-            float lm_prob = new_hyp.lm_log_prob - prev_lm_log_prob;
-
-            if (lm_scale_ != 0.0) {
-              lm_prob /= lm_scale_;  // remove lm-scale
+          if (!has_log_norm_with_temperature[hyp_index]) {
+            float *p = p_logit + hyp_index * vocab_size;
+            if (blank_penalty_ > 0.0) {
+              p[0] += blank_penalty_;  // confidences use the original logits
+            }
+            log_norm_with_temperature[hyp_index] =
+                LogSumExp<float>(p, vocab_size, 1 / temperature_scale_);
+            if (blank_penalty_ > 0.0) {
+              p[0] -= blank_penalty_;
             }
-            new_hyp.lm_probs.push_back(lm_prob);
+            has_log_norm_with_temperature[hyp_index] = true;
           }
 
+          float y_prob =
+              p_logit[start * vocab_size + k] / temperature_scale_ -
+              log_norm_with_temperature[hyp_index];
+          new_hyp.SetLastYsProb(y_prob);
+
           // export only when `ContextGraph` is used
           if (ss != nullptr && ss[b]->GetContextGraph() != nullptr) {
-            new_hyp.context_scores.push_back(context_score);
+            new_hyp.SetLastContextScore(context_score);
           }
         }
 
-        hyps.Add(std::move(new_hyp));
-      }  // for (auto k : topk)
-      cur.push_back(std::move(hyps));
-      p_logprob += (end - start) * vocab_size;
+        new_hyps.push_back(std::move(new_hyp));
+        prev_lm_log_probs.push_back(prev_lm_log_prob);
+      }  // for (int32_t j = 0; j != topk.size(); ++j)
+      new_hyps_row_splits[b + 1] = static_cast<int32_t>(new_hyps.size());
     }  // for (int32_t b = 0; b != batch_size; ++b)
+
+    if (!lm_hyp_indexes.empty()) {
+      std::vector<Hypothesis *> lm_hyps;
+      lm_hyps.reserve(lm_hyp_indexes.size());
+      for (auto i : lm_hyp_indexes) {
+        lm_hyps.push_back(&new_hyps[i]);
+      }
+
+      lm_->ComputeLMScoreSF(lm_scale_, lm_hyps);
+
+      // export only if LM shallow fusion is used
+      for (auto i : lm_hyp_indexes) {
+        float lm_prob = new_hyps[i].lm_log_prob - prev_lm_log_probs[i];
+
+        if (lm_scale_ != 0.0) {
+          lm_prob /= lm_scale_;  // remove lm-scale
+        }
+        new_hyps[i].SetLastLmProb(lm_prob);
+      }
+    }
+
+    for (int32_t b = 0; b != batch_size; ++b) {
+      Hypotheses hyps;
+      for (int32_t i = new_hyps_row_splits[b]; i != new_hyps_row_splits[b + 1];
+           ++i) {
+        hyps.Add(std::move(new_hyps[i]));
+      }
+      cur.push_back(std::move(hyps));
+    }
   }    // for (int32_t t = 0; t != num_frames; ++t)
 
   // classic lm rescore
@@ -251,7 +290,7 @@ void OnlineTransducerModifiedBeamSearchDecoder::Decode(
     auto &r = (*result)[b];
 
     r.hyps = std::move(hyps);
-    r.tokens = std::move(best_hyp.ys);
+    r.tokens = best_hyp.Ys();
     r.num_trailing_blanks = best_hyp.num_trailing_blanks;
     r.frame_offset += num_frames;
   }
@@ -11,6 +11,7 @@
 #include "sherpa-onnx/csrc/online-lm.h"
 #include "sherpa-onnx/csrc/online-stream.h"
 #include "sherpa-onnx/csrc/online-transducer-decoder.h"
+#include "sherpa-onnx/csrc/online-transducer-decoder-out-cache.h"
 #include "sherpa-onnx/csrc/online-transducer-model.h"
 
 namespace sherpa_onnx {
@@ -57,6 +58,8 @@ class OnlineTransducerModifiedBeamSearchDecoder
   int32_t unk_id_;
   float blank_penalty_;
   float temperature_scale_;
+
+  OnlineTransducerDecoderOutCache decoder_out_cache_;
 };
 
 }  // namespace sherpa_onnx
@@ -4,6 +4,9 @@
 
 #include "sherpa-onnx/csrc/online-websocket-server-impl.h"
 
+#include <sstream>
+#include <string>
+#include <utility>
 #include <vector>
 
 #include "sherpa-onnx/csrc/file-utils.h"
@@ -15,11 +18,25 @@ void OnlineWebsocketDecoderConfig::Register(ParseOptions *po) {
   recognizer_config.Register(po);
 
   po->Register("loop-interval-ms", &loop_interval_ms,
-               "It determines how often the decoder loop runs. ");
+               "It determines how often we check for disconnected clients. "
+               "Streams are decoded as soon as they are ready, so it does "
+               "not affect latency.");
 
   po->Register("max-batch-size", &max_batch_size,
                "Max batch size for recognition.");
 
+  po->Register("max-batch-wait-ms", &max_batch_wait_ms,
+               "A stream that is ready for decoding waits at most this "
+               "number of milliseconds for other streams to join its batch. "
+               "Larger values give larger batches at the cost of latency. "
+               "The wait is fixed: under light load, when batches are "
+               "seldom full, it adds up to this much latency to each "
+               "chunk. 0 means to decode ready streams right away.");
+
+  po->Register("stats-interval-s", &stats_interval_s,
+               "How often to log the histograms of queue depth and batch "
+               "size. 0 disables it.");
+
   po->Register("end-tail-padding", &end_tail_padding,
                "It determines the length of tail_padding at the end of audio.");
 }
@@ -28,6 +45,8 @@ void OnlineWebsocketDecoderConfig::Validate() const {
   recognizer_config.Validate();
   SHERPA_ONNX_CHECK_GT(loop_interval_ms, 0);
   SHERPA_ONNX_CHECK_GT(max_batch_size, 0);
+  SHERPA_ONNX_CHECK_GE(max_batch_wait_ms, 0);
+  SHERPA_ONNX_CHECK_GE(stats_interval_s, 0);
   SHERPA_ONNX_CHECK_GT(end_tail_padding, 0);
 }
 
@@ -43,10 +62,49 @@ void OnlineWebsocketServerConfig::Validate() const {
   decoder_config.Validate();
 }
 
+void Histogram::Add(int32_t value) {
+  int32_t i = 0;
+  while (value >= (1 << i) && i + 1 < static_cast<int32_t>(counts_.size())) {
+    ++i;
+  }
+  counts_[i] += 1;
+  num_values_ += 1;
+  sum_ += value;
+}
+
+std::string Histogram::ToString() const {
+  std::ostringstream os;
+  os << "count: " << num_values_;
+  if (num_values_ == 0) {
+    return os.str();
+  }
+
+  os << ", mean: " << static_cast<float>(sum_) / num_values_;
+  for (int32_t i = 0; i != static_cast<int32_t>(counts_.size()); ++i) {
+    if (counts_[i] == 0) {
+      continue;
+    }
+
+    if (i == 0) {
+      os << ", [0]: ";
+    } else if (i == 1) {
+      os << ", [1]: ";
+    } else if (i + 1 == static_cast<int32_t>(counts_.size())) {
+      os << ", [" << (1 << (i - 1)) << ", inf): ";
+    } else {
+      os << ", [" << (1 << (i - 1)) << ", " << ((1 << i) - 1) << "]: ";
+    }
+    os << counts_[i];
+  }
+  return os.str();
+}
+
 OnlineWebsocketDecoder::OnlineWebsocketDecoder(OnlineWebsocketServer *server)
     : server_(server),
       config_(server->GetConfig().decoder_config),
-      timer_(server->GetWorkContext()) {
+      timer_(server->GetWorkContext()),
+      batch_timer_(server->GetWorkContext()),
+      last_stats_time_(std::chrono::steady_clock::now()) {
   recognizer_ = std::make_unique<OnlineRecognizer>(config_.recognizer_config);
 }
 
@@ -66,33 +124,42 @@ std::shared_ptr<Connection> OnlineWebsocketDecoder::GetOrCreateConnection(
 }
 
 void OnlineWebsocketDecoder::AcceptWaveform(std::shared_ptr<Connection> c) {
-  std::lock_guard<std::mutex> lock(c->mutex);
-  float sample_rate = config_.recognizer_config.feat_config.sampling_rate;
-  while (!c->samples.empty()) {
-    const auto &s = c->samples.front();
-    c->s->AcceptWaveform(sample_rate, s.data(), s.size());
-    c->samples.pop_front();
+  {
+    std::lock_guard<std::mutex> lock(c->mutex);
+    float sample_rate = config_.recognizer_config.feat_config.sampling_rate;
+    while (!c->samples.empty()) {
+      const auto &s = c->samples.front();
+      c->s->AcceptWaveform(sample_rate, s.data(), s.size());
+      c->samples.pop_front();
+    }
   }
+
+  Schedule(std::move(c));
 }
 
 void OnlineWebsocketDecoder::InputFinished(std::shared_ptr<Connection> c) {
-  std::lock_guard<std::mutex> lock(c->mutex);
+  {
+    std::lock_guard<std::mutex> lock(c->mutex);
 
-  float sample_rate = config_.recognizer_config.feat_config.sampling_rate;
+    float sample_rate = config_.recognizer_config.feat_config.sampling_rate;
 
-  while (!c->samples.empty()) {
-    const auto &s = c->samples.front();
-    c->s->AcceptWaveform(sample_rate, s.data(), s.size());
-    c->samples.pop_front();
-  }
+    while (!c->samples.empty()) {
+      const auto &s = c->samples.front();
+      c->s->AcceptWaveform(sample_rate, s.data(), s.size());
+      c->samples.pop_front();
+    }
 
-  std::vector<float> tail_padding(
-      static_cast<int64_t>(config_.end_tail_padding * sample_rate));
+    std::vector<float> tail_padding(
+        static_cast<int64_t>(config_.end_tail_padding * sample_rate));
 
-  c->s->AcceptWaveform(sample_rate, tail_padding.data(), tail_padding.size());
+    c->s->AcceptWaveform(sample_rate, tail_padding.data(),
+                         tail_padding.size());
 
-  c->s->InputFinished();
-  c->eof = true;
+    c->s->InputFinished();
+    c->eof = true;
+  }
+
+  Schedule(std::move(c));
 }
 
 void OnlineWebsocketDecoder::Warmup() const {
@@ -107,61 +174,152 @@ void OnlineWebsocketDecoder::Run() {
       [this](const asio::error_code &ec) { ProcessConnections(ec); });
 }
 
-void OnlineWebsocketDecoder::ProcessConnections(const asio::error_code &ec) {
-  if (ec) {
-    SHERPA_ONNX_LOG(FATAL) << "The decoder loop is aborted!";
+void OnlineWebsocketDecoder::Schedule(std::shared_ptr<Connection> c) {
+  {
+    std::lock_guard<std::mutex> lock(queue_mutex_);
+    if (active_.count(c->hdl) || c->done) {
+      // It is being checked, queued, being decoded or finished. If it is
+      // being checked, the check is repeated. If it is being decoded,
+      // Decode() calls Schedule() again once it is done.
+      c->check_again = true;
+      return;
+    }
+
+    active_.insert(c->hdl);
+    c->check_again = false;
   }
 
-  std::lock_guard<std::mutex> lock(mutex_);
-  std::vector<connection_hdl> to_remove;
-  for (auto &p : connections_) {
-    auto hdl = p.first;
-    auto c = p.second;
-
-    // The order of `if` below matters!
-    if (!server_->Contains(hdl)) {
-      // If the connection is disconnected, we stop processing it
-      to_remove.push_back(hdl);
-      continue;
+  bool done = false;
+  while (true) {
+    bool eof = false;
+    {
+      std::lock_guard<std::mutex> lock(c->mutex);
+      eof = c->eof;
     }
 
-    if (active_.count(hdl)) {
-      // Another thread is decoding this stream, so skip it
-      continue;
+    bool ready = recognizer_->IsReady(c->s.get());
+
+    std::lock_guard<std::mutex> lock(queue_mutex_);
+    if (ready) {
+      auto deadline = std::chrono::steady_clock::now() +
+                      std::chrono::milliseconds(config_.max_batch_wait_ms);
+      ready_connections_.push_back({c, deadline});
+
+      DispatchLocked();
+      break;
     }
 
-    if (!recognizer_->IsReady(c->s.get()) && !c->eof) {
-      // this stream has not enough frames to decode, so skip it
+    if (c->check_again) {
+      // It may have received samples or input may have finished
+      // while we were checking it
+      c->check_again = false;
       continue;
     }
 
-    if (!recognizer_->IsReady(c->s.get()) && c->eof) {
-      // We won't receive samples from the client, so send a Done! to client
+    active_.erase(c->hdl);
 
-      asio::post(server_->GetWorkContext(),
-                 [this, hdl = c->hdl]() { server_->Send(hdl, "Done!"); });
+    // If it is not ready and we won't receive samples from the client,
+    // we are done with it
+    done = eof;
+    c->done = eof;
+    break;
+  }
 
-      to_remove.push_back(hdl);
-      continue;
+  if (done) {
+    asio::post(server_->GetConnectionContext(),
+               [this, hdl = c->hdl]() { server_->Send(hdl, "Done!"); });
+
+    RemoveConnection(c->hdl);
+  }
+}
+
+void OnlineWebsocketDecoder::DispatchLocked() {
+  auto now = std::chrono::steady_clock::now();
+  while (!ready_connections_.empty() &&
+         (static_cast<int32_t>(ready_connections_.size()) >=
+              config_.max_batch_size ||
+          ready_connections_.front().deadline <= now)) {
+    queue_depth_.Add(ready_connections_.size());
+
+    std::vector<std::shared_ptr<Connection>> c_vec;
+    while (!ready_connections_.empty() &&
+           static_cast<int32_t>(c_vec.size()) < config_.max_batch_size) {
+      c_vec.push_back(std::move(ready_connections_.front().c));
+      ready_connections_.pop_front();
     }
 
-    // TODO(fangun): If the connection is timed out, we need to also
-    // add it to `to_remove`
+    batch_size_.Add(c_vec.size());
 
-    // this stream has enough frames and is currently not processed by any
-    // threads, so put it into the ready queue
-    ready_connections_.push_back(c);
+    asio::post(server_->GetWorkContext(),
+               [this, c_vec = std::move(c_vec)]() mutable {
+                 Decode(std::move(c_vec));
+               });
+  }
 
-    // In `Decode()`, it will remove hdl from `active_`
-    active_.insert(c->hdl);
+  if (ready_connections_.empty() || batch_timer_armed_) {
+    // If the timer is armed, it is for the current front since
+    // streams are queued in the order of their deadlines.
+    return;
   }
 
-  for (auto hdl : to_remove) {
-    connections_.erase(hdl);
+  batch_timer_armed_ = true;
+  batch_timer_.expires_at(ready_connections_.front().deadline);
+  batch_timer_.async_wait(
+      [this](const asio::error_code &ec) { OnBatchTimer(ec); });
+}
+
+void OnlineWebsocketDecoder::OnBatchTimer(const asio::error_code &ec) {
+  if (ec == asio::error::operation_aborted) {
+    return;
   }
 
-  if (!ready_connections_.empty()) {
-    asio::post(server_->GetWorkContext(), [this]() { Decode(); });
+  std::lock_guard<std::mutex> lock(queue_mutex_);
+  batch_timer_armed_ = false;
+  DispatchLocked();
+}
+
+void OnlineWebsocketDecoder::RemoveConnection(connection_hdl hdl) {
+  std::lock_guard<std::mutex> lock(mutex_);
+  connections_.erase(hdl);
+}
+
+void OnlineWebsocketDecoder::ProcessConnections(const asio::error_code &ec) {
+  if (ec) {
+    SHERPA_ONNX_LOG(FATAL) << "The decoder loop is aborted!";
+  }
+
+  {
+    std::lock_guard<std::mutex> lock(mutex_);
+    std::vector<connection_hdl> to_remove;
+    for (auto &p : connections_) {
+      auto hdl = p.first;
+
+      if (!server_->Contains(hdl)) {
+        // If the connection is disconnected, we stop processing it
+        to_remove.push_back(hdl);
+      }
+
+      // TODO(fangun): If the connection is timed out, we need to also
+      // add it to `to_remove`
+    }
+
+    for (auto hdl : to_remove) {
+      connections_.erase(hdl);
+    }
+  }
+
+  if (config_.stats_interval_s > 0) {
+    auto now = std::chrono::steady_clock::now();
+    if (now - last_stats_time_ >=
+        std::chrono::seconds(config_.stats_interval_s)) {
+      last_stats_time_ = now;
+
+      std::lock_guard<std::mutex> lock(queue_mutex_);
+      SHERPA_ONNX_LOG(INFO) << "Queue depth: " << queue_depth_.ToString()
+                            << "\n";
+      SHERPA_ONNX_LOG(INFO) << "Batch size: " << batch_size_.ToString()
+                            << "\n";
+    }
   }
 
   // Schedule another call
@@ -171,35 +329,15 @@ void OnlineWebsocketDecoder::ProcessConnections(const asio::error_code &ec) {
       [this](const asio::error_code &ec) { ProcessConnections(ec); });
 }
 
-void OnlineWebsocketDecoder::Decode() {
-  std::unique_lock<std::mutex> lock(mutex_);
-  if (ready_connections_.empty()) {
-    // There are no connections that are ready for decoding,
-    // so we return directly
-    return;
-  }
-
-  std::vector<std::shared_ptr<Connection>> c_vec;
+void OnlineWebsocketDecoder::Decode(
+    std::vector<std::shared_ptr<Connection>> c_vec) {
   std::vector<OnlineStream *> s_vec;
-  while (!ready_connections_.empty() &&
-         static_cast<int32_t>(s_vec.size()) < config_.max_batch_size) {
-    auto c = ready_connections_.front();
-    ready_connections_.pop_front();
-
-    c_vec.push_back(c);
+  s_vec.reserve(c_vec.size());
+  for (const auto &c : c_vec) {
     s_vec.push_back(c->s.get());
   }
 
-  if (!ready_connections_.empty()) {
-    // there are too many ready connections but this thread can only handle
-    // max_batch_size connections at a time, so we schedule another call
-    // to Decode() and let other threads to process the ready connections
-    asio::post(server_->GetWorkContext(), [this]() { Decode(); });
-  }
-
-  lock.unlock();
   recognizer_->DecodeStreams(s_vec.data(), s_vec.size());
-  lock.lock();
 
   for (auto c : c_vec) {
     auto result = recognizer_->GetResult(c->s.get());
@@ -217,7 +355,14 @@ void OnlineWebsocketDecoder::Decode() {
                [this, hdl = c->hdl, str = result.AsJsonString()]() {
                  server_->Send(hdl, str);
                });
-    active_.erase(c->hdl);
+
+    {
+      std::lock_guard<std::mutex> lock(queue_mutex_);
+      active_.erase(c->hdl);
+    }
+
+    // It may have received enough samples while we were decoding it
+    Schedule(std::move(c));
   }
 }
 
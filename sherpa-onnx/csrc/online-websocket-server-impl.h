@@ -5,6 +5,8 @@
 #ifndef SHERPA_ONNX_CSRC_ONLINE_WEBSOCKET_SERVER_IMPL_H_
 #define SHERPA_ONNX_CSRC_ONLINE_WEBSOCKET_SERVER_IMPL_H_
 
+#include <array>
+#include <chrono>  // NOLINT
 #include <deque>
 #include <fstream>
 #include <map>
@@ -36,6 +38,15 @@ struct Connection {
   // set it to true when InputFinished() is called
   bool eof = false;
 
+  // Set to true, under the queue mutex of the decoder, when "Done!" is
+  // sent, so that it is sent only once
+  bool done = false;
+
+  // Set to true, under the queue mutex of the decoder, if Schedule() is
+  // called while the stream is being checked or decoded, so that it is
+  // checked again afterwards
+  bool check_again = false;
+
   // The last time we received a message from the client
   // TODO(fangjun): Use it to disconnect from a client if it is inactive
   // for a specified time.
@@ -57,17 +68,47 @@ struct Connection {
 struct OnlineWebsocketDecoderConfig {
   OnlineRecognizerConfig recognizer_config;
 
-  // It determines how often the decoder loop runs.
-  int32_t loop_interval_ms = 10;
+  // It determines how often we check for disconnected clients.
+  // Streams are scheduled for decoding as soon as they are ready, so
+  // it does not affect latency. The default was 10 when this loop also
+  // decoded the streams; now a longer interval only avoids locking all
+  // connections 100 times per second.
+  int32_t loop_interval_ms = 100;
 
   int32_t max_batch_size = 5;
 
+  // A ready stream waits at most this long for more streams to
+  // join its batch. 0 means to decode ready streams right away.
+  //
+  // The wait does not adapt to the load. Under heavy load, batches are
+  // full before the deadline and it does not matter. Under light load,
+  // every stream waits the full time for streams that may not come, so
+  // it adds up to this much latency to each chunk.
+  int32_t max_batch_wait_ms = 5;
+
+  // How often to log the queue depth and batch size histograms.
+  // 0 disables it.
+  int32_t stats_interval_s = 60;
+
   float end_tail_padding = 0.8;
 
   void Register(ParseOptions *po);
   void Validate() const;
 };
 
+// A histogram with power-of-two buckets, i.e., 0, 1, 2-3, 4-7, ...
+class Histogram {
+ public:
+  void Add(int32_t value);
+
+  std::string ToString() const;
+
+ private:
+  std::array<int64_t, 16> counts_{};
+  int64_t num_values_ = 0;
+  int64_t sum_ = 0;
+};
+
 class OnlineWebsocketServer;
 
 class OnlineWebsocketDecoder {
@@ -92,30 +133,75 @@ class OnlineWebsocketDecoder {
  private:
   void ProcessConnections(const asio::error_code &ec);
 
+  /** Put a connection into the ready queue if it has enough frames
+   * and is not queued or being decoded. It is called whenever the
+   * stream of a connection may have become ready.
+   *
+   * IsReady() is called without holding queue_mutex_, which is shared
+   * by all connections. The connection is put into active_ first so that
+   * no other thread checks or decodes it meanwhile.
+   */
+  void Schedule(std::shared_ptr<Connection> c);
+
+  /** Post batches from the ready queue to the worker threads.
+   *
+   * A batch is posted once it has max_batch_size streams or once its
+   * oldest stream has waited max_batch_wait_ms. Otherwise, a timer is
+   * armed for the deadline of the oldest stream.
+   *
+   * The caller must hold queue_mutex_.
+   */
+  void DispatchLocked();
+
+  void OnBatchTimer(const asio::error_code &ec);
+
   /** It is called by one of the worker thread.
    */
-  void Decode();
+  void Decode(std::vector<std::shared_ptr<Connection>> c_vec);
+
+  void RemoveConnection(connection_hdl hdl);
 
  private:
+  struct ReadyConnection {
+    std::shared_ptr<Connection> c;
+
+    // Time at which the connection must be dispatched for decoding
+    std::chrono::steady_clock::time_point deadline;
+  };
+
   OnlineWebsocketServer *server_;  // not owned
   std::unique_ptr<OnlineRecognizer> recognizer_;
   OnlineWebsocketDecoderConfig config_;
   asio::steady_timer timer_;
 
-  // It protects `connections_`, `ready_connections_`, and `active_`
+  // It protects `connections_`
   std::mutex mutex_;
 
   std::map<connection_hdl, std::shared_ptr<Connection>,
            std::owner_less<connection_hdl>>
       connections_;
 
-  // Whenever a connection has enough feature frames for decoding, we put
-  // it in this queue
-  std::deque<std::shared_ptr<Connection>> ready_connections_;
+  // It protects the members below. It is never held while decoding.
+  std::mutex queue_mutex_;
 
-  // If we are decoding a stream, we put it in the active_ set so that
-  // only one thread can decode a stream at a time.
+  // Whenever a connection has enough feature frames for decoding, we put
+  // it in this queue. Since every connection waits for the same
+  // max_batch_wait_ms, it is sorted by deadline. A connection appears at
+  // most once, so no connection can starve the others.
+  std::deque<ReadyConnection> ready_connections_;
+
+  // If a stream is being checked by Schedule(), queued or being decoded,
+  // we put it in the active_ set so that only one thread can access the
+  // stream at a time.
   std::set<connection_hdl, std::owner_less<connection_hdl>> active_;
+
+  // It posts the ready queue once its oldest stream reaches its deadline
+  asio::steady_timer batch_timer_;
+  bool batch_timer_armed_ = false;
+
+  Histogram queue_depth_;
+  Histogram batch_size_;
+  std::chrono::steady_clock::time_point last_stats_time_;
 };
 
 struct OnlineWebsocketServerConfig {
@@ -23,7 +23,7 @@ Usage:
   --joiner=/path/to/joiner.onnx \
   --log-file=./log.txt \
   --max-batch-size=5 \
-  --loop-interval-ms=10
+  --max-batch-wait-ms=5
 
 Please refer to
 https://k2-fsa.github.io/sherpa/onnx/pretrained_models/index.html
@@ -27,6 +27,7 @@
 #include "sherpa-onnx/csrc/macros.h"
 #include "sherpa-onnx/csrc/online-transducer-decoder.h"
 #include "sherpa-onnx/csrc/onnx-utils.h"
+#include "sherpa-onnx/csrc/session-registry.h"
 #include "sherpa-onnx/csrc/session.h"
 #include "sherpa-onnx/csrc/text-utils.h"
 #include "sherpa-onnx/csrc/unbind.h"
@@ -37,7 +38,7 @@ OnlineZipformerTransducerModel::OnlineZipformerTransducerModel(
     const OnlineModelConfig &config)
     : env_(ORT_LOGGING_LEVEL_ERROR),
       config_(config),
-      sess_opts_(GetSessionOptions(config)),
+      sess_opts_(GetSessionOptionsWithKey(config)),
       allocator_{} {
   {
     auto buf = ReadFile(config.transducer.encoder);
@@ -60,7 +61,7 @@ OnlineZipformerTransducerModel::OnlineZipformerTransducerModel(
     Manager *mgr, const OnlineModelConfig &config)
     : env_(ORT_LOGGING_LEVEL_ERROR),
       config_(config),
-      sess_opts_(GetSessionOptions(config)),
+      sess_opts_(GetSessionOptionsWithKey(config)),
       allocator_{} {
   {
     auto buf = ReadFile(mgr, config.transducer.encoder);
@@ -80,8 +81,8 @@ OnlineZipformerTransducerModel::OnlineZipformerTransducerModel(
 
 void OnlineZipformerTransducerModel::InitEncoder(void *model_data,
                                                  size_t model_data_length) {
-  encoder_sess_ = std::make_unique<Ort::Session>(env_, model_data,
-                                                 model_data_length, sess_opts_);
+  encoder_sess_ = GetOrCreateSession(env_, model_data, model_data_length,
+                                     sess_opts_);
 
   GetInputNames(encoder_sess_.get(), &encoder_input_names_,
                 &encoder_input_names_ptr_);
@@ -142,8 +143,8 @@ void OnlineZipformerTransducerModel::InitEncoder(void *model_data,
 
 void OnlineZipformerTransducerModel::InitDecoder(void *model_data,
                                                  size_t model_data_length) {
-  decoder_sess_ = std::make_unique<Ort::Session>(env_, model_data,
-                                                 model_data_length, sess_opts_);
+  decoder_sess_ = GetOrCreateSession(env_, model_data, model_data_length,
+                                     sess_opts_);
 
   GetInputNames(decoder_sess_.get(), &decoder_input_names_,
                 &decoder_input_names_ptr_);
@@ -171,8 +172,8 @@ void OnlineZipformerTransducerModel::InitDecoder(void *model_data,
 
 void OnlineZipformerTransducerModel::InitJoiner(void *model_data,
                                                 size_t model_data_length) {
-  joiner_sess_ = std::make_unique<Ort::Session>(env_, model_data,
-                                                model_data_length, sess_opts_);
+  joiner_sess_ = GetOrCreateSession(env_, model_data, model_data_length,
+                                    sess_opts_);
 
   GetInputNames(joiner_sess_.get(), &joiner_input_names_,
                 &joiner_input_names_ptr_);
@@ -505,6 +506,17 @@ Ort::Value OnlineZipformerTransducerModel::RunJoiner(Ort::Value encoder_out,
   return std::move(logit[0]);
 }
 
+void OnlineZipformerTransducerModel::RunJoinerInto(Ort::Value encoder_out,
+                                                   Ort::Value decoder_out,
+                                                   Ort::Value *logit) {
+  std::array<Ort::Value, 2> joiner_input = {std::move(encoder_out),
+                                            std::move(decoder_out)};
+
+  joiner_sess_->Run({}, joiner_input_names_ptr_.data(), joiner_input.data(),
+                    joiner_input.size(), joiner_output_names_ptr_.data(),
+                    logit, 1);
+}
+
 #if __ANDROID_API__ >= 9
 template OnlineZipformerTransducerModel::OnlineZipformerTransducerModel(
     AAssetManager *mgr, const OnlineModelConfig &config);
@@ -12,6 +12,7 @@
 #include "onnxruntime_cxx_api.h"  // NOLINT
 #include "sherpa-onnx/csrc/online-model-config.h"
 #include "sherpa-onnx/csrc/online-transducer-model.h"
+#include "sherpa-onnx/csrc/session.h"
 
 namespace sherpa_onnx {
 
@@ -38,6 +39,9 @@ class OnlineZipformerTransducerModel : public OnlineTransducerModel {
 
   Ort::Value RunJoiner(Ort::Value encoder_out, Ort::Value decoder_out) override;
 
+  void RunJoinerInto(Ort::Value encoder_out, Ort::Value decoder_out,
+                     Ort::Value *logit) override;
+
   int32_t ContextSize() const override { return context_size_; }
 
   int32_t ChunkSize() const override { return T_; }
@@ -54,12 +58,12 @@ class OnlineZipformerTransducerModel : public OnlineTransducerModel {
 
  private:
   Ort::Env env_;
-  Ort::SessionOptions sess_opts_;
+  SessionOptionsWithKey sess_opts_;
   Ort::AllocatorWithDefaultOptions allocator_;
 
-  std::unique_ptr<Ort::Session> encoder_sess_;
-  std::unique_ptr<Ort::Session> decoder_sess_;
-  std::unique_ptr<Ort::Session> joiner_sess_;
+  std::shared_ptr<Ort::Session> encoder_sess_;
+  std::shared_ptr<Ort::Session> decoder_sess_;
+  std::shared_ptr<Ort::Session> joiner_sess_;
 
   std::vector<std::string> encoder_input_names_;
   std::vector<const char *> encoder_input_names_ptr_;
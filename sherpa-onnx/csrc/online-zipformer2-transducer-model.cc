@@ -29,6 +29,7 @@
 #include "sherpa-onnx/csrc/macros.h"
 #include "sherpa-onnx/csrc/online-transducer-decoder.h"
 #include "sherpa-onnx/csrc/onnx-utils.h"
+#include "sherpa-onnx/csrc/session-registry.h"
 #include "sherpa-onnx/csrc/session.h"
 #include "sherpa-onnx/csrc/text-utils.h"
 #include "sherpa-onnx/csrc/unbind.h"
@@ -38,9 +39,9 @@ namespace sherpa_onnx {
 OnlineZipformer2TransducerModel::OnlineZipformer2TransducerModel(
     const OnlineModelConfig &config)
     : env_(ORT_LOGGING_LEVEL_ERROR),
-      encoder_sess_opts_(GetSessionOptions(config)),
-      decoder_sess_opts_(GetSessionOptions(config, "decoder")),
-      joiner_sess_opts_(GetSessionOptions(config, "joiner")),
+      encoder_sess_opts_(GetSessionOptionsWithKey(config)),
+      decoder_sess_opts_(GetSessionOptionsWithKey(config, "decoder")),
+      joiner_sess_opts_(GetSessionOptionsWithKey(config, "joiner")),
       config_(config),
       allocator_{} {
   {
@@ -64,9 +65,9 @@ OnlineZipformer2TransducerModel::OnlineZipformer2TransducerModel(
     Manager *mgr, const OnlineModelConfig &config)
     : env_(ORT_LOGGING_LEVEL_ERROR),
       config_(config),
-      encoder_sess_opts_(GetSessionOptions(config)),
-      decoder_sess_opts_(GetSessionOptions(config)),
-      joiner_sess_opts_(GetSessionOptions(config)),
+      encoder_sess_opts_(GetSessionOptionsWithKey(config)),
+      decoder_sess_opts_(GetSessionOptionsWithKey(config)),
+      joiner_sess_opts_(GetSessionOptionsWithKey(config)),
       allocator_{} {
   {
     auto buf = ReadFile(mgr, config.transducer.encoder);
@@ -86,8 +87,9 @@ OnlineZipformer2TransducerModel::OnlineZipformer2TransducerModel(
 
 void OnlineZipformer2TransducerModel::InitEncoder(void *model_data,
                                                   size_t model_data_length) {
-  encoder_sess_ = std::make_unique<Ort::Session>(
-      env_, model_data, model_data_length, encoder_sess_opts_);
+  encoder_sess_ =
+      GetOrCreateSession(env_, model_data, model_data_length,
+                         encoder_sess_opts_);
 
   GetInputNames(encoder_sess_.get(), &encoder_input_names_,
                 &encoder_input_names_ptr_);
@@ -159,8 +161,8 @@ void OnlineZipformer2TransducerModel::InitEncoder(void *model_data,
 
 void OnlineZipformer2TransducerModel::InitDecoder(void *model_data,
                                                   size_t model_data_length) {
-  decoder_sess_ = std::make_unique<Ort::Session>(
-      env_, model_data, model_data_length, decoder_sess_opts_);
+  decoder_sess_ = GetOrCreateSession(env_, model_data, model_data_length,
+                                     decoder_sess_opts_);
 
   GetInputNames(decoder_sess_.get(), &decoder_input_names_,
                 &decoder_input_names_ptr_);
@@ -184,8 +186,8 @@ void OnlineZipformer2TransducerModel::InitDecoder(void *model_data,
 
 void OnlineZipformer2TransducerModel::InitJoiner(void *model_data,
                                                  size_t model_data_length) {
-  joiner_sess_ = std::make_unique<Ort::Session>(
-      env_, model_data, model_data_length, joiner_sess_opts_);
+  joiner_sess_ = GetOrCreateSession(env_, model_data, model_data_length,
+                                    joiner_sess_opts_);
 
   GetInputNames(joiner_sess_.get(), &joiner_input_names_,
                 &joiner_input_names_ptr_);
@@ -365,6 +367,23 @@ OnlineZipformer2TransducerModel::UnStackStates(
   return ans;
 }
 
+std::vector<int32_t> OnlineZipformer2TransducerModel::StatesBatchDims() const {
+  int32_t m = std::accumulate(num_encoder_layers_.begin(),
+                              num_encoder_layers_.end(), 0);
+  std::vector<int32_t> ans;
+  ans.reserve(m * 6 + 2);
+
+  // See StackStates() for the batch dim of each state
+  for (int32_t i = 0; i != m; ++i) {
+    ans.insert(ans.end(), {1, 1, 1, 1, 0, 0});
+  }
+
+  ans.push_back(0);  // embed_states
+  ans.push_back(0);  // processed_lens
+
+  return ans;
+}
+
 std::vector<Ort::Value>
 OnlineZipformer2TransducerModel::GetEncoderInitStates() {
   std::vector<Ort::Value> ans;
@@ -498,6 +517,17 @@ Ort::Value OnlineZipformer2TransducerModel::RunJoiner(Ort::Value encoder_out,
   return std::move(logit[0]);
 }
 
+void OnlineZipformer2TransducerModel::RunJoinerInto(Ort::Value encoder_out,
+                                                    Ort::Value decoder_out,
+                                                    Ort::Value *logit) {
+  std::array<Ort::Value, 2> joiner_input = {std::move(encoder_out),
+                                            std::move(decoder_out)};
+
+  joiner_sess_->Run({}, joiner_input_names_ptr_.data(), joiner_input.data(),
+                    joiner_input.size(), joiner_output_names_ptr_.data(),
+                    logit, 1);
+}
+
 #if __ANDROID_API__ >= 9
 template OnlineZipformer2TransducerModel::OnlineZipformer2TransducerModel(
     AAssetManager *mgr, const OnlineModelConfig &config);
@@ -12,6 +12,7 @@
 #include "onnxruntime_cxx_api.h"  // NOLINT
 #include "sherpa-onnx/csrc/online-model-config.h"
 #include "sherpa-onnx/csrc/online-transducer-model.h"
+#include "sherpa-onnx/csrc/session.h"
 
 namespace sherpa_onnx {
 
@@ -29,6 +30,8 @@ class OnlineZipformer2TransducerModel : public OnlineTransducerModel {
   std::vector<std::vector<Ort::Value>> UnStackStates(
       const std::vector<Ort::Value> &states) const override;
 
+  std::vector<int32_t> StatesBatchDims() const override;
+
   std::vector<Ort::Value> GetEncoderInitStates() override;
 
   void SetFeatureDim(int32_t feature_dim) override {
@@ -43,6 +46,9 @@ class OnlineZipformer2TransducerModel : public OnlineTransducerModel {
 
   Ort::Value RunJoiner(Ort::Value encoder_out, Ort::Value decoder_out) override;
 
+  void RunJoinerInto(Ort::Value encoder_out, Ort::Value decoder_out,
+                     Ort::Value *logit) override;
+
   int32_t ContextSize() const override { return context_size_; }
 
   int32_t ChunkSize() const override { return T_; }
@@ -61,15 +67,15 @@ class OnlineZipformer2TransducerModel : public OnlineTransducerModel {
 
  private:
   Ort::Env env_;
-  Ort::SessionOptions encoder_sess_opts_;
-  Ort::SessionOptions decoder_sess_opts_;
-  Ort::SessionOptions joiner_sess_opts_;
+  SessionOptionsWithKey encoder_sess_opts_;
+  SessionOptionsWithKey decoder_sess_opts_;
+  SessionOptionsWithKey joiner_sess_opts_;
 
   Ort::AllocatorWithDefaultOptions allocator_;
 
-  std::unique_ptr<Ort::Session> encoder_sess_;
-  std::unique_ptr<Ort::Session> decoder_sess_;
-  std::unique_ptr<Ort::Session> joiner_sess_;
+  std::shared_ptr<Ort::Session> encoder_sess_;
+  std::shared_ptr<Ort::Session> decoder_sess_;
+  std::shared_ptr<Ort::Session> joiner_sess_;
 
   std::vector<std::string> encoder_input_names_;
   std::vector<const char *> encoder_input_names_ptr_;
@@ -101,6 +101,61 @@ Ort::Value GetEncoderOutFrame(OrtAllocator *allocator, Ort::Value *encoder_out,
   return ans;
 }
 
+Ort::Value GetEncoderOutFrame(Ort::Value *encoder_out, int32_t t,
+                              std::vector<float> *buffer) {
+  std::vector<int64_t> encoder_out_shape =
+      encoder_out->GetTensorTypeAndShapeInfo().GetShape();
+
+  auto batch_size = encoder_out_shape[0];
+  auto num_frames = encoder_out_shape[1];
+  assert(t < num_frames);
+
+  auto encoder_out_dim = encoder_out_shape[2];
+
+  std::array<int64_t, 2> shape{batch_size, encoder_out_dim};
+
+  float *src = encoder_out->GetTensorMutableData<float>();
+
+  if (batch_size == 1) {
+    auto memory_info =
+        Ort::MemoryInfo::CreateCpu(OrtDeviceAllocator, OrtMemTypeDefault);
+
+    return Ort::Value::CreateTensor(memory_info, src + t * encoder_out_dim,
+                                    encoder_out_dim, shape.data(),
+                                    shape.size());
+  }
+
+  Ort::Value ans = CreateTensorFromBuffer(buffer, shape.data(), shape.size());
+
+  float *dst = ans.GetTensorMutableData<float>();
+
+  auto offset = num_frames * encoder_out_dim;
+
+  for (int32_t i = 0; i != batch_size; ++i) {
+    std::copy(src + t * encoder_out_dim, src + (t + 1) * encoder_out_dim, dst);
+    src += offset;
+    dst += encoder_out_dim;
+  }
+
+  return ans;
+}
+
+Ort::Value CreateTensorFromBuffer(std::vector<float> *buffer,
+                                  const int64_t *shape, size_t shape_len) {
+  int64_t n = std::accumulate(shape, shape + shape_len, 1,
+                              std::multiplies<int64_t>());
+
+  if (static_cast<int64_t>(buffer->size()) < n) {
+    buffer->resize(n);
+  }
+
+  auto memory_info =
+      Ort::MemoryInfo::CreateCpu(OrtDeviceAllocator, OrtMemTypeDefault);
+
+  return Ort::Value::CreateTensor(memory_info, buffer->data(), n, shape,
+                                  shape_len);
+}
+
 void PrintModelMetadata(std::ostream &os, const Ort::ModelMetadata &meta_data) {
   Ort::AllocatorWithDefaultOptions allocator;
 #if ORT_API_VERSION >= 12
@@ -327,6 +382,32 @@ Ort::Value Repeat(OrtAllocator *allocator, Ort::Value *cur_encoder_out,
   return ans;
 }
 
+Ort::Value Repeat(Ort::Value *cur_encoder_out,
+                  const std::vector<int32_t> &hyps_num_split,
+                  std::vector<float> *buffer) {
+  std::vector<int64_t> cur_encoder_out_shape =
+      cur_encoder_out->GetTensorTypeAndShapeInfo().GetShape();
+
+  std::array<int64_t, 2> ans_shape{hyps_num_split.back(),
+                                   cur_encoder_out_shape[1]};
+
+  Ort::Value ans =
+      CreateTensorFromBuffer(buffer, ans_shape.data(), ans_shape.size());
+
+  const float *src = cur_encoder_out->GetTensorData<float>();
+  float *dst = ans.GetTensorMutableData<float>();
+  int32_t batch_size = static_cast<int32_t>(hyps_num_split.size()) - 1;
+  for (int32_t b = 0; b != batch_size; ++b) {
+    int32_t cur_stream_hyps_num = hyps_num_split[b + 1] - hyps_num_split[b];
+    for (int32_t i = 0; i != cur_stream_hyps_num; ++i) {
+      std::copy(src, src + cur_encoder_out_shape[1], dst);
+      dst += cur_encoder_out_shape[1];
+    }
+    src += cur_encoder_out_shape[1];
+  }
+  return ans;
+}
+
 CopyableOrtValue::CopyableOrtValue(const CopyableOrtValue &other) {
   *this = other;
 }
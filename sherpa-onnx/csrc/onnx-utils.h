@@ -54,6 +54,26 @@ void GetOutputNames(Ort::Session *sess, std::vector<std::string> *output_names,
 Ort::Value GetEncoderOutFrame(OrtAllocator *allocator, Ort::Value *encoder_out,
                               int32_t t);
 
+/**
+ * Like GetEncoderOutFrame() above, but the result is stored in the given
+ * buffer, which is reused across calls. If the batch size is 1, the
+ * returned tensor shares the memory with encoder_out and no copy is made.
+ *
+ * The returned tensor is valid as long as encoder_out and buffer are
+ * not changed.
+ */
+Ort::Value GetEncoderOutFrame(Ort::Value *encoder_out, int32_t t,
+                              std::vector<float> *buffer);
+
+/** Create a tensor that uses the memory of the given buffer.
+ *
+ * The buffer is resized if it is too small. Memory is allocated only if
+ * it has to grow, so it can be reused to avoid allocations in a loop.
+ * The returned tensor is valid as long as the buffer is not resized.
+ */
+Ort::Value CreateTensorFromBuffer(std::vector<float> *buffer,
+                                  const int64_t *shape, size_t shape_len);
+
 std::string LookupCustomModelMetaData(const Ort::ModelMetadata &meta_data,
                                       const char *key, OrtAllocator *allocator);
 
@@ -96,6 +116,12 @@ void Fill(Ort::Value *tensor, T value) {
 Ort::Value Repeat(OrtAllocator *allocator, Ort::Value *cur_encoder_out,
                   const std::vector<int32_t> &hyps_num_split);
 
+// Like Repeat() above, but the result is stored in the given buffer.
+// See also CreateTensorFromBuffer()
+Ort::Value Repeat(Ort::Value *cur_encoder_out,
+                  const std::vector<int32_t> &hyps_num_split,
+                  std::vector<float> *buffer);
+
 struct CopyableOrtValue {
   Ort::Value value{nullptr};
 
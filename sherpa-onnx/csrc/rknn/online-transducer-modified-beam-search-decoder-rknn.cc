@@ -35,9 +35,10 @@ void OnlineTransducerModifiedBeamSearchDecoderRknn::StripLeadingBlanks(
   int32_t context_size = model_->ContextSize();
   auto hyp = r->hyps.GetMostProbable(true);
 
-  std::vector<int64_t> tokens(hyp.ys.begin() + context_size, hyp.ys.end());
+  std::vector<int64_t> tokens = hyp.Ys();
+  tokens.erase(tokens.begin(), tokens.begin() + context_size);
   r->tokens = std::move(tokens);
-  r->timestamps = std::move(hyp.timestamps);
+  r->timestamps = hyp.Timestamps();
 
   r->num_trailing_blanks = hyp.num_trailing_blanks;
 }
@@ -50,9 +51,7 @@ static std::vector<std::vector<float>> GetDecoderOut(
   int32_t context_size = model->ContextSize();
   for (const auto &p : hyp_vec) {
     const auto &hyp = p.second;
-    auto start = hyp.ys.begin() + (hyp.ys.size() - context_size);
-    auto end = hyp.ys.end();
-    auto tokens = std::vector<int64_t>(start, end);
+    auto tokens = hyp.LastTokens(context_size);
     auto decoder_out = model->RunDecoder(std::move(tokens));
 
     ans.push_back(std::move(decoder_out));
@@ -125,8 +124,7 @@ void OnlineTransducerModifiedBeamSearchDecoderRknn::Decode(
       // blank is hardcoded to 0
       // also, it treats unk as blank
       if (new_token != 0 && new_token != unk_id_) {
-        new_hyp.ys.push_back(new_token);
-        new_hyp.timestamps.push_back(t + frame_offset);
+        new_hyp.Append(new_token, t + frame_offset);
         new_hyp.num_trailing_blanks = 0;
 
       } else {
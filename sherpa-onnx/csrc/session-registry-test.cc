@@ -0,0 +1,96 @@
+// sherpa-onnx/csrc/session-registry-test.cc
+//
+// Copyright (c)  2025  Xiaomi Corporation
+
+#include "sherpa-onnx/csrc/session-registry.h"
+
+#include <string>
+#include <vector>
+
+#include "gtest/gtest.h"
+#include "sherpa-onnx/csrc/file-utils.h"
+#include "sherpa-onnx/csrc/macros.h"
+#include "sherpa-onnx/csrc/session.h"
+
+namespace sherpa_onnx {
+
+TEST(SessionRegistry, HashModelData) {
+  std::vector<char> a(1001, 'a');
+  std::vector<char> b = a;
+
+  EXPECT_EQ(HashModelData(a.data(), a.size()),
+            HashModelData(b.data(), b.size()));
+
+  b.back() = 'b';
+  EXPECT_NE(HashModelData(a.data(), a.size()),
+            HashModelData(b.data(), b.size()));
+
+  EXPECT_NE(HashModelData(a.data(), a.size()),
+            HashModelData(a.data(), a.size() - 1));
+}
+
+TEST(SessionRegistry, SessionOptionsKey) {
+  OnlineModelConfig config;
+  config.num_threads = 2;
+  config.provider_config.provider = "cpu";
+
+  std::string key1 = GetSessionOptionsWithKey(config).key;
+  std::string key2 = GetSessionOptionsWithKey(config).key;
+  EXPECT_FALSE(key1.empty());
+  EXPECT_EQ(key1, key2);
+
+  config.num_threads = 1;
+  key2 = GetSessionOptionsWithKey(config).key;
+  EXPECT_NE(key1, key2);
+
+  config.num_threads = 2;
+  config.provider_config.device = 1;
+  key2 = GetSessionOptionsWithKey(config).key;
+  EXPECT_NE(key1, key2);
+
+  std::string key3 = GetSessionOptionsWithKey(2, "cpu").key;
+  std::string key4 = GetSessionOptionsWithKey(2, "cpu").key;
+  EXPECT_EQ(key3, key4);
+
+  key4 = GetSessionOptionsWithKey(2, "cuda").key;
+  EXPECT_NE(key3, key4);
+}
+
+// Please download the model from
+// https://github.com/k2-fsa/sherpa-onnx/releases/download/asr-models/silero_vad.onnx
+TEST(SessionRegistry, SameModelAndOptions) {
+  std::string filename = "./silero_vad.onnx";
+  if (!FileExists(filename)) {
+    SHERPA_ONNX_LOGE("%s does not exist. Skipping test", filename.c_str());
+    return;
+  }
+
+  Ort::Env env(ORT_LOGGING_LEVEL_ERROR);
+
+  SessionOptionsWithKey sess_opts1 = GetSessionOptionsWithKey(1, "cpu");
+  SessionOptionsWithKey sess_opts2 = GetSessionOptionsWithKey(2, "cpu");
+
+  auto &registry = SessionRegistry::GetInstance();
+  int32_t num_sessions = registry.NumSessions();
+
+  {
+    auto buf1 = ReadFile(filename);
+    auto buf2 = ReadFile(filename);
+
+    auto a = GetOrCreateSession(env, buf1.data(), buf1.size(), sess_opts1);
+    auto b = GetOrCreateSession(env, buf2.data(), buf2.size(), sess_opts1);
+    auto c = GetOrCreateSession(env, buf1.data(), buf1.size(), sess_opts2);
+    auto d = GetOrCreateSession(env, buf1.data(), buf1.size(),
+                                sess_opts1.options, "");
+
+    EXPECT_EQ(a, b);
+    EXPECT_NE(a, c);
+    EXPECT_NE(a, d);
+    EXPECT_EQ(registry.NumSessions(), num_sessions + 2);
+  }
+
+  // Sessions are released once no one uses them
+  EXPECT_EQ(registry.NumSessions(), num_sessions);
+}
+
+}  // namespace sherpa_onnx
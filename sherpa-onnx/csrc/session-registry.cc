@@ -0,0 +1,142 @@
+// sherpa-onnx/csrc/session-registry.cc
+//
+// Copyright (c)  2025  Xiaomi Corporation
+
+#include "sherpa-onnx/csrc/session-registry.h"
+
+#include <cstring>
+#include <iomanip>
+#include <memory>
+#include <sstream>
+#include <string>
+
+namespace sherpa_onnx {
+
+static inline uint64_t Rotl(uint64_t x, int32_t r) {
+  return (x << r) | (x >> (64 - r));
+}
+
+static inline uint64_t Mix(uint64_t h) {
+  h ^= h >> 33;
+  h *= 0xff51afd7ed558ccdULL;
+  h ^= h >> 33;
+  h *= 0xc4ceb9fe1a85ec53ULL;
+  h ^= h >> 33;
+  return h;
+}
+
+std::string HashModelData(const void *data, size_t n) {
+  const uint8_t *p = reinterpret_cast<const uint8_t *>(data);
+
+  uint64_t h1 = 0x9e3779b97f4a7c15ULL ^ n;
+  uint64_t h2 = 0xc2b2ae3d27d4eb4fULL ^ n;
+
+  // Process 8 bytes at a time. Model files are large, so the hash has to
+  // be fast; it does not need to be cryptographically secure.
+  size_t num_words = n / 8;
+  for (size_t i = 0; i != num_words; ++i, p += 8) {
+    uint64_t w;
+    std::memcpy(&w, p, 8);
+
+    h1 = Rotl(h1 ^ (w * 0x87c37b91114253d5ULL), 31) * 0x4cf5ad432745937fULL;
+    h2 = Rotl(h2 + w, 27) * 0x9e3779b97f4a7c15ULL + 0x52dce729;
+  }
+
+  for (size_t i = num_words * 8; i != n; ++i, ++p) {
+    h1 = Rotl(h1 ^ *p, 31) * 0x4cf5ad432745937fULL;
+    h2 = Rotl(h2 + *p, 27) * 0x9e3779b97f4a7c15ULL;
+  }
+
+  std::ostringstream os;
+  os << std::hex << std::setfill('0') << std::setw(16) << Mix(h1)
+     << std::setw(16) << Mix(h2 ^ h1);
+
+  return os.str();
+}
+
+SessionRegistry &SessionRegistry::GetInstance() {
+  // Intentionally leaked so that it outlives models destroyed during
+  // static destruction
+  static SessionRegistry *registry = new SessionRegistry;
+  return *registry;
+}
+
+std::shared_ptr<Ort::Session> SessionRegistry::GetOrCreate(
+    Ort::Env &env,  // NOLINT
+    const void *model_data, size_t model_data_length,
+    const Ort::SessionOptions &sess_opts, const std::string &sess_opts_key) {
+  if (sess_opts_key.empty()) {
+    return std::make_shared<Ort::Session>(env, model_data, model_data_length,
+                                          sess_opts);
+  }
+
+  std::string key = HashModelData(model_data, model_data_length) + "-" +
+                    std::to_string(model_data_length) + "-" + sess_opts_key;
+
+  {
+    std::lock_guard<std::mutex> lock(mutex_);
+    auto it = sessions_.find(key);
+    if (it != sessions_.end()) {
+      auto sess = it->second.lock();
+      if (sess) {
+        return sess;
+      }
+    }
+  }
+
+  // Create the session without holding the lock since it may take a long
+  // time
+  auto sess = std::make_shared<Ort::Session>(env, model_data,
+                                             model_data_length, sess_opts);
+
+  std::lock_guard<std::mutex> lock(mutex_);
+
+  auto &entry = sessions_[key];
+  auto existing = entry.lock();
+  if (existing) {
+    // Another thread has created the same session in the meantime
+    return existing;
+  }
+
+  entry = sess;
+
+  // Remove entries of destroyed sessions
+  for (auto it = sessions_.begin(); it != sessions_.end();) {
+    if (it->second.expired()) {
+      it = sessions_.erase(it);
+    } else {
+      ++it;
+    }
+  }
+
+  return sess;
+}
+
+int32_t SessionRegistry::NumSessions() {
+  std::lock_guard<std::mutex> lock(mutex_);
+
+  int32_t n = 0;
+  for (const auto &p : sessions_) {
+    n += !p.second.expired();
+  }
+
+  return n;
+}
+
+std::shared_ptr<Ort::Session> GetOrCreateSession(
+    Ort::Env &env,  // NOLINT
+    const void *model_data, size_t model_data_length,
+    const Ort::SessionOptions &sess_opts, const std::string &sess_opts_key) {
+  return SessionRegistry::GetInstance().GetOrCreate(
+      env, model_data, model_data_length, sess_opts, sess_opts_key);
+}
+
+std::shared_ptr<Ort::Session> GetOrCreateSession(
+    Ort::Env &env,  // NOLINT
+    const void *model_data, size_t model_data_length,
+    const SessionOptionsWithKey &sess_opts) {
+  return GetOrCreateSession(env, model_data, model_data_length,
+                            sess_opts.options, sess_opts.key);
+}
+
+}  // namespace sherpa_onnx
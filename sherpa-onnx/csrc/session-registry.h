@@ -0,0 +1,85 @@
+// sherpa-onnx/csrc/session-registry.h
+//
+// Copyright (c)  2025  Xiaomi Corporation
+
+#ifndef SHERPA_ONNX_CSRC_SESSION_REGISTRY_H_
+#define SHERPA_ONNX_CSRC_SESSION_REGISTRY_H_
+
+#include <cstdint>
+#include <memory>
+#include <mutex>  // NOLINT
+#include <string>
+#include <unordered_map>
+
+#include "onnxruntime_cxx_api.h"  // NOLINT
+#include "sherpa-onnx/csrc/session.h"
+
+namespace sherpa_onnx {
+
+/** A process-wide registry of onnxruntime sessions.
+ *
+ * Sessions are keyed by a hash of the model content and a key describing
+ * the session options. Models that are created from the same file with the
+ * same options, e.g., a recognizer with hotwords and one without, share a
+ * single session instead of holding duplicate weights.
+ *
+ * The registry holds only weak references. A session is destroyed once
+ * the last model using it is destroyed.
+ *
+ * Ort::Session::Run() is thread-safe, so sharing a session between
+ * recognizers running in different threads is safe.
+ *
+ * Models that load their sessions with the options returned by
+ * GetSessionOptions() use it. The RNN LMs and the temporary sessions
+ * used only to read model metadata still create their own sessions.
+ */
+class SessionRegistry {
+ public:
+  static SessionRegistry &GetInstance();
+
+  /** Return an existing session for the given model and options or
+   *  create a new one.
+   *
+   * @param env  Used only when a new session is created.
+   * @param model_data  Content of the model.
+   * @param model_data_length  Number of bytes in model_data.
+   * @param sess_opts  Used only when a new session is created.
+   * @param sess_opts_key  A string that identifies sess_opts. It is
+   *                       returned by GetSessionOptionsWithKey() together
+   *                       with sess_opts. Sessions are shared only if
+   *                       their keys are equal. If it is empty, a new
+   *                       session is created and not shared.
+   */
+  std::shared_ptr<Ort::Session> GetOrCreate(
+      Ort::Env &env,  // NOLINT
+      const void *model_data, size_t model_data_length,
+      const Ort::SessionOptions &sess_opts, const std::string &sess_opts_key);
+
+  // Number of sessions that are still alive
+  int32_t NumSessions();
+
+ private:
+  SessionRegistry() = default;
+
+ private:
+  std::mutex mutex_;
+  std::unordered_map<std::string, std::weak_ptr<Ort::Session>> sessions_;
+};
+
+// A shortcut for SessionRegistry::GetInstance().GetOrCreate()
+std::shared_ptr<Ort::Session> GetOrCreateSession(
+    Ort::Env &env,  // NOLINT
+    const void *model_data, size_t model_data_length,
+    const Ort::SessionOptions &sess_opts, const std::string &sess_opts_key);
+
+std::shared_ptr<Ort::Session> GetOrCreateSession(
+    Ort::Env &env,  // NOLINT
+    const void *model_data, size_t model_data_length,
+    const SessionOptionsWithKey &sess_opts);
+
+// Return a 128-bit hash of the given data as a hex string
+std::string HashModelData(const void *data, size_t n);
+
+}  // namespace sherpa_onnx
+
+#endif  // SHERPA_ONNX_CSRC_SESSION_REGISTRY_H_
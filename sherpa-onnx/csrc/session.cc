@@ -5,6 +5,7 @@
 #include "sherpa-onnx/csrc/session.h"
 
 #include <algorithm>
+#include <sstream>
 #include <string>
 #include <utility>
 #include <vector>
@@ -38,9 +39,28 @@ static void OrtStatusFailure(OrtStatus *status, const char *s) {
 Ort::SessionOptions GetSessionOptionsImpl(
     int32_t num_threads, const std::string &provider_str,
     const ProviderConfig *provider_config /*= nullptr*/) {
+  return GetSessionOptionsWithKeyImpl(num_threads, provider_str,
+                                      provider_config)
+      .options;
+}
+
+SessionOptionsWithKey GetSessionOptionsWithKeyImpl(
+    int32_t num_threads, const std::string &provider_str,
+    const ProviderConfig *provider_config /*= nullptr*/) {
   Provider p = StringToProvider(provider_str);
 
-  Ort::SessionOptions sess_opts;
+  SessionOptionsWithKey ans;
+
+  // It has to contain all arguments since each of them may change the
+  // options
+  std::ostringstream key_os;
+  key_os << "num_threads=" << num_threads << ",provider=" << provider_str;
+  if (provider_config) {
+    key_os << "," << provider_config->ToString();
+  }
+  ans.key = key_os.str();
+
+  Ort::SessionOptions &sess_opts = ans.options;
   sess_opts.SetIntraOpNumThreads(num_threads);
 
   sess_opts.SetInterOpNumThreads(num_threads);
@@ -240,29 +260,16 @@ Ort::SessionOptions GetSessionOptionsImpl(
       break;
     }
   }
-  return sess_opts;
+  return ans;
 }
 
 Ort::SessionOptions GetSessionOptions(const OnlineModelConfig &config) {
-  return GetSessionOptionsImpl(config.num_threads,
-                               config.provider_config.provider,
-                               &config.provider_config);
+  return GetSessionOptionsWithKey(config).options;
 }
 
 Ort::SessionOptions GetSessionOptions(const OnlineModelConfig &config,
                                       const std::string &model_type) {
-  /*
-    Transducer models : Only encoder will run with tensorrt,
-                        decoder and joiner will run with cuda
-  */
-  if (config.provider_config.provider == "trt" &&
-      (model_type == "decoder" || model_type == "joiner")) {
-    return GetSessionOptionsImpl(config.num_threads, "cuda",
-                                 &config.provider_config);
-  }
-  return GetSessionOptionsImpl(config.num_threads,
-                               config.provider_config.provider,
-                               &config.provider_config);
+  return GetSessionOptionsWithKey(config, model_type).options;
 }
 
 Ort::SessionOptions GetSessionOptions(const OfflineLMConfig &config) {
@@ -278,4 +285,32 @@ Ort::SessionOptions GetSessionOptions(int32_t num_threads,
   return GetSessionOptionsImpl(num_threads, provider_str);
 }
 
+SessionOptionsWithKey GetSessionOptionsWithKey(
+    const OnlineModelConfig &config) {
+  return GetSessionOptionsWithKeyImpl(config.num_threads,
+                                      config.provider_config.provider,
+                                      &config.provider_config);
+}
+
+SessionOptionsWithKey GetSessionOptionsWithKey(
+    const OnlineModelConfig &config, const std::string &model_type) {
+  /*
+    Transducer models : Only encoder will run with tensorrt,
+                        decoder and joiner will run with cuda
+  */
+  if (config.provider_config.provider == "trt" &&
+      (model_type == "decoder" || model_type == "joiner")) {
+    return GetSessionOptionsWithKeyImpl(config.num_threads, "cuda",
+                                        &config.provider_config);
+  }
+  return GetSessionOptionsWithKeyImpl(config.num_threads,
+                                      config.provider_config.provider,
+                                      &config.provider_config);
+}
+
+SessionOptionsWithKey GetSessionOptionsWithKey(
+    int32_t num_threads, const std::string &provider_str) {
+  return GetSessionOptionsWithKeyImpl(num_threads, provider_str);
+}
+
 }  // namespace sherpa_onnx
@@ -34,6 +34,33 @@ Ort::SessionOptions GetSessionOptions(const T &config) {
   return GetSessionOptionsImpl(config.num_threads, config.provider);
 }
 
+// Session options and a string identifying them. Sessions created with
+// options of equal keys can be shared. See session-registry.h
+struct SessionOptionsWithKey {
+  Ort::SessionOptions options;
+  std::string key;
+};
+
+// Like GetSessionOptions() with the same arguments, but it also returns
+// the key of the options
+SessionOptionsWithKey GetSessionOptionsWithKeyImpl(
+    int32_t num_threads, const std::string &provider_str,
+    const ProviderConfig *provider_config = nullptr);
+
+SessionOptionsWithKey GetSessionOptionsWithKey(
+    const OnlineModelConfig &config);
+
+SessionOptionsWithKey GetSessionOptionsWithKey(
+    const OnlineModelConfig &config, const std::string &model_type);
+
+SessionOptionsWithKey GetSessionOptionsWithKey(
+    int32_t num_threads, const std::string &provider_str);
+
+template <typename T>
+SessionOptionsWithKey GetSessionOptionsWithKey(const T &config) {
+  return GetSessionOptionsWithKeyImpl(config.num_threads, config.provider);
+}
+
 }  // namespace sherpa_onnx
 
 #endif  // SHERPA_ONNX_CSRC_SESSION_H_
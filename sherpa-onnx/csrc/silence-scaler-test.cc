@@ -0,0 +1,163 @@
+// sherpa-onnx/csrc/silence-scaler-test.cc
+//
+// Copyright (c)  2025  Xiaomi Corporation
+
+#include "sherpa-onnx/csrc/silence-scaler.h"
+
+#include <algorithm>
+#include <cmath>
+#include <random>
+#include <utility>
+#include <vector>
+
+#include "gtest/gtest.h"
+
+namespace sherpa_onnx {
+
+// The implementation of GeneratedAudio::ScaleSilence() before it used
+// SilenceScaler. The input must not end with a pause if scale > 1.
+static std::vector<float> ScaleSilenceReference(
+    const std::vector<float> &samples, int32_t sample_rate, float scale) {
+  int32_t threshold = static_cast<int32_t>(sample_rate * 0.2);
+
+  std::vector<std::pair<int32_t, int32_t>> intervals;
+  int32_t num_samples = static_cast<int32_t>(samples.size());
+
+  int32_t last = -1;
+  int32_t i;
+  for (i = 0; i != num_samples; ++i) {
+    if (fabs(samples[i]) <= 0.01) {
+      if (last == -1) {
+        last = i;
+      }
+      continue;
+    }
+
+    if (last != -1 && i - last < threshold) {
+      last = -1;
+      continue;
+    }
+
+    if (last != -1) {
+      intervals.push_back({last, i});
+      last = -1;
+    }
+  }
+
+  if (last != -1 && num_samples - last > threshold) {
+    intervals.push_back({last, num_samples});
+  }
+
+  std::vector<float> ans;
+
+  i = 0;
+  for (const auto &interval : intervals) {
+    ans.insert(ans.end(), samples.begin() + i,
+               samples.begin() + interval.first);
+    i = interval.second;
+    int32_t n =
+        static_cast<int32_t>((interval.second - interval.first) * scale);
+
+    ans.insert(ans.end(), samples.begin() + interval.first,
+               samples.begin() + interval.first + n);
+  }
+
+  if (i < num_samples) {
+    ans.insert(ans.end(), samples.begin() + i, samples.end());
+  }
+
+  return ans;
+}
+
+// Alternate between speech and silence of random lengths. The threshold
+// of a pause is 20 samples for sample_rate 100.
+static std::vector<float> GenerateAudio(std::mt19937 *gen,
+                                        bool end_in_speech) {
+  std::uniform_int_distribution<int32_t> len(1, 60);
+  std::uniform_real_distribution<float> value(0.02, 1);
+  std::uniform_real_distribution<float> silence(-0.01, 0.01);
+
+  std::vector<float> ans;
+  int32_t num_segments = 20;
+  for (int32_t k = 0; k != num_segments; ++k) {
+    int32_t n = len(*gen);
+    bool is_silence = k % 2 == 1;
+    for (int32_t i = 0; i != n; ++i) {
+      ans.push_back(is_silence ? silence(*gen) : value(*gen));
+    }
+  }
+
+  if (!end_in_speech) {
+    ans.resize(ans.size() + 50, 0);
+  } else {
+    ans.resize(ans.size() + 200, 0.5);
+  }
+
+  return ans;
+}
+
+static std::vector<float> ScaleInChunks(const std::vector<float> &samples,
+                                        int32_t sample_rate, float scale,
+                                        std::mt19937 *gen) {
+  std::uniform_int_distribution<int32_t> len(0, 30);
+
+  SilenceScaler scaler(sample_rate, scale);
+  std::vector<float> ans;
+
+  int32_t num_samples = static_cast<int32_t>(samples.size());
+  for (int32_t start = 0; start < num_samples;) {
+    int32_t n = std::min(len(*gen), num_samples - start);
+    auto out = scaler.Process(samples.data() + start, n);
+    ans.insert(ans.end(), out.begin(), out.end());
+    start += n;
+  }
+
+  auto tail = scaler.Finish();
+  ans.insert(ans.end(), tail.begin(), tail.end());
+  return ans;
+}
+
+TEST(SilenceScaler, SameAsWholeAudio) {
+  std::mt19937 gen(20250101);
+  int32_t sample_rate = 100;
+
+  for (float scale : {0.2f, 0.5f, 1.0f}) {
+    for (int32_t i = 0; i != 50; ++i) {
+      auto samples = GenerateAudio(&gen, i % 2 == 0);
+      auto expected = ScaleSilenceReference(samples, sample_rate, scale);
+      auto ans = ScaleInChunks(samples, sample_rate, scale, &gen);
+      EXPECT_EQ(ans, expected) << scale << " " << i;
+    }
+  }
+}
+
+TEST(SilenceScaler, LongerPauses) {
+  std::mt19937 gen(20250102);
+  int32_t sample_rate = 100;
+
+  for (float scale : {1.5f, 3.0f}) {
+    for (int32_t i = 0; i != 50; ++i) {
+      auto samples = GenerateAudio(&gen, true);
+      auto expected = ScaleSilenceReference(samples, sample_rate, scale);
+      auto ans = ScaleInChunks(samples, sample_rate, scale, &gen);
+      EXPECT_EQ(ans, expected) << scale << " " << i;
+    }
+  }
+}
+
+TEST(SilenceScaler, TrailingPause) {
+  SilenceScaler scaler(100, 0.5);
+
+  std::vector<float> samples(10, 1);
+  samples.resize(50, 0);
+
+  auto ans = scaler.Process(samples.data(), samples.size());
+
+  // The trailing silence is not output until we know it is a pause
+  EXPECT_EQ(ans.size(), 10);
+
+  ans = scaler.Finish();
+  EXPECT_EQ(ans.size(), 20);
+}
+
+}  // namespace sherpa_onnx
@@ -0,0 +1,107 @@
+// sherpa-onnx/csrc/silence-scaler.cc
+//
+// Copyright (c)  2025  Xiaomi Corporation
+
+#include "sherpa-onnx/csrc/silence-scaler.h"
+
+#include <algorithm>
+#include <cmath>
+#include <vector>
+
+namespace sherpa_onnx {
+
+SilenceScaler::SilenceScaler(int32_t sample_rate, float scale)
+    // if the interval is larger than 0.2 second, then we assume it is a
+    // pause
+    : threshold_(static_cast<int32_t>(sample_rate * 0.2)), scale_(scale) {}
+
+std::vector<float> SilenceScaler::Process(const float *samples, int32_t n) {
+  for (int32_t i = 0; i != n; ++i) {
+    AcceptSample(samples[i]);
+  }
+
+  std::vector<float> ans;
+  Flush(&ans);
+  return ans;
+}
+
+std::vector<float> SilenceScaler::Finish() {
+  int32_t num_run = static_cast<int32_t>(run_.size());
+  if (num_run > threshold_) {
+    // The audio ends with a pause. If scale_ > 1, there are no samples
+    // after it to make it longer.
+    EmitRun(std::min(num_run, static_cast<int32_t>(num_run * scale_)));
+  } else {
+    EmitRun(num_run);
+  }
+  run_.clear();
+
+  for (auto &s : segments_) {
+    s.need = 0;
+  }
+
+  std::vector<float> ans;
+  Flush(&ans);
+  return ans;
+}
+
+void SilenceScaler::AcceptSample(float x) {
+  if (std::fabs(x) <= 0.01) {
+    run_.push_back(x);
+  } else if (!run_.empty()) {
+    int32_t num_run = static_cast<int32_t>(run_.size());
+    if (num_run < threshold_) {
+      EmitRun(num_run);
+    } else {
+      int32_t n = static_cast<int32_t>(num_run * scale_);
+      EmitRun(std::min(n, num_run));
+      if (n > num_run) {
+        // The pause is followed by the next n - num_run samples, including
+        // this one
+        segments_.back().need = n - num_run;
+      }
+    }
+    run_.clear();
+  }
+
+  for (auto &s : segments_) {
+    if (s.need > 0) {
+      s.samples.push_back(x);
+      --s.need;
+    }
+  }
+
+  if (run_.empty()) {
+    Emit(&x, 1);
+  }
+}
+
+void SilenceScaler::EmitRun(int32_t n) { Emit(run_.data(), n); }
+
+void SilenceScaler::Emit(const float *p, int32_t n) {
+  if (segments_.empty() || segments_.back().need > 0) {
+    segments_.emplace_back();
+  }
+
+  auto &s = segments_.back().samples;
+  s.insert(s.end(), p, p + n);
+}
+
+void SilenceScaler::Flush(std::vector<float> *ans) {
+  int32_t k = 0;
+  int32_t num_segments = static_cast<int32_t>(segments_.size());
+  for (; k != num_segments; ++k) {
+    auto &s = segments_[k];
+    ans->insert(ans->end(), s.samples.begin(), s.samples.end());
+    s.samples.clear();
+
+    if (s.need > 0) {
+      // Output after it has to wait until it is complete
+      break;
+    }
+  }
+
+  segments_.erase(segments_.begin(), segments_.begin() + k);
+}
+
+}  // namespace sherpa_onnx
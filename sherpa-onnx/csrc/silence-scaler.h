@@ -0,0 +1,71 @@
+// sherpa-onnx/csrc/silence-scaler.h
+//
+// Copyright (c)  2025  Xiaomi Corporation
+
+#ifndef SHERPA_ONNX_CSRC_SILENCE_SCALER_H_
+#define SHERPA_ONNX_CSRC_SILENCE_SCALER_H_
+
+#include <cstdint>
+#include <vector>
+
+namespace sherpa_onnx {
+
+/** Scale the duration of pauses of audio that arrives chunk by chunk.
+ *
+ * The output is the same as GeneratedAudio::ScaleSilence() on the whole
+ * audio, no matter how the audio is split into chunks. A run of silent
+ * samples is buffered until we know whether it is a pause, so the output
+ * may lag behind the input.
+ */
+class SilenceScaler {
+ public:
+  /**
+   * @param sample_rate Sample rate of the audio.
+   * @param scale Duration of each pause is multiplied by it.
+   */
+  SilenceScaler(int32_t sample_rate, float scale);
+
+  /** Process a chunk of audio.
+   *
+   * @param samples Pointer to a 1-D array of samples.
+   * @param n Number of samples.
+   * @return Return output samples that are ready.
+   */
+  std::vector<float> Process(const float *samples, int32_t n);
+
+  // Call it after the last chunk. It returns the remaining output samples.
+  std::vector<float> Finish();
+
+ private:
+  void AcceptSample(float x);
+
+  // Output samples [begin, begin + n) of the current silent run
+  void EmitRun(int32_t n);
+
+  void Emit(const float *p, int32_t n);
+
+  void Flush(std::vector<float> *ans);
+
+ private:
+  // If a silent run is not shorter than it, it is a pause
+  int32_t threshold_;
+  float scale_;
+
+  // Samples of the current silent run
+  std::vector<float> run_;
+
+  // Output is a list of segments. If a pause is scaled by a factor larger
+  // than 1, it is followed by the samples after it, which we have not
+  // seen yet. The segment of such a pause has need > 0 and the next need
+  // input samples are appended to it. Output after it goes to the next
+  // segment.
+  struct Segment {
+    std::vector<float> samples;
+    int32_t need = 0;
+  };
+  std::vector<Segment> segments_;
+};
+
+}  // namespace sherpa_onnx
+
+#endif  // SHERPA_ONNX_CSRC_SILENCE_SCALER_H_
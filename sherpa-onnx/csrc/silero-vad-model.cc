@@ -4,6 +4,8 @@
 
 #include "sherpa-onnx/csrc/silero-vad-model.h"
 
+#include <algorithm>
+#include <array>
 #include <string>
 #include <utility>
 #include <vector>
@@ -20,7 +22,9 @@
 #include "sherpa-onnx/csrc/file-utils.h"
 #include "sherpa-onnx/csrc/macros.h"
 #include "sherpa-onnx/csrc/onnx-utils.h"
+#include "sherpa-onnx/csrc/session-registry.h"
 #include "sherpa-onnx/csrc/session.h"
+#include "sherpa-onnx/csrc/vad-trigger.h"
 
 namespace sherpa_onnx {
 
@@ -29,7 +33,7 @@ class SileroVadModel::Impl {
   explicit Impl(const VadModelConfig &config)
       : config_(config),
         env_(ORT_LOGGING_LEVEL_ERROR),
-        sess_opts_(GetSessionOptions(config)),
+        sess_opts_(GetSessionOptionsWithKey(config)),
         allocator_{},
         sample_rate_(config.sample_rate) {
     auto buf = ReadFile(config.silero_vad.model);
@@ -41,17 +45,17 @@ class SileroVadModel::Impl {
       exit(-1);
     }
 
-    min_silence_samples_ =
-        sample_rate_ * config_.silero_vad.min_silence_duration;
-
-    min_speech_samples_ = sample_rate_ * config_.silero_vad.min_speech_duration;
+    trigger_ = VadTrigger(
+        config_.silero_vad.threshold,
+        sample_rate_ * config_.silero_vad.min_silence_duration,
+        sample_rate_ * config_.silero_vad.min_speech_duration);
   }
 
   template <typename Manager>
   Impl(Manager *mgr, const VadModelConfig &config)
       : config_(config),
         env_(ORT_LOGGING_LEVEL_ERROR),
-        sess_opts_(GetSessionOptions(config)),
+        sess_opts_(GetSessionOptionsWithKey(config)),
         allocator_{},
         sample_rate_(config.sample_rate) {
     auto buf = ReadFile(mgr, config.silero_vad.model);
@@ -63,10 +67,10 @@ class SileroVadModel::Impl {
       exit(-1);
     }
 
-    min_silence_samples_ =
-        sample_rate_ * config_.silero_vad.min_silence_duration;
-
-    min_speech_samples_ = sample_rate_ * config_.silero_vad.min_speech_duration;
+    trigger_ = VadTrigger(
+        config_.silero_vad.threshold,
+        sample_rate_ * config_.silero_vad.min_silence_duration,
+        sample_rate_ * config_.silero_vad.min_speech_duration);
   }
 
   float Run(const float *samples, int32_t n) {
@@ -77,89 +81,102 @@ class SileroVadModel::Impl {
     }
   }
 
-  void Reset() {
-    if (is_v5_) {
-      ResetV5();
-    } else {
-      ResetV4();
-    }
-
-    triggered_ = false;
-    current_sample_ = 0;
-    temp_start_ = 0;
-    temp_end_ = 0;
-  }
-
-  bool IsSpeech(const float *samples, int32_t n) {
-    if (n != WindowSize()) {
-      SHERPA_ONNX_LOGE("n: %d != window_size: %d", n, WindowSize());
-      exit(-1);
-    }
+  // v5: state of shape (2, N, 128)
+  // v4: h and c, each of shape (2, N, 64)
+  int32_t StateSize() const { return is_v5_ ? 2 * 128 : 2 * 2 * 64; }
 
-    float prob = Run(samples, n);
+  void ComputeBatch(const float *samples, int32_t batch_size,
+                    float *const *states, float *probs) {
+    auto memory_info =
+        Ort::MemoryInfo::CreateCpu(OrtDeviceAllocator, OrtMemTypeDefault);
 
-    float threshold = config_.silero_vad.threshold;
+    int32_t n = WindowSize();
+    std::array<int64_t, 2> x_shape = {batch_size, n};
 
-    current_sample_ += config_.silero_vad.window_size;
+    Ort::Value x = Ort::Value::CreateTensor(
+        memory_info, const_cast<float *>(samples), batch_size * n,
+        x_shape.data(), x_shape.size());
 
-    if (prob > threshold && temp_end_ != 0) {
-      temp_end_ = 0;
-    }
+    int64_t sr_shape = 1;
+    Ort::Value sr =
+        Ort::Value::CreateTensor(memory_info, &sample_rate_, 1, &sr_shape, 1);
 
-    if (prob > threshold && temp_start_ == 0) {
-      // start speaking, but we require that it must satisfy
-      // min_speech_duration
-      temp_start_ = current_sample_;
-      return false;
+    // The states of a stream are stored as
+    // [num_states][num_layers][hidden_dim]
+    int32_t num_states = is_v5_ ? 1 : 2;
+    int32_t num_layers = 2;
+    int32_t hidden_dim = is_v5_ ? 128 : 64;
+    std::array<int64_t, 3> state_shape{num_layers, batch_size, hidden_dim};
+
+    std::vector<Ort::Value> batched_states;
+    batched_states.reserve(num_states);
+    for (int32_t k = 0; k != num_states; ++k) {
+      Ort::Value s = Ort::Value::CreateTensor<float>(
+          allocator_, state_shape.data(), state_shape.size());
+      float *dst = s.GetTensorMutableData<float>();
+
+      for (int32_t l = 0; l != num_layers; ++l) {
+        for (int32_t b = 0; b != batch_size; ++b) {
+          const float *src = states[b] + (k * num_layers + l) * hidden_dim;
+          std::copy(src, src + hidden_dim, dst);
+          dst += hidden_dim;
+        }
+      }
+      batched_states.push_back(std::move(s));
     }
 
-    if (prob > threshold && temp_start_ != 0 && !triggered_) {
-      if (current_sample_ - temp_start_ < min_speech_samples_) {
-        return false;
+    std::vector<Ort::Value> inputs;
+    inputs.reserve(input_names_.size());
+    inputs.push_back(std::move(x));
+    if (is_v5_) {
+      inputs.push_back(std::move(batched_states[0]));
+      inputs.push_back(std::move(sr));
+    } else {
+      if (input_names_.size() == 4) {
+        inputs.push_back(std::move(sr));
       }
-
-      triggered_ = true;
-
-      return true;
+      inputs.push_back(std::move(batched_states[0]));
+      inputs.push_back(std::move(batched_states[1]));
     }
 
-    if ((prob < threshold) && !triggered_) {
-      // silence
-      temp_start_ = 0;
-      temp_end_ = 0;
-      return false;
-    }
+    auto out =
+        sess_->Run({}, input_names_ptr_.data(), inputs.data(), inputs.size(),
+                   output_names_ptr_.data(), output_names_ptr_.size());
 
-    if ((prob > threshold - 0.15) && triggered_) {
-      // speaking
-      return true;
+    const float *p = out[0].GetTensorData<float>();
+    std::copy(p, p + batch_size, probs);
+
+    for (int32_t k = 0; k != num_states; ++k) {
+      const float *src = out[k + 1].GetTensorData<float>();
+      for (int32_t l = 0; l != num_layers; ++l) {
+        for (int32_t b = 0; b != batch_size; ++b) {
+          float *dst = states[b] + (k * num_layers + l) * hidden_dim;
+          std::copy(src, src + hidden_dim, dst);
+          src += hidden_dim;
+        }
+      }
     }
+  }
 
-    if ((prob > threshold) && !triggered_) {
-      // start speaking
-      triggered_ = true;
-
-      return true;
+  void Reset() {
+    if (is_v5_) {
+      ResetV5();
+    } else {
+      ResetV4();
     }
 
-    if ((prob < threshold) && triggered_) {
-      // stop to speak
-      if (temp_end_ == 0) {
-        temp_end_ = current_sample_;
-      }
+    trigger_.Reset();
+  }
 
-      if (current_sample_ - temp_end_ < min_silence_samples_) {
-        // continue speaking
-        return true;
-      }
-      // stopped speaking
-      temp_start_ = 0;
-      temp_end_ = 0;
-      triggered_ = false;
-      return false;
+  bool IsSpeech(const float *samples, int32_t n) {
+    if (n != WindowSize()) {
+      SHERPA_ONNX_LOGE("n: %d != window_size: %d", n, WindowSize());
+      exit(-1);
     }
 
-    return false;
+    float prob = Run(samples, n);
+
+    return trigger_.IsSpeech(prob, config_.silero_vad.window_size);
   }
 
   int32_t WindowShift() const { return config_.silero_vad.window_size; }
@@ -168,22 +185,26 @@ class SileroVadModel::Impl {
     return config_.silero_vad.window_size + window_overlap_;
   }
 
-  int32_t MinSilenceDurationSamples() const { return min_silence_samples_; }
+  int32_t MinSilenceDurationSamples() const {
+    return trigger_.MinSilenceDurationSamples();
+  }
 
-  int32_t MinSpeechDurationSamples() const { return min_speech_samples_; }
+  int32_t MinSpeechDurationSamples() const {
+    return trigger_.MinSpeechDurationSamples();
+  }
 
   void SetMinSilenceDuration(float s) {
-    min_silence_samples_ = sample_rate_ * s;
+    trigger_.SetMinSilenceDurationSamples(sample_rate_ * s);
   }
 
   void SetThreshold(float threshold) {
     config_.silero_vad.threshold = threshold;
+    trigger_.SetThreshold(threshold);
   }
 
  private:
   void Init(void *model_data, size_t model_data_length) {
-    sess_ = std::make_unique<Ort::Session>(env_, model_data, model_data_length,
-                                           sess_opts_);
+    sess_ = GetOrCreateSession(env_, model_data, model_data_length, sess_opts_);
 
     GetInputNames(sess_.get(), &input_names_, &input_names_ptr_);
     GetOutputNames(sess_.get(), &output_names_, &output_names_ptr_);
@@ -435,10 +456,10 @@ class SileroVadModel::Impl {
   VadModelConfig config_;
 
   Ort::Env env_;
-  Ort::SessionOptions sess_opts_;
+  SessionOptionsWithKey sess_opts_;
   Ort::AllocatorWithDefaultOptions allocator_;
 
-  std::unique_ptr<Ort::Session> sess_;
+  std::shared_ptr<Ort::Session> sess_;
 
   std::vector<std::string> input_names_;
   std::vector<const char *> input_names_ptr_;
@@ -448,13 +469,8 @@ class SileroVadModel::Impl {
 
   std::vector<Ort::Value> states_;
   int64_t sample_rate_;
-  int32_t min_silence_samples_;
-  int32_t min_speech_samples_;
 
-  bool triggered_ = false;
-  int32_t current_sample_ = 0;
-  int32_t temp_start_ = 0;
-  int32_t temp_end_ = 0;
+  VadTrigger trigger_;
 
   int32_t window_overlap_ = 0;
 
@@ -500,6 +516,13 @@ float SileroVadModel::Compute(const float *samples, int32_t n) {
   return impl_->Run(samples, n);
 }
 
+int32_t SileroVadModel::StateSize() const { return impl_->StateSize(); }
+
+void SileroVadModel::ComputeBatch(const float *samples, int32_t batch_size,
+                                  float *const *states, float *probs) {
+  impl_->ComputeBatch(samples, batch_size, states, probs);
+}
+
 #if __ANDROID_API__ >= 9
 template SileroVadModel::SileroVadModel(AAssetManager *mgr,
                                         const VadModelConfig &config);
@@ -47,6 +47,11 @@ class SileroVadModel : public VadModel {
   void SetMinSilenceDuration(float s) override;
   void SetThreshold(float threshold) override;
 
+  int32_t StateSize() const override;
+
+  void ComputeBatch(const float *samples, int32_t batch_size,
+                    float *const *states, float *probs) override;
+
  private:
   class Impl;
   std::unique_ptr<Impl> impl_;
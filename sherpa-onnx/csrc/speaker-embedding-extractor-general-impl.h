@@ -5,6 +5,7 @@
 #ifndef SHERPA_ONNX_CSRC_SPEAKER_EMBEDDING_EXTRACTOR_GENERAL_IMPL_H_
 #define SHERPA_ONNX_CSRC_SPEAKER_EMBEDDING_EXTRACTOR_GENERAL_IMPL_H_
 #include <algorithm>
+#include <map>
 #include <memory>
 #include <utility>
 #include <vector>
@@ -43,47 +44,86 @@ class SpeakerEmbeddingExtractorGeneralImpl
   }
 
   std::vector<float> Compute(OnlineStream *s) const override {
-    int32_t num_frames = s->NumFramesReady() - s->GetNumProcessedFrames();
-    if (num_frames <= 0) {
+    return std::move(ComputeBatch(&s, 1)[0]);
+  }
+
+  std::vector<std::vector<float>> ComputeBatch(OnlineStream **ss,
+                                               int32_t n) const override {
+    std::vector<std::vector<float>> ans(n);
+
+    // The model does not accept the number of frames of each stream, so
+    // padding would change the result. We put only streams of the same
+    // length into a batch.
+    std::map<int32_t, std::vector<int32_t>> groups;
+    for (int32_t i = 0; i != n; ++i) {
+      int32_t num_frames =
+          ss[i]->NumFramesReady() - ss[i]->GetNumProcessedFrames();
+      if (num_frames <= 0) {
 #if __OHOS__
-      SHERPA_ONNX_LOGE(
-          "Please make sure IsReady(s) returns true. num_frames: %{public}d",
-          num_frames);
+        SHERPA_ONNX_LOGE(
+            "Please make sure IsReady(s) returns true. num_frames: %{public}d",
+            num_frames);
 #else
-      SHERPA_ONNX_LOGE(
-          "Please make sure IsReady(s) returns true. num_frames: %d",
-          num_frames);
+        SHERPA_ONNX_LOGE(
+            "Please make sure IsReady(s) returns true. num_frames: %d",
+            num_frames);
 #endif
-      return {};
-    }
+        continue;
+      }
 
-    std::vector<float> features =
-        s->GetFrames(s->GetNumProcessedFrames(), num_frames);
+      groups[num_frames].push_back(i);
+    }
 
-    s->GetNumProcessedFrames() += num_frames;
+    for (const auto &p : groups) {
+      const auto &indexes = p.second;
+      int32_t num_indexes = static_cast<int32_t>(indexes.size());
+      for (int32_t i = 0; i < num_indexes; i += kMaxBatchSize) {
+        int32_t batch_size = std::min(kMaxBatchSize, num_indexes - i);
+        ComputeSameLength(ss, indexes.data() + i, batch_size, p.first, &ans);
+      }
+    }
 
-    int32_t feat_dim = features.size() / num_frames;
+    return ans;
+  }
 
+ private:
+  // Compute embeddings of ss[indexes[0]], ..., ss[indexes[batch_size-1]],
+  // each of which has num_frames unprocessed frames.
+  void ComputeSameLength(OnlineStream **ss, const int32_t *indexes,
+                         int32_t batch_size, int32_t num_frames,
+                         std::vector<std::vector<float>> *ans) const {
+    int32_t feat_dim = ss[indexes[0]]->FeatureDim();
     const auto &meta_data = model_.GetMetaData();
-    if (!meta_data.feature_normalize_type.empty()) {
-      if (meta_data.feature_normalize_type == "global-mean") {
-        SubtractGlobalMean(features.data(), num_frames, feat_dim);
-      } else {
+
+    std::vector<float> features(batch_size * num_frames * feat_dim);
+
+    for (int32_t b = 0; b != batch_size; ++b) {
+      OnlineStream *s = ss[indexes[b]];
+      float *p = features.data() + b * num_frames * feat_dim;
+
+      s->GetFrames(s->GetNumProcessedFrames(), num_frames, p);
+      s->GetNumProcessedFrames() += num_frames;
+
+      if (!meta_data.feature_normalize_type.empty()) {
+        if (meta_data.feature_normalize_type == "global-mean") {
+          SubtractGlobalMean(p, num_frames, feat_dim);
+        } else {
 #if __OHOS__
-        SHERPA_ONNX_LOGE("Unsupported feature_normalize_type: %{public}s",
-                         meta_data.feature_normalize_type.c_str());
+          SHERPA_ONNX_LOGE("Unsupported feature_normalize_type: %{public}s",
+                           meta_data.feature_normalize_type.c_str());
 #else
-        SHERPA_ONNX_LOGE("Unsupported feature_normalize_type: %s",
-                         meta_data.feature_normalize_type.c_str());
+          SHERPA_ONNX_LOGE("Unsupported feature_normalize_type: %s",
+                           meta_data.feature_normalize_type.c_str());
 #endif
-        exit(-1);
+          exit(-1);
+        }
       }
     }
 
     auto memory_info =
         Ort::MemoryInfo::CreateCpu(OrtDeviceAllocator, OrtMemTypeDefault);
 
-    std::array<int64_t, 3> x_shape{1, num_frames, feat_dim};
+    std::array<int64_t, 3> x_shape{batch_size, num_frames, feat_dim};
     Ort::Value x =
         Ort::Value::CreateTensor(memory_info, features.data(), features.size(),
                                  x_shape.data(), x_shape.size());
@@ -91,14 +131,13 @@ class SpeakerEmbeddingExtractorGeneralImpl
     std::vector<int64_t> embedding_shape =
         embedding.GetTensorTypeAndShapeInfo().GetShape();
 
-    std::vector<float> ans(embedding_shape[1]);
-    std::copy(embedding.GetTensorData<float>(),
-              embedding.GetTensorData<float>() + ans.size(), ans.begin());
-
-    return ans;
+    int32_t dim = embedding_shape[1];
+    const float *p = embedding.GetTensorData<float>();
+    for (int32_t b = 0; b != batch_size; ++b, p += dim) {
+      (*ans)[indexes[b]] = {p, p + dim};
+    }
   }
 
- private:
   void SubtractGlobalMean(float *p, int32_t num_frames,
                           int32_t feat_dim) const {
     auto m = Eigen::Map<
@@ -109,6 +148,8 @@ class SpeakerEmbeddingExtractorGeneralImpl
   }
 
  private:
+  static constexpr int32_t kMaxBatchSize = 32;
+
   SpeakerEmbeddingExtractorModel model_;
 };
 
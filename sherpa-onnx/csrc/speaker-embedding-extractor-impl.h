@@ -31,6 +31,15 @@ class SpeakerEmbeddingExtractorImpl {
   virtual bool IsReady(OnlineStream *s) const = 0;
 
   virtual std::vector<float> Compute(OnlineStream *s) const = 0;
+
+  virtual std::vector<std::vector<float>> ComputeBatch(OnlineStream **ss,
+                                                       int32_t n) const {
+    std::vector<std::vector<float>> ans(n);
+    for (int32_t i = 0; i != n; ++i) {
+      ans[i] = Compute(ss[i]);
+    }
+    return ans;
+  }
 };
 
 }  // namespace sherpa_onnx
@@ -51,77 +51,131 @@ class SpeakerEmbeddingExtractorNeMoImpl : public SpeakerEmbeddingExtractorImpl {
   }
 
   std::vector<float> Compute(OnlineStream *s) const override {
-    int32_t num_frames = s->NumFramesReady() - s->GetNumProcessedFrames();
-    if (num_frames <= 0) {
+    return std::move(ComputeBatch(&s, 1)[0]);
+  }
+
+  std::vector<std::vector<float>> ComputeBatch(OnlineStream **ss,
+                                               int32_t n) const override {
+    std::vector<std::vector<float>> ans(n);
+
+    // (num_frames, stream index)
+    std::vector<std::pair<int32_t, int32_t>> lens;
+    lens.reserve(n);
+
+    for (int32_t i = 0; i != n; ++i) {
+      int32_t num_frames =
+          ss[i]->NumFramesReady() - ss[i]->GetNumProcessedFrames();
+      if (num_frames <= 0) {
 #if __OHOS__
-      SHERPA_ONNX_LOGE(
-          "Please make sure IsReady(s) returns true. num_frames: %{public}d",
-          num_frames);
+        SHERPA_ONNX_LOGE(
+            "Please make sure IsReady(s) returns true. num_frames: %{public}d",
+            num_frames);
 #else
-      SHERPA_ONNX_LOGE(
-          "Please make sure IsReady(s) returns true. num_frames: %d",
-          num_frames);
+        SHERPA_ONNX_LOGE(
+            "Please make sure IsReady(s) returns true. num_frames: %d",
+            num_frames);
 #endif
-      return {};
+        continue;
+      }
+
+      lens.emplace_back(num_frames, i);
     }
 
-    std::vector<float> features =
-        s->GetFrames(s->GetNumProcessedFrames(), num_frames);
+    // Sort by length so that streams of similar lengths are put into
+    // the same batch, which limits the amount of padding
+    std::sort(lens.begin(), lens.end());
+
+    int32_t num_lens = static_cast<int32_t>(lens.size());
+    std::vector<int32_t> indexes;
+    std::vector<int32_t> num_frames;
+    for (int32_t i = 0; i < num_lens;) {
+      indexes.clear();
+      num_frames.clear();
+
+      int32_t min_len = lens[i].first;
+      while (i < num_lens &&
+             static_cast<int32_t>(indexes.size()) < kMaxBatchSize &&
+             lens[i].first <= min_len * kMaxLengthRatio) {
+        num_frames.push_back(lens[i].first);
+        indexes.push_back(lens[i].second);
+        ++i;
+      }
 
-    s->GetNumProcessedFrames() += num_frames;
+      ComputeBatchImpl(ss, indexes, num_frames, &ans);
+    }
+
+    return ans;
+  }
+
+ private:
+  // num_frames[i] is the number of unprocessed frames of ss[indexes[i]]
+  void ComputeBatchImpl(OnlineStream **ss, const std::vector<int32_t> &indexes,
+                        const std::vector<int32_t> &num_frames,
+                        std::vector<std::vector<float>> *ans) const {
+    int32_t batch_size = static_cast<int32_t>(indexes.size());
+    int32_t feat_dim = ss[indexes[0]]->FeatureDim();
 
-    int32_t feat_dim = features.size() / num_frames;
+    int32_t max_num_frames =
+        *std::max_element(num_frames.begin(), num_frames.end());
 
     const auto &meta_data = model_.GetMetaData();
-    if (!meta_data.feature_normalize_type.empty()) {
-      if (meta_data.feature_normalize_type == "per_feature") {
-        NormalizePerFeature(features.data(), num_frames, feat_dim);
-      } else {
+
+    // Padded frames are 0
+    std::vector<float> features(batch_size * max_num_frames * feat_dim);
+    std::vector<int64_t> x_lens(batch_size);
+
+    for (int32_t b = 0; b != batch_size; ++b) {
+      OnlineStream *s = ss[indexes[b]];
+      float *p = features.data() + b * max_num_frames * feat_dim;
+
+      s->GetFrames(s->GetNumProcessedFrames(), num_frames[b], p);
+      s->GetNumProcessedFrames() += num_frames[b];
+      x_lens[b] = num_frames[b];
+
+      if (!meta_data.feature_normalize_type.empty()) {
+        if (meta_data.feature_normalize_type == "per_feature") {
+          NormalizePerFeature(p, num_frames[b], feat_dim);
+        } else {
 #if __OHOS__
-        SHERPA_ONNX_LOGE("Unsupported feature_normalize_type: %{public}s",
-                         meta_data.feature_normalize_type.c_str());
+          SHERPA_ONNX_LOGE("Unsupported feature_normalize_type: %{public}s",
+                           meta_data.feature_normalize_type.c_str());
 #else
 
-        SHERPA_ONNX_LOGE("Unsupported feature_normalize_type: %s",
-                         meta_data.feature_normalize_type.c_str());
+          SHERPA_ONNX_LOGE("Unsupported feature_normalize_type: %s",
+                           meta_data.feature_normalize_type.c_str());
 #endif
-        exit(-1);
+          exit(-1);
+        }
       }
     }
 
-    if (num_frames % 16 != 0) {
-      int32_t pad = 16 - num_frames % 16;
-      features.resize((num_frames + pad) * feat_dim);
-    }
-
     auto memory_info =
         Ort::MemoryInfo::CreateCpu(OrtDeviceAllocator, OrtMemTypeDefault);
 
-    std::array<int64_t, 3> x_shape{1, num_frames, feat_dim};
+    std::array<int64_t, 3> x_shape{batch_size, max_num_frames, feat_dim};
     Ort::Value x =
         Ort::Value::CreateTensor(memory_info, features.data(), features.size(),
                                  x_shape.data(), x_shape.size());
 
     x = Transpose12(model_.Allocator(), &x);
 
-    int64_t x_lens = num_frames;
-    std::array<int64_t, 1> x_lens_shape{1};
-    Ort::Value x_lens_tensor = Ort::Value::CreateTensor(
-        memory_info, &x_lens, 1, x_lens_shape.data(), x_lens_shape.size());
+    std::array<int64_t, 1> x_lens_shape{batch_size};
+    Ort::Value x_lens_tensor =
+        Ort::Value::CreateTensor(memory_info, x_lens.data(), x_lens.size(),
+                                 x_lens_shape.data(), x_lens_shape.size());
 
     Ort::Value embedding =
         model_.Compute(std::move(x), std::move(x_lens_tensor));
     std::vector<int64_t> embedding_shape =
         embedding.GetTensorTypeAndShapeInfo().GetShape();
 
-    std::vector<float> ans(embedding_shape[1]);
-    std::copy(embedding.GetTensorData<float>(),
-              embedding.GetTensorData<float>() + ans.size(), ans.begin());
-
-    return ans;
+    int32_t dim = embedding_shape[1];
+    const float *p = embedding.GetTensorData<float>();
+    for (int32_t b = 0; b != batch_size; ++b, p += dim) {
+      (*ans)[indexes[b]] = {p, p + dim};
+    }
   }
 
- private:
   void NormalizePerFeature(float *p, int32_t num_frames,
                            int32_t feat_dim) const {
     auto m = Eigen::Map<
@@ -137,6 +191,12 @@ class SpeakerEmbeddingExtractorNeMoImpl : public SpeakerEmbeddingExtractorImpl {
   }
 
  private:
+  static constexpr int32_t kMaxBatchSize = 32;
+
+  // In a batch, the longest stream has at most this many times as many
+  // frames as the shortest one
+  static constexpr float kMaxLengthRatio = 1.25;
+
   SpeakerEmbeddingExtractorNeMoModel model_;
 };
 
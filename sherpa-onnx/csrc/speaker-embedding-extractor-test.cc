@@ -0,0 +1,91 @@
+// sherpa-onnx/csrc/speaker-embedding-extractor-test.cc
+//
+// Copyright (c)  2025  Xiaomi Corporation
+
+#include "sherpa-onnx/csrc/speaker-embedding-extractor.h"
+
+#include <memory>
+#include <random>
+#include <string>
+#include <vector>
+
+#include "gtest/gtest.h"
+#include "sherpa-onnx/csrc/file-utils.h"
+#include "sherpa-onnx/csrc/macros.h"
+
+namespace sherpa_onnx {
+
+static std::unique_ptr<OnlineStream> CreateStream(
+    const SpeakerEmbeddingExtractor &extractor,
+    const std::vector<float> &samples) {
+  auto stream = extractor.CreateStream();
+  stream->AcceptWaveform(16000, samples.data(), samples.size());
+  stream->InputFinished();
+  return stream;
+}
+
+// ComputeBatch() gives the same embeddings as Compute() on each stream
+static void TestComputeBatch(const std::string &model) {
+  if (!FileExists(model)) {
+    SHERPA_ONNX_LOGE("%s does not exist. Skipping test", model.c_str());
+    return;
+  }
+
+  SpeakerEmbeddingExtractorConfig config;
+  config.model = model;
+  SpeakerEmbeddingExtractor extractor(config);
+
+  // Some streams have the same length, so they are in the same batch for
+  // all models. Others differ a little, so they are padded for NeMo models.
+  std::vector<int32_t> durations = {16000, 24000, 16000, 17000,
+                                    24000, 16000, 20000, 30000};
+
+  std::mt19937 gen(20250107);
+  std::uniform_real_distribution<float> dist(-0.5, 0.5);
+
+  std::vector<std::vector<float>> audios;
+  for (int32_t n : durations) {
+    std::vector<float> samples(n);
+    for (auto &s : samples) {
+      s = dist(gen);
+    }
+    audios.push_back(std::move(samples));
+  }
+
+  std::vector<std::vector<float>> expected;
+  for (const auto &samples : audios) {
+    auto stream = CreateStream(extractor, samples);
+    ASSERT_TRUE(extractor.IsReady(stream.get()));
+    expected.push_back(extractor.Compute(stream.get()));
+  }
+
+  std::vector<std::unique_ptr<OnlineStream>> streams;
+  std::vector<OnlineStream *> ss;
+  for (const auto &samples : audios) {
+    streams.push_back(CreateStream(extractor, samples));
+    ss.push_back(streams.back().get());
+  }
+
+  auto embeddings = extractor.ComputeBatch(ss.data(), ss.size());
+  ASSERT_EQ(embeddings.size(), expected.size());
+
+  for (int32_t i = 0; i != static_cast<int32_t>(expected.size()); ++i) {
+    ASSERT_EQ(embeddings[i].size(), expected[i].size()) << i;
+    for (int32_t k = 0; k != static_cast<int32_t>(expected[i].size()); ++k) {
+      EXPECT_NEAR(embeddings[i][k], expected[i][k], 1e-3) << i << " " << k;
+    }
+  }
+}
+
+// Please download the models from
+// https://github.com/k2-fsa/sherpa-onnx/releases/tag/speaker-recongition-models
+TEST(SpeakerEmbeddingExtractor, ComputeBatchGeneral) {
+  TestComputeBatch(
+      "./3dspeaker_speech_eres2net_base_sv_zh-cn_3dspeaker_16k.onnx");
+}
+
+TEST(SpeakerEmbeddingExtractor, ComputeBatchNeMo) {
+  TestComputeBatch("./nemo_en_titanet_small.onnx");
+}
+
+}  // namespace sherpa_onnx
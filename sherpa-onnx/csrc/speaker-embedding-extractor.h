@@ -62,6 +62,16 @@ class SpeakerEmbeddingExtractor {
   // You have to ensure IsReady(s) returns true before you call this method.
   std::vector<float> Compute(OnlineStream *s) const;
 
+  // Like Compute(), but for n streams. Streams of similar lengths are
+  // processed with a single model run. The i-th returned embedding belongs
+  // to ss[i]. It is empty if ss[i] is not ready.
+  //
+  // For models without an input for the number of frames, only streams
+  // with the same number of frames are put into the same batch, so the
+  // results are the same as calling Compute() on each stream.
+  std::vector<std::vector<float>> ComputeBatch(OnlineStream **ss,
+                                               int32_t n) const;
+
  private:
   std::unique_ptr<SpeakerEmbeddingExtractorImpl> impl_;
 };
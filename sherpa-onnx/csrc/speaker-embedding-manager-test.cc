@@ -4,6 +4,13 @@
 
 #include "sherpa-onnx/csrc/speaker-embedding-manager.h"
 
+#include <cstdio>
+#include <fstream>
+#include <random>
+#include <string>
+#include <utility>
+#include <vector>
+
 #include "gtest/gtest.h"
 
 namespace sherpa_onnx {
@@ -144,4 +151,190 @@ TEST(SpeakerEmbeddingManager, Verify) {
   ASSERT_FALSE(status);
 }
 
+static std::vector<float> RandomEmbeddings(int32_t n, int32_t dim,
+                                           int32_t seed) {
+  std::mt19937 gen(seed);
+  std::normal_distribution<float> dist;
+  std::vector<float> ans(n * dim);
+  for (auto &x : ans) {
+    x = dist(gen);
+  }
+  return ans;
+}
+
+TEST(SpeakerEmbeddingManager, IndexAndBatchSearch) {
+  int32_t dim = 32;
+  int32_t n = 2000;
+  std::vector<float> e = RandomEmbeddings(n, dim, 1);
+
+  SpeakerEmbeddingManager manager(dim);
+  for (int32_t i = 0; i != n; ++i) {
+    ASSERT_TRUE(manager.Add(std::to_string(i), e.data() + i * dim));
+  }
+
+  // Queries are noisy versions of the enrolled embeddings
+  std::vector<float> noise = RandomEmbeddings(n, dim, 2);
+  std::vector<float> q(n * dim);
+  for (int32_t i = 0; i != n * dim; ++i) {
+    q[i] = e[i] + 0.1 * noise[i];
+  }
+
+  float threshold = 0.5;
+  std::vector<std::string> expected = manager.Search(q.data(), n, threshold);
+  for (int32_t i = 0; i != n; ++i) {
+    EXPECT_EQ(expected[i], std::to_string(i));
+    EXPECT_EQ(manager.Search(q.data() + i * dim, threshold), expected[i]);
+  }
+
+  ASSERT_TRUE(manager.BuildIndex(45));
+
+  // It is exact if all lists are visited
+  manager.SetNumProbes(45);
+  EXPECT_EQ(manager.Search(q.data(), n, threshold), expected);
+
+  manager.SetNumProbes(8);
+  int32_t num_found = 0;
+  for (int32_t i = 0; i != n; ++i) {
+    num_found += manager.Search(q.data() + i * dim, threshold) == expected[i];
+  }
+  EXPECT_GT(num_found, n * 9 / 10);
+
+  // Speakers that are added or removed after building the index
+  std::vector<float> v = RandomEmbeddings(1, dim, 3);
+  ASSERT_TRUE(manager.Add("new", v.data()));
+  EXPECT_EQ(manager.Search(v.data(), 0.99), "new");
+
+  for (int32_t i = 0; i < n; i += 2) {
+    ASSERT_TRUE(manager.Remove(std::to_string(i)));
+  }
+  EXPECT_EQ(manager.NumSpeakers(), n / 2 + 1);
+
+  manager.SetNumProbes(45);
+  for (int32_t i = 0; i != n; ++i) {
+    std::string name = manager.Search(e.data() + i * dim, 0.99);
+    EXPECT_EQ(name, i % 2 ? std::to_string(i) : "");
+  }
+  EXPECT_EQ(manager.Search(v.data(), 0.99), "new");
+}
+
+TEST(SpeakerEmbeddingManager, SaveAndLoad) {
+  int32_t dim = 16;
+  int32_t n = 300;
+  std::vector<float> e = RandomEmbeddings(n, dim, 4);
+
+  SpeakerEmbeddingManager manager(dim);
+  for (int32_t i = 0; i != n; ++i) {
+    std::string name = "speaker-" + std::to_string(i);
+    ASSERT_TRUE(manager.Add(name, e.data() + i * dim));
+  }
+  ASSERT_TRUE(manager.BuildIndex(10));
+  manager.SetNumProbes(3);
+
+  std::string filename = "speaker-embedding-manager-test.bin";
+  ASSERT_TRUE(manager.Save(filename));
+
+  SpeakerEmbeddingManager wrong_dim(dim + 1);
+  EXPECT_FALSE(wrong_dim.Load(filename));
+
+  SpeakerEmbeddingManager loaded(dim);
+  ASSERT_TRUE(loaded.Load(filename));
+  std::remove(filename.c_str());
+
+  EXPECT_EQ(loaded.NumSpeakers(), n);
+  EXPECT_EQ(loaded.NumProbes(), 3);
+  EXPECT_EQ(loaded.GetAllSpeakers(), manager.GetAllSpeakers());
+
+  for (int32_t i = 0; i != n; ++i) {
+    const float *p = e.data() + i * dim;
+    EXPECT_EQ(loaded.Search(p, 0.5), manager.Search(p, 0.5));
+    EXPECT_NEAR(loaded.Score("speaker-" + std::to_string(i), p), 1, 1e-5);
+  }
+}
+
+// Overwrite the int32 at the given byte offset of a file
+static void PatchFile(const std::string &filename, int32_t offset,
+                      int32_t value) {
+  std::fstream f(filename, std::ios::in | std::ios::out | std::ios::binary);
+  f.seekp(offset);
+  f.write(reinterpret_cast<const char *>(&value), sizeof(value));
+}
+
+TEST(SpeakerEmbeddingManager, LoadCorruptFile) {
+  int32_t dim = 4;
+  int32_t n = 20;
+  std::vector<float> e = RandomEmbeddings(n, dim, 5);
+
+  SpeakerEmbeddingManager manager(dim);
+  for (int32_t i = 0; i != n; ++i) {
+    ASSERT_TRUE(manager.Add(std::to_string(i), e.data() + i * dim));
+  }
+
+  std::string filename = "speaker-embedding-manager-corrupt-test.bin";
+
+  // A name that is longer than the rest of the file. Without an index,
+  // names start after the header and the embeddings.
+  ASSERT_TRUE(manager.Save(filename));
+  PatchFile(filename, 64 + n * dim * sizeof(float), 1000);
+  {
+    SpeakerEmbeddingManager loaded(dim);
+    EXPECT_FALSE(loaded.Load(filename));
+  }
+
+  ASSERT_TRUE(manager.BuildIndex(4));
+
+  // Offsets of num_speakers and num_lists in the header
+  int32_t num_speakers_offset = 16;
+  int32_t num_lists_offset = 20;
+
+  std::vector<std::pair<int32_t, int32_t>> patches = {
+      {num_speakers_offset, -1},    {num_speakers_offset, 2000000000},
+      {num_speakers_offset, n + 1}, {num_speakers_offset, 1000000},
+      {num_lists_offset, -1},
+      {num_lists_offset, n + 1},    {num_lists_offset, 2000000000},
+  };
+
+  for (const auto &p : patches) {
+    ASSERT_TRUE(manager.Save(filename));
+    PatchFile(filename, p.first, p.second);
+
+    SpeakerEmbeddingManager loaded(dim);
+    ASSERT_TRUE(loaded.Add("x", e.data()));
+    EXPECT_FALSE(loaded.Load(filename)) << p.first << " " << p.second;
+
+    // It is not changed
+    EXPECT_EQ(loaded.GetAllSpeakers(), std::vector<std::string>{"x"});
+  }
+
+  std::remove(filename.c_str());
+}
+
+// Lists that become empty after removing speakers are not saved
+TEST(SpeakerEmbeddingManager, SaveAfterRemove) {
+  int32_t dim = 8;
+  int32_t n = 40;
+  std::vector<float> e = RandomEmbeddings(n, dim, 6);
+
+  SpeakerEmbeddingManager manager(dim);
+  for (int32_t i = 0; i != n; ++i) {
+    ASSERT_TRUE(manager.Add(std::to_string(i), e.data() + i * dim));
+  }
+  ASSERT_TRUE(manager.BuildIndex(20));
+
+  for (int32_t i = 3; i != n; ++i) {
+    ASSERT_TRUE(manager.Remove(std::to_string(i)));
+  }
+
+  std::string filename = "speaker-embedding-manager-remove-test.bin";
+  ASSERT_TRUE(manager.Save(filename));
+
+  SpeakerEmbeddingManager loaded(dim);
+  ASSERT_TRUE(loaded.Load(filename));
+  std::remove(filename.c_str());
+
+  EXPECT_EQ(loaded.NumSpeakers(), 3);
+  for (int32_t i = 0; i != 3; ++i) {
+    EXPECT_EQ(loaded.Search(e.data() + i * dim, 0.99), std::to_string(i));
+  }
+}
+
 }  // namespace sherpa_onnx
@@ -5,10 +5,16 @@
 #include "sherpa-onnx/csrc/speaker-embedding-manager.h"
 
 #include <algorithm>
+#include <cstring>
+#include <fstream>
+#include <numeric>
+#include <string>
 #include <unordered_map>
 #include <utility>
+#include <vector>
 
 #include "Eigen/Dense"
+#include "sherpa-onnx/csrc/file-utils.h"
 #include "sherpa-onnx/csrc/macros.h"
 
 namespace sherpa_onnx {
@@ -16,6 +22,25 @@ namespace sherpa_onnx {
 using FloatMatrix =
     Eigen::Matrix<float, Eigen::Dynamic, Eigen::Dynamic, Eigen::RowMajor>;
 
+// Header of the file written by Save(). The embedding matrix starts right
+// after it.
+struct SpeakerEmbeddingFileHeader {
+  char magic[8];
+  int32_t version;
+  int32_t dim;
+  int32_t num_speakers;
+  int32_t num_lists;
+  int32_t num_probes;
+  int32_t reserved[9];
+};
+
+static_assert(sizeof(SpeakerEmbeddingFileHeader) == 64, "");
+
+static constexpr char kMagic[8] = "SPKEMB1";
+
+// Load() rejects files with more speakers than this
+static constexpr int32_t kMaxSpeakers = 100000000;
+
 class SpeakerEmbeddingManager::Impl {
  public:
   explicit Impl(int32_t dim) : dim_(dim) {}
@@ -26,14 +51,7 @@ class SpeakerEmbeddingManager::Impl {
       return false;
     }
 
-    embedding_matrix_.conservativeResize(embedding_matrix_.rows() + 1, dim_);
-
-    std::copy(p, p + dim_, &embedding_matrix_.bottomRows(1)(0, 0));
-
-    embedding_matrix_.bottomRows(1).normalize();  // inplace
-
-    name2row_[name] = embedding_matrix_.rows() - 1;
-    row2name_[embedding_matrix_.rows() - 1] = name;
+    AddRow(name, p);
 
     return true;
   }
@@ -58,109 +76,188 @@ class SpeakerEmbeddingManager::Impl {
       }
     }
 
-    // compute the average
-    Eigen::RowVectorXf v = Eigen::Map<Eigen::RowVectorXf>(
-        const_cast<float *>(embedding_list[0].data()), dim_);
-    int32_t i = -1;
+    // compute the sum. No need to compute the mean since we are going to
+    // normalize it anyway
+    Eigen::RowVectorXf v = Eigen::RowVectorXf::Zero(dim_);
     for (const auto &x : embedding_list) {
-      ++i;
-      if (i == 0) {
-        continue;
-      }
-      v += Eigen::Map<Eigen::RowVectorXf>(const_cast<float *>(x.data()), dim_);
+      v += Eigen::Map<const Eigen::RowVectorXf>(x.data(), dim_);
     }
 
-    // no need to compute the mean since we are going to normalize it anyway
-    // v /= embedding_list.size();
-
-    v.normalize();
-
-    embedding_matrix_.conservativeResize(embedding_matrix_.rows() + 1, dim_);
-    embedding_matrix_.bottomRows(1) = v;
-
-    name2row_[name] = embedding_matrix_.rows() - 1;
-    row2name_[embedding_matrix_.rows() - 1] = name;
+    AddRow(name, v.data());
 
     return true;
   }
 
   bool Remove(const std::string &name) {
-    if (!name2row_.count(name)) {
+    auto it = name2row_.find(name);
+    if (it == name2row_.end()) {
       return false;
     }
 
-    int32_t row_idx = name2row_.at(name);
+    int32_t row = it->second;
+    int32_t last = NumSpeakers() - 1;
 
-    int32_t num_rows = embedding_matrix_.rows();
+    name2row_.erase(it);
 
-    if (row_idx < num_rows - 1) {
-      embedding_matrix_.block(row_idx, 0, num_rows - 1 - row_idx, dim_) =
-          embedding_matrix_.bottomRows(num_rows - 1 - row_idx);
+    if (!centroids_.empty()) {
+      RemoveFromList(row);
     }
 
-    embedding_matrix_.conservativeResize(num_rows - 1, dim_);
-    for (auto &p : name2row_) {
-      if (p.second > row_idx) {
-        p.second -= 1;
-        row2name_[p.second] = p.first;
+    // Move the last row into the removed one so that removal is O(dim)
+    if (row != last) {
+      std::copy(embeddings_.begin() + static_cast<int64_t>(last) * dim_,
+                embeddings_.begin() + static_cast<int64_t>(last + 1) * dim_,
+                embeddings_.begin() + static_cast<int64_t>(row) * dim_);
+
+      row2name_[row] = std::move(row2name_[last]);
+      name2row_[row2name_[row]] = row;
+
+      if (!centroids_.empty()) {
+        row2list_[row] = row2list_[last];
+        row2pos_[row] = row2pos_[last];
+        lists_[row2list_[row]][row2pos_[row]] = row;
       }
     }
 
-    name2row_.erase(name);
-    row2name_.erase(num_rows - 1);
+    embeddings_.resize(static_cast<int64_t>(last) * dim_);
+    row2name_.pop_back();
+
+    if (!centroids_.empty()) {
+      row2list_.pop_back();
+      row2pos_.pop_back();
+    }
 
     return true;
   }
 
   std::string Search(const float *p, float threshold) {
-    if (embedding_matrix_.rows() == 0) {
+    if (NumSpeakers() == 0) {
       return {};
     }
 
-    Eigen::VectorXf v =
-        Eigen::Map<Eigen::VectorXf>(const_cast<float *>(p), dim_);
-    v.normalize();
+    if (centroids_.empty() || num_probes_ >= NumLists()) {
+      // All speakers are scored. We only need the best one, so there is
+      // no need to collect and sort the scores as GetBestMatches() does.
+      Eigen::VectorXf v = Eigen::Map<const Eigen::VectorXf>(p, dim_);
+      v.normalize();
+
+      Eigen::VectorXf scores = Matrix() * v;
+
+      Eigen::Index max_index = 0;
+      float max_score = scores.maxCoeff(&max_index);
+      if (max_score < threshold) {
+        return {};
+      }
 
-    Eigen::VectorXf scores = embedding_matrix_ * v;
+      return row2name_[max_index];
+    }
 
-    Eigen::VectorXf::Index max_index = 0;
-    float max_score = scores.maxCoeff(&max_index);
-    if (max_score < threshold) {
+    auto matches = GetBestMatches(p, threshold, 1);
+    if (matches.empty()) {
       return {};
     }
 
-    return row2name_.at(max_index);
+    return matches[0].name;
+  }
+
+  std::vector<std::string> Search(const float *p, int32_t num_queries,
+                                  float threshold) {
+    std::vector<std::string> ans(num_queries);
+
+    if (NumSpeakers() == 0 || num_queries <= 0) {
+      return ans;
+    }
+
+    if (!centroids_.empty() && num_probes_ < NumLists()) {
+      for (int32_t i = 0; i != num_queries; ++i) {
+        ans[i] = Search(p + static_cast<int64_t>(i) * dim_, threshold);
+      }
+      return ans;
+    }
+
+    FloatMatrix q =
+        Eigen::Map<const FloatMatrix>(p, num_queries, dim_).rowwise()
+            .normalized();
+
+    std::vector<float> best_scores(num_queries, threshold);
+    std::vector<int32_t> best_rows(num_queries, -1);
+
+    // Score a block of speakers at a time to limit the memory of the
+    // score matrix
+    constexpr int32_t kBlock = 4096;
+    int32_t num_rows = NumSpeakers();
+    FloatMatrix scores;
+    for (int32_t start = 0; start < num_rows; start += kBlock) {
+      int32_t n = std::min(kBlock, num_rows - start);
+      Eigen::Map<const FloatMatrix> e(
+          embeddings_.data() + static_cast<int64_t>(start) * dim_, n, dim_);
+
+      // (num_queries, n)
+      scores.noalias() = q * e.transpose();
+
+      for (int32_t i = 0; i != num_queries; ++i) {
+        Eigen::Index k = 0;
+        float s = scores.row(i).maxCoeff(&k);
+        if (s > best_scores[i] || (best_rows[i] == -1 && s >= threshold)) {
+          best_scores[i] = s;
+          best_rows[i] = start + k;
+        }
+      }
+    }
+
+    for (int32_t i = 0; i != num_queries; ++i) {
+      if (best_rows[i] != -1) {
+        ans[i] = row2name_[best_rows[i]];
+      }
+    }
+
+    return ans;
   }
 
   std::vector<SpeakerMatch> GetBestMatches(const float *p, float threshold,
                                            int32_t n) {
     std::vector<SpeakerMatch> matches;
 
-    if (embedding_matrix_.rows() == 0) {
+    if (NumSpeakers() == 0 || n <= 0) {
       return matches;
     }
 
-    Eigen::VectorXf v =
-        Eigen::Map<Eigen::VectorXf>(const_cast<float *>(p), dim_);
+    Eigen::VectorXf v = Eigen::Map<const Eigen::VectorXf>(p, dim_);
     v.normalize();
 
-    Eigen::VectorXf scores = embedding_matrix_ * v;
+    std::vector<std::pair<float, int32_t>> score_indices;
 
-    std::vector<std::pair<float, int>> score_indices;
-    for (int i = 0; i < scores.size(); ++i) {
-      if (scores[i] >= threshold) {
-        score_indices.emplace_back(scores[i], i);
+    if (!centroids_.empty() && num_probes_ < NumLists()) {
+      for (int32_t list : TopLists(v)) {
+        for (int32_t row : lists_[list]) {
+          float s = Row(row).dot(v);
+          if (s >= threshold) {
+            score_indices.emplace_back(s, row);
+          }
+        }
+      }
+    } else {
+      Eigen::VectorXf scores = Matrix() * v;
+      for (int32_t i = 0; i != scores.size(); ++i) {
+        if (scores[i] >= threshold) {
+          score_indices.emplace_back(scores[i], i);
+        }
       }
     }
 
-    std::sort(score_indices.rbegin(), score_indices.rend(),
-              [](const auto &a, const auto &b) { return a.first < b.first; });
+    // Higher scores first. For equal scores, smaller rows first.
+    auto cmp = [](const auto &a, const auto &b) {
+      return a.first > b.first || (a.first == b.first && a.second < b.second);
+    };
+
+    int32_t k = std::min(n, static_cast<int32_t>(score_indices.size()));
+    std::partial_sort(score_indices.begin(), score_indices.begin() + k,
+                      score_indices.end(), cmp);
 
-    matches.reserve(score_indices.size());
-    for (int i = 0; i < std::min(n, static_cast<int32_t>(score_indices.size()));
-         ++i) {
+    matches.reserve(k);
+    for (int32_t i = 0; i != k; ++i) {
       const auto &pair = score_indices[i];
-      matches.push_back({row2name_.at(pair.second), pair.first});
+      matches.push_back({row2name_[pair.second], pair.first});
     }
 
     return matches;
@@ -171,19 +268,7 @@ class SpeakerEmbeddingManager::Impl {
       return false;
     }
 
-    int32_t row_idx = name2row_.at(name);
-
-    Eigen::VectorXf v =
-        Eigen::Map<Eigen::VectorXf>(const_cast<float *>(p), dim_);
-    v.normalize();
-
-    float score = embedding_matrix_.row(row_idx) * v;
-
-    if (score < threshold) {
-      return false;
-    }
-
-    return true;
+    return Score(name, p) >= threshold;
   }
 
   float Score(const std::string &name, const float *p) {
@@ -194,11 +279,10 @@ class SpeakerEmbeddingManager::Impl {
 
     int32_t row_idx = name2row_.at(name);
 
-    Eigen::VectorXf v =
-        Eigen::Map<Eigen::VectorXf>(const_cast<float *>(p), dim_);
+    Eigen::VectorXf v = Eigen::Map<const Eigen::VectorXf>(p, dim_);
     v.normalize();
 
-    float score = embedding_matrix_.row(row_idx) * v;
+    float score = Row(row_idx).dot(v);
 
     return score;
   }
@@ -207,26 +291,379 @@ class SpeakerEmbeddingManager::Impl {
     return name2row_.count(name) > 0;
   }
 
-  int32_t NumSpeakers() const { return embedding_matrix_.rows(); }
+  int32_t NumSpeakers() const { return row2name_.size(); }
 
   int32_t Dim() const { return dim_; }
 
   std::vector<std::string> GetAllSpeakers() const {
-    std::vector<std::string> all_speakers;
-    all_speakers.reserve(name2row_.size());
-    for (const auto &p : name2row_) {
-      all_speakers.push_back(p.first);
-    }
-
+    std::vector<std::string> all_speakers = row2name_;
     std::sort(all_speakers.begin(), all_speakers.end());
     return all_speakers;
   }
 
+  bool BuildIndex(int32_t num_lists) {
+    centroids_.clear();
+    lists_.clear();
+    row2list_.clear();
+    row2pos_.clear();
+
+    if (num_lists <= 0) {
+      return true;
+    }
+
+    int32_t num_rows = NumSpeakers();
+    if (num_rows == 0) {
+      SHERPA_ONNX_LOGE("Please add speakers before building the index");
+      return false;
+    }
+
+    num_lists = std::min(num_lists, num_rows);
+
+    // Train on a subset if there are many speakers. It is the usual
+    // choice for IVF indexes and keeps k-means fast.
+    constexpr int32_t kMaxPointsPerList = 64;
+    int32_t num_train = std::min<int64_t>(
+        num_rows, static_cast<int64_t>(num_lists) * kMaxPointsPerList);
+
+    FloatMatrix train(num_train, dim_);
+    for (int32_t i = 0; i != num_train; ++i) {
+      train.row(i) = Row(static_cast<int64_t>(i) * num_rows / num_train);
+    }
+
+    FloatMatrix centroids(num_lists, dim_);
+    for (int32_t i = 0; i != num_lists; ++i) {
+      centroids.row(i) =
+          train.row(static_cast<int64_t>(i) * num_train / num_lists);
+    }
+
+    // spherical k-means
+    constexpr int32_t kNumIterations = 10;
+    std::vector<int32_t> assignment;
+    for (int32_t iter = 0; iter != kNumIterations; ++iter) {
+      Assign(train, centroids, &assignment);
+
+      FloatMatrix sums = FloatMatrix::Zero(num_lists, dim_);
+      for (int32_t i = 0; i != num_train; ++i) {
+        sums.row(assignment[i]) += train.row(i);
+      }
+
+      for (int32_t i = 0; i != num_lists; ++i) {
+        // Keep the old centroid for an empty list
+        if (sums.row(i).squaredNorm() > 0) {
+          centroids.row(i) = sums.row(i).normalized();
+        }
+      }
+    }
+
+    centroids_.assign(centroids.data(), centroids.data() + centroids.size());
+    lists_.resize(num_lists);
+
+    Assign(Matrix(), centroids, &assignment);
+    row2list_ = std::move(assignment);
+    row2pos_.resize(num_rows);
+    for (int32_t i = 0; i != num_rows; ++i) {
+      AppendToList(i);
+    }
+
+    return true;
+  }
+
+  void SetNumProbes(int32_t num_probes) {
+    num_probes_ = std::max(1, num_probes);
+  }
+
+  int32_t NumProbes() const { return num_probes_; }
+
+  bool Save(const std::string &filename) const {
+    std::ofstream os(filename, std::ios::binary);
+    if (!os) {
+      SHERPA_ONNX_LOGE("Failed to open '%s' for writing", filename.c_str());
+      return false;
+    }
+
+    // Lists become empty if speakers are removed after BuildIndex().
+    // Only non-empty lists are saved, so there are never more lists than
+    // speakers in a file.
+    std::vector<int32_t> new_list(NumLists(), -1);
+    std::vector<float> centroids;
+    int32_t num_lists = 0;
+    for (int32_t i = 0; i != NumLists(); ++i) {
+      if (lists_[i].empty()) {
+        continue;
+      }
+
+      new_list[i] = num_lists++;
+      centroids.insert(centroids.end(),
+                       centroids_.begin() + static_cast<int64_t>(i) * dim_,
+                       centroids_.begin() + static_cast<int64_t>(i + 1) * dim_);
+    }
+
+    std::vector<int32_t> row2list;
+    row2list.reserve(row2list_.size());
+    for (auto i : row2list_) {
+      row2list.push_back(new_list[i]);
+    }
+
+    SpeakerEmbeddingFileHeader header{};
+    std::copy(kMagic, kMagic + sizeof(kMagic), header.magic);
+    header.version = 1;
+    header.dim = dim_;
+    header.num_speakers = NumSpeakers();
+    header.num_lists = num_lists;
+    header.num_probes = num_probes_;
+
+    os.write(reinterpret_cast<const char *>(&header), sizeof(header));
+    Write(os, embeddings_);
+    Write(os, centroids);
+    Write(os, row2list);
+
+    for (const auto &name : row2name_) {
+      int32_t n = name.size();
+      os.write(reinterpret_cast<const char *>(&n), sizeof(n));
+      os.write(name.data(), n);
+    }
+
+    if (!os) {
+      SHERPA_ONNX_LOGE("Failed to write '%s'", filename.c_str());
+      return false;
+    }
+
+    return true;
+  }
+
+  bool Load(const std::string &filename) {
+    FileBuffer buf = ReadFile(filename);
+    if (buf.empty()) {
+      SHERPA_ONNX_LOGE("Failed to open '%s'", filename.c_str());
+      return false;
+    }
+
+    SpeakerEmbeddingFileHeader header;
+    if (buf.size() < sizeof(header)) {
+      SHERPA_ONNX_LOGE("'%s' is not a speaker embedding file",
+                       filename.c_str());
+      return false;
+    }
+
+    std::memcpy(&header, buf.data(), sizeof(header));
+    if (!std::equal(kMagic, kMagic + sizeof(kMagic), header.magic) ||
+        header.version != 1) {
+      SHERPA_ONNX_LOGE("'%s' is not a speaker embedding file",
+                       filename.c_str());
+      return false;
+    }
+
+    if (header.dim != dim_) {
+      SHERPA_ONNX_LOGE("Dim in '%s' is %d. Expected dim: %d", filename.c_str(),
+                       header.dim, dim_);
+      return false;
+    }
+
+    int32_t num_rows = header.num_speakers;
+    int32_t num_lists = header.num_lists;
+
+    if (num_rows < 0 || num_rows > kMaxSpeakers || num_lists < 0 ||
+        num_lists > num_rows) {
+      SHERPA_ONNX_LOGE("Invalid header in '%s': num_speakers %d, num_lists %d",
+                       filename.c_str(), num_rows, num_lists);
+      return false;
+    }
+
+    const char *p = buf.data() + sizeof(header);
+    const char *end = buf.data() + buf.size();
+
+    // The arrays and the length of each name
+    int64_t num_bytes =
+        (static_cast<int64_t>(num_rows + num_lists) * dim_ +
+         (num_lists > 0 ? num_rows : 0) + num_rows) *
+        sizeof(int32_t);
+
+    if (num_bytes > end - p) {
+      SHERPA_ONNX_LOGE("'%s' is truncated", filename.c_str());
+      return false;
+    }
+
+    std::vector<float> embeddings(static_cast<int64_t>(num_rows) * dim_);
+    std::vector<float> centroids(static_cast<int64_t>(num_lists) * dim_);
+    std::vector<int32_t> row2list(num_lists > 0 ? num_rows : 0);
+    Read(&p, &embeddings);
+    Read(&p, &centroids);
+    Read(&p, &row2list);
+
+    std::vector<std::string> row2name(num_rows);
+    std::unordered_map<std::string, int32_t> name2row;
+    for (int32_t i = 0; i != num_rows; ++i) {
+      int32_t n = 0;
+      if (end - p < static_cast<int64_t>(sizeof(n))) {
+        break;
+      }
+
+      std::memcpy(&n, p, sizeof(n));
+      p += sizeof(n);
+
+      if (n < 0 || n > end - p) {
+        break;
+      }
+
+      row2name[i].assign(p, n);
+      p += n;
+      name2row[row2name[i]] = i;
+    }
+
+    if (static_cast<int32_t>(name2row.size()) != num_rows) {
+      SHERPA_ONNX_LOGE("Failed to read '%s'", filename.c_str());
+      return false;
+    }
+
+    for (auto i : row2list) {
+      if (i < 0 || i >= num_lists) {
+        SHERPA_ONNX_LOGE("Invalid index in '%s'", filename.c_str());
+        return false;
+      }
+    }
+
+    embeddings_ = std::move(embeddings);
+    row2name_ = std::move(row2name);
+    name2row_ = std::move(name2row);
+    centroids_ = std::move(centroids);
+    row2list_ = std::move(row2list);
+    num_probes_ = std::max(1, header.num_probes);
+
+    lists_.clear();
+    lists_.resize(num_lists);
+    row2pos_.resize(row2list_.size());
+    for (int32_t i = 0; i != static_cast<int32_t>(row2list_.size()); ++i) {
+      AppendToList(i);
+    }
+
+    return true;
+  }
+
+ private:
+  Eigen::Map<const FloatMatrix> Matrix() const {
+    return Eigen::Map<const FloatMatrix>(embeddings_.data(), NumSpeakers(),
+                                         dim_);
+  }
+
+  Eigen::Map<const Eigen::VectorXf> Row(int64_t i) const {
+    return Eigen::Map<const Eigen::VectorXf>(embeddings_.data() + i * dim_,
+                                             dim_);
+  }
+
+  int32_t NumLists() const { return centroids_.size() / dim_; }
+
+  // The storage grows geometrically, so adding a speaker is amortized O(dim)
+  void AddRow(const std::string &name, const float *p) {
+    int32_t row = NumSpeakers();
+
+    embeddings_.insert(embeddings_.end(), p, p + dim_);
+    Eigen::Map<Eigen::VectorXf>(embeddings_.data() +
+                                    static_cast<int64_t>(row) * dim_,
+                                dim_)
+        .normalize();  // inplace
+
+    row2name_.push_back(name);
+    name2row_[name] = row;
+
+    if (!centroids_.empty()) {
+      Eigen::Map<const FloatMatrix> c(centroids_.data(), NumLists(), dim_);
+      Eigen::Index k = 0;
+      (c * Row(row)).maxCoeff(&k);
+
+      row2list_.push_back(k);
+      row2pos_.push_back(0);
+      AppendToList(row);
+    }
+  }
+
+  void AppendToList(int32_t row) {
+    auto &list = lists_[row2list_[row]];
+    row2pos_[row] = list.size();
+    list.push_back(row);
+  }
+
+  void RemoveFromList(int32_t row) {
+    auto &list = lists_[row2list_[row]];
+    int32_t pos = row2pos_[row];
+
+    list[pos] = list.back();
+    row2pos_[list[pos]] = pos;
+    list.pop_back();
+  }
+
+  // Indexes of the num_probes_ lists whose centroids are closest to v
+  std::vector<int32_t> TopLists(const Eigen::VectorXf &v) const {
+    Eigen::Map<const FloatMatrix> c(centroids_.data(), NumLists(), dim_);
+    Eigen::VectorXf scores = c * v;
+
+    std::vector<int32_t> ans(scores.size());
+    std::iota(ans.begin(), ans.end(), 0);
+
+    int32_t k = std::min<int32_t>(num_probes_, ans.size());
+    std::partial_sort(
+        ans.begin(), ans.begin() + k, ans.end(),
+        [&scores](int32_t a, int32_t b) { return scores[a] > scores[b]; });
+    ans.resize(k);
+
+    return ans;
+  }
+
+  // assignment[i] is the index of the centroid closest to the i-th row of x
+  static void Assign(const Eigen::Ref<const FloatMatrix> &x,
+                     const FloatMatrix &centroids,
+                     std::vector<int32_t> *assignment) {
+    int32_t num_rows = x.rows();
+    assignment->resize(num_rows);
+
+    constexpr int32_t kBlock = 4096;
+    FloatMatrix scores;
+    for (int32_t start = 0; start < num_rows; start += kBlock) {
+      int32_t n = std::min(kBlock, num_rows - start);
+      scores.noalias() = x.middleRows(start, n) * centroids.transpose();
+
+      for (int32_t i = 0; i != n; ++i) {
+        Eigen::Index k = 0;
+        scores.row(i).maxCoeff(&k);
+        (*assignment)[start + i] = k;
+      }
+    }
+  }
+
+  template <typename T>
+  static void Write(std::ofstream &os, const std::vector<T> &v) {  // NOLINT
+    os.write(reinterpret_cast<const char *>(v.data()), v.size() * sizeof(T));
+  }
+
+  // Copy v->size() items from *p and advance *p
+  template <typename T>
+  static void Read(const char **p, std::vector<T> *v) {
+    if (v->empty()) {
+      return;
+    }
+
+    std::memcpy(v->data(), *p, v->size() * sizeof(T));
+    *p += v->size() * sizeof(T);
+  }
+
  private:
   int32_t dim_;
-  FloatMatrix embedding_matrix_;
+
+  // Normalized embeddings of all speakers. Row i is for row2name_[i].
+  std::vector<float> embeddings_;
+  std::vector<std::string> row2name_;
   std::unordered_map<std::string, int32_t> name2row_;
-  std::unordered_map<int32_t, std::string> row2name_;
+
+  // IVF index. It is empty if no index is built.
+  //
+  // centroids_ is a matrix of shape (num_lists, dim_) in row major.
+  // lists_[i] contains the rows assigned to the i-th list.
+  // row i is lists_[row2list_[i]][row2pos_[i]]
+  std::vector<float> centroids_;
+  std::vector<std::vector<int32_t>> lists_;
+  std::vector<int32_t> row2list_;
+  std::vector<int32_t> row2pos_;
+
+  int32_t num_probes_ = 8;
 };
 
 SpeakerEmbeddingManager::SpeakerEmbeddingManager(int32_t dim)
@@ -254,6 +691,11 @@ std::string SpeakerEmbeddingManager::Search(const float *p,
   return impl_->Search(p, threshold);
 }
 
+std::vector<std::string> SpeakerEmbeddingManager::Search(
+    const float *p, int32_t num_queries, float threshold) const {
+  return impl_->Search(p, num_queries, threshold);
+}
+
 std::vector<SpeakerMatch> SpeakerEmbeddingManager::GetBestMatches(
     const float *p, float threshold, int32_t n) const {
   return impl_->GetBestMatches(p, threshold, n);
@@ -283,4 +725,24 @@ std::vector<std::string> SpeakerEmbeddingManager::GetAllSpeakers() const {
   return impl_->GetAllSpeakers();
 }
 
+bool SpeakerEmbeddingManager::BuildIndex(int32_t num_lists) const {
+  return impl_->BuildIndex(num_lists);
+}
+
+void SpeakerEmbeddingManager::SetNumProbes(int32_t num_probes) const {
+  impl_->SetNumProbes(num_probes);
+}
+
+int32_t SpeakerEmbeddingManager::NumProbes() const {
+  return impl_->NumProbes();
+}
+
+bool SpeakerEmbeddingManager::Save(const std::string &filename) const {
+  return impl_->Save(filename);
+}
+
+bool SpeakerEmbeddingManager::Load(const std::string &filename) const {
+  return impl_->Load(filename);
+}
+
 }  // namespace sherpa_onnx
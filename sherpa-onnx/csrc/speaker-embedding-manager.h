@@ -67,6 +67,19 @@ class SpeakerEmbeddingManager {
    */
   std::string Search(const float *p, float threshold) const;
 
+  /** Same as calling Search() for each of the given embeddings, but the
+   * scores for all of them are computed with a single matrix
+   * multiplication when no index is built.
+   *
+   * @param p Pointer to a 2-D array of shape (num_queries, dim) in row major.
+   * @param num_queries Number of embeddings in p.
+   * @param threshold A value between 0 and 1.
+   * @return Return a vector of size num_queries. Entry i is the name of the
+   *         speaker for the i-th embedding, or an empty string if not found.
+   */
+  std::vector<std::string> Search(const float *p, int32_t num_queries,
+                                  float threshold) const;
+
   /**
    * It is for speaker identification.
    *
@@ -110,6 +123,50 @@ class SpeakerEmbeddingManager {
   // Return a list of speaker names
   std::vector<std::string> GetAllSpeakers() const;
 
+  /** Build an inverted file (IVF) index for approximate search.
+   *
+   * Embeddings are clustered into num_lists lists with k-means. Search() and
+   * GetBestMatches() then only score the embeddings in the num_probes lists
+   * whose centroids are closest to the query, so their cost is about
+   * (num_lists + num_speakers * num_probes / num_lists) dot products instead
+   * of num_speakers. A good choice of num_lists is sqrt(num_speakers) to
+   * 4 * sqrt(num_speakers).
+   *
+   * Speakers added or removed after building the index are kept in it. Call
+   * it again if many speakers have been added since then.
+   *
+   * @param num_lists Number of lists. If it is not positive, the index is
+   *                  dropped and search is exact again.
+   * @return Return false if there are no speakers.
+   */
+  bool BuildIndex(int32_t num_lists) const;
+
+  // Number of lists to visit for each query when an index is built.
+  // Larger values are slower but more accurate. If it is not less than
+  // the number of lists, the search is exact.
+  void SetNumProbes(int32_t num_probes) const;
+
+  int32_t NumProbes() const;
+
+  /** Save all speakers and the index, if any, to a binary file.
+   *
+   * The file starts with a 64-byte header followed by the normalized
+   * embeddings as a float matrix of shape (num_speakers, dim) in row major,
+   * so the matrix can be memory-mapped directly. It is followed by the
+   * index and then the speaker names.
+   *
+   * @return Return true on success.
+   */
+  bool Save(const std::string &filename) const;
+
+  /** Replace the content of this manager with a file written by Save().
+   *
+   * @return Return false if the file cannot be read, if it is corrupted or
+   *         if its embedding dimension is different from Dim(). The manager
+   *         is not changed in that case.
+   */
+  bool Load(const std::string &filename) const;
+
  private:
   class Impl;
   std::unique_ptr<Impl> impl_;
@@ -26,8 +26,10 @@
 #include "sherpa-onnx/csrc/file-utils.h"
 #include "sherpa-onnx/csrc/macros.h"
 #include "sherpa-onnx/csrc/onnx-utils.h"
+#include "sherpa-onnx/csrc/session-registry.h"
 #include "sherpa-onnx/csrc/session.h"
 #include "sherpa-onnx/csrc/text-utils.h"
+#include "sherpa-onnx/csrc/vad-trigger.h"
 
 namespace sherpa_onnx {
 
@@ -37,7 +39,7 @@ class TenVadModel::Impl {
       : config_(config),
         rfft_(1024),
         env_(ORT_LOGGING_LEVEL_ERROR),
-        sess_opts_(GetSessionOptions(config)),
+        sess_opts_(GetSessionOptionsWithKey(config)),
         allocator_{},
         sample_rate_(config.sample_rate) {
     auto buf = ReadFile(config.ten_vad.model);
@@ -49,7 +51,7 @@ class TenVadModel::Impl {
       : config_(config),
         rfft_(1024),
         env_(ORT_LOGGING_LEVEL_ERROR),
-        sess_opts_(GetSessionOptions(config)),
+        sess_opts_(GetSessionOptionsWithKey(config)),
         allocator_{},
         sample_rate_(config.sample_rate) {
     auto buf = ReadFile(mgr, config.ten_vad.model);
@@ -89,10 +91,7 @@ class TenVadModel::Impl {
     return prob;
   }
   void Reset() {
-    triggered_ = false;
-    current_sample_ = 0;
-    temp_start_ = 0;
-    temp_end_ = 0;
+    trigger_.Reset();
 
     last_sample_ = 0;
 
@@ -111,83 +110,29 @@ class TenVadModel::Impl {
 
     float prob = Run(samples, n);
 
-    float threshold = config_.ten_vad.threshold;
-
-    current_sample_ += config_.ten_vad.window_size;
-
-    if (prob > threshold && temp_end_ != 0) {
-      temp_end_ = 0;
-    }
-
-    if (prob > threshold && temp_start_ == 0) {
-      // start speaking, but we require that it must satisfy
-      // min_speech_duration
-      temp_start_ = current_sample_;
-      return false;
-    }
-
-    if (prob > threshold && temp_start_ != 0 && !triggered_) {
-      if (current_sample_ - temp_start_ < min_speech_samples_) {
-        return false;
-      }
-
-      triggered_ = true;
-
-      return true;
-    }
-
-    if ((prob < threshold) && !triggered_) {
-      // silence
-      temp_start_ = 0;
-      temp_end_ = 0;
-      return false;
-    }
-
-    if ((prob > threshold - 0.15) && triggered_) {
-      // speaking
-      return true;
-    }
-
-    if ((prob > threshold) && !triggered_) {
-      // start speaking
-      triggered_ = true;
-
-      return true;
-    }
-
-    if ((prob < threshold) && triggered_) {
-      // stop to speak
-      if (temp_end_ == 0) {
-        temp_end_ = current_sample_;
-      }
-
-      if (current_sample_ - temp_end_ < min_silence_samples_) {
-        // continue speaking
-        return true;
-      }
-      // stopped speaking
-      temp_start_ = 0;
-      temp_end_ = 0;
-      triggered_ = false;
-      return false;
-    }
-
-    return false;
+    return trigger_.IsSpeech(prob, config_.ten_vad.window_size);
   }
 
   int32_t WindowShift() const { return config_.ten_vad.window_size; }
 
   int32_t WindowSize() const { return config_.ten_vad.window_size; }
 
-  int32_t MinSilenceDurationSamples() const { return min_silence_samples_; }
+  int32_t MinSilenceDurationSamples() const {
+    return trigger_.MinSilenceDurationSamples();
+  }
 
-  int32_t MinSpeechDurationSamples() const { return min_speech_samples_; }
+  int32_t MinSpeechDurationSamples() const {
+    return trigger_.MinSpeechDurationSamples();
+  }
 
   void SetMinSilenceDuration(float s) {
-    min_silence_samples_ = sample_rate_ * s;
+    trigger_.SetMinSilenceDurationSamples(sample_rate_ * s);
   }
 
-  void SetThreshold(float threshold) { config_.ten_vad.threshold = threshold; }
+  void SetThreshold(float threshold) {
+    config_.ten_vad.threshold = threshold;
+    trigger_.SetThreshold(threshold);
+  }
 
  private:
   void Init(void *model_data, size_t model_data_length) {
@@ -203,12 +148,12 @@ class TenVadModel::Impl {
       SHERPA_ONNX_EXIT(-1);
     }
 
-    min_silence_samples_ = sample_rate_ * config_.ten_vad.min_silence_duration;
-
-    min_speech_samples_ = sample_rate_ * config_.ten_vad.min_speech_duration;
+    trigger_ =
+        VadTrigger(config_.ten_vad.threshold,
+                   sample_rate_ * config_.ten_vad.min_silence_duration,
+                   sample_rate_ * config_.ten_vad.min_speech_duration);
 
-    sess_ = std::make_unique<Ort::Session>(env_, model_data, model_data_length,
-                                           sess_opts_);
+    sess_ = GetOrCreateSession(env_, model_data, model_data_length, sess_opts_);
 
     GetInputNames(sess_.get(), &input_names_, &input_names_ptr_);
     GetOutputNames(sess_.get(), &output_names_, &output_names_ptr_);
@@ -401,10 +346,10 @@ class TenVadModel::Impl {
   std::unique_ptr<knf::MelBanks> mel_banks_;
 
   Ort::Env env_;
-  Ort::SessionOptions sess_opts_;
+  SessionOptionsWithKey sess_opts_;
   Ort::AllocatorWithDefaultOptions allocator_;
 
-  std::unique_ptr<Ort::Session> sess_;
+  std::shared_ptr<Ort::Session> sess_;
 
   std::vector<std::string> input_names_;
   std::vector<const char *> input_names_ptr_;
@@ -414,13 +359,7 @@ class TenVadModel::Impl {
 
   std::vector<Ort::Value> states_;
   int64_t sample_rate_;
-  int32_t min_silence_samples_;
-  int32_t min_speech_samples_;
-
-  bool triggered_ = false;
-  int32_t current_sample_ = 0;
-  int32_t temp_start_ = 0;
-  int32_t temp_end_ = 0;
+  VadTrigger trigger_;
 
   float last_sample_ = 0;
 
@@ -5,8 +5,8 @@
 #include "sherpa-onnx/csrc/transducer-keyword-decoder.h"
 
 #include <algorithm>
+#include <array>
 #include <cmath>
-#include <cstring>
 #include <utility>
 #include <vector>
 
@@ -55,6 +55,12 @@ void TransducerKeywordDecoder::Decode(
   }
   std::vector<Hypothesis> prev;
 
+  // Scratch buffers reused across frames and calls. They are thread_local
+  // since streams may be decoded concurrently from several threads.
+  static thread_local std::vector<float> encoder_out_buffer;
+  static thread_local std::vector<float> repeat_buffer;
+  static thread_local std::vector<float> logit_buffer;
+
   for (int32_t t = 0; t != num_frames; ++t) {
     // Due to merging paths with identical token sequences,
     // not all utterances have "num_active_paths" paths.
@@ -70,46 +76,39 @@ void TransducerKeywordDecoder::Decode(
     cur.clear();
     cur.reserve(batch_size);
 
-    Ort::Value decoder_input = model_->BuildDecoderInput(prev);
-    Ort::Value decoder_out = model_->RunDecoder(std::move(decoder_input));
+    Ort::Value decoder_out = decoder_out_cache_.Run(model_, prev);
 
     Ort::Value cur_encoder_out =
-        GetEncoderOutFrame(model_->Allocator(), &encoder_out, t);
+        GetEncoderOutFrame(&encoder_out, t, &encoder_out_buffer);
     cur_encoder_out =
-        Repeat(model_->Allocator(), &cur_encoder_out, hyps_row_splits);
-    Ort::Value logit =
-        model_->RunJoiner(std::move(cur_encoder_out), View(&decoder_out));
-
-    float *p_logit = logit.GetTensorMutableData<float>();
-    LogSoftmax(p_logit, vocab_size, num_hyps);
-
-    // The acoustic logprobs for current frame
-    std::vector<float> logprobs(vocab_size * num_hyps);
-    std::memcpy(logprobs.data(), p_logit,
-                sizeof(float) * vocab_size * num_hyps);
-
-    // now p_logit contains log_softmax output, we rename it to p_logprob
-    // to match what it actually contains
-    float *p_logprob = p_logit;
-
-    // add log_prob of each hypothesis to p_logprob before taking top_k
+        Repeat(&cur_encoder_out, hyps_row_splits, &repeat_buffer);
+    std::array<int64_t, 2> logit_shape{num_hyps, vocab_size};
+    Ort::Value logit = CreateTensorFromBuffer(&logit_buffer, logit_shape.data(),
+                                              logit_shape.size());
+    model_->RunJoinerInto(std::move(cur_encoder_out), View(&decoder_out),
+                          &logit);
+
+    const float *p_logit = logit.GetTensorData<float>();
+
+    // log_prob of each hypothesis, added to the log_softmax output of the
+    // joiner before taking top_k
+    std::vector<float> hyp_log_probs(num_hyps);
     for (int32_t i = 0; i != num_hyps; ++i) {
-      float log_prob = prev[i].log_prob;
-      for (int32_t k = 0; k != vocab_size; ++k, ++p_logprob) {
-        *p_logprob += log_prob;
-      }
+      hyp_log_probs[i] = prev[i].log_prob;
     }
-    p_logprob = p_logit;  // we changed p_logprob in the above for loop
 
+    std::vector<float> topk_log_probs;
     for (int32_t b = 0; b != batch_size; ++b) {
       int32_t frame_offset = (*result)[b].frame_offset;
       int32_t start = hyps_row_splits[b];
       int32_t end = hyps_row_splits[b + 1];
-      auto topk =
-          TopkIndex(p_logprob, vocab_size * (end - start), max_active_paths_);
+      auto topk = LogSoftmaxTopk(
+          p_logit + start * vocab_size, vocab_size, end - start,
+          hyp_log_probs.data() + start, max_active_paths_, &topk_log_probs);
 
       Hypotheses hyps;
-      for (auto k : topk) {
+      for (int32_t j = 0; j != static_cast<int32_t>(topk.size()); ++j) {
+        int32_t k = topk[j];
         int32_t hyp_index = k / vocab_size + start;
         int32_t new_token = k % vocab_size;
 
@@ -120,10 +119,10 @@ void TransducerKeywordDecoder::Decode(
         // blank is hardcoded to 0
         // also, it treats unk as blank
         if (new_token != 0 && new_token != unk_id_) {
-          new_hyp.ys.push_back(new_token);
-          new_hyp.timestamps.push_back(t + frame_offset);
-          new_hyp.ys_probs.push_back(
-              exp(logprobs[hyp_index * vocab_size + new_token]));
+          new_hyp.Append(new_token, t + frame_offset);
+          // The acoustic prob of the new token for the current frame
+          new_hyp.SetLastYsProb(
+              std::exp(topk_log_probs[j] - hyp_log_probs[hyp_index]));
 
           new_hyp.num_trailing_blanks = 0;
           auto context_res = ss[b]->GetContextGraph()->ForwardOneStep(
@@ -132,16 +131,14 @@ void TransducerKeywordDecoder::Decode(
           new_hyp.context_state = std::get<1>(context_res);
           // Start matching from the start state, forget the decoder history.
           if (new_hyp.context_state->token == -1) {
-            new_hyp.ys = blanks;
-            new_hyp.timestamps.clear();
-            new_hyp.ys_probs.clear();
+            new_hyp.ResetTokens(blanks);
           }
         } else {
           ++new_hyp.num_trailing_blanks;
         }
-        new_hyp.log_prob = p_logprob[k] + context_score;
+        new_hyp.log_prob = topk_log_probs[j] + context_score;
         hyps.Add(std::move(new_hyp));
-      }  // for (auto k : topk)
+      }  // for (int32_t j = 0; j != topk.size(); ++j)
 
       auto best_hyp = hyps.GetMostProbable(false);
 
@@ -150,25 +147,25 @@ void TransducerKeywordDecoder::Decode(
       const ContextState *matched_state = std::get<1>(status);
 
       if (matched) {
+        auto ys_probs = best_hyp.YsProbs();
         float ys_prob = 0.0;
         for (int32_t i = 0; i < matched_state->level; ++i) {
-          ys_prob += best_hyp.ys_probs[i];
+          ys_prob += ys_probs[i];
         }
         ys_prob /= matched_state->level;
         if (best_hyp.num_trailing_blanks > num_trailing_blanks_ &&
             ys_prob >= matched_state->ac_threshold) {
           auto &r = (*result)[b];
-          r.tokens = {best_hyp.ys.end() - matched_state->level,
-                      best_hyp.ys.end()};
-          r.timestamps = {best_hyp.timestamps.end() - matched_state->level,
-                          best_hyp.timestamps.end()};
-          r.keyword = matched_state->phrase;
+          auto timestamps = best_hyp.Timestamps();
+          r.tokens = best_hyp.LastTokens(matched_state->level);
+          r.timestamps = {timestamps.end() - matched_state->level,
+                          timestamps.end()};
+          r.keyword = ss[b]->GetContextGraph()->Phrase(matched_state);
 
           hyps = Hypotheses({{blanks, 0, ss[b]->GetContextGraph()->Root()}});
         }
       }
       cur.push_back(std::move(hyps));
-      p_logprob += (end - start) * vocab_size;
     }  // for (int32_t b = 0; b != batch_size; ++b)
   }
 
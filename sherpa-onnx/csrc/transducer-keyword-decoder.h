@@ -10,6 +10,7 @@
 #include <vector>
 
 #include "sherpa-onnx/csrc/online-stream.h"
+#include "sherpa-onnx/csrc/online-transducer-decoder-out-cache.h"
 #include "sherpa-onnx/csrc/online-transducer-model.h"
 
 namespace sherpa_onnx {
@@ -55,6 +56,8 @@ class TransducerKeywordDecoder {
   int32_t max_active_paths_;
   int32_t num_trailing_blanks_;
   int32_t unk_id_;
+
+  OnlineTransducerDecoderOutCache decoder_out_cache_;
 };
 
 }  // namespace sherpa_onnx
@@ -0,0 +1,252 @@
+// sherpa-onnx/csrc/vad-engine.cc
+//
+// Copyright (c)  2025  Xiaomi Corporation
+
+#include "sherpa-onnx/csrc/vad-engine.h"
+
+#include <algorithm>
+#include <memory>
+#include <mutex>  // NOLINT
+#include <utility>
+#include <vector>
+
+#if __ANDROID_API__ >= 9
+#include "android/asset_manager.h"
+#include "android/asset_manager_jni.h"
+#endif
+
+#if __OHOS__
+#include "rawfile/raw_file_manager.h"
+#endif
+
+#include "sherpa-onnx/csrc/macros.h"
+#include "sherpa-onnx/csrc/vad-model.h"
+#include "sherpa-onnx/csrc/vad-segmenter.h"
+
+namespace sherpa_onnx {
+
+// Fixed-size slots for the recurrent states of streams. Slots are
+// allocated in chunks so that states of different streams are close in
+// memory and a slot never moves once allocated.
+class VadStatePool {
+ public:
+  explicit VadStatePool(int32_t state_size) : state_size_(state_size) {}
+
+  // The returned slot is zero-initialized
+  float *Alloc() {
+    std::lock_guard<std::mutex> lock(mutex_);
+    if (free_.empty()) {
+      chunks_.emplace_back(kSlotsPerChunk * state_size_);
+      float *p = chunks_.back().data();
+      for (int32_t i = kSlotsPerChunk - 1; i >= 0; --i) {
+        free_.push_back(p + i * state_size_);
+      }
+    }
+
+    float *p = free_.back();
+    free_.pop_back();
+    std::fill(p, p + state_size_, 0);
+
+    return p;
+  }
+
+  void Free(float *p) {
+    std::lock_guard<std::mutex> lock(mutex_);
+    free_.push_back(p);
+  }
+
+  int32_t StateSize() const { return state_size_; }
+
+ private:
+  static constexpr int32_t kSlotsPerChunk = 64;
+
+  int32_t state_size_;
+  std::vector<std::vector<float>> chunks_;
+  std::vector<float *> free_;
+  std::mutex mutex_;
+};
+
+VadStream::VadStream(std::unique_ptr<VadSegmenter> segmenter,
+                     std::shared_ptr<VadStatePool> pool)
+    : segmenter_(std::move(segmenter)),
+      pool_(std::move(pool)),
+      states_(pool_->Alloc()) {}
+
+VadStream::~VadStream() { pool_->Free(states_); }
+
+void VadStream::AcceptWaveform(const float *samples, int32_t n) {
+  segmenter_->AcceptWaveform(samples, n);
+}
+
+bool VadStream::Empty() const { return segmenter_->Empty(); }
+
+void VadStream::Pop() { segmenter_->Pop(); }
+
+void VadStream::Clear() { segmenter_->Clear(); }
+
+const SpeechSegment &VadStream::Front() const { return segmenter_->Front(); }
+
+SpeechSegmentView VadStream::FrontView() const {
+  return segmenter_->FrontView();
+}
+
+bool VadStream::IsSpeechDetected() const {
+  return segmenter_->IsSpeechDetected();
+}
+
+SpeechSegment VadStream::CurrentSpeechSegment() const {
+  return segmenter_->CurrentSpeechSegment();
+}
+
+SpeechSegmentView VadStream::CurrentSpeechSegmentView() const {
+  return segmenter_->CurrentSpeechSegmentView();
+}
+
+void VadStream::Reset() {
+  segmenter_->Reset();
+  std::fill(states_, states_ + pool_->StateSize(), 0);
+}
+
+void VadStream::Flush() { segmenter_->Flush(); }
+
+class VadEngine::Impl {
+ public:
+  Impl(const VadModelConfig &config, float buffer_size_in_seconds)
+      : model_(VadModel::Create(config)),
+        config_(config),
+        buffer_size_in_seconds_(buffer_size_in_seconds) {
+    Init();
+  }
+
+  template <typename Manager>
+  Impl(Manager *mgr, const VadModelConfig &config,
+       float buffer_size_in_seconds)
+      : model_(VadModel::Create(mgr, config)),
+        config_(config),
+        buffer_size_in_seconds_(buffer_size_in_seconds) {
+    Init();
+  }
+
+  std::unique_ptr<VadStream> CreateStream() const {
+    auto segmenter = std::make_unique<VadSegmenter>(
+        config_, model_->WindowSize(), model_->WindowShift(),
+        buffer_size_in_seconds_);
+
+    // VadStream's constructor is private
+    return std::unique_ptr<VadStream>(
+        new VadStream(std::move(segmenter), pool_));
+  }
+
+  bool IsReady(const VadStream *s) const {
+    return s->segmenter_->NextWindow() != nullptr;
+  }
+
+  void Compute(VadStream **ss, int32_t n) const {
+    int32_t window_size = model_->WindowSize();
+
+    std::vector<VadStream *> ready;
+    std::vector<float> samples;
+    std::vector<float *> states;
+    std::vector<float> probs;
+
+    ready.reserve(n);
+    states.reserve(n);
+
+    while (true) {
+      // Streams may have a different number of windows. Each iteration
+      // processes the next window of every stream that still has one.
+      ready.clear();
+      for (int32_t i = 0; i != n; ++i) {
+        if (IsReady(ss[i])) {
+          ready.push_back(ss[i]);
+        }
+      }
+
+      if (ready.empty()) {
+        break;
+      }
+
+      int32_t batch_size = static_cast<int32_t>(ready.size());
+      samples.resize(batch_size * window_size);
+      states.resize(batch_size);
+      probs.resize(batch_size);
+
+      for (int32_t i = 0; i != batch_size; ++i) {
+        const float *p = ready[i]->segmenter_->NextWindow();
+        std::copy(p, p + window_size, samples.data() + i * window_size);
+        states[i] = ready[i]->states_;
+      }
+
+      model_->ComputeBatch(samples.data(), batch_size, states.data(),
+                           probs.data());
+
+      for (int32_t i = 0; i != batch_size; ++i) {
+        ready[i]->segmenter_->AcceptProb(probs[i]);
+      }
+    }
+  }
+
+  const VadModelConfig &GetConfig() const { return config_; }
+
+ private:
+  void Init() {
+    if (!model_) {
+      SHERPA_ONNX_LOGE("Failed to create the VAD model");
+      SHERPA_ONNX_EXIT(-1);
+    }
+
+    int32_t state_size = model_->StateSize();
+    if (state_size <= 0) {
+      SHERPA_ONNX_LOGE(
+          "VadEngine supports only models with batch processing, e.g., "
+          "silero-vad");
+      SHERPA_ONNX_EXIT(-1);
+    }
+
+    pool_ = std::make_shared<VadStatePool>(state_size);
+  }
+
+ private:
+  std::unique_ptr<VadModel> model_;
+  VadModelConfig config_;
+  float buffer_size_in_seconds_;
+  std::shared_ptr<VadStatePool> pool_;
+};
+
+VadEngine::VadEngine(const VadModelConfig &config,
+                     float buffer_size_in_seconds /*= 60*/)
+    : impl_(std::make_unique<Impl>(config, buffer_size_in_seconds)) {}
+
+template <typename Manager>
+VadEngine::VadEngine(Manager *mgr, const VadModelConfig &config,
+                     float buffer_size_in_seconds /*= 60*/)
+    : impl_(std::make_unique<Impl>(mgr, config, buffer_size_in_seconds)) {}
+
+VadEngine::~VadEngine() = default;
+
+std::unique_ptr<VadStream> VadEngine::CreateStream() const {
+  return impl_->CreateStream();
+}
+
+bool VadEngine::IsReady(const VadStream *s) const { return impl_->IsReady(s); }
+
+void VadEngine::Compute(VadStream **ss, int32_t n) const {
+  impl_->Compute(ss, n);
+}
+
+const VadModelConfig &VadEngine::GetConfig() const {
+  return impl_->GetConfig();
+}
+
+#if __ANDROID_API__ >= 9
+template VadEngine::VadEngine(AAssetManager *mgr, const VadModelConfig &config,
+                              float buffer_size_in_seconds = 60);
+#endif
+
+#if __OHOS__
+template VadEngine::VadEngine(NativeResourceManager *mgr,
+                              const VadModelConfig &config,
+                              float buffer_size_in_seconds = 60);
+#endif
+
+}  // namespace sherpa_onnx
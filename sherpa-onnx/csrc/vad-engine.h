@@ -0,0 +1,111 @@
+// sherpa-onnx/csrc/vad-engine.h
+//
+// Copyright (c)  2025  Xiaomi Corporation
+#ifndef SHERPA_ONNX_CSRC_VAD_ENGINE_H_
+#define SHERPA_ONNX_CSRC_VAD_ENGINE_H_
+
+#include <memory>
+
+#include "sherpa-onnx/csrc/vad-model-config.h"
+#include "sherpa-onnx/csrc/voice-activity-detector.h"
+
+namespace sherpa_onnx {
+
+class VadSegmenter;
+class VadStatePool;
+
+// Per-stream states of VadEngine. Its methods have the same meaning as
+// those of VoiceActivityDetector.
+class VadStream {
+ public:
+  ~VadStream();
+
+  void AcceptWaveform(const float *samples, int32_t n);
+
+  bool Empty() const;
+  void Pop();
+  void Clear();
+
+  // It is an error to call Front() if Empty() returns true.
+  const SpeechSegment &Front() const;
+
+  SpeechSegmentView FrontView() const;
+
+  bool IsSpeechDetected() const;
+
+  // It is empty if IsSpeechDetected() returns false
+  SpeechSegment CurrentSpeechSegment() const;
+
+  SpeechSegmentView CurrentSpeechSegmentView() const;
+
+  void Reset();
+
+  // At the end of the utterance, you can invoke this method so that
+  // the last speech segment can be detected.
+  void Flush();
+
+ private:
+  friend class VadEngine;
+
+  VadStream(std::unique_ptr<VadSegmenter> segmenter,
+            std::shared_ptr<VadStatePool> pool);
+
+  std::unique_ptr<VadSegmenter> segmenter_;
+  std::shared_ptr<VadStatePool> pool_;
+
+  // Recurrent states of the model for this stream. Owned by pool_.
+  float *states_ = nullptr;
+};
+
+// Voice activity detection for many streams with a single model.
+//
+// Unlike VoiceActivityDetector, which runs the model once per window of
+// a single stream, VadEngine collects one window from each ready stream
+// and runs the model once for all of them. The recurrent states of each
+// stream are kept in a pool owned by the engine.
+//
+// Usage:
+//
+//   VadEngine engine(config);
+//   auto s1 = engine.CreateStream();
+//   auto s2 = engine.CreateStream();
+//   // s1->AcceptWaveform(...), s2->AcceptWaveform(...)
+//   VadStream *ss[] = {s1.get(), s2.get()};
+//   engine.Compute(ss, 2);
+//   // check s1->Empty(), s1->Front(), etc.
+//
+// Only models whose VadModel::StateSize() is positive are supported,
+// e.g., silero-vad.
+class VadEngine {
+ public:
+  explicit VadEngine(const VadModelConfig &config,
+                     float buffer_size_in_seconds = 60);
+
+  template <typename Manager>
+  VadEngine(Manager *mgr, const VadModelConfig &config,
+            float buffer_size_in_seconds = 60);
+
+  ~VadEngine();
+
+  std::unique_ptr<VadStream> CreateStream() const;
+
+  // Return true if the stream has at least one window to process.
+  bool IsReady(const VadStream *s) const;
+
+  // Process all available windows of the given streams. Windows at the
+  // same position of different streams are processed in one batch.
+  //
+  // It is safe to call it from multiple threads as long as a stream
+  // is not passed to two calls at the same time.
+  void Compute(VadStream **ss, int32_t n) const;
+
+  const VadModelConfig &GetConfig() const;
+
+ private:
+  class Impl;
+  std::unique_ptr<Impl> impl_;
+};
+
+}  // namespace sherpa_onnx
+
+#endif  // SHERPA_ONNX_CSRC_VAD_ENGINE_H_
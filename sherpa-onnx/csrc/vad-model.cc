@@ -23,6 +23,12 @@
 
 namespace sherpa_onnx {
 
+void VadModel::ComputeBatch(const float * /*samples*/, int32_t /*batch_size*/,
+                            float *const * /*states*/, float * /*probs*/) {
+  SHERPA_ONNX_LOGE("This VAD model does not support batch processing");
+  SHERPA_ONNX_EXIT(-1);
+}
+
 std::unique_ptr<VadModel> VadModel::Create(const VadModelConfig &config) {
   if (config.provider == "rknn") {
 #if SHERPA_ONNX_ENABLE_RKNN
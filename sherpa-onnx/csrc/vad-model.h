@@ -42,6 +42,29 @@ class VadModel {
   virtual int32_t MinSpeechDurationSamples() const = 0;
   virtual void SetMinSilenceDuration(float s) = 0;
   virtual void SetThreshold(float threshold) = 0;
+
+  // Number of floats in the recurrent states of a single stream.
+  // Return 0 if ComputeBatch() is not supported.
+  virtual int32_t StateSize() const { return 0; }
+
+  /**
+   * Compute the speech probability of one window from each of batch_size
+   * streams with a single model run.
+   *
+   * Unlike Compute(), the recurrent states are owned by the caller and the
+   * internal states of this object are neither used nor changed, so one
+   * model can serve many streams.
+   *
+   * @param samples 2-D array of shape (batch_size, WindowSize())
+   * @param batch_size Number of streams
+   * @param states states[i] points to StateSize() floats containing the
+   *               states of the i-th stream. It is updated in-place.
+   *               Initial states are all zeros.
+   * @param probs On return, probs[i] contains the speech probability of
+   *              the i-th stream. It has batch_size entries.
+   */
+  virtual void ComputeBatch(const float *samples, int32_t batch_size,
+                            float *const *states, float *probs);
 };
 
 }  // namespace sherpa_onnx
@@ -0,0 +1,94 @@
+// sherpa-onnx/csrc/vad-segmenter-test.cc
+//
+// Copyright (c)  2025  Xiaomi Corporation
+
+#include "sherpa-onnx/csrc/vad-segmenter.h"
+
+#include <vector>
+
+#include "gtest/gtest.h"
+
+namespace sherpa_onnx {
+
+TEST(VadSegmenter, SpeechSegment) {
+  VadModelConfig config;
+  config.silero_vad.model = "unused.onnx";
+  config.silero_vad.min_silence_duration = 0.1;
+  config.silero_vad.min_speech_duration = 0.1;
+
+  int32_t window_size = 512;
+  VadSegmenter segmenter(config, window_size, window_size, 10);
+
+  // 1 second of silence, 1 second of speech, 1 second of silence.
+  // The probabilities are given per window.
+  int32_t num_windows = 16000 / window_size;
+  std::vector<float> probs;
+  probs.insert(probs.end(), num_windows, 0);
+  probs.insert(probs.end(), num_windows, 1);
+  probs.insert(probs.end(), num_windows, 0);
+
+  std::vector<float> samples(window_size);
+  for (auto prob : probs) {
+    segmenter.AcceptWaveform(samples.data(), samples.size());
+    const float *p = segmenter.NextWindow();
+    ASSERT_NE(p, nullptr);
+    segmenter.AcceptProb(prob);
+    EXPECT_EQ(segmenter.NextWindow(), nullptr);
+  }
+
+  ASSERT_FALSE(segmenter.Empty());
+  const auto &segment = segmenter.Front();
+  EXPECT_GT(segment.start, 0);
+  EXPECT_LT(segment.start, num_windows * window_size);
+  EXPECT_GT(segment.samples.size(), 16000 * 0.9);
+  EXPECT_LT(segment.samples.size(), 16000 * 1.3);
+
+  SpeechSegmentView view = segmenter.FrontView();
+  EXPECT_EQ(view.start, segment.start);
+  EXPECT_EQ(view.samples.ToVector(), segment.samples);
+
+  segmenter.Pop();
+  EXPECT_TRUE(segmenter.Empty());
+  EXPECT_FALSE(segmenter.IsSpeechDetected());
+}
+
+TEST(VadSegmenter, CurrentSpeechSegment) {
+  VadModelConfig config;
+  config.silero_vad.model = "unused.onnx";
+
+  int32_t window_size = 512;
+  VadSegmenter segmenter(config, window_size, window_size, 10);
+
+  std::vector<float> samples(window_size);
+  for (int32_t i = 0; i != 100; ++i) {
+    for (int32_t k = 0; k != window_size; ++k) {
+      samples[k] = i * window_size + k;
+    }
+
+    segmenter.AcceptWaveform(samples.data(), samples.size());
+    segmenter.AcceptProb(1);
+  }
+
+  ASSERT_TRUE(segmenter.IsSpeechDetected());
+  EXPECT_TRUE(segmenter.Empty());
+
+  SpeechSegment segment = segmenter.CurrentSpeechSegment();
+  SpeechSegmentView view = segmenter.CurrentSpeechSegmentView();
+  EXPECT_EQ(view.start, segment.start);
+  ASSERT_EQ(view.samples.ToVector(), segment.samples);
+  ASSERT_FALSE(segment.samples.empty());
+
+  // Samples are not shifted or lost
+  for (int32_t i = 0; i != static_cast<int32_t>(segment.samples.size());
+       ++i) {
+    ASSERT_EQ(segment.samples[i], segment.start + i);
+  }
+
+  segmenter.Flush();
+  EXPECT_FALSE(segmenter.IsSpeechDetected());
+  ASSERT_FALSE(segmenter.Empty());
+  EXPECT_EQ(segmenter.Front().start, segment.start);
+  EXPECT_GT(segmenter.Front().samples.size(), segment.samples.size());
+}
+
+}  // namespace sherpa_onnx
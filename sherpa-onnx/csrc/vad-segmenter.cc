@@ -0,0 +1,225 @@
+// sherpa-onnx/csrc/vad-segmenter.cc
+//
+// Copyright (c)  2025  Xiaomi Corporation
+
+#include "sherpa-onnx/csrc/vad-segmenter.h"
+
+#include <algorithm>
+
+#include "sherpa-onnx/csrc/macros.h"
+
+namespace sherpa_onnx {
+
+VadSegmenter::VadSegmenter(const VadModelConfig &config, int32_t window_size,
+                           int32_t window_shift,
+                           float buffer_size_in_seconds /*= 60*/)
+    : config_(config),
+      buffer_(buffer_size_in_seconds * config.sample_rate),
+      window_size_(window_size),
+      window_shift_(window_shift) {
+  float max_speech_duration = 0;
+  float min_speech_duration = 0;
+  if (!config_.silero_vad.model.empty()) {
+    threshold_ = config_.silero_vad.threshold;
+    min_silence_duration_ = config_.silero_vad.min_silence_duration;
+    min_speech_duration = config_.silero_vad.min_speech_duration;
+    max_speech_duration = config_.silero_vad.max_speech_duration;
+  } else if (!config_.ten_vad.model.empty()) {
+    threshold_ = config_.ten_vad.threshold;
+    min_silence_duration_ = config_.ten_vad.min_silence_duration;
+    min_speech_duration = config_.ten_vad.min_speech_duration;
+    max_speech_duration = config_.ten_vad.max_speech_duration;
+  } else {
+    SHERPA_ONNX_LOGE("Unsupported VAD model");
+    SHERPA_ONNX_EXIT(-1);
+  }
+
+  max_utterance_length_ = config_.sample_rate * max_speech_duration;
+
+  trigger_ = VadTrigger(threshold_,
+                        config_.sample_rate * min_silence_duration_,
+                        config_.sample_rate * min_speech_duration);
+}
+
+void VadSegmenter::AcceptWaveform(const float *samples, int32_t n) {
+  UpdateTrigger();
+
+  if (offset_ > 0) {
+    last_.erase(last_.begin(), last_.begin() + offset_);
+    offset_ = 0;
+  }
+
+  // note n is usually window_size and there is no need to use
+  // an extra buffer here
+  last_.insert(last_.end(), samples, samples + n);
+}
+
+const float *VadSegmenter::NextWindow() const {
+  if (static_cast<int32_t>(last_.size()) - offset_ < window_size_) {
+    return nullptr;
+  }
+
+  return last_.data() + offset_;
+}
+
+void VadSegmenter::AcceptProb(float prob) {
+  buffer_.Push(last_.data() + offset_, window_shift_);
+  offset_ += window_shift_;
+
+  bool this_window_is_speech = trigger_.IsSpeech(prob, window_shift_);
+  is_speech_ = is_speech_ || this_window_is_speech;
+
+  if (!NextWindow()) {
+    UpdateSegments();
+    is_speech_ = false;
+  }
+}
+
+void VadSegmenter::UpdateTrigger() {
+  // Samples kept only for segments_ do not count
+  int32_t size = buffer_.Tail() - std::max(keep_, buffer_.Head());
+  if (size > max_utterance_length_) {
+    trigger_.SetMinSilenceDurationSamples(config_.sample_rate *
+                                          new_min_silence_duration_s_);
+    trigger_.SetThreshold(new_threshold_);
+  } else {
+    trigger_.SetMinSilenceDurationSamples(config_.sample_rate *
+                                          min_silence_duration_);
+    trigger_.SetThreshold(threshold_);
+  }
+}
+
+void VadSegmenter::UpdateSegments() {
+  if (is_speech_) {
+    if (start_ == -1) {
+      // beginning of speech
+      start_ = std::max(buffer_.Tail() - 2 * window_size_ -
+                            trigger_.MinSpeechDurationSamples(),
+                        std::max(keep_, buffer_.Head()));
+    }
+    // The current segment is a view into buffer_, so there is nothing to
+    // copy here even for a very long segment.
+    cur_end_ = buffer_.Tail() - 1;
+  } else {
+    // non-speech
+    if (start_ != -1 && buffer_.Size()) {
+      // end of speech, save the speech segment
+      int32_t end = buffer_.Tail() - trigger_.MinSilenceDurationSamples();
+      AddSegment(end);
+    }
+
+    if (start_ == -1) {
+      keep_ = std::max(keep_, buffer_.Tail() - 2 * window_size_ -
+                                  trigger_.MinSpeechDurationSamples());
+    }
+
+    start_ = -1;
+    Trim();
+  }
+}
+
+void VadSegmenter::AddSegment(int32_t end) {
+  segments_.push_back({start_, std::max(0, end - start_)});
+  keep_ = std::max(keep_, end);
+}
+
+void VadSegmenter::Trim() {
+  int32_t end = keep_;
+  if (!segments_.empty()) {
+    end = std::min(end, segments_.front().start);
+  }
+
+  int32_t n = std::min(end, buffer_.Tail()) - buffer_.Head();
+  if (n > 0) {
+    buffer_.Pop(n);
+  }
+}
+
+void VadSegmenter::Pop() {
+  segments_.pop_front();
+  front_valid_ = false;
+  Trim();
+}
+
+void VadSegmenter::Clear() {
+  segments_.clear();
+  front_valid_ = false;
+  Trim();
+}
+
+const SpeechSegment &VadSegmenter::Front() const {
+  if (!front_valid_) {
+    const auto &r = segments_.front();
+    front_.start = r.start;
+    // resize() reuses the memory of the previous segment if possible
+    front_.samples.resize(r.n);
+    buffer_.Get(r.start, r.n, front_.samples.data());
+    front_valid_ = true;
+  }
+
+  return front_;
+}
+
+SpeechSegmentView VadSegmenter::FrontView() const {
+  const auto &r = segments_.front();
+
+  SpeechSegmentView ans;
+  ans.start = r.start;
+  ans.samples = buffer_.View(r.start, r.n);
+  return ans;
+}
+
+SpeechSegment VadSegmenter::CurrentSpeechSegment() const {
+  SpeechSegment ans;
+  ans.start = -1;
+
+  if (start_ != -1) {
+    ans.start = start_;
+    ans.samples = buffer_.Get(start_, cur_end_ - start_);
+  }
+
+  return ans;
+}
+
+SpeechSegmentView VadSegmenter::CurrentSpeechSegmentView() const {
+  SpeechSegmentView ans;
+
+  if (start_ != -1) {
+    ans.start = start_;
+    ans.samples = buffer_.View(start_, cur_end_ - start_);
+  }
+
+  return ans;
+}
+
+void VadSegmenter::Reset() {
+  segments_.clear();
+  front_valid_ = false;
+
+  trigger_.Reset();
+  buffer_.Reset();
+  last_.clear();
+  offset_ = 0;
+  is_speech_ = false;
+
+  start_ = -1;
+  cur_end_ = -1;
+  keep_ = 0;
+}
+
+void VadSegmenter::Flush() {
+  if (start_ == -1 || buffer_.Size() == 0) {
+    return;
+  }
+
+  int32_t end = buffer_.Tail();
+  if (end <= start_) {
+    return;
+  }
+
+  AddSegment(end);
+  start_ = -1;
+  Trim();
+}
+
+}  // namespace sherpa_onnx
@@ -0,0 +1,125 @@
+// sherpa-onnx/csrc/vad-segmenter.h
+//
+// Copyright (c)  2025  Xiaomi Corporation
+#ifndef SHERPA_ONNX_CSRC_VAD_SEGMENTER_H_
+#define SHERPA_ONNX_CSRC_VAD_SEGMENTER_H_
+
+#include <deque>
+#include <vector>
+
+#include "sherpa-onnx/csrc/circular-buffer.h"
+#include "sherpa-onnx/csrc/vad-model-config.h"
+#include "sherpa-onnx/csrc/vad-trigger.h"
+#include "sherpa-onnx/csrc/voice-activity-detector.h"
+
+namespace sherpa_onnx {
+
+// It splits the input audio of a single stream into speech segments,
+// given the speech probability of each window.
+//
+// It does not run any model. The caller gets windows with NextWindow(),
+// computes their speech probabilities and passes them to AcceptProb().
+// This makes it possible to compute the probabilities of many streams
+// in a batch. See VoiceActivityDetector and VadEngine.
+class VadSegmenter {
+ public:
+  VadSegmenter(const VadModelConfig &config, int32_t window_size,
+               int32_t window_shift, float buffer_size_in_seconds = 60);
+
+  void AcceptWaveform(const float *samples, int32_t n);
+
+  // Return the next window that needs a speech probability. It returns
+  // nullptr if there are not enough samples.
+  //
+  // The returned pointer is valid until the next call to a non-const method.
+  const float *NextWindow() const;
+
+  // Set the speech probability of the window returned by NextWindow().
+  void AcceptProb(float prob);
+
+  bool Empty() const { return segments_.empty(); }
+
+  void Pop();
+
+  void Clear();
+
+  // The samples of the first segment are copied from the buffer on the
+  // first call after Pop(). The returned reference is valid until the
+  // next call to a non-const method.
+  const SpeechSegment &Front() const;
+
+  SpeechSegmentView FrontView() const;
+
+  void Reset();
+
+  void Flush();
+
+  bool IsSpeechDetected() const { return start_ != -1; }
+
+  SpeechSegment CurrentSpeechSegment() const;
+
+  SpeechSegmentView CurrentSpeechSegmentView() const;
+
+ private:
+  // Switch to a lower threshold and a shorter min silence duration
+  // for long segments.
+  void UpdateTrigger();
+
+  // It is called after all available windows are processed
+  void UpdateSegments();
+
+  // Add the samples [start_, end) as a new segment
+  void AddSegment(int32_t end);
+
+  // Remove samples from buffer_ that are no longer needed
+  void Trim();
+
+ private:
+  struct Range {
+    int32_t start;
+    int32_t n;
+  };
+
+  // Detected segments. Their samples stay in buffer_ until they are
+  // popped, so no copy is made unless Front() is called.
+  std::deque<Range> segments_;
+
+  // Cache for Front()
+  mutable SpeechSegment front_;
+  mutable bool front_valid_ = false;
+
+  VadModelConfig config_;
+  VadTrigger trigger_;
+  CircularBuffer buffer_;
+
+  // samples not yet pushed into buffer_
+  std::vector<float> last_;
+  // index into last_ of the next window
+  int32_t offset_ = 0;
+
+  int32_t window_size_;
+  int32_t window_shift_;
+
+  int32_t max_utterance_length_ = -1;  // in samples
+  float new_min_silence_duration_s_ = 0.1;
+  float new_threshold_ = 0.90;
+
+  float threshold_;
+  float min_silence_duration_;
+
+  // true if any window since the last call to UpdateSegments() is speech
+  bool is_speech_ = false;
+
+  // Start of the current speech segment. -1 if no speech is detected
+  int32_t start_ = -1;
+
+  // End of the current speech segment. Valid only if start_ != -1
+  int32_t cur_end_ = -1;
+
+  // Samples before it are not needed except for segments_
+  int32_t keep_ = 0;
+};
+
+}  // namespace sherpa_onnx
+
+#endif  // SHERPA_ONNX_CSRC_VAD_SEGMENTER_H_
@@ -0,0 +1,61 @@
+// sherpa-onnx/csrc/vad-trigger.h
+//
+// Copyright (c)  2025  Xiaomi Corporation
+#ifndef SHERPA_ONNX_CSRC_VAD_TRIGGER_H_
+#define SHERPA_ONNX_CSRC_VAD_TRIGGER_H_
+
+#include <cstdint>
+
+namespace sherpa_onnx {
+
+// Decide whether the current window is speech from the speech probability
+// of the window. It applies a hysteresis on the threshold and requires
+// a minimum speech/silence duration before switching states.
+//
+// It contains only the per-stream states of a VAD, so it can be used
+// with models that process many streams at once.
+class VadTrigger {
+ public:
+  VadTrigger() = default;
+
+  // @param threshold  Windows with a probability above it are speech
+  // @param min_silence_samples  Minimum number of silence samples to end
+  //                             a speech segment
+  // @param min_speech_samples  Minimum number of speech samples to start
+  //                            a speech segment
+  VadTrigger(float threshold, int32_t min_silence_samples,
+             int32_t min_speech_samples)
+      : threshold_(threshold),
+        min_silence_samples_(min_silence_samples),
+        min_speech_samples_(min_speech_samples) {}
+
+  /**
+   * @param prob Speech probability of the current window
+   * @param window_shift Number of new samples in the current window
+   *
+   * @return Return true if speech is detected. Return false otherwise.
+   */
+  bool IsSpeech(float prob, int32_t window_shift);
+
+  void Reset();
+
+  int32_t MinSilenceDurationSamples() const { return min_silence_samples_; }
+  int32_t MinSpeechDurationSamples() const { return min_speech_samples_; }
+
+  void SetMinSilenceDurationSamples(int32_t n) { min_silence_samples_ = n; }
+  void SetThreshold(float threshold) { threshold_ = threshold; }
+
+ private:
+  float threshold_ = 0.5;
+  int32_t min_silence_samples_ = 0;
+  int32_t min_speech_samples_ = 0;
+
+  bool triggered_ = false;
+  int32_t current_sample_ = 0;
+  int32_t temp_start_ = 0;
+  int32_t temp_end_ = 0;
+};
+
+}  // namespace sherpa_onnx
+
+#endif  // SHERPA_ONNX_CSRC_VAD_TRIGGER_H_
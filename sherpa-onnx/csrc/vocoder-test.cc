@@ -0,0 +1,180 @@
+// sherpa-onnx/csrc/vocoder-test.cc
+//
+// Copyright (c)  2025  Xiaomi Corporation
+
+#include "sherpa-onnx/csrc/vocoder.h"
+
+#include <algorithm>
+#include <array>
+#include <cmath>
+#include <random>
+#include <utility>
+#include <vector>
+
+#include "gtest/gtest.h"
+
+namespace sherpa_onnx {
+
+// Output sample h of frame t depends on frames [t - context, t + context]
+// of the input. Frames outside of the input are treated as 0, so the
+// output near the two ends of the input differs from that of a longer
+// input, like a real vocoder.
+class FakeVocoder : public Vocoder {
+ public:
+  explicit FakeVocoder(int32_t context) : context_(context) {}
+
+  std::vector<float> Run(Ort::Value mel) const override {
+    std::vector<int64_t> shape = mel.GetTensorTypeAndShapeInfo().GetShape();
+    int32_t feat_dim = shape[1];
+    int32_t num_frames = shape[2];
+    const float *p = mel.GetTensorData<float>();
+
+    std::vector<float> ans(num_frames * kHopLength);
+    for (int32_t t = 0; t != num_frames; ++t) {
+      float sum = 0;
+      for (int32_t j = -context_; j <= context_; ++j) {
+        int32_t k = t + j;
+        if (k < 0 || k >= num_frames) {
+          continue;
+        }
+
+        for (int32_t d = 0; d != feat_dim; ++d) {
+          sum += p[d * num_frames + k] * (d + 1) / (std::abs(j) + 1);
+        }
+      }
+
+      for (int32_t h = 0; h != kHopLength; ++h) {
+        ans[t * kHopLength + h] = sum * (h + 1) / kHopLength;
+      }
+    }
+
+    return ans;
+  }
+
+  int32_t HopLength() const override { return kHopLength; }
+
+  static constexpr int32_t kHopLength = 4;
+
+ private:
+  int32_t context_;
+};
+
+static Ort::Value RandomMel(int32_t feat_dim, int32_t num_frames,
+                            std::mt19937 *gen) {
+  Ort::AllocatorWithDefaultOptions allocator;
+  std::array<int64_t, 3> shape = {1, feat_dim, num_frames};
+  Ort::Value mel =
+      Ort::Value::CreateTensor<float>(allocator, shape.data(), shape.size());
+
+  std::uniform_real_distribution<float> dist(-1, 1);
+  float *p = mel.GetTensorMutableData<float>();
+  std::generate(p, p + feat_dim * num_frames, [&]() { return dist(*gen); });
+
+  return mel;
+}
+
+static Ort::Value Copy(const Ort::Value &mel) {
+  Ort::AllocatorWithDefaultOptions allocator;
+  std::vector<int64_t> shape = mel.GetTensorTypeAndShapeInfo().GetShape();
+  Ort::Value ans =
+      Ort::Value::CreateTensor<float>(allocator, shape.data(), shape.size());
+
+  const float *src = mel.GetTensorData<float>();
+  std::copy(src, src + shape[1] * shape[2], ans.GetTensorMutableData<float>());
+  return ans;
+}
+
+static std::vector<float> RunChunked(const Vocoder &vocoder,
+                                     const Ort::Value &mel,
+                                     int32_t chunk_size) {
+  std::vector<float> ans;
+  float last_progress = 0;
+  vocoder.RunChunked(Copy(mel), chunk_size,
+                     [&](const float *samples, int32_t n, float progress) {
+                       EXPECT_GT(progress, last_progress);
+                       last_progress = progress;
+                       ans.insert(ans.end(), samples, samples + n);
+                       return 1;
+                     });
+  EXPECT_EQ(last_progress, 1);
+
+  return ans;
+}
+
+// If the receptive field of the vocoder is within the context of a
+// chunk, the output is the same as that of Run()
+TEST(Vocoder, RunChunked) {
+  std::mt19937 gen(20250103);
+  FakeVocoder vocoder(4);
+
+  for (int32_t num_frames : {5, 30, 100, 101, 150}) {
+    for (int32_t chunk_size : {0, 10, 16, 33}) {
+      Ort::Value mel = RandomMel(3, num_frames, &gen);
+      std::vector<float> expected = vocoder.Run(Copy(mel));
+      std::vector<float> ans = RunChunked(vocoder, mel, chunk_size);
+
+      ASSERT_EQ(ans.size(), expected.size()) << num_frames << " " << chunk_size;
+      for (int32_t i = 0; i != static_cast<int32_t>(ans.size()); ++i) {
+        EXPECT_NEAR(ans[i], expected[i], 1e-5)
+            << num_frames << " " << chunk_size << " " << i;
+      }
+    }
+  }
+}
+
+// If the receptive field is larger than the context, the output differs
+// from that of Run() only near chunk boundaries
+TEST(Vocoder, RunChunkedAwayFromSeams) {
+  std::mt19937 gen(20250104);
+  int32_t context = 12;
+  FakeVocoder vocoder(context);
+
+  // Chunks are [0, 40), [40, 80) and [80, 100)
+  int32_t num_frames = 100;
+  int32_t chunk_size = 40;
+  std::vector<int32_t> seams = {40, 80};
+
+  Ort::Value mel = RandomMel(3, num_frames, &gen);
+  std::vector<float> expected = vocoder.Run(Copy(mel));
+  std::vector<float> ans = RunChunked(vocoder, mel, chunk_size);
+
+  ASSERT_EQ(ans.size(), expected.size());
+
+  int32_t num_checked = 0;
+  for (int32_t t = 0; t != num_frames; ++t) {
+    bool near_seam = false;
+    for (int32_t s : seams) {
+      near_seam = near_seam || std::abs(t - s) < context;
+    }
+
+    if (near_seam) {
+      continue;
+    }
+
+    for (int32_t h = 0; h != FakeVocoder::kHopLength; ++h) {
+      int32_t i = t * FakeVocoder::kHopLength + h;
+      EXPECT_NEAR(ans[i], expected[i], 1e-5) << t << " " << h;
+    }
+    ++num_checked;
+  }
+
+  EXPECT_GT(num_checked, 0);
+}
+
+TEST(Vocoder, RunChunkedStop) {
+  std::mt19937 gen(20250105);
+  FakeVocoder vocoder(4);
+
+  Ort::Value mel = RandomMel(3, 100, &gen);
+
+  int32_t num_calls = 0;
+  vocoder.RunChunked(std::move(mel), 10,
+                     [&](const float *samples, int32_t n, float progress) {
+                       ++num_calls;
+                       return 0;
+                     });
+
+  EXPECT_EQ(num_calls, 1);
+}
+
+}  // namespace sherpa_onnx
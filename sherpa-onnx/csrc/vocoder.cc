@@ -4,6 +4,12 @@
 
 #include "sherpa-onnx/csrc/vocoder.h"
 
+#include <algorithm>
+#include <array>
+#include <memory>
+#include <utility>
+#include <vector>
+
 #if __ANDROID_API__ >= 9
 #include "android/asset_manager.h"
 #include "android/asset_manager_jni.h"
@@ -73,6 +79,120 @@ static ModelType GetModelType(char *model_data, size_t model_data_length,
   }
 }
 
+void Vocoder::RunChunked(Ort::Value mel, int32_t chunk_size,
+                         const VocoderCallback &callback) const {
+  // Number of frames of context on each side of a chunk
+  constexpr int32_t kContext = 8;
+
+  // Number of frames over which neighboring chunks are cross-faded. The
+  // cross-fade is centered on the chunk boundary, so it has to be at most
+  // 2 * kContext.
+  constexpr int32_t kFade = 4;
+
+  std::vector<int64_t> shape = mel.GetTensorTypeAndShapeInfo().GetShape();
+  if (shape.size() != 3 || shape[0] != 1) {
+    SHERPA_ONNX_LOGE("Expect a mel of shape (1, feat_dim, num_frames)");
+    SHERPA_ONNX_EXIT(-1);
+  }
+
+  int32_t feat_dim = shape[1];
+  int32_t num_frames = shape[2];
+
+  if (chunk_size <= 0 || num_frames <= chunk_size + kContext) {
+    std::vector<float> samples = Run(std::move(mel));
+    callback(samples.data(), samples.size(), 1.0);
+    return;
+  }
+
+  const float *p = mel.GetTensorData<float>();
+
+  auto memory_info =
+      Ort::MemoryInfo::CreateCpu(OrtDeviceAllocator, OrtMemTypeDefault);
+
+  int32_t hop_length = HopLength();
+
+  // Output samples of the previous chunk that overlap with the current
+  // chunk. They are cross-faded with the current chunk. tail[0] is the
+  // output sample with index tail_start.
+  std::vector<float> tail;
+  int64_t tail_start = 0;
+
+  std::vector<float> x;
+  std::vector<float> samples;
+
+  for (int32_t start = 0, end = 0; start < num_frames; start = end) {
+    end = std::min(start + chunk_size, num_frames);
+    if (num_frames - end < kContext) {
+      // Avoid a tiny last chunk
+      end = num_frames;
+    }
+    bool is_last = end == num_frames;
+
+    // [ws, we) is the range of frames given to the model
+    int32_t ws = std::max(0, start - kContext);
+    int32_t we = std::min(num_frames, end + kContext);
+    int32_t n = we - ws;
+
+    x.resize(feat_dim * n);
+    for (int32_t d = 0; d != feat_dim; ++d) {
+      const float *src = p + static_cast<int64_t>(d) * num_frames + ws;
+      std::copy(src, src + n, x.begin() + d * n);
+    }
+
+    std::array<int64_t, 3> x_shape = {1, feat_dim, n};
+    Ort::Value x_tensor = Ort::Value::CreateTensor(
+        memory_info, x.data(), x.size(), x_shape.data(), x_shape.size());
+
+    std::vector<float> out = Run(std::move(x_tensor));
+
+    if (hop_length <= 0) {
+      hop_length = static_cast<int32_t>(out.size()) / n;
+    }
+
+    // Number of samples of the cross-fade on each side of the boundary
+    int32_t half_fade = hop_length * kFade / 2;
+
+    // out[i] is the output sample with index offset + i
+    int64_t offset = static_cast<int64_t>(ws) * hop_length;
+    int64_t out_end = offset + static_cast<int64_t>(out.size());
+
+    int64_t begin = std::max(offset, tail_start);
+
+    int64_t emit_end =
+        is_last ? out_end
+                : std::min(out_end,
+                           static_cast<int64_t>(end) * hop_length - half_fade);
+    int64_t keep_end =
+        is_last ? out_end
+                : std::min(out_end,
+                           static_cast<int64_t>(end) * hop_length + half_fade);
+
+    samples.clear();
+
+    int64_t i = begin;
+    int32_t num_tail = static_cast<int32_t>(tail.size());
+    for (int32_t k = 0; k != num_tail && i < emit_end; ++k, ++i) {
+      float w = (k + 0.5f) / num_tail;
+      samples.push_back(tail[k] * (1 - w) + out[i - offset] * w);
+    }
+
+    if (i < emit_end) {
+      samples.insert(samples.end(), out.begin() + (i - offset),
+                     out.begin() + (emit_end - offset));
+      i = emit_end;
+    }
+
+    tail_start = i;
+    tail.assign(out.begin() + (i - offset),
+                out.begin() + std::max(i, keep_end) - offset);
+
+    float progress = static_cast<float>(end) / num_frames;
+    if (!callback(samples.data(), samples.size(), progress)) {
+      return;
+    }
+  }
+}
+
 std::unique_ptr<Vocoder> Vocoder::Create(const OfflineTtsModelConfig &config) {
   auto buffer = ReadFile(config.matcha.vocoder);
   auto model_type = GetModelType(buffer.data(), buffer.size(), config.debug);
@@ -5,6 +5,7 @@
 #ifndef SHERPA_ONNX_CSRC_VOCODER_H_
 #define SHERPA_ONNX_CSRC_VOCODER_H_
 
+#include <functional>
 #include <memory>
 #include <string>
 #include <vector>
@@ -14,6 +15,10 @@
 
 namespace sherpa_onnx {
 
+// If it returns 0, no more chunks are processed.
+using VocoderCallback = std::function<int32_t(
+    const float * /*samples*/, int32_t /*n*/, float /*progress*/)>;
+
 class Vocoder {
  public:
   virtual ~Vocoder() = default;
@@ -28,6 +33,29 @@ class Vocoder {
    *  @return Return a float32 vector containing audio samples..
    */
   virtual std::vector<float> Run(Ort::Value mel) const = 0;
+
+  // Number of output samples per mel frame. Return 0 if it is not known
+  // in advance. In that case, Run() must return exactly
+  // num_frames * hop_length samples.
+  virtual int32_t HopLength() const { return 0; }
+
+  /** Run the vocoder on chunks of the mel spectrogram.
+   *
+   * Each chunk is extended with 8 frames of context on both sides.
+   * Output samples belonging to the context are discarded and neighboring
+   * chunks are cross-faded linearly over 4 frames centered on their
+   * boundary, so there are no clicks at chunk boundaries.
+   *
+   * @param mel A float32 tensor of shape (1, feat_dim, num_frames).
+   * @param chunk_size Number of frames per chunk. If it is not positive or
+   *                   if num_frames is small, the whole mel is processed at
+   *                   once.
+   * @param callback It is called with the samples of each chunk in order.
+   *                 progress is in the range (0, 1]. The samples are freed
+   *                 after it returns.
+   */
+  void RunChunked(Ort::Value mel, int32_t chunk_size,
+                  const VocoderCallback &callback) const;
 };
 
 }  // namespace sherpa_onnx
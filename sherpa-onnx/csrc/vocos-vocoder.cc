@@ -21,6 +21,7 @@
 #include "sherpa-onnx/csrc/file-utils.h"
 #include "sherpa-onnx/csrc/macros.h"
 #include "sherpa-onnx/csrc/onnx-utils.h"
+#include "sherpa-onnx/csrc/session-registry.h"
 #include "sherpa-onnx/csrc/session.h"
 
 namespace sherpa_onnx {
@@ -40,7 +41,8 @@ class VocosVocoder::Impl {
   explicit Impl(const OfflineTtsModelConfig &config)
       : config_(config),
         env_(ORT_LOGGING_LEVEL_ERROR),
-        sess_opts_(GetSessionOptions(config.num_threads, config.provider)),
+        sess_opts_(
+            GetSessionOptionsWithKey(config.num_threads, config.provider)),
         allocator_{} {
     auto buf = ReadFile(config.matcha.vocoder);
     Init(buf.data(), buf.size());
@@ -50,7 +52,8 @@ class VocosVocoder::Impl {
   explicit Impl(Manager *mgr, const OfflineTtsModelConfig &config)
       : config_(config),
         env_(ORT_LOGGING_LEVEL_ERROR),
-        sess_opts_(GetSessionOptions(config.num_threads, config.provider)),
+        sess_opts_(
+            GetSessionOptionsWithKey(config.num_threads, config.provider)),
         allocator_{} {
     auto buf = ReadFile(mgr, config.matcha.vocoder);
     Init(buf.data(), buf.size());
@@ -105,10 +108,11 @@ class VocosVocoder::Impl {
     return istft.Compute(stft_result);
   }
 
+  int32_t HopLength() const { return meta_.hop_length; }
+
  private:
   void Init(void *model_data, size_t model_data_length) {
-    sess_ = std::make_unique<Ort::Session>(env_, model_data, model_data_length,
-                                           sess_opts_);
+    sess_ = GetOrCreateSession(env_, model_data, model_data_length, sess_opts_);
 
     GetInputNames(sess_.get(), &input_names_, &input_names_ptr_);
 
@@ -156,10 +160,10 @@ class VocosVocoder::Impl {
   VocosModelMetaData meta_;
 
   Ort::Env env_;
-  Ort::SessionOptions sess_opts_;
+  SessionOptionsWithKey sess_opts_;
   Ort::AllocatorWithDefaultOptions allocator_;
 
-  std::unique_ptr<Ort::Session> sess_;
+  std::shared_ptr<Ort::Session> sess_;
 
   std::vector<std::string> input_names_;
   std::vector<const char *> input_names_ptr_;
@@ -181,6 +185,8 @@ std::vector<float> VocosVocoder::Run(Ort::Value mel) const {
   return impl_->Run(std::move(mel));
 }
 
+int32_t VocosVocoder::HopLength() const { return impl_->HopLength(); }
+
 #if __ANDROID_API__ >= 9
 template VocosVocoder::VocosVocoder(AAssetManager *mgr,
                                     const OfflineTtsModelConfig &config);
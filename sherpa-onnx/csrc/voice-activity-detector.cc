@@ -4,9 +4,7 @@
 
 #include "sherpa-onnx/csrc/voice-activity-detector.h"
 
-#include <algorithm>
-#include <queue>
-#include <utility>
+#include <memory>
 
 #if __ANDROID_API__ >= 9
 #include "android/asset_manager.h"
@@ -17,9 +15,8 @@
 #include "rawfile/raw_file_manager.h"
 #endif
 
-#include "sherpa-onnx/csrc/circular-buffer.h"
-#include "sherpa-onnx/csrc/macros.h"
 #include "sherpa-onnx/csrc/vad-model.h"
+#include "sherpa-onnx/csrc/vad-segmenter.h"
 
 namespace sherpa_onnx {
 
@@ -28,194 +25,65 @@ class VoiceActivityDetector::Impl {
   explicit Impl(const VadModelConfig &config, float buffer_size_in_seconds = 60)
       : model_(VadModel::Create(config)),
         config_(config),
-        buffer_(buffer_size_in_seconds * config.sample_rate) {
-    Init();
-  }
+        segmenter_(config, model_->WindowSize(), model_->WindowShift(),
+                   buffer_size_in_seconds) {}
 
   template <typename Manager>
   Impl(Manager *mgr, const VadModelConfig &config,
        float buffer_size_in_seconds = 60)
       : model_(VadModel::Create(mgr, config)),
         config_(config),
-        buffer_(buffer_size_in_seconds * config.sample_rate) {
-    Init();
-  }
+        segmenter_(config, model_->WindowSize(), model_->WindowShift(),
+                   buffer_size_in_seconds) {}
 
   float Compute(const float *samples, int32_t n) {
     return model_->Compute(samples, n);
   }
 
   void AcceptWaveform(const float *samples, int32_t n) {
-    if (buffer_.Size() > max_utterance_length_) {
-      model_->SetMinSilenceDuration(new_min_silence_duration_s_);
-      model_->SetThreshold(new_threshold_);
-    } else {
-      if (!config_.silero_vad.model.empty()) {
-        model_->SetMinSilenceDuration(config_.silero_vad.min_silence_duration);
-        model_->SetThreshold(config_.silero_vad.threshold);
-      } else if (!config_.ten_vad.model.empty()) {
-        model_->SetMinSilenceDuration(config_.ten_vad.min_silence_duration);
-        model_->SetThreshold(config_.ten_vad.threshold);
-      } else {
-        SHERPA_ONNX_LOGE("Unknown vad model");
-        SHERPA_ONNX_EXIT(-1);
-      }
-    }
+    segmenter_.AcceptWaveform(samples, n);
 
     int32_t window_size = model_->WindowSize();
-    int32_t window_shift = model_->WindowShift();
 
-    // note n is usually window_size and there is no need to use
-    // an extra buffer here
-    last_.insert(last_.end(), samples, samples + n);
-
-    if (last_.size() < window_size) {
-      return;
-    }
-
-    // Note: For v4, window_shift == window_size
-    int32_t k =
-        (static_cast<int32_t>(last_.size()) - window_size) / window_shift + 1;
-    const float *p = last_.data();
-    bool is_speech = false;
-
-    for (int32_t i = 0; i < k; ++i, p += window_shift) {
-      buffer_.Push(p, window_shift);
+    while (const float *p = segmenter_.NextWindow()) {
       // NOTE(fangjun): Please don't use a very large n.
-      bool this_window_is_speech = model_->IsSpeech(p, window_size);
-      is_speech = is_speech || this_window_is_speech;
-    }
-
-    last_ = std::vector<float>(
-        p, static_cast<const float *>(last_.data()) + last_.size());
-
-    if (is_speech) {
-      if (start_ == -1) {
-        // beginning of speech
-        start_ = std::max(buffer_.Tail() - 2 * model_->WindowSize() -
-                              model_->MinSpeechDurationSamples(),
-                          buffer_.Head());
-        cur_segment_.start = start_;
-      }
-      int32_t num_samples = buffer_.Tail() - start_ - 1;
-      cur_segment_.samples = buffer_.Get(start_, num_samples);
-    } else {
-      // non-speech
-
-      cur_segment_.start = -1;
-      cur_segment_.samples.clear();
-
-      if (start_ != -1 && buffer_.Size()) {
-        // end of speech, save the speech segment
-        int32_t end = buffer_.Tail() - model_->MinSilenceDurationSamples();
-
-        std::vector<float> s = buffer_.Get(start_, end - start_);
-        SpeechSegment segment;
-
-        segment.start = start_;
-        segment.samples = std::move(s);
-
-        segments_.push(std::move(segment));
-
-        buffer_.Pop(end - buffer_.Head());
-      }
-
-      if (start_ == -1) {
-        int32_t end = buffer_.Tail() - 2 * model_->WindowSize() -
-                      model_->MinSpeechDurationSamples();
-        int32_t n = std::max(0, end - buffer_.Head());
-        if (n > 0) {
-          buffer_.Pop(n);
-        }
-      }
-
-      start_ = -1;
+      segmenter_.AcceptProb(model_->Compute(p, window_size));
     }
   }
 
-  bool Empty() const { return segments_.empty(); }
+  bool Empty() const { return segmenter_.Empty(); }
 
-  void Pop() { segments_.pop(); }
+  void Pop() { segmenter_.Pop(); }
 
-  void Clear() { std::queue<SpeechSegment>().swap(segments_); }
+  void Clear() { segmenter_.Clear(); }
 
-  const SpeechSegment &Front() const { return segments_.front(); }
+  const SpeechSegment &Front() const { return segmenter_.Front(); }
 
-  void Reset() {
-    std::queue<SpeechSegment>().swap(segments_);
+  SpeechSegmentView FrontView() const { return segmenter_.FrontView(); }
 
+  void Reset() {
     model_->Reset();
-    buffer_.Reset();
-    last_.clear();
-
-    start_ = -1;
-
-    cur_segment_.start = -1;
-    cur_segment_.samples.clear();
+    segmenter_.Reset();
   }
 
-  void Flush() {
-    if (start_ == -1 || buffer_.Size() == 0) {
-      return;
-    }
-
-    int32_t end = buffer_.Tail();
-    if (end <= start_) {
-      return;
-    }
-
-    std::vector<float> s = buffer_.Get(start_, end - start_);
+  void Flush() { segmenter_.Flush(); }
 
-    SpeechSegment segment;
+  bool IsSpeechDetected() const { return segmenter_.IsSpeechDetected(); }
 
-    segment.start = start_;
-    segment.samples = std::move(s);
-
-    segments_.push(std::move(segment));
-
-    buffer_.Pop(end - buffer_.Head());
-    start_ = -1;
-
-    cur_segment_.start = -1;
-    cur_segment_.samples.clear();
+  SpeechSegment CurrentSpeechSegment() const {
+    return segmenter_.CurrentSpeechSegment();
   }
 
-  bool IsSpeechDetected() const { return start_ != -1; }
-
-  SpeechSegment CurrentSpeechSegment() const { return cur_segment_; }
+  SpeechSegmentView CurrentSpeechSegmentView() const {
+    return segmenter_.CurrentSpeechSegmentView();
+  }
 
   const VadModelConfig &GetConfig() const { return config_; }
 
  private:
-  void Init() {
-    if (!config_.silero_vad.model.empty()) {
-      max_utterance_length_ =
-          config_.sample_rate * config_.silero_vad.max_speech_duration;
-    } else if (!config_.ten_vad.model.empty()) {
-      max_utterance_length_ =
-          config_.sample_rate * config_.ten_vad.max_speech_duration;
-    } else {
-      SHERPA_ONNX_LOGE("Unsupported VAD model");
-      SHERPA_ONNX_EXIT(-1);
-    }
-  }
-
- private:
-  std::queue<SpeechSegment> segments_;
-
-  // it is empty if no speech is detected
-  SpeechSegment cur_segment_;
-
   std::unique_ptr<VadModel> model_;
   VadModelConfig config_;
-  CircularBuffer buffer_;
-  std::vector<float> last_;
-
-  int max_utterance_length_ = -1;  // in samples
-  float new_min_silence_duration_s_ = 0.1;
-  float new_threshold_ = 0.90;
-
-  int32_t start_ = -1;
+  VadSegmenter segmenter_;
 };
 
 VoiceActivityDetector::VoiceActivityDetector(
@@ -244,6 +112,10 @@ const SpeechSegment &VoiceActivityDetector::Front() const {
   return impl_->Front();
 }
 
+SpeechSegmentView VoiceActivityDetector::FrontView() const {
+  return impl_->FrontView();
+}
+
 void VoiceActivityDetector::Reset() const { impl_->Reset(); }
 
 void VoiceActivityDetector::Flush() const { impl_->Flush(); }
@@ -256,6 +128,10 @@ SpeechSegment VoiceActivityDetector::CurrentSpeechSegment() const {
   return impl_->CurrentSpeechSegment();
 }
 
+SpeechSegmentView VoiceActivityDetector::CurrentSpeechSegmentView() const {
+  return impl_->CurrentSpeechSegmentView();
+}
+
 const VadModelConfig &VoiceActivityDetector::GetConfig() const {
   return impl_->GetConfig();
 }
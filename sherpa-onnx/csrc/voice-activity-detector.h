@@ -7,6 +7,7 @@
 #include <memory>
 #include <vector>
 
+#include "sherpa-onnx/csrc/circular-buffer.h"
 #include "sherpa-onnx/csrc/vad-model-config.h"
 
 namespace sherpa_onnx {
@@ -16,6 +17,14 @@ struct SpeechSegment {
   std::vector<float> samples;
 };
 
+// Like SpeechSegment, but samples point into the internal buffer of the
+// VAD instead of being copied. It is invalidated by the next call to a
+// non-const method of the VAD.
+struct SpeechSegmentView {
+  int32_t start = -1;  // in samples
+  CircularBufferView samples;
+};
+
 class VoiceActivityDetector {
  public:
   explicit VoiceActivityDetector(const VadModelConfig &config,
@@ -40,11 +49,17 @@ class VoiceActivityDetector {
   // methods of VoiceActivityDetector.
   const SpeechSegment &Front() const;
 
+  // Same as Front(), but it does not copy the samples.
+  SpeechSegmentView FrontView() const;
+
   bool IsSpeechDetected() const;
 
   // It is empty if IsSpeechDetected() returns false
   SpeechSegment CurrentSpeechSegment() const;
 
+  // Same as CurrentSpeechSegment(), but it does not copy the samples.
+  SpeechSegmentView CurrentSpeechSegmentView() const;
+
   void Reset() const;
 
   // At the end of the utterance, you can invoke this method so that
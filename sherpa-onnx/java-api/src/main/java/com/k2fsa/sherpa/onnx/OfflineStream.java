@@ -26,6 +26,11 @@ public class OfflineStream {
         acceptWaveform(this.ptr, samples, sampleRate);
     }
 
+    // 16-bit PCM samples, e.g., from javax.sound.sampled or AudioRecord
+    public void acceptWaveform(short[] samples, int sampleRate) {
+        acceptWaveformShort(this.ptr, samples, sampleRate);
+    }
+
     public void release() {
         // stream object must be release after used
         if (this.ptr == 0) {
@@ -43,5 +48,7 @@ public class OfflineStream {
 
     private native void acceptWaveform(long ptr, float[] samples, int sampleRate);
 
+    private native void acceptWaveformShort(long ptr, short[] samples, int sampleRate);
+
     private native void delete(long ptr);
 }
@@ -27,6 +27,11 @@ public class OnlineStream {
         acceptWaveform(this.ptr, samples, sampleRate);
     }
 
+    // 16-bit PCM samples, e.g., from javax.sound.sampled or AudioRecord
+    public void acceptWaveform(short[] samples, int sampleRate) {
+        acceptWaveformShort(this.ptr, samples, sampleRate);
+    }
+
     public void inputFinished() {
         inputFinished(this.ptr);
     }
@@ -52,6 +57,8 @@ public class OnlineStream {
 
     private native void acceptWaveform(long ptr, float[] samples, int sampleRate);
 
+    private native void acceptWaveformShort(long ptr, short[] samples, int sampleRate);
+
     private native void inputFinished(long ptr);
 
     private native void delete(long ptr);
@@ -23,3 +23,19 @@ JNIEXPORT void JNICALL Java_com_k2fsa_sherpa_onnx_OfflineStream_acceptWaveform(
   stream->AcceptWaveform(sample_rate, p, n);
   env->ReleaseFloatArrayElements(samples, p, JNI_ABORT);
 }
+
+// 16-bit PCM samples. They are converted to float inside.
+SHERPA_ONNX_EXTERN_C
+JNIEXPORT void JNICALL
+Java_com_k2fsa_sherpa_onnx_OfflineStream_acceptWaveformShort(JNIEnv *env,
+                                                       jobject /*obj*/,
+                                                       jlong ptr,
+                                                       jshortArray samples,
+                                                       jint sample_rate) {
+  auto stream = reinterpret_cast<sherpa_onnx::OfflineStream *>(ptr);
+
+  jshort *p = env->GetShortArrayElements(samples, nullptr);
+  jsize n = env->GetArrayLength(samples);
+  stream->AcceptWaveform(sample_rate, reinterpret_cast<const int16_t *>(p), n);
+  env->ReleaseShortArrayElements(samples, p, JNI_ABORT);
+}
@@ -182,12 +182,14 @@ JNIEXPORT void JNICALL Java_com_k2fsa_sherpa_onnx_Vad_clear(JNIEnv * /*env*/,
 SHERPA_ONNX_EXTERN_C
 JNIEXPORT jobjectArray JNICALL
 Java_com_k2fsa_sherpa_onnx_Vad_front(JNIEnv *env, jobject /*obj*/, jlong ptr) {
-  const auto &front =
-      reinterpret_cast<sherpa_onnx::VoiceActivityDetector *>(ptr)->Front();
-
-  jfloatArray samples_arr = env->NewFloatArray(front.samples.size());
-  env->SetFloatArrayRegion(samples_arr, 0, front.samples.size(),
-                           front.samples.data());
+  auto front =
+      reinterpret_cast<sherpa_onnx::VoiceActivityDetector *>(ptr)->FrontView();
+
+  // Copy directly from the internal buffer of the VAD
+  const auto &v = front.samples;
+  jfloatArray samples_arr = env->NewFloatArray(v.Size());
+  env->SetFloatArrayRegion(samples_arr, 0, v.n1, v.p1);
+  env->SetFloatArrayRegion(samples_arr, v.n1, v.n2, v.p2);
 
   jobjectArray obj_arr = (jobjectArray)env->NewObjectArray(
       2, env->FindClass("java/lang/Object"), nullptr);
@@ -4,6 +4,10 @@ class OfflineStream(var ptr: Long) {
     fun acceptWaveform(samples: FloatArray, sampleRate: Int) =
         acceptWaveform(ptr, samples, sampleRate)
 
+    // 16-bit PCM samples, e.g., from AudioRecord with ENCODING_PCM_16BIT
+    fun acceptWaveform(samples: ShortArray, sampleRate: Int) =
+        acceptWaveformShort(ptr, samples, sampleRate)
+
     protected fun finalize() {
         if (ptr != 0L) {
             delete(ptr)
@@ -22,6 +26,7 @@ class OfflineStream(var ptr: Long) {
     }
 
     private external fun acceptWaveform(ptr: Long, samples: FloatArray, sampleRate: Int)
+    private external fun acceptWaveformShort(ptr: Long, samples: ShortArray, sampleRate: Int)
     private external fun delete(ptr: Long)
 
     companion object {
@@ -4,6 +4,10 @@ class OnlineStream(var ptr: Long = 0) {
     fun acceptWaveform(samples: FloatArray, sampleRate: Int) =
         acceptWaveform(ptr, samples, sampleRate)
 
+    // 16-bit PCM samples, e.g., from AudioRecord with ENCODING_PCM_16BIT
+    fun acceptWaveform(samples: ShortArray, sampleRate: Int) =
+        acceptWaveformShort(ptr, samples, sampleRate)
+
     fun inputFinished() = inputFinished(ptr)
 
     protected fun finalize() {
@@ -24,6 +28,7 @@ class OnlineStream(var ptr: Long = 0) {
     }
 
     private external fun acceptWaveform(ptr: Long, samples: FloatArray, sampleRate: Int)
+    private external fun acceptWaveformShort(ptr: Long, samples: ShortArray, sampleRate: Int)
     private external fun inputFinished(ptr: Long)
     private external fun delete(ptr: Long)
 
@@ -5,6 +5,7 @@
 #include "sherpa-onnx/python/csrc/fast-clustering.h"
 
 #include <sstream>
+#include <string>
 #include <vector>
 
 #include "sherpa-onnx/csrc/fast-clustering.h"
@@ -14,10 +15,13 @@ namespace sherpa_onnx {
 static void PybindFastClusteringConfig(py::module *m) {
   using PyClass = FastClusteringConfig;
   py::class_<PyClass>(*m, "FastClusteringConfig")
-      .def(py::init<int32_t, float>(), py::arg("num_clusters") = -1,
-           py::arg("threshold") = 0.5)
+      .def(py::init<int32_t, float, const std::string &, int32_t>(),
+           py::arg("num_clusters") = -1, py::arg("threshold") = 0.5,
+           py::arg("method") = "hclust", py::arg("block_size") = 1000)
       .def_readwrite("num_clusters", &PyClass::num_clusters)
       .def_readwrite("threshold", &PyClass::threshold)
+      .def_readwrite("method", &PyClass::method)
+      .def_readwrite("block_size", &PyClass::block_size)
       .def("__str__", &PyClass::ToString)
       .def("validate", &PyClass::Validate);
 }
@@ -37,6 +37,8 @@ static void PybindOfflineSpeakerSegmentationModelConfig(py::module *m) {
       .def_readwrite("num_threads", &PyClass::num_threads)
       .def_readwrite("debug", &PyClass::debug)
       .def_readwrite("provider", &PyClass::provider)
+      .def_readwrite("batch_size", &PyClass::batch_size)
+      .def_readwrite("num_workers", &PyClass::num_workers)
       .def("__str__", &PyClass::ToString)
       .def("validate", &PyClass::Validate);
 }
@@ -15,11 +15,12 @@ void PybindOnlineLMConfig(py::module *m) {
   py::class_<PyClass>(*m, "OnlineLMConfig")
       .def(py::init<const std::string &, float, int32_t,
            const std::string &, bool, const std::string &,
-           float, int>(),
+           float, int, int>(),
            py::arg("model") = "", py::arg("scale") = 0.5f,
            py::arg("lm_num_threads") = 1, py::arg("lm_provider") = "cpu",
            py::arg("shallow_fusion") = true, py::arg("lodr_fst") = "",
-           py::arg("lodr_scale") = 0.0f, py::arg("lodr_backoff_id") = -1)
+           py::arg("lodr_scale") = 0.0f, py::arg("lodr_backoff_id") = -1,
+           py::arg("lm_cache_size") = 1024)
       .def_readwrite("model", &PyClass::model)
       .def_readwrite("scale", &PyClass::scale)
       .def_readwrite("lm_provider", &PyClass::lm_provider)
@@ -28,6 +29,7 @@ void PybindOnlineLMConfig(py::module *m) {
       .def_readwrite("lodr_fst", &PyClass::lodr_fst)
       .def_readwrite("lodr_scale", &PyClass::lodr_scale)
       .def_readwrite("lodr_backoff_id", &PyClass::lodr_backoff_id)
+      .def_readwrite("lm_cache_size", &PyClass::lm_cache_size)
 
       .def("__str__", &PyClass::ToString);
 }
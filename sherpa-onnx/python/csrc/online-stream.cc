@@ -4,9 +4,12 @@
 
 #include "sherpa-onnx/python/csrc/online-stream.h"
 
+#include <string>
+#include <utility>
 #include <vector>
 
 #include "sherpa-onnx/csrc/online-stream.h"
+#include "sherpa-onnx/python/csrc/waveform-utils.h"
 
 namespace sherpa_onnx {
 
@@ -18,11 +21,13 @@ Args:
     Sample rate of the input samples. If it is different from the one
     expected by the model, we will do resampling inside.
   waveform:
-    A 1-D float32 tensor containing audio samples. It must be normalized
-    to the range [-1, 1].
+    A 1-D array containing audio samples. If it is a C-contiguous
+    float32 numpy array, it is used in place without a copy. An int16
+    numpy array is treated as 16-bit PCM and converted to float inside.
+    Anything else, e.g., a list or a float64 array, is first converted
+    to float32. Float samples must be normalized to the range [-1, 1].
 )";
 
-
 constexpr const char *kGetFramesUsage = R"(
 Get n frames starting from the given frame index.
 (hint: intended for debugging, for comparing FBANK features across pipelines)
@@ -44,12 +49,10 @@ void PybindOnlineStream(py::module *m) {
   py::class_<PyClass>(*m, "OnlineStream")
       .def(
           "accept_waveform",
-          [](PyClass &self, float sample_rate,
-             const std::vector<float> &waveform) {
-            self.AcceptWaveform(sample_rate, waveform.data(), waveform.size());
+          [](PyClass &self, float sample_rate, py::object waveform) {
+            AcceptWaveformImpl(self, sample_rate, std::move(waveform));
           },
-          py::arg("sample_rate"), py::arg("waveform"), kAcceptWaveformUsage,
-          py::call_guard<py::gil_scoped_release>())
+          py::arg("sample_rate"), py::arg("waveform"), kAcceptWaveformUsage)
       .def("input_finished", &PyClass::InputFinished,
            py::call_guard<py::gil_scoped_release>())
       .def("get_frames", &PyClass::GetFrames,
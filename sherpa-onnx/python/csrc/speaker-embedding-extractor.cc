@@ -5,6 +5,7 @@
 #include "sherpa-onnx/python/csrc/speaker-embedding-extractor.h"
 
 #include <string>
+#include <vector>
 
 #include "sherpa-onnx/csrc/speaker-embedding-extractor.h"
 
@@ -37,6 +38,12 @@ void PybindSpeakerEmbeddingExtractor(py::module *m) {
            py::call_guard<py::gil_scoped_release>())
       .def("compute", &PyClass::Compute,
            py::call_guard<py::gil_scoped_release>())
+      .def(
+          "compute_batch",
+          [](const PyClass &self, std::vector<OnlineStream *> ss) {
+            return self.ComputeBatch(ss.data(), ss.size());
+          },
+          py::arg("ss"), py::call_guard<py::gil_scoped_release>())
       .def("is_ready", &PyClass::IsReady,
            py::call_guard<py::gil_scoped_release>());
 }
@@ -4,6 +4,7 @@
 
 #include "sherpa-onnx/python/csrc/speaker-embedding-manager.h"
 
+#include <sstream>
 #include <string>
 #include <vector>
 
@@ -53,6 +54,32 @@ void PybindSpeakerEmbeddingManager(py::module *m) {
               -> std::string { return self.Search(v.data(), threshold); },
           py::arg("v"), py::arg("threshold"),
           py::call_guard<py::gil_scoped_release>())
+      .def(
+          "search_batch",
+          [](const PyClass &self, const std::vector<std::vector<float>> &v,
+             float threshold) -> std::vector<std::string> {
+            std::vector<float> buf;
+            buf.reserve(v.size() * self.Dim());
+            for (const auto &x : v) {
+              if (static_cast<int32_t>(x.size()) != self.Dim()) {
+                std::ostringstream os;
+                os << "Expect embeddings of dim " << self.Dim()
+                   << ". Given: " << x.size();
+                throw py::value_error(os.str());
+              }
+              buf.insert(buf.end(), x.begin(), x.end());
+            }
+            return self.Search(buf.data(), v.size(), threshold);
+          },
+          py::arg("v"), py::arg("threshold"),
+          py::call_guard<py::gil_scoped_release>())
+      .def("build_index", &PyClass::BuildIndex, py::arg("num_lists"),
+           py::call_guard<py::gil_scoped_release>())
+      .def_property("num_probes", &PyClass::NumProbes, &PyClass::SetNumProbes)
+      .def("save", &PyClass::Save, py::arg("filename"),
+           py::call_guard<py::gil_scoped_release>())
+      .def("load", &PyClass::Load, py::arg("filename"),
+           py::call_guard<py::gil_scoped_release>())
       .def(
           "verify",
           [](const PyClass &self, const std::string &name,
@@ -0,0 +1,58 @@
+// sherpa-onnx/python/csrc/waveform-utils.h
+//
+// Copyright (c)  2025  Xiaomi Corporation
+
+#ifndef SHERPA_ONNX_PYTHON_CSRC_WAVEFORM_UTILS_H_
+#define SHERPA_ONNX_PYTHON_CSRC_WAVEFORM_UTILS_H_
+
+#include <string>
+
+#include "sherpa-onnx/python/csrc/sherpa-onnx.h"
+
+namespace sherpa_onnx {
+
+// Call self.AcceptWaveform() with the given waveform.
+//
+// An int16 numpy array is passed as 16-bit PCM. A C-contiguous float32
+// numpy array is passed without a copy. Anything else is first converted
+// to float32.
+//
+// Stream is either OnlineStream or OfflineStream.
+template <typename Stream>
+void AcceptWaveformImpl(Stream &self, float sample_rate,  // NOLINT
+                        py::object waveform) {
+  if (py::isinstance<py::array_t<int16_t>>(waveform)) {
+    auto samples =
+        py::array_t<int16_t, py::array::c_style | py::array::forcecast>::ensure(
+            waveform);
+    if (samples.ndim() != 1) {
+      throw py::value_error("Expect a 1-D array. Given: " +
+                            std::to_string(samples.ndim()) + "-D");
+    }
+
+    py::gil_scoped_release release;
+    self.AcceptWaveform(sample_rate, samples.data(), samples.size());
+    return;
+  }
+
+  auto samples =
+      py::array_t<float, py::array::c_style | py::array::forcecast>::ensure(
+          waveform);
+  if (!samples) {
+    // ensure() sets a Python error, which is replaced by the one below
+    PyErr_Clear();
+    throw py::type_error("waveform must be a 1-D float32/float64/int16 array");
+  }
+
+  if (samples.ndim() != 1) {
+    throw py::value_error("Expect a 1-D array. Given: " +
+                          std::to_string(samples.ndim()) + "-D");
+  }
+
+  py::gil_scoped_release release;
+  self.AcceptWaveform(sample_rate, samples.data(), samples.size());
+}
+
+}  // namespace sherpa_onnx
+
+#endif  // SHERPA_ONNX_PYTHON_CSRC_WAVEFORM_UTILS_H_